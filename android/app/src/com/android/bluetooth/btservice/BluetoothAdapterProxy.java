@@ -16,6 +16,7 @@
 package com.android.bluetooth.btservice;
 
 import android.bluetooth.BluetoothAdapter;
+import android.os.SystemProperties;
 import android.util.Log;
 
 import com.android.bluetooth.Utils;
@@ -32,6 +33,9 @@ public class BluetoothAdapterProxy {
     private static final String TAG = BluetoothAdapterProxy.class.getSimpleName();
     private static BluetoothAdapterProxy sInstance;
     private static final Object INSTANCE_LOCK = new Object();
+    // Also read by the native LE scanning manager, which filters the scan results when it is set
+    private static final String HOST_SCAN_FILTERING_PROPERTY =
+            "bluetooth.le.host_scan_filtering.enabled";
 
     private BluetoothAdapterProxy() {}
 
@@ -59,6 +63,16 @@ public class BluetoothAdapterProxy {
         return adapter.isOffloadedFilteringSupported();
     }
 
+    /**
+     * Proxy function that reads the host scan filtering system property.
+     *
+     * @return whether the scan filters are applied by the native stack on the host when the
+     * offloaded scan filtering is not supported
+     */
+    public boolean isHostScanFilteringEnabled() {
+        return SystemProperties.getBoolean(HOST_SCAN_FILTERING_PROPERTY, false);
+    }
+
     /**
      * Allow unit tests to substitute BluetoothAdapterProxy with a test instance
      *
@@ -359,6 +359,20 @@ public class ScanManager {
         return mBluetoothAdapterProxy.isOffloadedScanFilteringSupported();
     }
 
+    // Without offloaded filtering, the native stack can apply the scan filters on the host. The
+    // filters of every client are then configured as they would be in the controller, with an
+    // ALL_PASS filter for the unfiltered clients, so that no client loses results.
+    private boolean isHostFilteringEnabled() {
+        if (mBluetoothAdapterProxy == null) {
+            return false;
+        }
+        return !isFilteringSupported() && mBluetoothAdapterProxy.isHostScanFilteringEnabled();
+    }
+
+    private boolean shouldConfigureScanFilters() {
+        return isFilteringSupported() || isHostFilteringEnabled();
+    }
+
     boolean isAutoBatchScanClientEnabled(ScanClient client) {
         return mScanNative.isAutoBatchScanClientEnabled(client);
     }
@@ -952,6 +966,9 @@ public class ScanManager {
         private static final int ALL_PASS_FILTER_INDEX_BATCH_SCAN = 2;
         private static final int ALL_PASS_FILTER_SELECTION = 0;
 
+        // Filter indices available when the scan filters are applied on the host.
+        private static final int HOST_SCAN_FILTERS_SUPPORTED = 32;
+
         private static final int DISCARD_OLDEST_WHEN_BUFFER_FULL = 0;
 
 
@@ -1090,11 +1107,11 @@ public class ScanManager {
         }
 
         void startRegularScan(ScanClient client) {
-            if (isFilteringSupported() && mFilterIndexStack.isEmpty()
+            if (shouldConfigureScanFilters() && mFilterIndexStack.isEmpty()
                     && mClientFilterIndexMap.isEmpty()) {
                 initFilterIndexStack();
             }
-            if (isFilteringSupported()) {
+            if (shouldConfigureScanFilters()) {
                 configureScanFilters(client);
             }
             // Start scan native only for the first client.
@@ -1122,7 +1139,7 @@ public class ScanManager {
         }
 
         void startBatchScan(ScanClient client) {
-            if (mFilterIndexStack.isEmpty() && isFilteringSupported()) {
+            if (mFilterIndexStack.isEmpty() && shouldConfigureScanFilters()) {
                 initFilterIndexStack();
             }
             configureScanFilters(client);
@@ -1601,8 +1618,9 @@ public class ScanManager {
         }
 
         private void initFilterIndexStack() {
-            int maxFiltersSupported =
-                    AdapterService.getAdapterService().getNumOfOffloadedScanFilterSupported();
+            int maxFiltersSupported = isFilteringSupported()
+                    ? AdapterService.getAdapterService().getNumOfOffloadedScanFilterSupported()
+                    : HOST_SCAN_FILTERS_SUPPORTED;
             // Start from index 4 as:
             // index 0 is reserved for ALL_PASS filter in Settings app.
             // index 1 is reserved for ALL_PASS filter for regular scan apps.
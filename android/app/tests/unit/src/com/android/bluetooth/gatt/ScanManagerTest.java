@@ -29,6 +29,7 @@ import static android.bluetooth.le.ScanSettings.SCAN_MODE_SCREEN_OFF_BALANCED;
 import static com.google.common.truth.Truth.assertThat;
 
 import static org.junit.Assert.assertNotNull;
+import static org.mockito.ArgumentMatchers.any;
 import static org.mockito.ArgumentMatchers.anyInt;
 import static org.mockito.ArgumentMatchers.anyLong;
 import static org.mockito.Mockito.anyString;
@@ -1236,4 +1237,41 @@ public class ScanManagerTest {
                 eq(BluetoothProtoEnums.SCREEN_OFF_EVENT), anyLong());
         Mockito.clearInvocations(mMetricsLogger);
     }
+
+    @Test
+    public void testHostScanFilteringConfiguresAllPassFilterForUnfilteredClient() {
+        when(mBluetoothAdapterProxy.isOffloadedScanFilteringSupported()).thenReturn(false);
+        when(mBluetoothAdapterProxy.isHostScanFilteringEnabled()).thenReturn(true);
+        // Turn on screen
+        sendMessageWaitForProcessed(createScreenOnOffMessage(true));
+        // Start a filtered and an unfiltered scan client
+        ScanClient filteredClient = createScanClient(0, true, SCAN_MODE_LOW_POWER);
+        ScanClient unfilteredClient = createScanClient(1, false, SCAN_MODE_LOW_POWER);
+        sendMessageWaitForProcessed(createStartStopScanMessage(true, filteredClient));
+        sendMessageWaitForProcessed(createStartStopScanMessage(true, unfilteredClient));
+
+        // The filtered client gets its own filter index, the unfiltered one the ALL_PASS filter
+        ArgumentCaptor<FilterParams> filterParams = ArgumentCaptor.forClass(FilterParams.class);
+        verify(mScanNativeInterface, times(1)).gattClientScanFilterAdd(eq(0), any(), anyInt());
+        verify(mScanNativeInterface, times(2)).gattClientScanFilterParamAdd(filterParams.capture());
+        assertThat(filterParams.getAllValues().get(0).getFiltIndex()).isAtLeast(4);
+        assertThat(filterParams.getAllValues().get(1).getFiltIndex()).isEqualTo(1);
+        assertThat(filterParams.getAllValues().get(1).getFeatSeln()).isEqualTo(0);
+    }
+
+    @Test
+    public void testNoScanFiltersConfiguredWithoutOffloadOrHostFiltering() {
+        when(mBluetoothAdapterProxy.isOffloadedScanFilteringSupported()).thenReturn(false);
+        when(mBluetoothAdapterProxy.isHostScanFilteringEnabled()).thenReturn(false);
+        // Turn on screen
+        sendMessageWaitForProcessed(createScreenOnOffMessage(true));
+        // Start a filtered scan client
+        ScanClient client = createScanClient(0, true, SCAN_MODE_LOW_POWER);
+        sendMessageWaitForProcessed(createStartStopScanMessage(true, client));
+
+        // The scan results are only filtered by the scan clients
+        verify(mScanNativeInterface, never()).gattClientScanFilterEnable(anyInt(), eq(true));
+        verify(mScanNativeInterface, never()).gattClientScanFilterAdd(anyInt(), any(), anyInt());
+        verify(mScanNativeInterface, never()).gattClientScanFilterParamAdd(any());
+    }
 }
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bta/gatt/bta_gattc_int.h"
+#include "bta/gatt/database_builder.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+using bluetooth::Uuid;
+
+namespace {
+
+constexpr size_t kNumDevices = 50;
+
+// A database the size of a typical LE Audio or HID device: a dozen services,
+// with a few characteristics each, most of them with a CCC descriptor
+gatt::Database BuildDatabase(uint16_t seed) {
+  gatt::DatabaseBuilder builder;
+  uint16_t handle = 0x0001;
+  for (uint16_t svc = 0; svc < 12; ++svc) {
+    uint16_t start_handle = handle;
+    uint16_t end_handle = start_handle + 5 * 4;
+    builder.AddService(start_handle, end_handle,
+                       Uuid::From16Bit(0x1800 + (svc + seed) % 0x40), true);
+    handle++;
+    for (uint16_t chr = 0; chr < 5; ++chr) {
+      builder.AddCharacteristic(handle, handle + 1,
+                                Uuid::From16Bit(0x2a00 + svc * 5 + chr), 0x1a);
+      if (chr != 4) builder.AddDescriptor(handle + 2, Uuid::From16Bit(0x2902));
+      handle += 4;
+    }
+    handle = end_handle + 1;
+  }
+  return builder.Build();
+}
+
+RawAddress DeviceAddress(size_t i) {
+  return RawAddress({0x00, 0x1b, 0xdc, 0x00, 0x00, static_cast<uint8_t>(i)});
+}
+
+// Time for the GATT client to restore the databases of the cached devices,
+// as done when they all reconnect, e.g. after the stack restarts
+class BM_GattcCache : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    char dir[] = "/tmp/btgattcXXXXXX";
+    dir_ = mkdtemp(dir);
+    bta_gattc_cache_set_dir_for_testing(dir_);
+
+    for (size_t i = 0; i < kNumDevices; ++i) {
+      bta_gattc_cache_write(DeviceAddress(i), BuildDatabase(i));
+    }
+  }
+
+  void TearDown(State& st) override {
+    std::unique_ptr<DIR, decltype(&closedir)> dirp(opendir(dir_.c_str()),
+                                                   &closedir);
+    dirent* dp;
+    while ((dp = readdir(dirp.get())) != nullptr) {
+      unlink((dir_ + "/" + dp->d_name).c_str());
+    }
+    rmdir(dir_.c_str());
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::string dir_;
+};
+
+BENCHMARK_DEFINE_F(BM_GattcCache, reconnect)(State& state) {
+  for (auto _ : state) {
+    for (size_t i = 0; i < kNumDevices; ++i) {
+      gatt::Database db = bta_gattc_cache_load(DeviceAddress(i));
+      if (db.IsEmpty()) state.SkipWithError("device not cached");
+      ::benchmark::DoNotOptimize(db);
+    }
+  }
+  state.counters["devices_per_sec"] =
+      Counter(state.iterations() * kNumDevices, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(BM_GattcCache, reconnect)
+    ->Unit(::benchmark::kMicrosecond);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
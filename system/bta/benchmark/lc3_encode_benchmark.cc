@@ -0,0 +1,121 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "bta/le_audio/lc3_encode_pool.h"
+
+using ::benchmark::State;
+using le_audio::Lc3EncodePool;
+
+namespace {
+
+constexpr int kDtUs = 10000;
+constexpr int kSrHz = 48000;
+// 48_4 configuration: 120 octets per channel and 10 ms frame
+constexpr int kOctetsPerFrame = 120;
+
+// Stands in for IsoManager::SendIsoData(), which copies the SDU into an HCI
+// packet
+uint8_t iso_packet[kOctetsPerFrame];
+void SendIsoData(const uint8_t* data, uint16_t data_len) {
+  memcpy(iso_packet, data, data_len);
+  ::benchmark::ClobberMemory();
+}
+
+// Time from a frame of interleaved PCM being ready until every channel was
+// encoded and handed over to the ISO manager, as done per BIS by the
+// broadcaster and per CIS by the unicast client
+class BM_Lc3Encode : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    size_t num_channels = st.range(0);
+    bool parallel = st.range(1);
+
+    int num_samples = lc3_frame_samples(kDtUs, kSrHz);
+    pcm_.resize(num_samples * num_channels);
+    for (int i = 0; i < num_samples; ++i) {
+      for (size_t chan = 0; chan < num_channels; ++chan) {
+        pcm_[i * num_channels + chan] =
+            8000 * std::sin(2 * M_PI * 440 * (chan + 1) * i / kSrHz);
+      }
+    }
+
+    outputs_.assign(num_channels, std::vector<uint8_t>(kOctetsPerFrame));
+    for (size_t chan = 0; chan < num_channels; ++chan) {
+      encoders_mem_.emplace_back(malloc(lc3_encoder_size(kDtUs, kSrHz)),
+                                 &std::free);
+      jobs_.push_back(
+          {.encoder = lc3_setup_encoder(kDtUs, kSrHz, 0,
+                                        encoders_mem_.back().get()),
+           .pcm = pcm_.data() + chan,
+           .stride = static_cast<int>(num_channels),
+           .out = outputs_[chan].data(),
+           .out_size = kOctetsPerFrame});
+    }
+
+    pool_ = std::make_unique<Lc3EncodePool>(
+        parallel ? Lc3EncodePool::GetWorkerCount(num_channels) : 0);
+  }
+
+  void TearDown(State& st) override {
+    pool_.reset();
+    jobs_.clear();
+    outputs_.clear();
+    encoders_mem_.clear();
+    pcm_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<int16_t> pcm_;
+  std::vector<std::vector<uint8_t>> outputs_;
+  std::vector<std::unique_ptr<void, decltype(&std::free)>> encoders_mem_;
+  std::vector<Lc3EncodePool::Job> jobs_;
+  std::unique_ptr<Lc3EncodePool> pool_;
+};
+
+BENCHMARK_DEFINE_F(BM_Lc3Encode, frame)(State& state) {
+  for (auto _ : state) {
+    pool_->Encode(LC3_PCM_FORMAT_S16, jobs_);
+    for (auto const& output : outputs_) {
+      SendIsoData(output.data(), output.size());
+    }
+  }
+  state.counters["workers"] = pool_->GetNumWorkers();
+}
+
+BENCHMARK_REGISTER_F(BM_Lc3Encode, frame)
+    ->ArgNames({"channels", "parallel"})
+    ->ArgsProduct({{2, 4, 6}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(::benchmark::kMicrosecond);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -21,8 +21,14 @@
 #include <base/logging.h>
 #include <base/strings/string_number_conversions.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -34,99 +40,275 @@ using std::string;
 using std::vector;
 
 #ifdef TARGET_FLOSS
-#define GATT_CACHE_PREFIX "/var/lib/bluetooth/gatt/gatt_cache_"
-#define GATT_CACHE_VERSION 6
-
-#define GATT_HASH_MAX_SIZE 30
-#define GATT_HASH_PATH_PREFIX "/var/lib/bluetooth/gatt/gatt_hash_"
-#define GATT_HASH_PATH "/var/lib/bluetooth/gatt"
-#define GATT_HASH_FILE_PREFIX "gatt_hash_"
+#define GATT_CACHE_PATH "/var/lib/bluetooth/gatt"
 #else
-#define GATT_CACHE_PREFIX "/data/misc/bluetooth/gatt_cache_"
-#define GATT_CACHE_VERSION 6
+#define GATT_CACHE_PATH "/data/misc/bluetooth"
+#endif
+
+#define GATT_CACHE_FILE_PREFIX "gatt_cache_"
+#define GATT_CACHE_TMP_FILE "gatt_cache.tmp"
+#define GATT_CACHE_VERSION 7
 
 #define GATT_HASH_MAX_SIZE 30
-#define GATT_HASH_PATH_PREFIX "/data/misc/bluetooth/gatt_hash_"
-#define GATT_HASH_PATH "/data/misc/bluetooth"
 #define GATT_HASH_FILE_PREFIX "gatt_hash_"
-#endif
 
 // Default expired time is 7 days
 #define GATT_HASH_EXPIRED_TIME 604800
 
+namespace {
+
+/* Cache files are a header followed by the attributes, as laid out in memory,
+ * so that they are used in place once mapped. */
+struct GattCacheHeader {
+  /* Kept first, to tell apart older formats */
+  uint16_t version;
+  uint16_t num_attr;
+  /* Hash of the stored database. The address files are hard links to the hash
+   * files, this tells which one without comparing inodes. */
+  Octet16 hash;
+};
+static_assert(sizeof(GattCacheHeader) % alignof(StoredAttribute) == 0,
+              "GATT cache attributes are not aligned");
+
+/* Cache file mapped in memory. Cache files are replaced rather than written
+ * over, so the mapping stays valid as long as it is kept. */
+class GattCacheFile {
+ public:
+  GattCacheFile(void* data, size_t size) : data_(data), size_(size) {}
+  ~GattCacheFile() { munmap(data_, size_); }
+
+  GattCacheFile(const GattCacheFile&) = delete;
+  GattCacheFile& operator=(const GattCacheFile&) = delete;
+
+  const GattCacheHeader& Header() const {
+    return *static_cast<const GattCacheHeader*>(data_);
+  }
+  const StoredAttribute* Attributes() const {
+    return reinterpret_cast<const StoredAttribute*>(&Header() + 1);
+  }
+
+ private:
+  void* data_;
+  size_t size_;
+};
+
+/* In memory index of the cache files, so that storing a database does not
+ * list the cache directory, and that devices not in the cache are known
+ * without a lookup. It is built from one scan of the directory, on first use,
+ * and kept in sync by the functions below. */
+struct GattCacheIndex {
+  bool valid = false;
+  /* hash of the database linked to by the address files */
+  std::map<RawAddress, Octet16> addresses;
+  /* modification time of the hash files */
+  std::map<Octet16, time_t> hashes;
+  /* hash files loaded so far, kept mapped for the next connections */
+  std::map<Octet16, std::unique_ptr<GattCacheFile>> files;
+};
+
+string cache_dir = GATT_CACHE_PATH;
+GattCacheIndex cache_index;
+
+}  // namespace
+
 static void bta_gattc_hash_remove_least_recently_used_if_possible();
 
 static void bta_gattc_generate_cache_file_name(char* buffer, size_t buffer_len,
                                                const RawAddress& bda) {
-  snprintf(buffer, buffer_len, "%s%02x%02x%02x%02x%02x%02x", GATT_CACHE_PREFIX,
-           bda.address[0], bda.address[1], bda.address[2], bda.address[3],
-           bda.address[4], bda.address[5]);
+  snprintf(buffer, buffer_len, "%s/%s%02x%02x%02x%02x%02x%02x",
+           cache_dir.c_str(), GATT_CACHE_FILE_PREFIX, bda.address[0],
+           bda.address[1], bda.address[2], bda.address[3], bda.address[4],
+           bda.address[5]);
 }
 
 static void bta_gattc_generate_hash_file_name(char* buffer, size_t buffer_len,
                                               const Octet16& hash) {
-  snprintf(buffer, buffer_len, "%s%s", GATT_HASH_PATH_PREFIX,
-           base::HexEncode(hash.data(), 16).c_str());
+  snprintf(buffer, buffer_len, "%s/%s%s", cache_dir.c_str(),
+           GATT_HASH_FILE_PREFIX, base::HexEncode(hash.data(), 16).c_str());
 }
 
 static gatt::Database EMPTY_DB;
 
 /*******************************************************************************
  *
- * Function         bta_gattc_load_db
+ * Function         bta_gattc_read_header
  *
- * Description      Load GATT database from storage.
+ * Description      Read the header of a GATT cache file.
  *
  * Parameter        fname: input file name
+ *                  header: header read
  *
- * Returns          non-empty GATT database on success, empty GATT database
- *                  otherwise
+ * Returns          true if the file has the current format, false otherwise
  *
  ******************************************************************************/
-static gatt::Database bta_gattc_load_db(const char* fname) {
-  FILE* fd = fopen(fname, "rb");
-  if (!fd) {
+static bool bta_gattc_read_header(const char* fname, GattCacheHeader* header) {
+  int fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+
+  ssize_t len = TEMP_FAILURE_RETRY(read(fd, header, sizeof(*header)));
+  close(fd);
+  return len == sizeof(*header) && header->version == GATT_CACHE_VERSION;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_index
+ *
+ * Description      Return the index of the cache files, built on first use.
+ *
+ * Returns          the index, not valid if the cache directory can't be read
+ *
+ ******************************************************************************/
+static GattCacheIndex& bta_gattc_cache_index() {
+  if (cache_index.valid) return cache_index;
+
+  std::unique_ptr<DIR, decltype(&closedir)> dirp(opendir(cache_dir.c_str()),
+                                                 &closedir);
+  if (dirp == nullptr) {
+    LOG_ERROR("open dir error, dir=%s", cache_dir.c_str());
+    return cache_index;
+  }
+
+  const size_t cache_prefix_len = strlen(GATT_CACHE_FILE_PREFIX);
+  const size_t hash_prefix_len = strlen(GATT_HASH_FILE_PREFIX);
+
+  dirent* dp;
+  while ((dp = readdir(dirp.get())) != nullptr) {
+    bool is_cache_file =
+        strncmp(dp->d_name, GATT_CACHE_FILE_PREFIX, cache_prefix_len) == 0;
+    bool is_hash_file =
+        strncmp(dp->d_name, GATT_HASH_FILE_PREFIX, hash_prefix_len) == 0;
+    if (!is_cache_file && !is_hash_file) continue;
+
+    char fname[255] = {0};
+    snprintf(fname, sizeof(fname), "%s/%s", cache_dir.c_str(), dp->d_name);
+
+    // Files of an older format can't be loaded anymore
+    GattCacheHeader header;
+    if (!bta_gattc_read_header(fname, &header)) {
+      LOG_DEBUG("delete cache file (format), name=%s", fname);
+      unlink(fname);
+      continue;
+    }
+
+    if (is_cache_file) {
+      RawAddress bda;
+      std::vector<uint8_t> bytes;
+      if (!base::HexStringToBytes(dp->d_name + cache_prefix_len, &bytes) ||
+          bytes.size() != sizeof(bda.address)) {
+        continue;
+      }
+      std::copy(bytes.begin(), bytes.end(), bda.address);
+      cache_index.addresses[bda] = header.hash;
+    } else {
+      struct stat buf;
+      if (lstat(fname, &buf) == -1) continue;
+      cache_index.hashes[header.hash] = buf.st_mtime;
+    }
+  }
+
+  LOG_DEBUG("indexed %zu devices and %zu hash files",
+            cache_index.addresses.size(), cache_index.hashes.size());
+  cache_index.valid = true;
+  return cache_index;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_map_db
+ *
+ * Description      Map GATT cache file in memory.
+ *
+ * Parameter        fname: input file name
+ *
+ * Returns          mapped file if it has the current format, nullptr otherwise
+ *
+ ******************************************************************************/
+static std::unique_ptr<GattCacheFile> bta_gattc_map_db(const char* fname) {
+  int fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
     LOG(ERROR) << __func__ << ": can't open GATT cache file " << fname
                << " for reading, error: " << strerror(errno);
-    return EMPTY_DB;
+    return nullptr;
   }
 
-  uint16_t cache_ver = 0;
-  uint16_t num_attr = 0;
+  struct stat buf;
+  if (fstat(fd, &buf) == -1 || buf.st_size < (off_t)sizeof(GattCacheHeader)) {
+    LOG(ERROR) << __func__ << ": can't read GATT cache header from: " << fname;
+    close(fd);
+    return nullptr;
+  }
 
-  if (fread(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__ << ": can't read GATT cache version from: " << fname;
-    goto done;
+  size_t size = buf.st_size;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(ERROR) << __func__ << ": can't map GATT cache file " << fname
+               << ", error: " << strerror(errno);
+    return nullptr;
   }
 
-  if (cache_ver != GATT_CACHE_VERSION) {
+  auto file = std::make_unique<GattCacheFile>(data, size);
+  const GattCacheHeader& header = file->Header();
+  if (header.version != GATT_CACHE_VERSION) {
     LOG(ERROR) << __func__ << ": wrong GATT cache version: " << fname;
-    goto done;
+    return nullptr;
   }
 
-  if (fread(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__
-               << ": can't read number of GATT attributes: " << fname;
-    goto done;
+  if (size !=
+      sizeof(GattCacheHeader) + header.num_attr * sizeof(StoredAttribute)) {
+    LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
+    return nullptr;
   }
 
-  {
-    std::vector<StoredAttribute> attr(num_attr);
+  return file;
+}
 
-    if (fread(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
-      LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
-      goto done;
-    }
-    fclose(fd);
+/*******************************************************************************
+ *
+ * Function         bta_gattc_load_db
+ *
+ * Description      Load GATT database from a mapped cache file, the
+ *                  attributes are used in place.
+ *
+ * Parameter        file: mapped cache file
+ *
+ * Returns          non-empty GATT database on success, empty GATT database
+ *                  otherwise
+ *
+ ******************************************************************************/
+static gatt::Database bta_gattc_load_db(const GattCacheFile& file) {
+  bool success = false;
+  gatt::Database result = gatt::Database::Deserialize(
+      file.Attributes(), file.Header().num_attr, &success);
+  return success ? result : EMPTY_DB;
+}
 
-    bool success = false;
-    gatt::Database result = gatt::Database::Deserialize(attr, &success);
-    return success ? result : EMPTY_DB;
-  }
+/*******************************************************************************
+ *
+ * Function         bta_gattc_load_db
+ *
+ * Description      Load GATT database from storage. The hash files known by
+ *                  the index are kept mapped for the next loads.
+ *
+ * Parameter        fname: input file name
+ *
+ * Returns          non-empty GATT database on success, empty GATT database
+ *                  otherwise
+ *
+ ******************************************************************************/
+static gatt::Database bta_gattc_load_db(const char* fname) {
+  std::unique_ptr<GattCacheFile> file = bta_gattc_map_db(fname);
+  if (!file) return EMPTY_DB;
 
-done:
-  fclose(fd);
-  return EMPTY_DB;
+  gatt::Database result = bta_gattc_load_db(*file);
+
+  GattCacheIndex& index = bta_gattc_cache_index();
+  const Octet16& hash = file->Header().hash;
+  if (index.valid && index.hashes.count(hash) != 0) {
+    index.files[hash] = std::move(file);
+  }
+  return result;
 }
 
 /*******************************************************************************
@@ -142,6 +324,15 @@ done:
  *
  ******************************************************************************/
 gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
+  const GattCacheIndex& index = bta_gattc_cache_index();
+  if (index.valid) {
+    auto address = index.addresses.find(server_bda);
+    if (address == index.addresses.end()) return EMPTY_DB;
+
+    auto file = index.files.find(address->second);
+    if (file != index.files.end()) return bta_gattc_load_db(*file->second);
+  }
+
   char fname[255] = {0};
   bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
   return bta_gattc_load_db(fname);
@@ -160,6 +351,14 @@ gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
  *
  ******************************************************************************/
 gatt::Database bta_gattc_hash_load(const Octet16& hash) {
+  const GattCacheIndex& index = bta_gattc_cache_index();
+  if (index.valid) {
+    if (index.hashes.count(hash) == 0) return EMPTY_DB;
+
+    auto file = index.files.find(hash);
+    if (file != index.files.end()) return bta_gattc_load_db(*file->second);
+  }
+
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
   return bta_gattc_load_db(fname);
@@ -169,45 +368,56 @@ gatt::Database bta_gattc_hash_load(const Octet16& hash) {
  *
  * Function         bta_gattc_store_db
  *
- * Description      Storess GATT db.
+ * Description      Storess GATT db. The file is replaced, and not written
+ *                  over, as it may be mapped.
  *
  * Parameter        fname: output file name
+ *                  hash: hash of the database
  *                  attr: attributes to save.
  *
  * Returns          true on success, false otherwise
  *
  ******************************************************************************/
-static bool bta_gattc_store_db(const char* fname,
+static bool bta_gattc_store_db(const char* fname, const Octet16& hash,
                                const std::vector<StoredAttribute>& attr) {
-  FILE* fd = fopen(fname, "wb");
+  char tmp_fname[255] = {0};
+  snprintf(tmp_fname, sizeof(tmp_fname), "%s/%s", cache_dir.c_str(),
+           GATT_CACHE_TMP_FILE);
+
+  FILE* fd = fopen(tmp_fname, "wb");
   if (!fd) {
     LOG(ERROR) << __func__
                << ": can't open GATT cache file for writing: " << fname;
     return false;
   }
 
-  uint16_t cache_ver = GATT_CACHE_VERSION;
-  if (fwrite(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__ << ": can't write GATT cache version: " << fname;
-    fclose(fd);
-    return false;
-  }
-
-  uint16_t num_attr = attr.size();
-  if (fwrite(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__
-               << ": can't write GATT cache attribute count: " << fname;
+  GattCacheHeader header = {
+      .version = GATT_CACHE_VERSION,
+      .num_attr = static_cast<uint16_t>(attr.size()),
+      .hash = hash,
+  };
+  if (fwrite(&header, sizeof(header), 1, fd) != 1) {
+    LOG(ERROR) << __func__ << ": can't write GATT cache header: " << fname;
     fclose(fd);
+    unlink(tmp_fname);
     return false;
   }
 
+  uint16_t num_attr = header.num_attr;
   if (fwrite(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
     LOG(ERROR) << __func__ << ": can't write GATT cache attributes: " << fname;
     fclose(fd);
+    unlink(tmp_fname);
     return false;
   }
 
   fclose(fd);
+  if (rename(tmp_fname, fname) == -1) {
+    LOG(ERROR) << __func__ << ": can't replace GATT cache file: " << fname
+               << ", error: " << strerror(errno);
+    unlink(tmp_fname);
+    return false;
+  }
   return true;
 }
 
@@ -258,10 +468,14 @@ void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash) {
   bta_gattc_generate_cache_file_name(addr_file, sizeof(addr_file), server_bda);
   bta_gattc_generate_hash_file_name(hash_file, sizeof(hash_file), hash);
 
+  GattCacheIndex& index = bta_gattc_cache_index();
   unlink(addr_file);  // remove addr file first if the file exists
+  index.addresses.erase(server_bda);
   if (link(hash_file, addr_file) == -1) {
     LOG_ERROR("link %s to %s, errno=%d", addr_file, hash_file, errno);
+    return;
   }
+  if (index.valid) index.addresses[server_bda] = hash;
 }
 
 /*******************************************************************************
@@ -281,7 +495,14 @@ bool bta_gattc_hash_write(const Octet16& hash, const gatt::Database& database) {
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
   bta_gattc_hash_remove_least_recently_used_if_possible();
-  return bta_gattc_store_db(fname, database.Serialize());
+  if (!bta_gattc_store_db(fname, hash, database.Serialize())) return false;
+
+  GattCacheIndex& index = bta_gattc_cache_index();
+  if (index.valid) {
+    index.hashes[hash] = time(NULL);
+    index.files.erase(hash);
+  }
+  return true;
 }
 
 /*******************************************************************************
@@ -301,6 +522,7 @@ void bta_gattc_cache_reset(const RawAddress& server_bda) {
   char fname[255] = {0};
   bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
   unlink(fname);
+  bta_gattc_cache_index().addresses.erase(server_bda);
 }
 
 /*******************************************************************************
@@ -316,77 +538,68 @@ void bta_gattc_cache_reset(const RawAddress& server_bda) {
  *
  ******************************************************************************/
 static void bta_gattc_hash_remove_least_recently_used_if_possible() {
-  std::unique_ptr<DIR, decltype(&closedir)> dirp(opendir(GATT_HASH_PATH),
-                                                 &closedir);
-  if (dirp == nullptr) {
-    LOG_ERROR("open dir error, dir=%s", GATT_HASH_PATH);
-    return;
-  }
+  GattCacheIndex& index = bta_gattc_cache_index();
+  if (!index.valid) return;
+
+  // hash files linked to by a trusted device are not candidates to be removed
+  std::set<Octet16> linked_hashes;
+  for (const auto& [bda, hash] : index.addresses) linked_hashes.insert(hash);
 
   time_t current_time = time(NULL);
   time_t lru_time = current_time;
-  size_t count = 0;
-  string candidate_item;
-  vector<string> expired_items;
-
-  LOG_DEBUG("<-----------Start Local Hash Cache---------->");
-  dirent* dp;
-  while ((dp = readdir(dirp.get())) != nullptr) {
-    if (strncmp(".", dp->d_name, 1) == 0 || strncmp("..", dp->d_name, 2) == 0) {
-      continue;
-    }
+  auto candidate_item = index.hashes.end();
+  vector<Octet16> expired_items;
 
-    // pattern match: gatt_hash_
-    size_t fname_len = strlen(dp->d_name);
-    size_t pattern_len = strlen(GATT_HASH_FILE_PREFIX);
-    if (pattern_len > fname_len) {
-      continue;
-    }
+  for (auto it = index.hashes.begin(); it != index.hashes.end(); it++) {
+    const auto& [hash, mtime] = *it;
+    if (linked_hashes.count(hash) != 0) continue;
 
-    // check if the file name has gatt_hash_ as prefix
-    char tmp[255] = {0};
-    strncpy(tmp, dp->d_name, pattern_len);
-    if (strncmp(tmp, GATT_HASH_FILE_PREFIX, pattern_len) != 0) {
-      continue;
+    if (mtime < lru_time) {
+      lru_time = mtime;
+      candidate_item = it;
     }
 
-    // increase hash file count
-    count++;
-
-    // generate the full path, in order to get the state of the file
-    snprintf(tmp, 255, "%s/%s", GATT_HASH_PATH, dp->d_name);
-
-    struct stat buf;
-    int result = lstat(tmp, &buf);
-    LOG_DEBUG("name=%s, result=%d, linknum=%lu, mtime=%lu", dp->d_name, result,
-              (unsigned long)buf.st_nlink, (unsigned long)buf.st_mtime);
-
-    // if hard link count of the file is 1, it means no trusted device links to
-    // the inode. It is safe to be a candidate to be removed
-    if (buf.st_nlink == 1) {
-      if (buf.st_mtime < lru_time) {
-        lru_time = buf.st_mtime;
-        // Find the LRU candidate during for-loop itreation.
-        candidate_item.assign(tmp);
-      }
-
-      if (buf.st_mtime + GATT_HASH_EXPIRED_TIME < current_time) {
-        // Add expired item.
-        expired_items.emplace_back(tmp);
-      }
+    if (mtime + GATT_HASH_EXPIRED_TIME < current_time) {
+      expired_items.push_back(hash);
     }
   }
-  LOG_DEBUG("<-----------End Local Hash Cache------------>");
+
+  char fname[255] = {0};
 
   // if the number of hash files exceeds the limit, remove the cadidate item.
-  if (count > GATT_HASH_MAX_SIZE && !candidate_item.empty()) {
-    unlink(candidate_item.c_str());
-    LOG_DEBUG("delete hash file (size), name=%s", candidate_item.c_str());
+  if (index.hashes.size() > GATT_HASH_MAX_SIZE &&
+      candidate_item != index.hashes.end()) {
+    bta_gattc_generate_hash_file_name(fname, sizeof(fname),
+                                      candidate_item->first);
+    unlink(fname);
+    LOG_DEBUG("delete hash file (size), name=%s", fname);
+    index.files.erase(candidate_item->first);
+    index.hashes.erase(candidate_item);
   }
 
   // If there is any file expired, also delete it.
-  for (string expired_item : expired_items) {
-    unlink(expired_item.c_str());
-    LOG_DEBUG("delete hash file (expired), name=%s", expired_item.c_str());
+  for (const Octet16& expired_item : expired_items) {
+    if (index.hashes.erase(expired_item) == 0) continue;
+    index.files.erase(expired_item);
+    bta_gattc_generate_hash_file_name(fname, sizeof(fname), expired_item);
+    unlink(fname);
+    LOG_DEBUG("delete hash file (expired), name=%s", fname);
   }
 }
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_set_dir_for_testing
+ *
+ * Description      Store the GATT cache files in another directory, and drop
+ *                  the index of the current one.
+ *
+ * Parameter        dir: directory of the cache files
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void bta_gattc_cache_set_dir_for_testing(const std::string& dir) {
+  cache_dir = dir;
+  cache_index = GattCacheIndex();
+}
@@ -26,6 +26,7 @@
 
 #include <cstdint>
 #include <deque>
+#include <string>
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/gatt/database.h"
@@ -502,5 +503,6 @@ void bta_gattc_cache_write(const RawAddress& server_bda,
                            const gatt::Database& database);
 void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash);
 void bta_gattc_cache_reset(const RawAddress& server_bda);
+void bta_gattc_cache_set_dir_for_testing(const std::string& dir);
 
 #endif /* BTA_GATTC_INT_H */
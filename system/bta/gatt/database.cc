@@ -139,11 +139,17 @@ std::vector<StoredAttribute> Database::Serialize() const {
 
 Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
                                bool* success) {
+  return Deserialize(nv_attr.data(), nv_attr.size(), success);
+}
+
+Database Database::Deserialize(const StoredAttribute* nv_attr, size_t num_attr,
+                               bool* success) {
   // clear reallocating
   Database result;
-  auto it = nv_attr.cbegin();
+  const StoredAttribute* it = nv_attr;
+  const StoredAttribute* end = nv_attr + num_attr;
 
-  for (; it != nv_attr.cend(); ++it) {
+  for (; it != end; ++it) {
     const auto& attr = *it;
     if (attr.type != PRIMARY_SERVICE && attr.type != SECONDARY_SERVICE) break;
     result.services.emplace_back(Service{
@@ -155,7 +161,7 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
   }
 
   auto current_service_it = result.services.begin();
-  for (; it != nv_attr.cend(); it++) {
+  for (; it != end; it++) {
     const auto& attr = *it;
 
     // go to the service this attribute belongs to; attributes are stored in
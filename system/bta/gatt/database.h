@@ -119,6 +119,11 @@ class Database {
   static Database Deserialize(const std::vector<gatt::StoredAttribute>& nv_attr,
                               bool* success);
 
+  /* Same as above, for |num_attr| attributes stored in place, e.g. in a
+   * memory mapped cache file */
+  static Database Deserialize(const gatt::StoredAttribute* nv_attr,
+                              size_t num_attr, bool* success);
+
   /* Return 128 bit unique identifier of this GATT database */
   Octet16 Hash() const;
 
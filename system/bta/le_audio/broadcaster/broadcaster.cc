@@ -23,6 +23,7 @@
 #include "bta/include/bta_le_audio_broadcaster_api.h"
 #include "bta/le_audio/broadcaster/state_machine.h"
 #include "bta/le_audio/content_control_id_keeper.h"
+#include "bta/le_audio/lc3_encode_pool.h"
 #include "bta/le_audio/le_audio_types.h"
 #include "bta/le_audio/le_audio_utils.h"
 #include "bta/le_audio/metrics_collector.h"
@@ -46,6 +47,7 @@ using bluetooth::le_audio::BroadcastId;
 using bluetooth::le_audio::PublicBroadcastAnnouncementData;
 using le_audio::CodecManager;
 using le_audio::ContentControlIdKeeper;
+using le_audio::Lc3EncodePool;
 using le_audio::LeAudioCodecConfiguration;
 using le_audio::LeAudioSourceAudioHalClient;
 using le_audio::broadcaster::BigConfig;
@@ -887,6 +889,13 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
         encoders_.emplace_back(
             lc3_setup_encoder(dt_us, sr_hz, 0, encoders_mem_.back().get()));
       }
+
+      auto num_workers =
+          Lc3EncodePool::GetWorkerCount(codec_wrapper_.GetNumChannels());
+      if (!encode_pool_ || encode_pool_->GetNumWorkers() != num_workers) {
+        encode_pool_ = std::make_unique<Lc3EncodePool>(num_workers);
+      }
+      encode_jobs_.resize(codec_wrapper_.GetNumChannels());
     }
 
     const BroadcastCodecWrapper& getCurrentCodecConfig(void) const {
@@ -897,18 +906,16 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       codec_wrapper_ = config;
     }
 
-    void encodeLc3Channel(lc3_encoder_t encoder,
-                          std::vector<uint8_t>& out_buffer,
-                          const std::vector<uint8_t>& data,
-                          int initial_channel_offset, int pitch_samples,
-                          int num_channels) {
-      auto encoder_status =
-          lc3_encode(encoder, LC3_PCM_FORMAT_S16,
-                     (int16_t*)(data.data() + initial_channel_offset),
-                     pitch_samples, out_buffer.size(), out_buffer.data());
-      if (encoder_status != 0) {
-        LOG_ERROR("Encoding error=%d", encoder_status);
-      }
+    Lc3EncodePool::Job prepareLc3ChannelJob(lc3_encoder_t encoder,
+                                            std::vector<uint8_t>& out_buffer,
+                                            const std::vector<uint8_t>& data,
+                                            int initial_channel_offset,
+                                            int pitch_samples) {
+      return {.encoder = encoder,
+              .pcm = data.data() + initial_channel_offset,
+              .stride = pitch_samples,
+              .out = out_buffer.data(),
+              .out_size = static_cast<int>(out_buffer.size())};
     }
 
     static void sendBroadcastData(
@@ -937,7 +944,7 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
     }
 
     virtual void OnAudioDataReady(const std::vector<uint8_t>& data) override {
-      if (!instance) return;
+      if (!instance || !encode_pool_) return;
 
       LOG_VERBOSE("Received %zu bytes.", data.size());
 
@@ -948,8 +955,15 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       /* Prepare encoded data for all channels */
       for (uint8_t chan = 0; chan < num_channels; ++chan) {
         /* TODO: Use encoder agnostic wrapper */
-        encodeLc3Channel(encoders_[chan], enc_audio_buffers_[chan], data,
-                         chan * bytes_per_sample, num_channels, num_channels);
+        encode_jobs_[chan] =
+            prepareLc3ChannelJob(encoders_[chan], enc_audio_buffers_[chan],
+                                 data, chan * bytes_per_sample, num_channels);
+      }
+      encode_pool_->Encode(LC3_PCM_FORMAT_S16, encode_jobs_);
+      for (auto const& job : encode_jobs_) {
+        if (job.status != 0) {
+          LOG_ERROR("Encoding error=%d", job.status);
+        }
       }
 
       /* Currently there is no way to broadcast multiple distinct streams.
@@ -1015,6 +1029,8 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
     std::vector<lc3_encoder_t> encoders_;
     std::vector<std::unique_ptr<void, decltype(&std::free)>> encoders_mem_;
     std::vector<std::vector<uint8_t>> enc_audio_buffers_;
+    std::unique_ptr<Lc3EncodePool> encode_pool_;
+    std::vector<Lc3EncodePool::Job> encode_jobs_;
   } audio_receiver_;
 
   bluetooth::le_audio::LeAudioBroadcasterCallbacks* callbacks_;
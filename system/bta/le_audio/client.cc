@@ -43,6 +43,7 @@
 #include "gatt/bta_gattc_int.h"
 #include "gd/common/strings.h"
 #include "internal_include/stack_config.h"
+#include "lc3_encode_pool.h"
 #include "le_audio_set_configuration_provider.h"
 #include "le_audio_types.h"
 #include "le_audio_utils.h"
@@ -2960,9 +2961,8 @@ class LeAudioClientImpl : public LeAudioClient {
   }
 
   // mix stero signal into mono
-  std::vector<uint8_t> mono_blend(const std::vector<uint8_t>& buf,
-                                  int bytes_per_sample, size_t frames) {
-    std::vector<uint8_t> mono_out;
+  void mono_blend(const std::vector<uint8_t>& buf, int bytes_per_sample,
+                  size_t frames, std::vector<uint8_t>& mono_out) {
     mono_out.resize(frames * bytes_per_sample);
 
     if (bytes_per_sample == 2) {
@@ -2988,7 +2988,21 @@ class LeAudioClientImpl : public LeAudioClient {
     } else {
       LOG_ERROR("Don't know how to mono blend that %d!", bytes_per_sample);
     }
-    return mono_out;
+  }
+
+  /* Encode the channels queued in encode_jobs_, in parallel if possible */
+  void EncodeChannels(lc3_pcm_format bits_per_sample) {
+    if (!lc3_encode_pool_) {
+      LOG(ERROR) << __func__ << " encoders are not set up";
+      return;
+    }
+
+    lc3_encode_pool_->Encode(bits_per_sample, encode_jobs_);
+    for (auto const& job : encode_jobs_) {
+      if (job.status < 0) {
+        LOG(ERROR) << " error while encoding, error code: " << +job.status;
+      }
+    }
   }
 
   void PrepareAndSendToTwoCises(
@@ -3024,41 +3038,54 @@ class LeAudioClientImpl : public LeAudioClient {
       return;
     }
 
-    std::vector<uint8_t> chan_left_enc(byte_count, 0);
-    std::vector<uint8_t> chan_right_enc(byte_count, 0);
+    encoded_left_.resize(byte_count);
+    encoded_right_.resize(byte_count);
+    encode_jobs_.clear();
 
     bool mono = (left_cis_handle == 0) || (right_cis_handle == 0);
 
     if (!mono) {
-      lc3_encode(lc3_encoder_left, bits_per_sample, data.data(), 2,
-                 chan_left_enc.size(), chan_left_enc.data());
-      lc3_encode(lc3_encoder_right, bits_per_sample,
-                 data.data() + bytes_per_sample, 2, chan_right_enc.size(),
-                 chan_right_enc.data());
+      encode_jobs_.push_back({.encoder = lc3_encoder_left,
+                              .pcm = data.data(),
+                              .stride = 2,
+                              .out = encoded_left_.data(),
+                              .out_size = byte_count});
+      encode_jobs_.push_back({.encoder = lc3_encoder_right,
+                              .pcm = data.data() + bytes_per_sample,
+                              .stride = 2,
+                              .out = encoded_right_.data(),
+                              .out_size = byte_count});
     } else {
-      std::vector<uint8_t> mono = mono_blend(
-          data, bytes_per_sample, number_of_required_samples_per_channel);
+      mono_blend(data, bytes_per_sample, number_of_required_samples_per_channel,
+                 mono_pcm_);
       if (left_cis_handle) {
-        lc3_encode(lc3_encoder_left, bits_per_sample, mono.data(), 1,
-                   chan_left_enc.size(), chan_left_enc.data());
+        encode_jobs_.push_back({.encoder = lc3_encoder_left,
+                                .pcm = mono_pcm_.data(),
+                                .stride = 1,
+                                .out = encoded_left_.data(),
+                                .out_size = byte_count});
       }
 
       if (right_cis_handle) {
-        lc3_encode(lc3_encoder_right, bits_per_sample, mono.data(), 1,
-                   chan_right_enc.size(), chan_right_enc.data());
+        encode_jobs_.push_back({.encoder = lc3_encoder_right,
+                                .pcm = mono_pcm_.data(),
+                                .stride = 1,
+                                .out = encoded_right_.data(),
+                                .out_size = byte_count});
       }
     }
+    EncodeChannels(bits_per_sample);
 
     DLOG(INFO) << __func__ << " left_cis_handle: " << +left_cis_handle
                << " right_cis_handle: " << right_cis_handle;
     /* Send data to the controller */
     if (left_cis_handle)
       IsoManager::GetInstance()->SendIsoData(
-          left_cis_handle, chan_left_enc.data(), chan_left_enc.size());
+          left_cis_handle, encoded_left_.data(), encoded_left_.size());
 
     if (right_cis_handle)
       IsoManager::GetInstance()->SendIsoData(
-          right_cis_handle, chan_right_enc.data(), chan_right_enc.size());
+          right_cis_handle, encoded_right_.data(), encoded_right_.size());
   }
 
   void PrepareAndSendToSingleCis(
@@ -3082,31 +3109,37 @@ class LeAudioClientImpl : public LeAudioClient {
       LOG(ERROR) << __func__ << "Missing samples";
       return;
     }
-    std::vector<uint8_t> chan_encoded(num_channels * byte_count, 0);
+    /* Both channels go into a single SDU, one after the other */
+    encoded_left_.resize(num_channels * byte_count);
+    encode_jobs_.clear();
 
     if (num_channels == 1) {
       /* Since we always get two channels from framework, lets make it mono here
        */
-      std::vector<uint8_t> mono = mono_blend(
-          data, bytes_per_sample, number_of_required_samples_per_channel);
-
-      auto err = lc3_encode(lc3_encoder_left, bits_per_sample, mono.data(), 1,
-                            byte_count, chan_encoded.data());
-
-      if (err < 0) {
-        LOG(ERROR) << " error while encoding, error code: " << +err;
-      }
+      mono_blend(data, bytes_per_sample, number_of_required_samples_per_channel,
+                 mono_pcm_);
+      encode_jobs_.push_back({.encoder = lc3_encoder_left,
+                              .pcm = mono_pcm_.data(),
+                              .stride = 1,
+                              .out = encoded_left_.data(),
+                              .out_size = byte_count});
     } else {
-      lc3_encode(lc3_encoder_left, bits_per_sample, (const int16_t*)data.data(),
-                 2, byte_count, chan_encoded.data());
-      lc3_encode(lc3_encoder_right, bits_per_sample,
-                 (const int16_t*)data.data() + 1, 2, byte_count,
-                 chan_encoded.data() + byte_count);
-    }
+      encode_jobs_.push_back({.encoder = lc3_encoder_left,
+                              .pcm = (const int16_t*)data.data(),
+                              .stride = 2,
+                              .out = encoded_left_.data(),
+                              .out_size = byte_count});
+      encode_jobs_.push_back({.encoder = lc3_encoder_right,
+                              .pcm = (const int16_t*)data.data() + 1,
+                              .stride = 2,
+                              .out = encoded_left_.data() + byte_count,
+                              .out_size = byte_count});
+    }
+    EncodeChannels(bits_per_sample);
 
     /* Send data to the controller */
-    IsoManager::GetInstance()->SendIsoData(cis_handle, chan_encoded.data(),
-                                           chan_encoded.size());
+    IsoManager::GetInstance()->SendIsoData(cis_handle, encoded_left_.data(),
+                                           encoded_left_.size());
   }
 
   const struct le_audio::stream_configuration* GetStreamSinkConfiguration(
@@ -3433,6 +3466,11 @@ class LeAudioClientImpl : public LeAudioClient {
           lc3_setup_encoder(dt_us, sr_hz, af_hz, lc3_encoder_left_mem);
       lc3_encoder_right =
           lc3_setup_encoder(dt_us, sr_hz, af_hz, lc3_encoder_right_mem);
+
+      if (!lc3_encode_pool_) {
+        lc3_encode_pool_ = std::make_unique<le_audio::Lc3EncodePool>(
+            le_audio::Lc3EncodePool::GetWorkerCount(2));
+      }
     }
 
     le_audio_source_hal_client_->UpdateRemoteDelay(remote_delay_ms);
@@ -3525,6 +3563,7 @@ class LeAudioClientImpl : public LeAudioClient {
       free(lc3_encoder_right_mem);
       lc3_encoder_right_mem = nullptr;
     }
+    lc3_encode_pool_.reset();
 
     if (lc3_decoder_left_mem) {
       free(lc3_decoder_left_mem);
@@ -5273,6 +5312,13 @@ class LeAudioClientImpl : public LeAudioClient {
   lc3_encoder_t lc3_encoder_left;
   lc3_encoder_t lc3_encoder_right;
 
+  /* Encodes the channels of a frame in parallel, reusing the buffers below */
+  std::unique_ptr<le_audio::Lc3EncodePool> lc3_encode_pool_;
+  std::vector<le_audio::Lc3EncodePool::Job> encode_jobs_;
+  std::vector<uint8_t> mono_pcm_;
+  std::vector<uint8_t> encoded_left_;
+  std::vector<uint8_t> encoded_right_;
+
   void* lc3_decoder_left_mem;
   void* lc3_decoder_right_mem;
 
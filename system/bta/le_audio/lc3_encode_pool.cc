@@ -0,0 +1,118 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lc3_encode_pool.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+
+namespace le_audio {
+
+namespace {
+/* Frames have at most a handful of channels, more workers would only idle */
+constexpr size_t kMaxWorkers = 3;
+
+void EncodeJob(lc3_pcm_format format, Lc3EncodePool::Job& job) {
+  job.status = lc3_encode(job.encoder, format, job.pcm, job.stride,
+                          job.out_size, job.out);
+}
+}  // namespace
+
+size_t Lc3EncodePool::GetWorkerCount(size_t num_channels) {
+  size_t num_cores = std::thread::hardware_concurrency();
+  if (num_channels < 2 || num_cores < 2) return 0;
+  return std::min({num_channels - 1, num_cores - 1, kMaxWorkers});
+}
+
+Lc3EncodePool::Lc3EncodePool(size_t num_workers) {
+  for (size_t i = 0; i < std::min(num_workers, kMaxWorkers); ++i) {
+    workers_.emplace_back(&Lc3EncodePool::WorkerMain, this);
+  }
+}
+
+Lc3EncodePool::~Lc3EncodePool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) worker.join();
+}
+
+void Lc3EncodePool::Encode(lc3_pcm_format format, std::vector<Job>& jobs) {
+  if (workers_.empty() || jobs.size() < 2) {
+    for (auto& job : jobs) EncodeJob(format, job);
+    return;
+  }
+
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_ = &jobs;
+    format_ = format;
+    next_job_ = 0;
+    pending_jobs_ = jobs.size();
+    generation = ++generation_;
+  }
+  work_cv_.notify_all();
+
+  RunJobs(generation);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return pending_jobs_ == 0; });
+  jobs_ = nullptr;
+}
+
+void Lc3EncodePool::RunJobs(uint64_t generation) {
+  for (;;) {
+    Job* job;
+    lc3_pcm_format format;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      /* A worker waking up late must not touch the jobs of a later frame */
+      if (generation != generation_ || jobs_ == nullptr ||
+          next_job_ >= jobs_->size())
+        return;
+      job = &(*jobs_)[next_job_++];
+      format = format_;
+    }
+
+    EncodeJob(format, *job);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_jobs_ == 0) done_cv_.notify_one();
+  }
+}
+
+void Lc3EncodePool::WorkerMain() {
+  pthread_setname_np(pthread_self(), "bt_lc3_encode");
+
+  uint64_t last_generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this, last_generation] {
+        return stopping_ || generation_ != last_generation;
+      });
+      if (stopping_) return;
+      last_generation = generation_;
+    }
+    RunJobs(last_generation);
+  }
+}
+
+}  // namespace le_audio
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "embdrv/lc3/include/lc3.h"
+
+namespace le_audio {
+
+/* Encodes the channels of an audio frame concurrently.
+ *
+ * Each channel has its own LC3 encoder instance, so the lc3_encode() calls of
+ * one frame are independent of each other. The calling thread encodes
+ * channels alongside a few worker threads and Encode() returns once every
+ * channel of the frame is encoded, so that the caller can send them right
+ * away. Workers are started once and inherit the scheduling policy of the
+ * thread creating the pool.
+ */
+class Lc3EncodePool {
+ public:
+  struct Job {
+    lc3_encoder_t encoder;
+    /* First sample of the channel and the distance between its samples */
+    const void* pcm;
+    int stride;
+    uint8_t* out;
+    int out_size;
+    /* Result of lc3_encode() */
+    int status;
+  };
+
+  /* Number of workers worth starting for |num_channels| channels: one less
+   * than the channels, as the calling thread takes one of them, and no more
+   * than the other cores available.
+   */
+  static size_t GetWorkerCount(size_t num_channels);
+
+  explicit Lc3EncodePool(size_t num_workers);
+  ~Lc3EncodePool();
+
+  Lc3EncodePool(const Lc3EncodePool&) = delete;
+  Lc3EncodePool& operator=(const Lc3EncodePool&) = delete;
+
+  /* Encode all |jobs| using |format| PCM input and return once done */
+  void Encode(lc3_pcm_format format, std::vector<Job>& jobs);
+
+  size_t GetNumWorkers() const { return workers_.size(); }
+
+ private:
+  void WorkerMain();
+  /* Run jobs of the frame |generation| until none is left to take */
+  void RunJobs(uint64_t generation);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  /* Frame being encoded, guarded by |mutex_| */
+  uint64_t generation_ = 0;
+  std::vector<Job>* jobs_ = nullptr;
+  lc3_pcm_format format_ = LC3_PCM_FORMAT_S16;
+  size_t next_job_ = 0;
+  size_t pending_jobs_ = 0;
+  bool stopping_ = false;
+};
+
+}  // namespace le_audio
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lc3_encode_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace le_audio {
+
+namespace {
+constexpr int kDtUs = 10000;
+constexpr int kSrHz = 48000;
+constexpr int kOctetsPerFrame = 100;
+
+class Lc3EncodePoolTest : public ::testing::TestWithParam<size_t> {
+ protected:
+  void SetUp() override {
+    num_channels_ = GetParam();
+    num_samples_ = lc3_frame_samples(kDtUs, kSrHz);
+    /* A different tone on each channel, interleaved */
+    pcm_.resize(num_samples_ * num_channels_);
+    for (int i = 0; i < num_samples_; ++i) {
+      for (size_t chan = 0; chan < num_channels_; ++chan) {
+        pcm_[i * num_channels_ + chan] =
+            8000 * std::sin(2 * M_PI * 440 * (chan + 1) * i / kSrHz);
+      }
+    }
+  }
+
+  /* Fresh encoders and output buffers, one per channel */
+  void SetupJobs(std::vector<Lc3EncodePool::Job>& jobs,
+                 std::vector<std::vector<uint8_t>>& outputs) {
+    jobs.clear();
+    outputs.assign(num_channels_, std::vector<uint8_t>(kOctetsPerFrame));
+    for (size_t chan = 0; chan < num_channels_; ++chan) {
+      encoders_mem_.emplace_back(malloc(lc3_encoder_size(kDtUs, kSrHz)),
+                                 &std::free);
+      jobs.push_back(
+          {.encoder = lc3_setup_encoder(kDtUs, kSrHz, 0,
+                                        encoders_mem_.back().get()),
+           .pcm = pcm_.data() + chan,
+           .stride = static_cast<int>(num_channels_),
+           .out = outputs[chan].data(),
+           .out_size = kOctetsPerFrame,
+           .status = -1});
+    }
+  }
+
+  size_t num_channels_;
+  int num_samples_;
+  std::vector<int16_t> pcm_;
+  std::vector<std::unique_ptr<void, decltype(&std::free)>> encoders_mem_;
+};
+}  // namespace
+
+TEST(Lc3EncodePoolWorkersTest, testWorkerCount) {
+  ASSERT_EQ(Lc3EncodePool::GetWorkerCount(0), 0u);
+  ASSERT_EQ(Lc3EncodePool::GetWorkerCount(1), 0u);
+  ASSERT_LE(Lc3EncodePool::GetWorkerCount(2), 1u);
+  ASSERT_LE(Lc3EncodePool::GetWorkerCount(8), 3u);
+}
+
+TEST_P(Lc3EncodePoolTest, testMatchesSequentialEncoding) {
+  std::vector<Lc3EncodePool::Job> sequential_jobs;
+  std::vector<std::vector<uint8_t>> sequential_outputs;
+  SetupJobs(sequential_jobs, sequential_outputs);
+
+  std::vector<Lc3EncodePool::Job> parallel_jobs;
+  std::vector<std::vector<uint8_t>> parallel_outputs;
+  SetupJobs(parallel_jobs, parallel_outputs);
+
+  Lc3EncodePool sequential_pool(0);
+  Lc3EncodePool parallel_pool(num_channels_ - 1);
+  ASSERT_EQ(sequential_pool.GetNumWorkers(), 0u);
+
+  /* Encoders keep state between frames, so compare a few in a row */
+  for (int frame = 0; frame < 5; ++frame) {
+    sequential_pool.Encode(LC3_PCM_FORMAT_S16, sequential_jobs);
+    parallel_pool.Encode(LC3_PCM_FORMAT_S16, parallel_jobs);
+
+    for (size_t chan = 0; chan < num_channels_; ++chan) {
+      ASSERT_EQ(sequential_jobs[chan].status, 0);
+      ASSERT_EQ(parallel_jobs[chan].status, 0);
+      ASSERT_EQ(parallel_outputs[chan], sequential_outputs[chan]);
+    }
+  }
+
+  /* Each channel carries its own tone */
+  ASSERT_NE(parallel_outputs[0], parallel_outputs[1]);
+}
+
+INSTANTIATE_TEST_SUITE_P(Channels, Lc3EncodePoolTest,
+                         ::testing::Values(2, 4, 6));
+
+}  // namespace le_audio
@@ -0,0 +1,139 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <dirent.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "bta/gatt/bta_gattc_int.h"
+#include "gatt/database_builder.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+using bluetooth::Uuid;
+
+namespace gatt {
+
+namespace {
+const RawAddress kAddress1({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+const RawAddress kAddress2({0x11, 0x22, 0x33, 0x44, 0x55, 0x77});
+
+Database BuildDatabase(uint16_t battery_level_properties) {
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x0005, Uuid::FromString("1800"), true);
+  builder.AddCharacteristic(0x0002, 0x0003, Uuid::FromString("2a00"), 0x02);
+  builder.AddCharacteristic(0x0004, 0x0005, Uuid::FromString("2a01"), 0x02);
+  builder.AddService(0x0010, 0x0014, Uuid::FromString("180f"), true);
+  builder.AddIncludedService(0x0011, Uuid::FromString("1800"), 0x0001, 0x0005);
+  builder.AddCharacteristic(0x0012, 0x0013, Uuid::FromString("2a19"),
+                            battery_level_properties);
+  builder.AddDescriptor(0x0014, Uuid::FromString("2902"));
+  return builder.Build();
+}
+}  // namespace
+
+class GattCacheStorageTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char dir[] = "/tmp/btgattcXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    dir_ = dir;
+    bta_gattc_cache_set_dir_for_testing(dir_);
+  }
+
+  void TearDown() override {
+    std::unique_ptr<DIR, decltype(&closedir)> dirp(opendir(dir_.c_str()),
+                                                   &closedir);
+    dirent* dp;
+    while ((dp = readdir(dirp.get())) != nullptr) {
+      unlink((dir_ + "/" + dp->d_name).c_str());
+    }
+    rmdir(dir_.c_str());
+  }
+
+  std::string dir_;
+};
+
+TEST_F(GattCacheStorageTest, load_by_address_and_hash) {
+  Database db = BuildDatabase(0x12);
+  bta_gattc_cache_write(kAddress1, db);
+
+  Database loaded = bta_gattc_cache_load(kAddress1);
+  EXPECT_FALSE(loaded.IsEmpty());
+  EXPECT_EQ(loaded.ToString(), db.ToString());
+  EXPECT_EQ(loaded.Hash(), db.Hash());
+
+  loaded = bta_gattc_hash_load(db.Hash());
+  EXPECT_EQ(loaded.ToString(), db.ToString());
+
+  EXPECT_TRUE(bta_gattc_cache_load(kAddress2).IsEmpty());
+}
+
+TEST_F(GattCacheStorageTest, link_and_reset) {
+  Database db = BuildDatabase(0x12);
+  bta_gattc_cache_write(kAddress1, db);
+  bta_gattc_cache_link(kAddress2, db.Hash());
+  EXPECT_EQ(bta_gattc_cache_load(kAddress2).ToString(), db.ToString());
+
+  bta_gattc_cache_reset(kAddress1);
+  EXPECT_TRUE(bta_gattc_cache_load(kAddress1).IsEmpty());
+  EXPECT_FALSE(bta_gattc_cache_load(kAddress2).IsEmpty());
+}
+
+TEST_F(GattCacheStorageTest, index_is_rebuilt_from_files) {
+  Database db1 = BuildDatabase(0x12);
+  Database db2 = BuildDatabase(0x1a);
+  ASSERT_NE(db1.Hash(), db2.Hash());
+  bta_gattc_cache_write(kAddress1, db1);
+  bta_gattc_cache_write(kAddress2, db2);
+
+  // As done at the next start of the stack
+  bta_gattc_cache_set_dir_for_testing(dir_);
+  EXPECT_EQ(bta_gattc_cache_load(kAddress1).ToString(), db1.ToString());
+  EXPECT_EQ(bta_gattc_cache_load(kAddress2).ToString(), db2.ToString());
+  EXPECT_EQ(bta_gattc_hash_load(db2.Hash()).ToString(), db2.ToString());
+}
+
+TEST_F(GattCacheStorageTest, older_format_is_not_loaded) {
+  // Version 6 header, with no attributes
+  std::string fname = dir_ + "/gatt_cache_112233445566";
+  FILE* fd = fopen(fname.c_str(), "wb");
+  ASSERT_NE(fd, nullptr);
+  uint16_t header[2] = {6, 0};
+  ASSERT_EQ(fwrite(header, sizeof(header), 1, fd), 1u);
+  fclose(fd);
+
+  bta_gattc_cache_set_dir_for_testing(dir_);
+  EXPECT_TRUE(bta_gattc_cache_load(kAddress1).IsEmpty());
+  EXPECT_NE(access(fname.c_str(), F_OK), 0);
+}
+
+TEST_F(GattCacheStorageTest, truncated_file_is_not_loaded) {
+  Database db = BuildDatabase(0x12);
+  bta_gattc_cache_write(kAddress1, db);
+
+  std::string fname = dir_ + "/gatt_cache_112233445566";
+  ASSERT_EQ(truncate(fname.c_str(), 40), 0);
+  EXPECT_TRUE(bta_gattc_cache_load(kAddress1).IsEmpty());
+}
+
+}  // namespace gatt
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "btcore/include/module.h"
+#include "device/include/interop.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+extern const module_t interop_module;
+
+namespace {
+
+// Most remote devices are not in the database, so every feature they are
+// checked against has to be ruled out
+const uint8_t kUnlistedAddressBytes[] = {0x00, 0x1a, 0x7d, 0xda, 0x71, 0x13};
+const RawAddress kUnlistedAddress(kUnlistedAddressBytes);
+const char* kUnlistedName = "Galaxy Buds2 Pro (3F21) LE";
+
+interop_feature_t NextFeature(int i) {
+  return static_cast<interop_feature_t>(i % END_OF_INTEROP_LIST);
+}
+
+// Matches against every feature of the database shipped with the stack
+void BM_InteropMatchAddr(State& state) {
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        interop_match_addr(NextFeature(i++), &kUnlistedAddress));
+  }
+}
+
+void BM_InteropMatchName(State& state) {
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        interop_match_name(NextFeature(i++), kUnlistedName));
+  }
+}
+
+void BM_InteropMatchVendorProductIds(State& state) {
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        interop_match_vendor_product_ids(NextFeature(i++), 0x04e8, 0xa013));
+  }
+}
+
+// Lookups from several threads at once, as connection, SDP, AVRCP and HID
+// events are handled concurrently
+BENCHMARK(BM_InteropMatchAddr)->ThreadRange(1, 4);
+BENCHMARK(BM_InteropMatchName)->ThreadRange(1, 4);
+BENCHMARK(BM_InteropMatchVendorProductIds);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Loads the interop_database.conf installed with the stack
+  module_init(&interop_module);
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+  module_clean_up(&interop_module);
+}
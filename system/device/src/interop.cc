@@ -32,10 +32,15 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "bt_types.h"
 #include "btcore/include/module.h"
@@ -175,6 +180,270 @@ typedef struct {
 
 } interop_db_entry_t;
 
+namespace {
+
+// Immutable lookup tables compiled from |interop_list|, so that matching a
+// remote device neither walks the list nor takes |interop_list_lock|. A new
+// index is built whenever the list changes and published by swapping
+// |interop_index|; readers keep using the index they loaded until they drop
+// it.
+class InteropIndex {
+ public:
+  explicit InteropIndex(const list_t* list);
+
+  bool MatchAddr(interop_feature_t feature, const RawAddress& addr) const;
+  // |name| must already be trimmed
+  bool MatchName(interop_feature_t feature, const char* name) const;
+  bool MatchManufacturer(interop_feature_t feature,
+                         uint16_t manufacturer) const;
+  bool MatchVndrPrdt(interop_feature_t feature, uint16_t vendor_id,
+                     uint16_t product_id) const;
+  bool MatchVersion(interop_feature_t feature, uint16_t version) const;
+  // Return the first entry listed for the OUI of |addr|, nullptr if none
+  const interop_hid_ssr_max_lat_t* FindSsrMaxLat(interop_feature_t feature,
+                                                 const RawAddress& addr) const;
+  const interop_lmp_version_t* FindLmpVersion(interop_feature_t feature,
+                                              const RawAddress& addr) const;
+
+ private:
+  // Case folded prefix trie of device names, matching a name when one of the
+  // listed names is a prefix of it
+  class NameTrie {
+   public:
+    void Insert(const char* name);
+    bool MatchesPrefixOf(const char* name) const;
+
+   private:
+    struct Node {
+      bool is_name_end = false;
+      std::vector<std::pair<char, uint32_t>> children;
+    };
+    std::vector<Node> nodes_;
+  };
+
+  struct FeatureTables {
+    // Address prefixes keyed by PrefixKey(), with bit n of
+    // |addr_prefix_lengths| set when a prefix of n bytes is listed
+    std::unordered_set<uint64_t> addr_prefixes;
+    uint8_t addr_prefix_lengths = 0;
+    std::vector<interop_addr_range_entry_t> addr_ranges;
+    NameTrie names;
+    std::unordered_set<uint16_t> manufacturers;
+    std::unordered_set<uint32_t> vndr_prdts;
+    std::unordered_set<uint16_t> versions;
+    std::unordered_map<uint32_t, interop_hid_ssr_max_lat_t> ssr_max_lats;
+    std::unordered_map<uint32_t, interop_lmp_version_t> lmp_versions;
+  };
+
+  static uint64_t PrefixKey(const RawAddress& addr, size_t length);
+  static uint32_t Oui(const RawAddress& addr);
+  // Return nullptr for a feature outside of interop_feature_t
+  const FeatureTables* Tables(interop_feature_t feature) const;
+  FeatureTables* MutableTables(interop_feature_t feature) {
+    return const_cast<FeatureTables*>(Tables(feature));
+  }
+
+  std::vector<FeatureTables> features_;
+};
+
+InteropIndex::InteropIndex(const list_t* list)
+    : features_(END_OF_INTEROP_LIST) {
+  for (const list_node_t* node = list_begin(list); node != list_end(list);
+       node = list_next(node)) {
+    const interop_db_entry_t* db_entry =
+        static_cast<const interop_db_entry_t*>(list_node(node));
+    switch (db_entry->bl_type) {
+      case INTEROP_BL_TYPE_ADDR: {
+        const interop_addr_entry_t& e = db_entry->entry_type.addr_entry;
+        size_t length = std::min(e.length, sizeof(RawAddress));
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->addr_prefixes.insert(PrefixKey(e.addr, length));
+          tables->addr_prefix_lengths |= 1 << length;
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_NAME: {
+        const interop_name_entry_t& e = db_entry->entry_type.name_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->names.Insert(e.name);
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_MANUFACTURE: {
+        const interop_manufacturer_t& e = db_entry->entry_type.mnfr_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->manufacturers.insert(e.manufacturer);
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_VNDR_PRDT: {
+        const interop_hid_multitouch_t& e = db_entry->entry_type.vnr_pdt_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->vndr_prdts.insert(e.vendor_id << 16 | e.product_id);
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_SSR_MAX_LAT: {
+        const interop_hid_ssr_max_lat_t& e =
+            db_entry->entry_type.ssr_max_lat_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->ssr_max_lats.emplace(Oui(e.addr), e);
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_VERSION: {
+        const interop_version_t& e = db_entry->entry_type.version_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->versions.insert(e.version);
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_LMP_VERSION: {
+        const interop_lmp_version_t& e = db_entry->entry_type.lmp_version_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->lmp_versions.emplace(Oui(e.addr), e);
+        }
+        break;
+      }
+      case INTEROP_BL_TYPE_ADDR_RANGE: {
+        // Only ranges from the static database are ever matched
+        if (db_entry->bl_entry_type != INTEROP_ENTRY_TYPE_STATIC) break;
+        const interop_addr_range_entry_t& e =
+            db_entry->entry_type.addr_range_entry;
+        if (FeatureTables* tables = MutableTables(e.feature)) {
+          tables->addr_ranges.push_back(e);
+        }
+        break;
+      }
+      default:
+        LOG_ERROR("bl_type: %d not handled", db_entry->bl_type);
+        break;
+    }
+  }
+}
+
+uint64_t InteropIndex::PrefixKey(const RawAddress& addr, size_t length) {
+  uint64_t key = length;
+  for (size_t i = 0; i < length; i++) key = (key << 8) | addr.address[i];
+  return key;
+}
+
+uint32_t InteropIndex::Oui(const RawAddress& addr) {
+  return addr.address[0] << 16 | addr.address[1] << 8 | addr.address[2];
+}
+
+const InteropIndex::FeatureTables* InteropIndex::Tables(
+    interop_feature_t feature) const {
+  if (feature < BEGINNING_OF_INTEROP_LIST || feature >= END_OF_INTEROP_LIST) {
+    return nullptr;
+  }
+  return &features_[feature];
+}
+
+bool InteropIndex::MatchAddr(interop_feature_t feature,
+                             const RawAddress& addr) const {
+  const FeatureTables* tables = Tables(feature);
+  if (tables == nullptr) return false;
+  for (size_t length = 0; length <= sizeof(RawAddress); length++) {
+    if ((tables->addr_prefix_lengths & (1 << length)) &&
+        tables->addr_prefixes.count(PrefixKey(addr, length))) {
+      return true;
+    }
+  }
+  for (const interop_addr_range_entry_t& range : tables->addr_ranges) {
+    if (addr >= range.addr_start && addr <= range.addr_end) return true;
+  }
+  return false;
+}
+
+bool InteropIndex::MatchName(interop_feature_t feature,
+                             const char* name) const {
+  const FeatureTables* tables = Tables(feature);
+  return tables != nullptr && tables->names.MatchesPrefixOf(name);
+}
+
+bool InteropIndex::MatchManufacturer(interop_feature_t feature,
+                                     uint16_t manufacturer) const {
+  const FeatureTables* tables = Tables(feature);
+  return tables != nullptr && tables->manufacturers.count(manufacturer);
+}
+
+bool InteropIndex::MatchVndrPrdt(interop_feature_t feature, uint16_t vendor_id,
+                                 uint16_t product_id) const {
+  const FeatureTables* tables = Tables(feature);
+  return tables != nullptr &&
+         tables->vndr_prdts.count(vendor_id << 16 | product_id);
+}
+
+bool InteropIndex::MatchVersion(interop_feature_t feature,
+                                uint16_t version) const {
+  const FeatureTables* tables = Tables(feature);
+  return tables != nullptr && tables->versions.count(version);
+}
+
+const interop_hid_ssr_max_lat_t* InteropIndex::FindSsrMaxLat(
+    interop_feature_t feature, const RawAddress& addr) const {
+  const FeatureTables* tables = Tables(feature);
+  if (tables == nullptr) return nullptr;
+  auto it = tables->ssr_max_lats.find(Oui(addr));
+  return it == tables->ssr_max_lats.end() ? nullptr : &it->second;
+}
+
+const interop_lmp_version_t* InteropIndex::FindLmpVersion(
+    interop_feature_t feature, const RawAddress& addr) const {
+  const FeatureTables* tables = Tables(feature);
+  if (tables == nullptr) return nullptr;
+  auto it = tables->lmp_versions.find(Oui(addr));
+  return it == tables->lmp_versions.end() ? nullptr : &it->second;
+}
+
+void InteropIndex::NameTrie::Insert(const char* name) {
+  if (nodes_.empty()) nodes_.emplace_back();
+  uint32_t node = 0;
+  for (const char* p = name; *p; p++) {
+    char c = tolower(static_cast<unsigned char>(*p));
+    uint32_t next = 0;
+    for (const auto& child : nodes_[node].children) {
+      if (child.first == c) {
+        next = child.second;
+        break;
+      }
+    }
+    if (next == 0) {
+      next = nodes_.size();
+      nodes_[node].children.emplace_back(c, next);
+      nodes_.emplace_back();
+    }
+    node = next;
+  }
+  nodes_[node].is_name_end = true;
+}
+
+bool InteropIndex::NameTrie::MatchesPrefixOf(const char* name) const {
+  if (nodes_.empty()) return false;
+  uint32_t node = 0;
+  for (const char* p = name;; p++) {
+    if (nodes_[node].is_name_end) return true;
+    if (*p == '\0') return false;
+    char c = tolower(static_cast<unsigned char>(*p));
+    uint32_t next = 0;
+    for (const auto& child : nodes_[node].children) {
+      if (child.first == c) {
+        next = child.second;
+        break;
+      }
+    }
+    if (next == 0) return false;
+    node = next;
+  }
+}
+
+}  // namespace
+
+// Index of |interop_list| for lock free matching, nullptr until the database
+// is loaded. Accessed with std::atomic_load() and std::atomic_store() only.
+static std::shared_ptr<const InteropIndex> interop_index;
+
 static const char* interop_feature_string_(const interop_feature_t feature);
 static void interop_free_entry_(void* data);
 static void interop_lazy_init_(void);
@@ -189,6 +458,7 @@ static void interop_database_save_allowlisted_media_players_list(
     const config_t* config);
 static void interop_database_add_(interop_db_entry_t* db_entry, bool persist);
 static bool interop_database_remove_(interop_db_entry_t* entry);
+static void interop_index_rebuild_locked_(void);
 static bool interop_database_match(interop_db_entry_t* entry,
                                    interop_db_entry_t** ret_entry,
                                    interop_entry_type entry_type);
@@ -296,6 +566,7 @@ static future_t* interop_clean_up(void) {
   pthread_mutex_lock(&interop_list_lock);
   list_free(interop_list);
   interop_list = NULL;
+  interop_index_rebuild_locked_();
   list_free(media_player_list);
   media_player_list = NULL;
   interop_is_initialized = false;
@@ -393,7 +664,20 @@ static void interop_lazy_init_(void) {
   if (interop_list == NULL) {
     interop_list = list_new(interop_free_entry_);
     load_config();
+    // Entries are indexed once the whole database is loaded
+    pthread_mutex_lock(&interop_list_lock);
+    interop_index_rebuild_locked_();
+    pthread_mutex_unlock(&interop_list_lock);
+  }
+}
+
+// Must be called with |interop_list_lock| held
+static void interop_index_rebuild_locked_(void) {
+  std::shared_ptr<const InteropIndex> index;
+  if (interop_list != NULL) {
+    index = std::make_shared<const InteropIndex>(interop_list);
   }
+  std::atomic_store(&interop_index, std::move(index));
 }
 
 // interop config related functions
@@ -618,6 +902,8 @@ static void interop_database_add_(interop_db_entry_t* db_entry, bool persist) {
 
   if (interop_list) {
     list_append(interop_list, db_entry);
+    // Loading the database indexes all entries at once when done
+    if (interop_is_initialized) interop_index_rebuild_locked_();
   }
 
   pthread_mutex_unlock(&interop_list_lock);
@@ -776,6 +1062,7 @@ static bool interop_database_remove_(interop_db_entry_t* entry) {
   // first remove it from linked list
   pthread_mutex_lock(&interop_list_lock);
   list_remove(interop_list, (void*)ret_entry);
+  interop_index_rebuild_locked_();
   pthread_mutex_unlock(&interop_list_lock);
 
   return interop_config_add_or_remove(entry, false);
@@ -1277,16 +1564,8 @@ void interop_database_add_addr_lmp_version(const interop_feature_t feature,
 
 bool interop_database_match_manufacturer(const interop_feature_t feature,
                                          uint16_t manufacturer) {
-  interop_db_entry_t entry;
-
-  entry.bl_type = INTEROP_BL_TYPE_MANUFACTURE;
-  entry.entry_type.mnfr_entry.feature = feature;
-  entry.entry_type.mnfr_entry.manufacturer = manufacturer;
-
-  if (interop_database_match(
-          &entry, NULL,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  if (index && index->MatchManufacturer(feature, manufacturer)) {
     LOG_WARN(
         "Device with manufacturer id: %d is a match for interop workaround %s",
         manufacturer, interop_feature_string_(feature));
@@ -1302,17 +1581,9 @@ bool interop_database_match_name(const interop_feature_t feature,
   CHECK(name);
 
   strlcpy(trim_name, name, KEY_MAX_LENGTH);
-  interop_db_entry_t entry;
-
-  entry.bl_type = INTEROP_BL_TYPE_NAME;
-  strlcpy(entry.entry_type.name_entry.name, trim(trim_name), KEY_MAX_LENGTH);
-  entry.entry_type.name_entry.feature = (interop_feature_t)feature;
-  entry.entry_type.name_entry.length = strlen(entry.entry_type.name_entry.name);
 
-  if (interop_database_match(
-          &entry, NULL,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  if (index && index->MatchName(feature, trim(trim_name))) {
     LOG_WARN("Device with name: %s is a match for interop workaround %s", name,
              interop_feature_string_(feature));
     return true;
@@ -1325,29 +1596,8 @@ bool interop_database_match_addr(const interop_feature_t feature,
                                  const RawAddress* addr) {
   CHECK(addr);
 
-  interop_db_entry_t entry;
-
-  entry.bl_type = INTEROP_BL_TYPE_ADDR;
-  entry.entry_type.addr_entry.addr = *addr;
-  entry.entry_type.addr_entry.feature = (interop_feature_t)feature;
-  entry.entry_type.addr_entry.length = sizeof(RawAddress);
-
-  if (interop_database_match(
-          &entry, NULL,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
-    LOG_WARN("Device %s is a match for interop workaround %s.",
-             ADDRESS_TO_LOGGABLE_CSTR(*addr), interop_feature_string_(feature));
-    return true;
-  }
-
-  entry.bl_type = INTEROP_BL_TYPE_ADDR_RANGE;
-  entry.bl_entry_type = INTEROP_ENTRY_TYPE_STATIC;
-  entry.entry_type.addr_range_entry.addr_start = *addr;
-  entry.entry_type.addr_range_entry.feature = (interop_feature_t)feature;
-
-  if (interop_database_match(&entry, NULL,
-                             (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  if (index && index->MatchAddr(feature, *addr)) {
     LOG_WARN("Device %s is a match for interop workaround %s.",
              ADDRESS_TO_LOGGABLE_CSTR(*addr), interop_feature_string_(feature));
     return true;
@@ -1358,17 +1608,8 @@ bool interop_database_match_addr(const interop_feature_t feature,
 
 bool interop_database_match_vndr_prdt(const interop_feature_t feature,
                                       uint16_t vendor_id, uint16_t product_id) {
-  interop_db_entry_t entry;
-
-  entry.bl_type = INTEROP_BL_TYPE_VNDR_PRDT;
-
-  entry.entry_type.vnr_pdt_entry.feature = (interop_feature_t)feature;
-  entry.entry_type.vnr_pdt_entry.vendor_id = vendor_id;
-  entry.entry_type.vnr_pdt_entry.product_id = product_id;
-  if (interop_database_match(
-          &entry, NULL,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  if (index && index->MatchVndrPrdt(feature, vendor_id, product_id)) {
     LOG_WARN(
         "Device with vendor_id: %d product_id: %d is a match for interop "
         "workaround %s",
@@ -1382,21 +1623,13 @@ bool interop_database_match_vndr_prdt(const interop_feature_t feature,
 bool interop_database_match_addr_get_max_lat(const interop_feature_t feature,
                                              const RawAddress* addr,
                                              uint16_t* max_lat) {
-  interop_db_entry_t entry;
-  interop_db_entry_t* ret_entry = NULL;
-
-  entry.bl_type = INTEROP_BL_TYPE_SSR_MAX_LAT;
-
-  entry.entry_type.ssr_max_lat_entry.feature = feature;
-  entry.entry_type.ssr_max_lat_entry.addr = *addr;
-  entry.entry_type.ssr_max_lat_entry.feature = feature;
-  if (interop_database_match(
-          &entry, &ret_entry,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  const interop_hid_ssr_max_lat_t* ssr_max_lat_entry =
+      index ? index->FindSsrMaxLat(feature, *addr) : nullptr;
+  if (ssr_max_lat_entry != nullptr) {
     LOG_WARN("Device %s is a match for interop workaround %s.",
              ADDRESS_TO_LOGGABLE_CSTR(*addr), interop_feature_string_(feature));
-    *max_lat = ret_entry->entry_type.ssr_max_lat_entry.max_lat;
+    *max_lat = ssr_max_lat_entry->max_lat;
     return true;
   }
 
@@ -1405,16 +1638,8 @@ bool interop_database_match_addr_get_max_lat(const interop_feature_t feature,
 
 bool interop_database_match_version(const interop_feature_t feature,
                                     uint16_t version) {
-  interop_db_entry_t entry;
-
-  entry.bl_type = INTEROP_BL_TYPE_VERSION;
-
-  entry.entry_type.version_entry.feature = (interop_feature_t)feature;
-  entry.entry_type.version_entry.version = version;
-  if (interop_database_match(
-          &entry, NULL,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  if (index && index->MatchVersion(feature, version)) {
     LOG_WARN("Device with version: 0x%04x is a match for interop workaround %s",
              version, interop_feature_string_(feature));
     return true;
@@ -1427,22 +1652,14 @@ bool interop_database_match_addr_get_lmp_ver(const interop_feature_t feature,
                                              const RawAddress* addr,
                                              uint8_t* lmp_ver,
                                              uint16_t* lmp_sub_ver) {
-  interop_db_entry_t entry;
-  interop_db_entry_t* ret_entry = NULL;
-
-  entry.bl_type = INTEROP_BL_TYPE_LMP_VERSION;
-
-  entry.entry_type.lmp_version_entry.feature = feature;
-  entry.entry_type.lmp_version_entry.addr = *addr;
-  entry.entry_type.lmp_version_entry.feature = feature;
-  if (interop_database_match(
-          &entry, &ret_entry,
-          (interop_entry_type)(INTEROP_ENTRY_TYPE_STATIC |
-                               INTEROP_ENTRY_TYPE_DYNAMIC))) {
+  std::shared_ptr<const InteropIndex> index = std::atomic_load(&interop_index);
+  const interop_lmp_version_t* lmp_version_entry =
+      index ? index->FindLmpVersion(feature, *addr) : nullptr;
+  if (lmp_version_entry != nullptr) {
     LOG_WARN("Device %s is a match for interop workaround %s.",
              ADDRESS_TO_LOGGABLE_CSTR(*addr), interop_feature_string_(feature));
-    *lmp_ver = ret_entry->entry_type.lmp_version_entry.lmp_ver;
-    *lmp_sub_ver = ret_entry->entry_type.lmp_version_entry.lmp_sub_ver;
+    *lmp_ver = lmp_version_entry->lmp_ver;
+    *lmp_sub_ver = lmp_version_entry->lmp_sub_ver;
     return true;
   }
 
@@ -1564,6 +1781,7 @@ bool interop_database_remove_feature(const interop_feature_t feature) {
     if (entry_match) {
       pthread_mutex_lock(&interop_list_lock);
       list_remove(interop_list, (void*)entry);
+      interop_index_rebuild_locked_();
       pthread_mutex_unlock(&interop_list_lock);
     }
   }
@@ -466,6 +466,19 @@ TEST_F(InteropTest, test_name_hit) {
   module_clean_up(&interop_module);
 }
 
+TEST_F(InteropTest, test_name_prefix_ignores_case) {
+  module_init(&interop_module);
+
+  EXPECT_TRUE(interop_match_name(INTEROP_DISABLE_AUTO_PAIRING, "bmw X5"));
+  EXPECT_TRUE(interop_match_name(INTEROP_DISABLE_AUTO_PAIRING, "AUDI"));
+  EXPECT_TRUE(interop_match_name(INTEROP_DISABLE_AUTO_PAIRING, "  Audi A4  "));
+  EXPECT_FALSE(interop_match_name(INTEROP_DISABLE_AUTO_PAIRING, "My BMW"));
+  EXPECT_FALSE(interop_match_name(INTEROP_DISABLE_AUTO_PAIRING, "Aud"));
+  EXPECT_FALSE(interop_match_name(INTEROP_REMOVE_HID_DIG_DESCRIPTOR, "BMW"));
+
+  module_clean_up(&interop_module);
+}
+
 TEST_F(InteropTest, test_name_miss) {
   module_init(&interop_module);
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <lc3.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+// Octets per frame of the 10 ms configurations of the BAP specification
+int FrameOctets(int sr_hz) {
+  switch (sr_hz) {
+    case 8000:
+      return 30;
+    case 16000:
+      return 40;
+    case 24000:
+      return 60;
+    case 32000:
+      return 80;
+    default:
+      return 120;
+  }
+}
+
+// One channel encoded or decoded by the calling thread, so that the frames
+// per second are those of a single core
+class BM_Lc3 : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    dt_us_ = st.range(0);
+    sr_hz_ = st.range(1);
+    // Scaled to the frame duration, to keep the bitrate of the configuration
+    nbytes_ = FrameOctets(sr_hz_) * dt_us_ / 10000;
+
+    int num_samples = lc3_frame_samples(dt_us_, sr_hz_);
+    pcm_.resize(num_samples);
+    for (int i = 0; i < num_samples; ++i) {
+      pcm_[i] = 8000 * std::sin(2 * M_PI * 440 * i / sr_hz_) +
+                2000 * std::sin(2 * M_PI * 3000 * i / sr_hz_);
+    }
+    frame_.resize(nbytes_);
+
+    encoder_mem_.reset(malloc(lc3_encoder_size(dt_us_, sr_hz_)));
+    encoder_ = lc3_setup_encoder(dt_us_, sr_hz_, 0, encoder_mem_.get());
+    decoder_mem_.reset(malloc(lc3_decoder_size(dt_us_, sr_hz_)));
+    decoder_ = lc3_setup_decoder(dt_us_, sr_hz_, 0, decoder_mem_.get());
+
+    lc3_encode(encoder_, LC3_PCM_FORMAT_S16, pcm_.data(), 1, nbytes_,
+               frame_.data());
+  }
+
+  void TearDown(State& st) override {
+    encoder_mem_.reset();
+    decoder_mem_.reset();
+    pcm_.clear();
+    frame_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  int dt_us_;
+  int sr_hz_;
+  int nbytes_;
+  std::vector<int16_t> pcm_;
+  std::vector<uint8_t> frame_;
+  std::unique_ptr<void, decltype(&std::free)> encoder_mem_{nullptr,
+                                                           &std::free};
+  std::unique_ptr<void, decltype(&std::free)> decoder_mem_{nullptr,
+                                                           &std::free};
+  lc3_encoder_t encoder_;
+  lc3_decoder_t decoder_;
+};
+
+BENCHMARK_DEFINE_F(BM_Lc3, Encode)(State& state) {
+  for (auto _ : state) {
+    lc3_encode(encoder_, LC3_PCM_FORMAT_S16, pcm_.data(), 1, nbytes_,
+               frame_.data());
+    ::benchmark::DoNotOptimize(frame_.data());
+    ::benchmark::ClobberMemory();
+  }
+  state.counters["frames_per_sec"] =
+      Counter(state.iterations(), Counter::kIsRate);
+}
+
+BENCHMARK_DEFINE_F(BM_Lc3, Decode)(State& state) {
+  for (auto _ : state) {
+    lc3_decode(decoder_, frame_.data(), nbytes_, LC3_PCM_FORMAT_S16,
+               pcm_.data(), 1);
+    ::benchmark::DoNotOptimize(pcm_.data());
+    ::benchmark::ClobberMemory();
+  }
+  state.counters["frames_per_sec"] =
+      Counter(state.iterations(), Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(BM_Lc3, Encode)
+    ->ArgNames({"dt_us", "sr_hz"})
+    ->ArgsProduct({{7500, 10000}, {8000, 16000, 24000, 32000, 48000}})
+    ->Unit(::benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(BM_Lc3, Decode)
+    ->ArgNames({"dt_us", "sr_hz"})
+    ->ArgsProduct({{7500, 10000}, {8000, 16000, 24000, 32000, 48000}})
+    ->Unit(::benchmark::kMicrosecond);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -19,6 +19,7 @@
 #include "tables.h"
 
 #include "mdct_neon.h"
+#include "mdct_sse.h"
 
 
 /* ----------------------------------------------------------------------------
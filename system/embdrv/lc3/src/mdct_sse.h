@@ -0,0 +1,312 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 Google LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#if __SSE2__
+
+#include <emmintrin.h>
+
+
+/**
+ * The kernels evaluate the expressions in the same order as the generic
+ * implementations, and without fused multiply-add, so that the results
+ * are bit-exact. A complex `(re, im)` occupies 2 lanes, the subtraction of
+ * a product is done by adding the product with a negated factor.
+ */
+
+/**
+ * Load / Store a single complex value
+ */
+
+static inline __m128 sse_ld1_c(const struct lc3_complex *p)
+{
+    return _mm_castpd_ps(_mm_load_sd((const double *)p));
+}
+
+static inline void sse_st1_c(struct lc3_complex *p, __m128 v)
+{
+    _mm_store_sd((double *)p, _mm_castps_pd(v));
+}
+
+/**
+ * Return `(-im, re)` for each complex `(re, im)` of the vector
+ */
+
+static inline __m128 sse_rot90_c(__m128 v)
+{
+    const __m128 neg_re = _mm_set_ps(0.f, -0.f, 0.f, -0.f);
+
+    return _mm_xor_ps(
+        _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)), neg_re);
+}
+
+
+/**
+ * Butterfly 3 points output, from the twiddles `wa` and `wb` of 2 complex
+ */
+
+static inline __m128 sse_bf3_y(__m128 x0,
+    __m128 x1, __m128 x1r, __m128 x2, __m128 x2r, __m128 wa, __m128 wb)
+{
+    __m128 y;
+
+    y = _mm_add_ps( x0, _mm_mul_ps(x1 , _mm_shuffle_ps(wa, wb, 0x00)) );
+    y = _mm_add_ps( y , _mm_mul_ps(x1r, _mm_shuffle_ps(wa, wb, 0x55)) );
+    y = _mm_add_ps( y , _mm_mul_ps(x2 , _mm_shuffle_ps(wa, wb, 0xaa)) );
+    y = _mm_add_ps( y , _mm_mul_ps(x2r, _mm_shuffle_ps(wa, wb, 0xff)) );
+    return y;
+}
+
+
+/**
+ * FFT 5 Points
+ * The number of interleaved transform `n` assumed to be even
+ */
+#ifndef fft_5
+#define fft_5 sse_fft_5
+LC3_HOT static inline void sse_fft_5(
+    const struct lc3_complex *x, struct lc3_complex *y, int n)
+{
+    const __m128 cos1 = _mm_set1_ps( 0.3090169944);
+    const __m128 cos2 = _mm_set1_ps(-0.8090169944);
+    const __m128 sin1 = _mm_set_ps(-0.9510565163, 0.9510565163,
+                                   -0.9510565163, 0.9510565163);
+    const __m128 sin2 = _mm_set_ps(-0.5877852523, 0.5877852523,
+                                   -0.5877852523, 0.5877852523);
+
+    const __m128 sign = _mm_set1_ps(-0.f);
+    const __m128 nsin1 = _mm_xor_ps(sin1, sign);
+    const __m128 nsin2 = _mm_xor_ps(sin2, sign);
+
+    for (int i = 0; i < n; i += 2, x += 2, y += 10) {
+
+        __m128 y0, y1, y2, y3, y4;
+
+        __m128 x0 = _mm_loadu_ps( (const float *)(x + 0*n) );
+        __m128 x1 = _mm_loadu_ps( (const float *)(x + 1*n) );
+        __m128 x2 = _mm_loadu_ps( (const float *)(x + 2*n) );
+        __m128 x3 = _mm_loadu_ps( (const float *)(x + 3*n) );
+        __m128 x4 = _mm_loadu_ps( (const float *)(x + 4*n) );
+
+        __m128 s14 = _mm_add_ps(x1, x4);
+        __m128 s23 = _mm_add_ps(x2, x3);
+
+        __m128 d14 = _mm_sub_ps(x1, x4);
+        __m128 d23 = _mm_sub_ps(x2, x3);
+
+        d14 = _mm_shuffle_ps(d14, d14, _MM_SHUFFLE(2, 3, 0, 1));
+        d23 = _mm_shuffle_ps(d23, d23, _MM_SHUFFLE(2, 3, 0, 1));
+
+        y0 = _mm_add_ps( _mm_add_ps(x0, s14), s23 );
+
+        __m128 x0_14c1 = _mm_add_ps( x0, _mm_mul_ps(s14, cos1) );
+        __m128 x0_14c2 = _mm_add_ps( x0, _mm_mul_ps(s14, cos2) );
+
+        y1 = _mm_add_ps( x0_14c1, _mm_mul_ps(d14,  sin1) );
+        y1 = _mm_add_ps( y1     , _mm_mul_ps(s23,  cos2) );
+        y1 = _mm_add_ps( y1     , _mm_mul_ps(d23,  sin2) );
+
+        y4 = _mm_add_ps( x0_14c1, _mm_mul_ps(d14, nsin1) );
+        y4 = _mm_add_ps( y4     , _mm_mul_ps(s23,  cos2) );
+        y4 = _mm_add_ps( y4     , _mm_mul_ps(d23, nsin2) );
+
+        y2 = _mm_add_ps( x0_14c2, _mm_mul_ps(d14,  sin2) );
+        y2 = _mm_add_ps( y2     , _mm_mul_ps(s23,  cos1) );
+        y2 = _mm_add_ps( y2     , _mm_mul_ps(d23, nsin1) );
+
+        y3 = _mm_add_ps( x0_14c2, _mm_mul_ps(d14, nsin2) );
+        y3 = _mm_add_ps( y3     , _mm_mul_ps(s23,  cos1) );
+        y3 = _mm_add_ps( y3     , _mm_mul_ps(d23,  sin1) );
+
+        _mm_storel_pi( (__m64 *)(y + 0), y0 );
+        _mm_storel_pi( (__m64 *)(y + 1), y1 );
+        _mm_storel_pi( (__m64 *)(y + 2), y2 );
+        _mm_storel_pi( (__m64 *)(y + 3), y3 );
+        _mm_storel_pi( (__m64 *)(y + 4), y4 );
+
+        _mm_storeh_pi( (__m64 *)(y + 5), y0 );
+        _mm_storeh_pi( (__m64 *)(y + 6), y1 );
+        _mm_storeh_pi( (__m64 *)(y + 7), y2 );
+        _mm_storeh_pi( (__m64 *)(y + 8), y3 );
+        _mm_storeh_pi( (__m64 *)(y + 9), y4 );
+    }
+}
+#endif /* fft_5 */
+
+/**
+ * FFT Butterfly 3 Points
+ */
+#ifndef fft_bf3
+#define fft_bf3 sse_fft_bf3
+LC3_HOT static inline void sse_fft_bf3(
+    const struct lc3_fft_bf3_twiddles *twiddles,
+    const struct lc3_complex *x, struct lc3_complex *y, int n)
+{
+    int n3 = twiddles->n3;
+    const struct lc3_complex (*w0_ptr)[2] = twiddles->t;
+    const struct lc3_complex (*w1_ptr)[2] = w0_ptr + n3;
+    const struct lc3_complex (*w2_ptr)[2] = w1_ptr + n3;
+
+    const struct lc3_complex *x0_ptr = x;
+    const struct lc3_complex *x1_ptr = x0_ptr + n*n3;
+    const struct lc3_complex *x2_ptr = x1_ptr + n*n3;
+
+    struct lc3_complex *y0_ptr = y;
+    struct lc3_complex *y1_ptr = y0_ptr + n3;
+    struct lc3_complex *y2_ptr = y1_ptr + n3;
+
+    for (int j, i = 0; i < n; i++,
+            y0_ptr += 3*n3, y1_ptr += 3*n3, y2_ptr += 3*n3) {
+
+        /* --- Process by pair --- */
+
+        for (j = 0; j < (n3 >> 1); j++,
+                x0_ptr += 2, x1_ptr += 2, x2_ptr += 2) {
+
+            __m128 x0 = _mm_loadu_ps( (const float *)x0_ptr );
+            __m128 x1 = _mm_loadu_ps( (const float *)x1_ptr );
+            __m128 x2 = _mm_loadu_ps( (const float *)x2_ptr );
+
+            __m128 x1r = sse_rot90_c(x1);
+            __m128 x2r = sse_rot90_c(x2);
+
+            __m128 wa, wb, yn;
+
+            wa = _mm_loadu_ps( (const float *)(w0_ptr + 2*j + 0) );
+            wb = _mm_loadu_ps( (const float *)(w0_ptr + 2*j + 1) );
+            yn = sse_bf3_y(x0, x1, x1r, x2, x2r, wa, wb);
+            _mm_storeu_ps( (float *)(y0_ptr + 2*j), yn );
+
+            wa = _mm_loadu_ps( (const float *)(w1_ptr + 2*j + 0) );
+            wb = _mm_loadu_ps( (const float *)(w1_ptr + 2*j + 1) );
+            yn = sse_bf3_y(x0, x1, x1r, x2, x2r, wa, wb);
+            _mm_storeu_ps( (float *)(y1_ptr + 2*j), yn );
+
+            wa = _mm_loadu_ps( (const float *)(w2_ptr + 2*j + 0) );
+            wb = _mm_loadu_ps( (const float *)(w2_ptr + 2*j + 1) );
+            yn = sse_bf3_y(x0, x1, x1r, x2, x2r, wa, wb);
+            _mm_storeu_ps( (float *)(y2_ptr + 2*j), yn );
+        }
+
+        /* --- Last iteration --- */
+
+        if (n3 & 1) {
+
+            __m128 x0 = sse_ld1_c(x0_ptr++);
+            __m128 x1 = sse_ld1_c(x1_ptr++);
+            __m128 x2 = sse_ld1_c(x2_ptr++);
+
+            __m128 x1r = sse_rot90_c(x1);
+            __m128 x2r = sse_rot90_c(x2);
+
+            __m128 w;
+
+            w = _mm_loadu_ps( (const float *)(w0_ptr + 2*j) );
+            sse_st1_c(y0_ptr + 2*j, sse_bf3_y(x0, x1, x1r, x2, x2r, w, w));
+
+            w = _mm_loadu_ps( (const float *)(w1_ptr + 2*j) );
+            sse_st1_c(y1_ptr + 2*j, sse_bf3_y(x0, x1, x1r, x2, x2r, w, w));
+
+            w = _mm_loadu_ps( (const float *)(w2_ptr + 2*j) );
+            sse_st1_c(y2_ptr + 2*j, sse_bf3_y(x0, x1, x1r, x2, x2r, w, w));
+        }
+
+    }
+}
+#endif /* fft_bf3 */
+
+/**
+ * FFT Butterfly 2 Points
+ */
+#ifndef fft_bf2
+#define fft_bf2 sse_fft_bf2
+LC3_HOT static inline void sse_fft_bf2(
+    const struct lc3_fft_bf2_twiddles *twiddles,
+    const struct lc3_complex *x, struct lc3_complex *y, int n)
+{
+    int n2 = twiddles->n2;
+    const struct lc3_complex *w_ptr = twiddles->t;
+
+    const struct lc3_complex *x0_ptr = x;
+    const struct lc3_complex *x1_ptr = x0_ptr + n*n2;
+
+    struct lc3_complex *y0_ptr = y;
+    struct lc3_complex *y1_ptr = y0_ptr + n2;
+
+    const __m128 sign = _mm_set1_ps(-0.f);
+
+    for (int j, i = 0; i < n; i++, y0_ptr += 2*n2, y1_ptr += 2*n2) {
+
+        /* --- Process by pair --- */
+
+        for (j = 0; j < (n2 >> 1); j++, x0_ptr += 2, x1_ptr += 2) {
+
+            __m128 x0 = _mm_loadu_ps( (const float *)x0_ptr );
+            __m128 x1 = _mm_loadu_ps( (const float *)x1_ptr );
+            __m128 y0, y1;
+
+            __m128 x1r = sse_rot90_c(x1);
+
+            __m128 w = _mm_loadu_ps( (const float *)(w_ptr + 2*j) );
+            __m128 w_re = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 w_im = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+
+            y0 = _mm_add_ps( x0, _mm_mul_ps(x1 , w_re) );
+            y0 = _mm_add_ps( y0, _mm_mul_ps(x1r, w_im) );
+            _mm_storeu_ps( (float *)(y0_ptr + 2*j), y0 );
+
+            y1 = _mm_add_ps( x0, _mm_mul_ps(x1 , _mm_xor_ps(w_re, sign)) );
+            y1 = _mm_add_ps( y1, _mm_mul_ps(x1r, _mm_xor_ps(w_im, sign)) );
+            _mm_storeu_ps( (float *)(y1_ptr + 2*j), y1 );
+        }
+
+        /* --- Last iteration --- */
+
+        if (n2 & 1) {
+
+            __m128 x0 = sse_ld1_c(x0_ptr++);
+            __m128 x1 = sse_ld1_c(x1_ptr++);
+            __m128 y0, y1;
+
+            __m128 x1r = sse_rot90_c(x1);
+
+            __m128 w = sse_ld1_c(w_ptr + 2*j);
+            __m128 w_re = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 w_im = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+
+            y0 = _mm_add_ps( x0, _mm_mul_ps(x1 , w_re) );
+            y0 = _mm_add_ps( y0, _mm_mul_ps(x1r, w_im) );
+            sse_st1_c(y0_ptr + 2*j, y0);
+
+            y1 = _mm_add_ps( x0, _mm_mul_ps(x1 , _mm_xor_ps(w_re, sign)) );
+            y1 = _mm_add_ps( y1, _mm_mul_ps(x1r, _mm_xor_ps(w_im, sign)) );
+            sse_st1_c(y1_ptr + 2*j, y1);
+        }
+    }
+}
+#endif /* fft_bf2 */
+
+/**
+ * The unit tests check the kernels against the generic implementations
+ */
+#ifdef TEST_SSE
+#undef fft_5
+#undef fft_bf3
+#undef fft_bf2
+#endif /* TEST_SSE */
+
+#endif /* __SSE2__ */
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "sbc_encoder.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+constexpr int kSrHz = 48000;
+// High quality joint stereo configuration of the A2DP specification
+constexpr int kBitPool = 53;
+// Frames of input, so that successive frames do not encode the same samples
+constexpr int kNumFrames = 64;
+
+void BM_SbcEncode(State& state) {
+  SBC_ENC_PARAMS params;
+  memset(&params, 0, sizeof(params));
+  params.s16SamplingFreq = SBC_sf48000;
+  params.s16ChannelMode = SBC_JOINT_STEREO;
+  params.s16NumOfSubBands = state.range(0);
+  params.s16NumOfBlocks = 16;
+  params.s16AllocationMethod = SBC_LOUDNESS;
+  params.u16BitRate = 328;
+  params.Format = SBC_FORMAT_GENERAL;
+  SBC_Encoder_Init(&params);
+  // The bit pool derived from the bit rate is overridden, as done by the A2DP
+  // source with the negotiated maximum bit pool
+  params.s16BitPool = kBitPool;
+
+  int frame_samples = params.s16NumOfSubBands * params.s16NumOfBlocks * 2;
+  std::vector<int16_t> pcm(frame_samples * kNumFrames);
+  for (size_t i = 0; i < pcm.size() / 2; ++i) {
+    pcm[2 * i] = 8000 * std::sin(2 * M_PI * 440 * i / kSrHz);
+    pcm[2 * i + 1] = 8000 * std::sin(2 * M_PI * 660 * i / kSrHz);
+  }
+
+  uint8_t output[512];  // More than the largest frame
+  int frame = 0;
+  for (auto _ : state) {
+    uint32_t len =
+        SBC_Encode(&params, pcm.data() + frame * frame_samples, output);
+    ::benchmark::DoNotOptimize(len);
+    ::benchmark::ClobberMemory();
+    frame = (frame + 1) % kNumFrames;
+  }
+
+  state.counters["frames_per_sec"] =
+      Counter(state.iterations(), Counter::kIsRate);
+}
+
+BENCHMARK(BM_SbcEncode)->ArgName("subbands")->Arg(4)->Arg(8);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -119,6 +119,20 @@
 #define SBC_IS_64_MULT_IN_WINDOW_ACCU FALSE
 #endif /*SBC_IS_64_MULT_IN_WINDOW_ACCU */
 
+/* Set SBC_SIMD_OPT to TRUE to compute the windowing of the analysis filter
+ * with SSE2 or NEON intrinsics. It only applies to the 32 bits windowing
+ * selected by SBC_IPAQ_OPT, and gives the same results.
+ */
+#ifndef SBC_SIMD_OPT
+#if (defined(__SSE2__) || defined(__ARM_NEON)) && \
+    (SBC_ARM_ASM_OPT == FALSE) && (SBC_IPAQ_OPT == TRUE) && \
+    (SBC_IS_64_MULT_IN_WINDOW_ACCU == FALSE)
+#define SBC_SIMD_OPT TRUE
+#else
+#define SBC_SIMD_OPT FALSE
+#endif
+#endif /* SBC_SIMD_OPT */
+
 /* Set SBC_IS_64_MULT_IN_IDCT to TRUE to use 64 bits multiplication in the DCT
  * of Matrixing
  */
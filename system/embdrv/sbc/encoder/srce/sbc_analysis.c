@@ -25,6 +25,14 @@
 #include <string.h>
 #include "sbc_enc_func_declare.h"
 #include "sbc_encoder.h"
+
+#if (SBC_SIMD_OPT == TRUE)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 /*#include <math.h>*/
 
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
@@ -1185,6 +1193,106 @@ static int16_t* s16X =
 #endif
 #endif
 
+#if (SBC_SIMD_OPT == TRUE)
+/* Window coefficients of the 32 bits windowing above, by tap. The output i
+ * of the windowing is the sum over the taps j of
+ * as16WindowFor?SBs[j][i] * s16X[ChOffset + i + j * 2 * SubBands]
+ */
+static const int16_t as16WindowFor4SBs[5][8] __attribute__((aligned(16))) = {
+    {0, WIND_4_SUBBANDS_1_0, WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_3_0,
+     WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_2_4,
+     WIND_4_SUBBANDS_1_4},
+    {WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_1, WIND_4_SUBBANDS_2_1,
+     WIND_4_SUBBANDS_3_1, WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_3,
+     WIND_4_SUBBANDS_2_3, WIND_4_SUBBANDS_1_3},
+    {WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_2, WIND_4_SUBBANDS_2_2,
+     WIND_4_SUBBANDS_3_2, WIND_4_SUBBANDS_4_2, WIND_4_SUBBANDS_3_2,
+     WIND_4_SUBBANDS_2_2, WIND_4_SUBBANDS_1_2},
+    {-WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_3, WIND_4_SUBBANDS_2_3,
+     WIND_4_SUBBANDS_3_3, WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_1,
+     WIND_4_SUBBANDS_2_1, WIND_4_SUBBANDS_1_1},
+    {-WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_4, WIND_4_SUBBANDS_2_4,
+     WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_0,
+     WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_1_0},
+};
+
+static const int16_t as16WindowFor8SBs[5][16] __attribute__((aligned(16))) = {
+    {0, WIND_8_SUBBANDS_1_0, WIND_8_SUBBANDS_2_0, WIND_8_SUBBANDS_3_0,
+     WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_5_0, WIND_8_SUBBANDS_6_0,
+     WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_8_0, WIND_8_SUBBANDS_7_4,
+     WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_5_4, WIND_8_SUBBANDS_4_4,
+     WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_2_4, WIND_8_SUBBANDS_1_4},
+    {WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_1, WIND_8_SUBBANDS_2_1,
+     WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_5_1,
+     WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_8_1,
+     WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_5_3,
+     WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_2_3,
+     WIND_8_SUBBANDS_1_3},
+    {WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_2, WIND_8_SUBBANDS_2_2,
+     WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_5_2,
+     WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_8_2,
+     WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_5_2,
+     WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_2_2,
+     WIND_8_SUBBANDS_1_2},
+    {-WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_3, WIND_8_SUBBANDS_2_3,
+     WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_5_3,
+     WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_8_1,
+     WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_5_1,
+     WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_2_1,
+     WIND_8_SUBBANDS_1_1},
+    {-WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_4, WIND_8_SUBBANDS_2_4,
+     WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_4_4, WIND_8_SUBBANDS_5_4,
+     WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_7_4, WIND_8_SUBBANDS_8_0,
+     WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_6_0, WIND_8_SUBBANDS_5_0,
+     WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_3_0, WIND_8_SUBBANDS_2_0,
+     WIND_8_SUBBANDS_1_0},
+};
+
+/* Windowing of |s32NumOfOutputs| (8 or 16) outputs, from the samples |ps16X|
+ * taken every |s32NumOfOutputs| for each of the 5 taps. The 16 x 16 bits
+ * products are exact, and summed in 32 bits as done by WINDOW_ACCU_*.
+ */
+static inline void SbcWindowSimd(const int16_t* ps16X,
+                                 const int16_t* ps16Coeffs,
+                                 int32_t s32NumOfOutputs, int32_t* ps32Y) {
+  int32_t i, j;
+#if defined(__SSE2__)
+  for (i = 0; i < s32NumOfOutputs; i += 8) {
+    __m128i s32Lo = _mm_setzero_si128();
+    __m128i s32Hi = _mm_setzero_si128();
+    for (j = 0; j < 5; j++) {
+      __m128i s16X8 =
+          _mm_loadu_si128((const __m128i*)(ps16X + j * s32NumOfOutputs + i));
+      __m128i s16C8 = _mm_load_si128(
+          (const __m128i*)(ps16Coeffs + j * s32NumOfOutputs + i));
+      __m128i s16ProdLo = _mm_mullo_epi16(s16X8, s16C8);
+      __m128i s16ProdHi = _mm_mulhi_epi16(s16X8, s16C8);
+      s32Lo = _mm_add_epi32(s32Lo, _mm_unpacklo_epi16(s16ProdLo, s16ProdHi));
+      s32Hi = _mm_add_epi32(s32Hi, _mm_unpackhi_epi16(s16ProdLo, s16ProdHi));
+    }
+    _mm_storeu_si128((__m128i*)(ps32Y + i), s32Lo);
+    _mm_storeu_si128((__m128i*)(ps32Y + i + 4), s32Hi);
+  }
+#else
+  for (i = 0; i < s32NumOfOutputs; i += 4) {
+    int32x4_t s32Acc = vmull_s16(vld1_s16(ps16X + i), vld1_s16(ps16Coeffs + i));
+    for (j = 1; j < 5; j++) {
+      s32Acc = vmlal_s16(s32Acc, vld1_s16(ps16X + j * s32NumOfOutputs + i),
+                         vld1_s16(ps16Coeffs + j * s32NumOfOutputs + i));
+    }
+    vst1q_s32(ps32Y + i, s32Acc);
+  }
+#endif
+}
+
+#undef WINDOW_PARTIAL_4
+#undef WINDOW_PARTIAL_8
+#define WINDOW_PARTIAL_4 \
+  SbcWindowSimd(s16X + ChOffset, &as16WindowFor4SBs[0][0], 8, s32DCTY);
+#define WINDOW_PARTIAL_8 \
+  SbcWindowSimd(s16X + ChOffset, &as16WindowFor8SBs[0][0], 16, s32DCTY);
+#endif /* SBC_SIMD_OPT */
+
 static int16_t ShiftCounter = 0;
 extern int16_t EncMaxShiftCounter;
 /****************************************************************************
@@ -1205,7 +1313,7 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 #if (SBC_IPAQ_OPT == TRUE)
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
   register int64_t s64Temp, s64Temp2;
-#else
+#elif (SBC_SIMD_OPT == FALSE)
   register int32_t s32Temp, s32Temp2;
 #endif
 #else
@@ -1296,7 +1404,7 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 #if (SBC_IPAQ_OPT == TRUE)
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
   register int64_t s64Temp, s64Temp2;
-#else
+#elif (SBC_SIMD_OPT == FALSE)
   register int32_t s32Temp, s32Temp2;
 #endif
 #else
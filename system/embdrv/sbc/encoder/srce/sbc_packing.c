@@ -57,8 +57,10 @@ uint32_t EncPacking(SBC_ENC_PARAMS* pstrEncParams, uint8_t* output) {
   int32_t s32PresentBit; /* represents bit to be stored*/
   /*int32_t s32LoopCountI;                       loop counter*/
   int32_t s32LoopCountJ; /* loop counter*/
-  uint32_t u32QuantizedSbValue,
-      u32QuantizedSbValue0; /* temp variable to store quantized sb val*/
+  uint32_t u32QuantizedSbValue0; /* temp variable to store quantized sb val*/
+  uint64_t u64Acc;    /* bits pending to be stored, in the lsbs*/
+  int32_t s32AccBits; /* number of bits pending in u64Acc*/
+  uint32_t u32Word;   /* 32 bits to be stored*/
   int32_t s32LoopCount;     /* loop counter*/
   uint8_t u8XoredVal;       /* to store XORed value in CRC calculation*/
   uint8_t u8CRC;            /* to store CRC value*/
@@ -132,7 +134,12 @@ uint32_t EncPacking(SBC_ENC_PARAMS* pstrEncParams, uint8_t* output) {
     }
   }
 
-  /* Pack samples */
+  /* Pack samples, in a 64 bits accumulator which takes over the bits of the
+  byte in progress. As done byte per byte before, the last bits are only
+  written out once more bits follow, so that at most 32 + 16 bits are
+  pending. */
+  u64Acc = Temp;
+  s32AccBits = 8 - s32PresentBit;
   ps32SbPtr = pstrEncParams->s32SbBuffer;
   /*Temp=*pu8PacketPtr;*/
   s32NumOfBlocks = pstrEncParams->s16NumOfBlocks;
@@ -169,42 +176,18 @@ uint32_t EncPacking(SBC_ENC_PARAMS* pstrEncParams, uint8_t* output) {
         s32Low >>= (*ps16ScfPtr + 1);
         u32QuantizedSbValue0 = (uint16_t)s32Low;
 #endif
-        /*store the number of bits required and the quantized s32Sb
-        sample to ease the coding*/
-        u32QuantizedSbValue = u32QuantizedSbValue0;
-
-        if (s32PresentBit >= s32LoopCount) {
-          Temp <<= s32LoopCount;
-          Temp |= u32QuantizedSbValue;
-          s32PresentBit -= s32LoopCount;
-        } else {
-          while (s32PresentBit < s32LoopCount) {
-            s32LoopCount -= s32PresentBit;
-            u32QuantizedSbValue >>= s32LoopCount;
-
-            /*remove the unwanted msbs*/
-            /*u32QuantizedSbValue <<= 16 - s32PresentBit;
-            u32QuantizedSbValue >>= 16 - s32PresentBit;*/
-
-            Temp <<= s32PresentBit;
-
-            Temp |= u32QuantizedSbValue;
-            /*restore the original*/
-            u32QuantizedSbValue = u32QuantizedSbValue0;
-
-            *(pu8PacketPtr++) = Temp;
-            Temp = 0;
-            s32PresentBit = 8;
-          }
-          Temp <<= s32LoopCount;
-
-          /* remove the unwanted msbs */
-          /*u32QuantizedSbValue <<= 16 - s32LoopCount;
-          u32QuantizedSbValue >>= 16 - s32LoopCount;*/
-
-          Temp |= u32QuantizedSbValue;
-
-          s32PresentBit -= s32LoopCount;
+        /* append the quantized sample, and write out the oldest 32 bits
+        once more are pending */
+        u64Acc = (u64Acc << s32LoopCount) | u32QuantizedSbValue0;
+        s32AccBits += s32LoopCount;
+        if (s32AccBits > 32) {
+          s32AccBits -= 32;
+          u32Word = (uint32_t)(u64Acc >> s32AccBits);
+          pu8PacketPtr[0] = (uint8_t)(u32Word >> 24);
+          pu8PacketPtr[1] = (uint8_t)(u32Word >> 16);
+          pu8PacketPtr[2] = (uint8_t)(u32Word >> 8);
+          pu8PacketPtr[3] = (uint8_t)u32Word;
+          pu8PacketPtr += 4;
         }
       }
       ps16ScfPtr++;
@@ -212,6 +195,14 @@ uint32_t EncPacking(SBC_ENC_PARAMS* pstrEncParams, uint8_t* output) {
     }
   }
 
+  /* write out the bytes left, but the last one which goes back to Temp */
+  while (s32AccBits > 8) {
+    s32AccBits -= 8;
+    *(pu8PacketPtr++) = (uint8_t)(u64Acc >> s32AccBits);
+  }
+  Temp = (uint8_t)(u64Acc & ((1u << s32AccBits) - 1));
+  s32PresentBit = 8 - s32AccBits;
+
   Temp <<= s32PresentBit;
   *pu8PacketPtr = Temp;
   uint32_t u16PacketLength = pu8PacketPtr - output + 1;
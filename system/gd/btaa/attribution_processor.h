@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <unordered_map>
 
+#include "common/circular_buffer.h"
 #include "hci_processor.h"
 
 namespace bluetooth {
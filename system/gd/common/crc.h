@@ -0,0 +1,235 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLUETOOTH_CRC_CLMUL_X86
+#elif defined(__aarch64__) && defined(__linux__) && defined(__clang__)
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define BLUETOOTH_CRC_PMULL_ARM
+#endif
+
+namespace bluetooth {
+namespace common {
+
+// Bit reflected CRC of |kWidth| <= 16 bits, with polynomial |kPoly| given in normal form without the x^kWidth term.
+// No final XOR is applied, callers add their own. Update() gives the same result as the byte-wise table lookup:
+//  - eight bytes at a time with slicing tables,
+//  - sixteen bytes at a time with carry-less multiplication (PCLMULQDQ, PMULL) for long inputs on CPUs that have it.
+template <typename T, int kWidth, uint32_t kPoly>
+class ReflectedCrc {
+ public:
+  static_assert(kWidth <= 16 && sizeof(T) * 8 >= kWidth, "Unsupported CRC width");
+
+  static T Update(T crc, const uint8_t* data, size_t length) {
+#if defined(BLUETOOTH_CRC_CLMUL_X86) || defined(BLUETOOTH_CRC_PMULL_ARM)
+    if (length >= kFoldMinLength && SupportsCarrylessMultiply()) {
+      return UpdateFolded(crc, data, length);
+    }
+#endif
+    return UpdateSliced(crc, data, length);
+  }
+
+  // One byte at a time, as in the specifications. Reference for the tests and benchmarks.
+  static T UpdateBytewise(T crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      crc = (crc >> 8) ^ kTables[0][(crc ^ data[i]) & 0xff];
+    }
+    return crc;
+  }
+
+  static T UpdateSliced(T crc, const uint8_t* data, size_t length) {
+    const auto& t = kTables;
+    while (length >= 8) {
+      crc = t[7][(data[0] ^ crc) & 0xff] ^ t[6][(data[1] ^ (crc >> 8)) & 0xff] ^ t[5][data[2]] ^ t[4][data[3]] ^
+            t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+      data += 8;
+      length -= 8;
+    }
+    return UpdateBytewise(crc, data, length);
+  }
+
+ private:
+  using Tables = std::array<std::array<T, 256>, 8>;
+
+  static constexpr T kReflectedPoly = [] {
+    T reflected = 0;
+    for (int i = 0; i < kWidth; i++) {
+      if (kPoly & (1u << i)) {
+        reflected |= 1u << (kWidth - 1 - i);
+      }
+    }
+    return reflected;
+  }();
+
+  // kTables[0] is the byte-wise table, kTables[k] advances a byte through k more bytes of zeroes
+  static constexpr Tables kTables = [] {
+    Tables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) ? (crc >> 1) ^ kReflectedPoly : crc >> 1;
+      }
+      tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < tables.size(); k++) {
+      for (uint32_t i = 0; i < 256; i++) {
+        T previous = tables[k - 1][i];
+        tables[k][i] = (previous >> 8) ^ tables[0][previous & 0xff];
+      }
+    }
+    return tables;
+  }();
+
+  // Folding keeps a 128 bit remainder congruent to the data seen so far. In the reflected bit order its low 64 bits
+  // hold the high degree half, so folding it across |bits| more bits multiplies the low half by x^(bits + 64) and the
+  // high half by x^bits, modulo the polynomial. Carry-less multiplication of reflected operands adds a factor of x,
+  // which the constants take out.
+  static constexpr uint64_t FoldConstant(uint32_t exponent) {
+    uint64_t remainder = 1;
+    for (uint32_t i = 0; i < exponent - 1; i++) {
+      remainder <<= 1;
+      if (remainder & (1u << kWidth)) {
+        remainder ^= (1u << kWidth) | kPoly;
+      }
+    }
+    uint64_t reflected = 0;
+    for (int i = 0; i < 64; i++) {
+      if (remainder & (uint64_t{1} << i)) {
+        reflected |= uint64_t{1} << (63 - i);
+      }
+    }
+    return reflected;
+  }
+
+  static constexpr uint64_t kFold128Low = FoldConstant(128 + 64);
+  static constexpr uint64_t kFold128High = FoldConstant(128);
+  static constexpr uint64_t kFold512Low = FoldConstant(512 + 64);
+  static constexpr uint64_t kFold512High = FoldConstant(512);
+
+  // Below this, setting up the four folding lanes costs more than the slicing tables
+  static constexpr size_t kFoldMinLength = 64;
+
+#if defined(BLUETOOTH_CRC_CLMUL_X86)
+  static bool SupportsCarrylessMultiply() {
+    static const bool supported = __builtin_cpu_supports("pclmul");
+    return supported;
+  }
+
+  __attribute__((target("sse2,pclmul"))) static __m128i Fold(__m128i x, __m128i constants) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, constants, 0x00), _mm_clmulepi64_si128(x, constants, 0x11));
+  }
+
+  __attribute__((target("sse2,pclmul"))) static __m128i Load(const uint8_t* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  }
+
+  __attribute__((target("sse2,pclmul"))) static T UpdateFolded(T crc, const uint8_t* data, size_t length) {
+    const __m128i fold_128 = _mm_set_epi64x(kFold128High, kFold128Low);
+    const __m128i fold_512 = _mm_set_epi64x(kFold512High, kFold512Low);
+
+    // The initial value only affects the first bytes, as if it was XORed into the data
+    __m128i x0 = _mm_xor_si128(Load(data), _mm_set_epi64x(0, crc));
+    __m128i x1 = Load(data + 16);
+    __m128i x2 = Load(data + 32);
+    __m128i x3 = Load(data + 48);
+    data += 64;
+    length -= 64;
+    while (length >= 64) {
+      x0 = _mm_xor_si128(Fold(x0, fold_512), Load(data));
+      x1 = _mm_xor_si128(Fold(x1, fold_512), Load(data + 16));
+      x2 = _mm_xor_si128(Fold(x2, fold_512), Load(data + 32));
+      x3 = _mm_xor_si128(Fold(x3, fold_512), Load(data + 48));
+      data += 64;
+      length -= 64;
+    }
+    __m128i x = _mm_xor_si128(Fold(x0, fold_128), x1);
+    x = _mm_xor_si128(Fold(x, fold_128), x2);
+    x = _mm_xor_si128(Fold(x, fold_128), x3);
+    while (length >= 16) {
+      x = _mm_xor_si128(Fold(x, fold_128), Load(data));
+      data += 16;
+      length -= 16;
+    }
+
+    uint8_t remainder[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(remainder), x);
+    return UpdateSliced(UpdateSliced(0, remainder, sizeof(remainder)), data, length);
+  }
+#elif defined(BLUETOOTH_CRC_PMULL_ARM)
+  static bool SupportsCarrylessMultiply() {
+    static const bool supported = (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+    return supported;
+  }
+
+  __attribute__((target("aes"))) static uint64x2_t Fold(uint64x2_t x, uint64_t low, uint64_t high) {
+    poly128_t low_product = vmull_p64(vgetq_lane_u64(x, 0), low);
+    poly128_t high_product = vmull_p64(vgetq_lane_u64(x, 1), high);
+    return veorq_u64(vreinterpretq_u64_p128(low_product), vreinterpretq_u64_p128(high_product));
+  }
+
+  static uint64x2_t Load(const uint8_t* data) {
+    return vreinterpretq_u64_u8(vld1q_u8(data));
+  }
+
+  __attribute__((target("aes"))) static T UpdateFolded(T crc, const uint8_t* data, size_t length) {
+    // The initial value only affects the first bytes, as if it was XORed into the data
+    uint64x2_t x0 = veorq_u64(Load(data), vcombine_u64(vcreate_u64(crc), vcreate_u64(0)));
+    uint64x2_t x1 = Load(data + 16);
+    uint64x2_t x2 = Load(data + 32);
+    uint64x2_t x3 = Load(data + 48);
+    data += 64;
+    length -= 64;
+    while (length >= 64) {
+      x0 = veorq_u64(Fold(x0, kFold512Low, kFold512High), Load(data));
+      x1 = veorq_u64(Fold(x1, kFold512Low, kFold512High), Load(data + 16));
+      x2 = veorq_u64(Fold(x2, kFold512Low, kFold512High), Load(data + 32));
+      x3 = veorq_u64(Fold(x3, kFold512Low, kFold512High), Load(data + 48));
+      data += 64;
+      length -= 64;
+    }
+    uint64x2_t x = veorq_u64(Fold(x0, kFold128Low, kFold128High), x1);
+    x = veorq_u64(Fold(x, kFold128Low, kFold128High), x2);
+    x = veorq_u64(Fold(x, kFold128Low, kFold128High), x3);
+    while (length >= 16) {
+      x = veorq_u64(Fold(x, kFold128Low, kFold128High), Load(data));
+      data += 16;
+      length -= 16;
+    }
+
+    uint8_t remainder[16];
+    vst1q_u8(remainder, vreinterpretq_u8_u64(x));
+    return UpdateSliced(UpdateSliced(0, remainder, sizeof(remainder)), data, length);
+  }
+#endif
+};
+
+// L2CAP Frame Check Sequence: x^16 + x^15 + x^2 + 1, initial value 0
+using Crc16 = ReflectedCrc<uint16_t, 16, 0x8005>;
+
+// RFCOMM Frame Check Sequence (TS 07.10): x^8 + x^2 + x + 1, initial value 0xff, complemented
+using Crc8 = ReflectedCrc<uint8_t, 8, 0x07>;
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/crc.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::Crc16;
+using ::bluetooth::common::Crc8;
+
+namespace {
+
+template <typename T, T (*Update)(T, const uint8_t*, size_t)>
+void BM_Crc(State& state) {
+  std::vector<uint8_t> frame(state.range(0), 0x5a);
+  T crc = 0;
+  for (auto _ : state) {
+    crc = Update(crc, frame.data(), frame.size());
+    ::benchmark::DoNotOptimize(crc);
+  }
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+
+// L2CAP FCS
+BENCHMARK_TEMPLATE(BM_Crc, uint16_t, Crc16::UpdateBytewise)->RangeMultiplier(8)->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_Crc, uint16_t, Crc16::UpdateSliced)->RangeMultiplier(8)->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_Crc, uint16_t, Crc16::Update)->RangeMultiplier(8)->Range(64, 64 * 1024);
+
+// RFCOMM FCS
+BENCHMARK_TEMPLATE(BM_Crc, uint8_t, Crc8::UpdateBytewise)->RangeMultiplier(8)->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_Crc, uint8_t, Crc8::UpdateSliced)->RangeMultiplier(8)->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_Crc, uint8_t, Crc8::Update)->RangeMultiplier(8)->Range(64, 64 * 1024);
+
+}  // namespace
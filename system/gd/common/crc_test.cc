@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/crc.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace testing {
+
+using bluetooth::common::Crc16;
+using bluetooth::common::Crc8;
+
+const uint8_t kCheckInput[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+std::vector<uint8_t> RandomBytes(size_t size) {
+  std::mt19937 generator(size);
+  std::vector<uint8_t> bytes(size);
+  for (auto& byte : bytes) {
+    byte = generator();
+  }
+  return bytes;
+}
+
+TEST(CrcTest, crc16_check_value) {
+  // CRC-16/ARC, as used by the L2CAP FCS
+  ASSERT_EQ(Crc16::UpdateBytewise(0, kCheckInput, sizeof(kCheckInput)), 0xbb3d);
+  ASSERT_EQ(Crc16::Update(0, kCheckInput, sizeof(kCheckInput)), 0xbb3d);
+}
+
+TEST(CrcTest, crc16_table_entries) {
+  uint8_t byte = 0x01;
+  ASSERT_EQ(Crc16::UpdateBytewise(0, &byte, 1), 0xc0c1);
+  byte = 0xff;
+  ASSERT_EQ(Crc16::UpdateBytewise(0, &byte, 1), 0x4040);
+}
+
+TEST(CrcTest, crc8_check_value) {
+  // CRC-8/ROHC, the RFCOMM FCS before its final complement
+  ASSERT_EQ(Crc8::UpdateBytewise(0xff, kCheckInput, sizeof(kCheckInput)), 0xd0);
+  ASSERT_EQ(Crc8::Update(0xff, kCheckInput, sizeof(kCheckInput)), 0xd0);
+}
+
+TEST(CrcTest, crc8_table_entries) {
+  uint8_t byte = 0x01;
+  ASSERT_EQ(Crc8::UpdateBytewise(0, &byte, 1), 0x91);
+  byte = 0xff;
+  ASSERT_EQ(Crc8::UpdateBytewise(0, &byte, 1), 0xcf);
+}
+
+TEST(CrcTest, crc16_matches_bytewise) {
+  for (size_t size : {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 80, 127, 128, 129, 1000, 1021, 4096, 65535}) {
+    auto bytes = RandomBytes(size + 1);
+    // Unaligned data as well
+    for (size_t offset : {0, 1}) {
+      for (uint16_t crc : {0x0000, 0x1234, 0xffff}) {
+        uint16_t expected = Crc16::UpdateBytewise(crc, bytes.data() + offset, size);
+        ASSERT_EQ(Crc16::UpdateSliced(crc, bytes.data() + offset, size), expected) << size;
+        ASSERT_EQ(Crc16::Update(crc, bytes.data() + offset, size), expected) << size;
+      }
+    }
+  }
+}
+
+TEST(CrcTest, crc8_matches_bytewise) {
+  for (size_t size : {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 80, 127, 128, 129, 1000, 1021, 4096, 65535}) {
+    auto bytes = RandomBytes(size + 1);
+    for (size_t offset : {0, 1}) {
+      for (uint8_t crc : {0x00, 0x5a, 0xff}) {
+        uint8_t expected = Crc8::UpdateBytewise(crc, bytes.data() + offset, size);
+        ASSERT_EQ(Crc8::UpdateSliced(crc, bytes.data() + offset, size), expected) << size;
+        ASSERT_EQ(Crc8::Update(crc, bytes.data() + offset, size), expected) << size;
+      }
+    }
+  }
+}
+
+TEST(CrcTest, update_in_pieces) {
+  auto bytes = RandomBytes(1000);
+  uint16_t crc = Crc16::Update(0, bytes.data(), 300);
+  crc = Crc16::Update(crc, bytes.data() + 300, 700);
+  ASSERT_EQ(crc, Crc16::UpdateBytewise(0, bytes.data(), bytes.size()));
+}
+
+}  // namespace testing
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace common {
+
+// A map that maintains insertion order of its elements, like ListMap, but stores them contiguously. Elements live in
+// a vector in insertion order and are indexed by an open addressing (linear probing) hash table of positions.
+//
+// Performance:
+//   - Key look-up, insertion and modification is O(1), without per-element allocation
+//   - Removal is O(n) as later elements are shifted down and the index is rebuilt
+//   - Iteration is over contiguous memory
+//   - NOT THREAD SAFE
+//
+// Unlike ListMap, any insertion or removal invalidates iterators.
+//
+// Template:
+//   - Key key
+//   - T value
+//   - Hash hash function for Key
+template <typename Key, typename T, typename Hash = std::hash<Key>>
+class FlatListMap {
+ public:
+  using value_type = std::pair<Key, T>;
+  using node_type = std::pair<Key, T>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  FlatListMap() = default;
+
+  // Elements are referred to by position, so the index can be copied as is
+  FlatListMap(const FlatListMap& other) = default;
+  FlatListMap& operator=(const FlatListMap& other) = default;
+  FlatListMap(FlatListMap&& other) noexcept = default;
+  FlatListMap& operator=(FlatListMap&& other) noexcept = default;
+
+  // comparison operators
+  bool operator==(const FlatListMap& rhs) const {
+    return entries_ == rhs.entries_;
+  }
+  bool operator!=(const FlatListMap& rhs) const {
+    return !(*this == rhs);
+  }
+
+  // Clear the map
+  void clear() {
+    entries_.clear();
+    slots_.clear();
+  }
+
+  // Make room for |capacity| elements without further reallocation
+  void reserve(size_t capacity) {
+    entries_.reserve(capacity);
+    if (capacity * 2 > slots_.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  // const version of find()
+  const_iterator find(const Key& key) const {
+    return const_cast<FlatListMap*>(this)->find(key);
+  }
+
+  // Get the value of a key. Return iterator to the item if found, end() if not found
+  iterator find(const Key& key) {
+    if (entries_.empty()) {
+      return end();
+    }
+    uint32_t position = slots_[FindSlot(key)];
+    return position == kEmptySlot ? end() : begin() + position;
+  }
+
+  // Check if key exist in the map. Return true if key exist in map, false if not.
+  bool contains(const Key& key) const {
+    return find(key) != end();
+  }
+
+  // Try emplace an element at the end of the map. If the key already exists, does nothing. Return <iterator, true>
+  // when key does not exist, <iterator, false> when key exists and iterator is the position of the existing element.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace_back(const Key& key, Args&&... args) {
+    GrowIfNeeded();
+    size_t slot = FindSlot(key);
+    if (slots_[slot] != kEmptySlot) {
+      return std::make_pair(begin() + slots_[slot], false);
+    }
+    ASSERT(entries_.size() < kEmptySlot);
+    slots_[slot] = static_cast<uint32_t>(entries_.size());
+    entries_.emplace_back(
+        std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+    return std::make_pair(std::prev(end()), true);
+  }
+
+  // Put a key-value pair to the end of the map or replace the current value without moving the key if key exists
+  void insert_or_assign(const Key& key, T value) {
+    auto result = try_emplace_back(key);
+    result.first->second = std::move(value);
+  }
+
+  // Remove a key from the map and return removed value if key exits, std::nullopt if not
+  std::optional<node_type> extract(const Key& key) {
+    auto iter = find(key);
+    if (iter == end()) {
+      return std::nullopt;
+    }
+    std::optional<node_type> removed_node(std::move(*iter));
+    erase(iter);
+    return removed_node;
+  }
+
+  // Remove an iterator pointed item from the map and return the iterator immediately after the erased item
+  iterator erase(const_iterator iter) {
+    auto next = entries_.erase(iter);
+    Rehash(slots_.size() / 2);
+    return next;
+  }
+
+  // Return size of the map
+  inline size_t size() const {
+    return entries_.size();
+  }
+
+  // Return iterator interface for begin
+  inline iterator begin() {
+    return entries_.begin();
+  }
+
+  // Iterator interface for begin, const
+  inline const_iterator begin() const {
+    return entries_.begin();
+  }
+
+  // Iterator interface for end
+  inline iterator end() {
+    return entries_.end();
+  }
+
+  // Iterator interface for end, const
+  inline const_iterator end() const {
+    return entries_.end();
+  }
+
+ private:
+  static constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kMinSlots = 8;
+
+  // Return the slot holding |key|, or the empty slot where it would be inserted. The index must not be empty.
+  size_t FindSlot(const Key& key) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = Hash{}(key) & mask;; slot = (slot + 1) & mask) {
+      uint32_t position = slots_[slot];
+      if (position == kEmptySlot || entries_[position].first == key) {
+        return slot;
+      }
+    }
+  }
+
+  // Keep the load factor at most 1/2 so that probe sequences stay short
+  void GrowIfNeeded() {
+    if ((entries_.size() + 1) * 2 > slots_.size()) {
+      Rehash(std::max(entries_.size() + 1, slots_.size()));
+    }
+  }
+
+  // Rebuild the index with room for at least |capacity| elements
+  void Rehash(size_t capacity) {
+    size_t num_slots = kMinSlots;
+    while (num_slots < capacity * 2) {
+      num_slots *= 2;
+    }
+    slots_.assign(num_slots, kEmptySlot);
+    for (size_t position = 0; position < entries_.size(); position++) {
+      slots_[FindSlot(entries_[position].first)] = static_cast<uint32_t>(position);
+    }
+  }
+
+  std::vector<value_type> entries_;
+  std::vector<uint32_t> slots_;
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/flat_list_map.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+namespace testing {
+
+using bluetooth::common::FlatListMap;
+
+TEST(FlatListMapTest, empty_test) {
+  FlatListMap<int, int> map;
+  EXPECT_EQ(map.size(), 0ul);
+  EXPECT_EQ(map.find(42), map.end());
+  map.clear();  // should not crash
+  EXPECT_EQ(map.find(42), map.end());
+  EXPECT_FALSE(map.contains(42));
+  EXPECT_FALSE(map.extract(42));
+}
+
+TEST(FlatListMapTest, comparison_test) {
+  FlatListMap<int, int> map_1;
+  map_1.insert_or_assign(1, 10);
+  map_1.insert_or_assign(2, 20);
+  FlatListMap<int, int> map_2;
+  map_2.insert_or_assign(1, 10);
+  map_2.insert_or_assign(2, 20);
+  EXPECT_EQ(map_1, map_2);
+  // Map with different value should be different
+  map_2.insert_or_assign(1, 11);
+  EXPECT_NE(map_1, map_2);
+  // Maps with different order should not be equal
+  FlatListMap<int, int> map_3;
+  map_3.insert_or_assign(2, 20);
+  map_3.insert_or_assign(1, 10);
+  EXPECT_NE(map_1, map_3);
+  // Empty map should not be equal to non-empty ones
+  FlatListMap<int, int> map_4;
+  EXPECT_NE(map_1, map_4);
+}
+
+TEST(FlatListMapTest, copy_test) {
+  FlatListMap<int, std::shared_ptr<int>> map;
+  map.insert_or_assign(1, std::make_shared<int>(100));
+  FlatListMap<int, std::shared_ptr<int>> new_map = map;
+  auto iter = new_map.find(1);
+  ASSERT_NE(iter, new_map.end());
+  EXPECT_EQ(*iter->second, 100);
+  // Since copy is used, shared_ptr should increase count
+  EXPECT_EQ(iter->second.use_count(), 2);
+}
+
+TEST(FlatListMapTest, move_insert_unique_ptr_test) {
+  FlatListMap<int, std::unique_ptr<int>> map;
+  map.insert_or_assign(1, std::make_unique<int>(100));
+  EXPECT_EQ(*map.find(1)->second, 100);
+  map.insert_or_assign(1, std::make_unique<int>(400));
+  EXPECT_EQ(*map.find(1)->second, 400);
+  EXPECT_EQ(map.size(), 1ul);
+}
+
+TEST(FlatListMapTest, try_emplace_back_test) {
+  FlatListMap<std::string, int> map;
+  auto result = map.try_emplace_back("a", 1);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first->second, 1);
+  result = map.try_emplace_back("a", 2);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(result.first->second, 1);
+  map.try_emplace_back("b", 3);
+  EXPECT_THAT(map, ElementsAre(Pair("a", 1), Pair("b", 3)));
+}
+
+TEST(FlatListMapTest, erase_in_for_loop_test) {
+  FlatListMap<int, int> map;
+  map.insert_or_assign(1, 10);
+  map.insert_or_assign(2, 20);
+  map.insert_or_assign(3, 30);
+  for (auto iter = map.begin(); iter != map.end();) {
+    if (iter->first == 2) {
+      iter = map.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  EXPECT_THAT(map, ElementsAre(Pair(1, 10), Pair(3, 30)));
+  EXPECT_EQ(map.find(2), map.end());
+  EXPECT_EQ(map.find(3)->second, 30);
+}
+
+TEST(FlatListMapTest, extract_test) {
+  FlatListMap<int, int> map;
+  map.insert_or_assign(1, 10);
+  map.insert_or_assign(2, 20);
+  auto node = map.extract(1);
+  ASSERT_TRUE(node);
+  EXPECT_EQ(node->first, 1);
+  EXPECT_EQ(node->second, 10);
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_THAT(map, ElementsAre(Pair(2, 20)));
+}
+
+TEST(FlatListMapTest, many_items_keep_insertion_order_test) {
+  struct CollidingHash {
+    size_t operator()(int key) const {
+      return key % 3;
+    }
+  };
+  FlatListMap<int, int, CollidingHash> map;
+  for (int i = 200; i > 0; i--) {
+    map.insert_or_assign(i, i * 10);
+  }
+  for (int i = 1; i <= 200; i += 2) {
+    EXPECT_TRUE(map.extract(i));
+  }
+  EXPECT_EQ(map.size(), 100ul);
+  int expected = 200;
+  for (const auto& item : map) {
+    EXPECT_EQ(item.first, expected);
+    EXPECT_EQ(item.second, expected * 10);
+    EXPECT_EQ(map.find(expected), map.begin() + (200 - expected) / 2);
+    expected -= 2;
+  }
+  EXPECT_FALSE(map.contains(199));
+}
+
+}  // namespace testing
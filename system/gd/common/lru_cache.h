@@ -190,6 +190,11 @@ class LruCache {
     return list_map_.size();
   }
 
+  // Return capacity of the cache
+  inline size_t capacity() const {
+    return capacity_;
+  }
+
   // Iterator interface for begin
   inline iterator begin() {
     return list_map_.begin();
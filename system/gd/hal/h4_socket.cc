@@ -0,0 +1,190 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/h4_socket.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "os/utils.h"
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+constexpr uint8_t kH4Acl = 0x02;
+constexpr uint8_t kH4Sco = 0x03;
+constexpr uint8_t kH4Event = 0x04;
+constexpr uint8_t kH4Iso = 0x05;
+
+constexpr size_t kH4HeaderSize = 1;
+constexpr size_t kHciAclHeaderSize = 4;
+constexpr size_t kHciScoHeaderSize = 3;
+constexpr size_t kHciEvtHeaderSize = 2;
+constexpr size_t kHciIsoHeaderSize = 4;
+
+// Large enough for any H4 packet, whose longest are ACL packets with 16 bit lengths
+constexpr size_t kStreamBufferSize = 1 << 17;
+
+// Returns the size of the H4 packet at |data|, 0 if its headers are not complete yet, or -1 for an unknown type
+ssize_t GetH4PacketSize(const uint8_t* data, size_t size) {
+  if (size < kH4HeaderSize) {
+    return 0;
+  }
+  const uint8_t* hci = data + kH4HeaderSize;
+  size_t hci_size = size - kH4HeaderSize;
+  switch (data[0]) {
+    case kH4Event:
+      if (hci_size < kHciEvtHeaderSize) return 0;
+      return kH4HeaderSize + kHciEvtHeaderSize + hci[1];
+    case kH4Acl:
+      if (hci_size < kHciAclHeaderSize) return 0;
+      return kH4HeaderSize + kHciAclHeaderSize + (hci[2] | (hci[3] << 8));
+    case kH4Sco:
+      if (hci_size < kHciScoHeaderSize) return 0;
+      return kH4HeaderSize + kHciScoHeaderSize + hci[2];
+    case kH4Iso:
+      if (hci_size < kHciIsoHeaderSize) return 0;
+      return kH4HeaderSize + kHciIsoHeaderSize + (hci[2] | ((hci[3] & 0x3f) << 8));
+    default:
+      return -1;
+  }
+}
+
+}  // namespace
+
+bool H4Writer::Write(int fd) {
+  size_t count = std::min(queue_.size(), kH4MaxBatch);
+  if (count == 0) {
+    return true;
+  }
+  struct iovec iov[kH4MaxBatch];
+  for (size_t i = 0; i < count; i++) {
+    iov[i].iov_base = queue_[i].data();
+    iov[i].iov_len = queue_[i].size();
+  }
+
+  if (datagram_) {
+    struct mmsghdr messages[kH4MaxBatch] = {};
+    for (size_t i = 0; i < count; i++) {
+      messages[i].msg_hdr.msg_iov = &iov[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int sent;
+    RUN_NO_INTR(sent = sendmmsg(fd, messages, count, 0));
+    if (sent == -1) {
+      return false;
+    }
+    queue_.erase(queue_.begin(), queue_.begin() + sent);
+    return true;
+  }
+
+  iov[0].iov_base = static_cast<uint8_t*>(iov[0].iov_base) + written_;
+  iov[0].iov_len -= written_;
+  ssize_t written;
+  RUN_NO_INTR(written = writev(fd, iov, count));
+  if (written == -1) {
+    return false;
+  }
+  size_t remaining = written + written_;
+  while (!queue_.empty() && remaining >= queue_.front().size()) {
+    remaining -= queue_.front().size();
+    queue_.pop_front();
+  }
+  written_ = remaining;
+  return true;
+}
+
+H4Reader::H4Reader(bool datagram, size_t max_packet_size, HciPacketPool* pool)
+    : datagram_(datagram), max_packet_size_(max_packet_size), pool_(pool) {
+  if (!datagram_) {
+    buffer_.resize(kStreamBufferSize);
+  }
+}
+
+ssize_t H4Reader::Read(int fd, const PacketCallback& on_packet) {
+  return datagram_ ? ReadDatagrams(fd, on_packet) : ReadStream(fd, on_packet);
+}
+
+ssize_t H4Reader::ReadDatagrams(int fd, const PacketCallback& on_packet) {
+  // Each message is received into a pooled buffer, behind its H4 packet type
+  uint8_t h4_types[kH4MaxBatch];
+  std::shared_ptr<std::vector<uint8_t>> packets[kH4MaxBatch];
+  struct iovec iov[kH4MaxBatch][2];
+  struct mmsghdr messages[kH4MaxBatch] = {};
+  for (size_t i = 0; i < kH4MaxBatch; i++) {
+    packets[i] = pool_->Get();
+    packets[i]->resize(max_packet_size_);
+    iov[i][0] = {&h4_types[i], kH4HeaderSize};
+    iov[i][1] = {packets[i]->data(), packets[i]->size()};
+    messages[i].msg_hdr.msg_iov = iov[i];
+    messages[i].msg_hdr.msg_iovlen = 2;
+  }
+
+  int received;
+  RUN_NO_INTR(received = recvmmsg(fd, messages, kH4MaxBatch, MSG_DONTWAIT, nullptr));
+  if (received == -1) {
+    return -1;
+  }
+  ssize_t bytes = 0;
+  for (int i = 0; i < received; i++) {
+    size_t size = messages[i].msg_len;
+    if (size == 0) {
+      // End of the stream
+      break;
+    }
+    bytes += size;
+    packets[i]->resize(size - kH4HeaderSize);
+    on_packet(h4_types[i], std::move(packets[i]));
+  }
+  return bytes;
+}
+
+ssize_t H4Reader::ReadStream(int fd, const PacketCallback& on_packet) {
+  ssize_t received;
+  RUN_NO_INTR(received = recv(fd, buffer_.data() + buffered_, buffer_.size() - buffered_, MSG_DONTWAIT));
+  if (received <= 0) {
+    return received;
+  }
+  buffered_ += received;
+
+  size_t offset = 0;
+  while (true) {
+    ssize_t packet_size = GetH4PacketSize(buffer_.data() + offset, buffered_ - offset);
+    if (packet_size == -1) {
+      errno = EPROTO;
+      return -1;
+    }
+    if (packet_size == 0 || static_cast<size_t>(packet_size) > buffered_ - offset) {
+      break;
+    }
+    auto packet = pool_->Get();
+    packet->assign(buffer_.begin() + offset + kH4HeaderSize, buffer_.begin() + offset + packet_size);
+    on_packet(buffer_[offset], std::move(packet));
+    offset += packet_size;
+  }
+  // Keep the start of the next packet
+  std::memmove(buffer_.data(), buffer_.data() + offset, buffered_ - offset);
+  buffered_ -= offset;
+  return received;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
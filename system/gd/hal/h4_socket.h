@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "hal/hci_hal.h"
+#include "hal/hci_packet_pool.h"
+
+namespace bluetooth {
+namespace hal {
+
+// Batched I/O of H4 packets on the socket of a host HAL. On a datagram socket (the HCI user channel) each message is
+// one packet, and several messages are moved per system call with sendmmsg() and recvmmsg(). On a stream socket
+// (rootcanal) queued packets are gathered with writev(), and the received bytes are split into packets.
+
+// Maximum number of packets moved by a single system call
+constexpr size_t kH4MaxBatch = 16;
+
+class H4Writer {
+ public:
+  explicit H4Writer(bool datagram) : datagram_(datagram) {}
+
+  // Queues a packet, which starts with its H4 packet type.
+  void Enqueue(HciPacket packet) {
+    queue_.push_back(std::move(packet));
+  }
+
+  bool IsEmpty() const {
+    return queue_.empty();
+  }
+
+  size_t Size() const {
+    return queue_.size();
+  }
+
+  // Writes up to kH4MaxBatch queued packets with one system call. Returns false, with errno set, if the socket failed.
+  bool Write(int fd);
+
+ private:
+  bool datagram_;
+  std::deque<HciPacket> queue_;
+  // Bytes of the first packet already written to a stream socket
+  size_t written_ = 0;
+};
+
+class H4Reader {
+ public:
+  // Called with the H4 packet type and the HCI packet
+  using PacketCallback = std::function<void(uint8_t, std::shared_ptr<std::vector<uint8_t>>)>;
+
+  // |max_packet_size| bounds the HCI packets received on a datagram socket.
+  H4Reader(bool datagram, size_t max_packet_size, HciPacketPool* pool);
+
+  // Reads what the socket has available, without blocking for more, and calls |on_packet| for each complete packet.
+  // Returns the number of bytes read, 0 at the end of the stream, or -1 with errno set.
+  ssize_t Read(int fd, const PacketCallback& on_packet);
+
+ private:
+  ssize_t ReadDatagrams(int fd, const PacketCallback& on_packet);
+  ssize_t ReadStream(int fd, const PacketCallback& on_packet);
+
+  bool datagram_;
+  size_t max_packet_size_;
+  HciPacketPool* pool_;
+  // Received bytes of a stream socket which do not form a complete packet yet
+  std::vector<uint8_t> buffer_;
+  size_t buffered_ = 0;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hal/h4_socket.h"
+#include "hal/hci_packet_pool.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+using ::bluetooth::hal::H4Reader;
+using ::bluetooth::hal::H4Writer;
+using ::bluetooth::hal::HciPacket;
+using ::bluetooth::hal::HciPacketPool;
+using ::bluetooth::hal::kH4MaxBatch;
+
+namespace {
+
+constexpr size_t kMaxPacketSize = 1024 + 4;
+constexpr size_t kH4AclHeaderSize = 1 + 4;
+
+HciPacket MakeH4Acl(size_t payload_size) {
+  HciPacket h4 = {
+      0x02, 0x40, 0x20, static_cast<uint8_t>(payload_size), static_cast<uint8_t>(payload_size >> 8)};
+  h4.resize(h4.size() + payload_size, 0x5a);
+  return h4;
+}
+
+struct SocketPair {
+  explicit SocketPair(int type) {
+    socketpair(AF_UNIX, type, 0, fds);
+  }
+  ~SocketPair() {
+    close(fds[0]);
+    close(fds[1]);
+  }
+  int fds[2];
+};
+
+void ReportCounters(State& state, size_t payload_size, size_t syscalls) {
+  size_t packets = state.iterations() * kH4MaxBatch;
+  state.SetBytesProcessed(packets * payload_size);
+  state.counters["packets_per_sec"] = Counter(packets, Counter::kIsRate);
+  state.counters["syscalls_per_packet"] = Counter(static_cast<double>(syscalls) / packets);
+}
+
+// Previous HCI user channel path: one write() per outgoing packet and one readv() per incoming packet
+void BM_H4DatagramPerPacket(State& state) {
+  SocketPair sockets(SOCK_SEQPACKET);
+  HciPacket h4 = MakeH4Acl(state.range(0));
+  HciPacketPool pool(64, kMaxPacketSize);
+  size_t syscalls = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < kH4MaxBatch; i++) {
+      write(sockets.fds[0], h4.data(), h4.size());
+    }
+    for (size_t i = 0; i < kH4MaxBatch; i++) {
+      uint8_t h4_type;
+      auto packet = pool.Get();
+      packet->resize(kMaxPacketSize);
+      struct iovec iov[2] = {{&h4_type, 1}, {packet->data(), packet->size()}};
+      ssize_t size = readv(sockets.fds[1], iov, 2);
+      packet->resize(size - 1);
+      ::benchmark::DoNotOptimize(packet);
+    }
+    syscalls += 2 * kH4MaxBatch;
+  }
+  ReportCounters(state, state.range(0), syscalls);
+}
+
+void BM_H4DatagramBatched(State& state) {
+  SocketPair sockets(SOCK_SEQPACKET);
+  HciPacket h4 = MakeH4Acl(state.range(0));
+  HciPacketPool pool(64, kMaxPacketSize);
+  H4Writer writer(true);
+  H4Reader reader(true, kMaxPacketSize, &pool);
+  size_t syscalls = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < kH4MaxBatch; i++) {
+      writer.Enqueue(h4);
+    }
+    while (!writer.IsEmpty()) {
+      writer.Write(sockets.fds[0]);
+      syscalls++;
+    }
+    size_t received = 0;
+    while (received < kH4MaxBatch) {
+      reader.Read(sockets.fds[1], [&received](uint8_t, std::shared_ptr<std::vector<uint8_t>> packet) {
+        ::benchmark::DoNotOptimize(packet);
+        received++;
+      });
+      syscalls++;
+    }
+  }
+  ReportCounters(state, state.range(0), syscalls);
+}
+
+// Previous rootcanal path: one write() per outgoing packet, and a recv() for the header and another for the payload
+// of each incoming packet
+void BM_H4StreamPerPacket(State& state) {
+  SocketPair sockets(SOCK_STREAM);
+  HciPacket h4 = MakeH4Acl(state.range(0));
+  HciPacketPool pool(64, kMaxPacketSize);
+  size_t syscalls = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < kH4MaxBatch; i++) {
+      write(sockets.fds[0], h4.data(), h4.size());
+    }
+    for (size_t i = 0; i < kH4MaxBatch; i++) {
+      uint8_t header[kH4AclHeaderSize];
+      recv(sockets.fds[1], header, sizeof(header), MSG_WAITALL);
+      size_t payload_size = header[3] | (header[4] << 8);
+      auto packet = pool.Get();
+      packet->resize(kH4AclHeaderSize - 1 + payload_size);
+      std::copy(header + 1, header + kH4AclHeaderSize, packet->begin());
+      recv(sockets.fds[1], packet->data() + kH4AclHeaderSize - 1, payload_size, MSG_WAITALL);
+      ::benchmark::DoNotOptimize(packet);
+    }
+    syscalls += 3 * kH4MaxBatch;
+  }
+  ReportCounters(state, state.range(0), syscalls);
+}
+
+void BM_H4StreamBatched(State& state) {
+  SocketPair sockets(SOCK_STREAM);
+  HciPacket h4 = MakeH4Acl(state.range(0));
+  HciPacketPool pool(64, kMaxPacketSize);
+  H4Writer writer(false);
+  H4Reader reader(false, kMaxPacketSize, &pool);
+  size_t syscalls = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < kH4MaxBatch; i++) {
+      writer.Enqueue(h4);
+    }
+    while (!writer.IsEmpty()) {
+      writer.Write(sockets.fds[0]);
+      syscalls++;
+    }
+    size_t received = 0;
+    while (received < kH4MaxBatch) {
+      reader.Read(sockets.fds[1], [&received](uint8_t, std::shared_ptr<std::vector<uint8_t>> packet) {
+        ::benchmark::DoNotOptimize(packet);
+        received++;
+      });
+      syscalls++;
+    }
+  }
+  ReportCounters(state, state.range(0), syscalls);
+}
+
+BENCHMARK(BM_H4DatagramPerPacket)->ArgName("payload")->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_H4DatagramBatched)->ArgName("payload")->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_H4StreamPerPacket)->ArgName("payload")->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_H4StreamBatched)->ArgName("payload")->Arg(27)->Arg(251)->Arg(1021);
+
+}  // namespace
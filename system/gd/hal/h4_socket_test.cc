@@ -0,0 +1,157 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/h4_socket.h"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <utility>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+constexpr size_t kMaxPacketSize = 1028;
+
+// H4 ACL packet with |payload_size| bytes of |value|
+std::vector<uint8_t> AclPacket(size_t payload_size, uint8_t value) {
+  std::vector<uint8_t> packet = {
+      0x02, 0x01, 0x20, static_cast<uint8_t>(payload_size), static_cast<uint8_t>(payload_size >> 8)};
+  packet.insert(packet.end(), payload_size, value);
+  return packet;
+}
+
+class H4SocketTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(socketpair(AF_UNIX, GetParam(), 0, fds_), 0);
+  }
+
+  void TearDown() override {
+    close(fds_[0]);
+    if (fds_[1] != -1) close(fds_[1]);
+  }
+
+  bool IsDatagram() const {
+    return GetParam() == SOCK_SEQPACKET;
+  }
+
+  std::vector<std::pair<uint8_t, std::vector<uint8_t>>> ReadAll(H4Reader& reader) {
+    std::vector<std::pair<uint8_t, std::vector<uint8_t>>> packets;
+    reader.Read(fds_[1], [&packets](uint8_t h4_type, std::shared_ptr<std::vector<uint8_t>> packet) {
+      packets.emplace_back(h4_type, *packet);
+    });
+    return packets;
+  }
+
+  int fds_[2] = {-1, -1};
+  HciPacketPool pool_{4, kMaxPacketSize};
+};
+
+TEST_P(H4SocketTest, packets_are_batched) {
+  H4Writer writer(IsDatagram());
+  for (uint8_t i = 0; i < 3; i++) {
+    writer.Enqueue(AclPacket(10 + i, i));
+  }
+  writer.Enqueue({0x04, 0x0e, 0x01, 0x00});
+  ASSERT_TRUE(writer.Write(fds_[0]));
+  EXPECT_TRUE(writer.IsEmpty());
+
+  H4Reader reader(IsDatagram(), kMaxPacketSize, &pool_);
+  auto packets = ReadAll(reader);
+  ASSERT_EQ(packets.size(), 4u);
+  for (uint8_t i = 0; i < 3; i++) {
+    auto expected = AclPacket(10 + i, i);
+    EXPECT_EQ(packets[i].first, 0x02);
+    EXPECT_EQ(packets[i].second, std::vector<uint8_t>(expected.begin() + 1, expected.end()));
+  }
+  EXPECT_EQ(packets[3].first, 0x04);
+  EXPECT_EQ(packets[3].second, std::vector<uint8_t>({0x0e, 0x01, 0x00}));
+}
+
+TEST_P(H4SocketTest, writes_are_limited_to_a_batch) {
+  H4Writer writer(IsDatagram());
+  for (size_t i = 0; i < kH4MaxBatch + 2; i++) {
+    writer.Enqueue(AclPacket(4, i));
+  }
+  ASSERT_TRUE(writer.Write(fds_[0]));
+  EXPECT_EQ(writer.Size(), 2u);
+  ASSERT_TRUE(writer.Write(fds_[0]));
+  EXPECT_TRUE(writer.IsEmpty());
+
+  H4Reader reader(IsDatagram(), kMaxPacketSize, &pool_);
+  size_t count = 0;
+  while (count < kH4MaxBatch + 2) {
+    auto packets = ReadAll(reader);
+    ASSERT_FALSE(packets.empty());
+    count += packets.size();
+  }
+  EXPECT_EQ(count, kH4MaxBatch + 2);
+}
+
+TEST_P(H4SocketTest, end_of_stream) {
+  close(fds_[0]);
+  fds_[0] = fds_[1];
+  fds_[1] = -1;
+  H4Reader reader(IsDatagram(), kMaxPacketSize, &pool_);
+  EXPECT_EQ(reader.Read(fds_[0], [](uint8_t, std::shared_ptr<std::vector<uint8_t>>) { FAIL(); }), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sockets, H4SocketTest, ::testing::Values(SOCK_SEQPACKET, SOCK_STREAM));
+
+TEST(H4StreamTest, packet_split_across_reads) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  HciPacketPool pool(4, kMaxPacketSize);
+  H4Reader reader(false, kMaxPacketSize, &pool);
+  std::vector<std::vector<uint8_t>> packets;
+  auto on_packet = [&packets](uint8_t, std::shared_ptr<std::vector<uint8_t>> packet) {
+    packets.push_back(*packet);
+  };
+
+  auto acl = AclPacket(300, 0x5a);
+  ASSERT_EQ(write(fds[0], acl.data(), 3), 3);
+  EXPECT_EQ(reader.Read(fds[1], on_packet), 3);
+  EXPECT_TRUE(packets.empty());
+
+  ASSERT_EQ(write(fds[0], acl.data() + 3, acl.size() - 3), static_cast<ssize_t>(acl.size() - 3));
+  reader.Read(fds[1], on_packet);
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_EQ(packets[0], std::vector<uint8_t>(acl.begin() + 1, acl.end()));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(H4StreamTest, unknown_packet_type) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  HciPacketPool pool(4, kMaxPacketSize);
+  H4Reader reader(false, kMaxPacketSize, &pool);
+
+  uint8_t garbage[] = {0x7f, 0x00, 0x00};
+  ASSERT_EQ(write(fds[0], garbage, sizeof(garbage)), 3);
+  EXPECT_EQ(reader.Read(fds[1], [](uint8_t, std::shared_ptr<std::vector<uint8_t>>) {}), -1);
+  EXPECT_EQ(errno, EPROTO);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
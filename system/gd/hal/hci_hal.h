@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "module.h"
@@ -24,6 +25,8 @@ namespace bluetooth {
 namespace hal {
 
 using HciPacket = std::vector<uint8_t>;
+// A received packet in a buffer shared with its views, e.g. from an HciPacketPool
+using SharedHciPacket = std::shared_ptr<const std::vector<uint8_t>>;
 
 enum class Status : int32_t { SUCCESS, TRANSPORT_ERROR, INITIALIZATION_ERROR, UNKNOWN };
 
@@ -51,6 +54,24 @@ class HciHalCallbacks {
   // Send an ISO data packet from the controller to the host
   // @param data the ISO HCI packet to be passed to the host stack
   virtual void isoDataReceived(HciPacket data) = 0;
+
+  // Same as hciEventReceived, aclDataReceived, scoDataReceived and isoDataReceived, for a packet in a shared buffer.
+  // The stack keeps a reference to the buffer instead of copying the packet.
+  virtual void hciEventBufferReceived(SharedHciPacket event) {
+    hciEventReceived(*event);
+  }
+
+  virtual void aclDataBufferReceived(SharedHciPacket data) {
+    aclDataReceived(*data);
+  }
+
+  virtual void scoDataBufferReceived(SharedHciPacket data) {
+    scoDataReceived(*data);
+  }
+
+  virtual void isoDataBufferReceived(SharedHciPacket data) {
+    isoDataReceived(*data);
+  }
 };
 
 // Mirrors hardware/interfaces/bluetooth/1.0/IBluetoothHci.hal in Android
@@ -98,11 +119,40 @@ class HciHal : public ::bluetooth::Module {
   // Packets must be processed in order.
   virtual void sendIsoData(HciPacket data) = 0;
 
+  // Number of bytes the caller of the send*DataWithHeadroom methods reserves in front of the HCI packet. A HAL that
+  // prepends a transport header (e.g. the H4 packet type) writes it there instead of reallocating the packet.
+  virtual size_t getOutgoingPacketHeadroom() const {
+    return 0;
+  }
+
+  // Same as sendAclData, sendScoData and sendIsoData, except that the first getOutgoingPacketHeadroom() bytes of
+  // |data| are scratch space owned by the HAL and are not part of the HCI packet.
+  virtual void sendAclDataWithHeadroom(HciPacket data) {
+    sendAclData(StripHeadroom(std::move(data)));
+  }
+
+  virtual void sendScoDataWithHeadroom(HciPacket data) {
+    sendScoData(StripHeadroom(std::move(data)));
+  }
+
+  virtual void sendIsoDataWithHeadroom(HciPacket data) {
+    sendIsoData(StripHeadroom(std::move(data)));
+  }
+
   // Get the MSFT opcode (as specified in Microsoft-defined Bluetooth HCI
   // extensions)
   virtual uint16_t getMsftOpcode() {
     return 0;
   }
+
+ private:
+  HciPacket StripHeadroom(HciPacket data) const {
+    size_t headroom = getOutgoingPacketHeadroom();
+    if (headroom != 0) {
+      data.erase(data.begin(), data.begin() + headroom);
+    }
+    return data;
+  }
 };
 // LINT.ThenChange(fuzz/fuzz_hci_hal.h)
 
@@ -26,10 +26,11 @@
 #include <chrono>
 #include <csignal>
 #include <mutex>
-#include <queue>
 
 #include "gd/common/init_flags.h"
+#include "hal/h4_socket.h"
 #include "hal/hci_hal.h"
+#include "hal/hci_packet_pool.h"
 #include "hal/mgmt.h"
 #include "hal/snoop_logger.h"
 #include "metrics/counter_metrics.h"
@@ -52,6 +53,7 @@ constexpr uint8_t kHciScoHeaderSize = 3;
 constexpr uint8_t kHciEvtHeaderSize = 2;
 constexpr uint8_t kHciIsoHeaderSize = 4;
 constexpr int kBufSize = 1024 + 4 + 1;  // DeviceProperties::acl_data_packet_size_ + ACL header + H4 header
+constexpr size_t kNumReceiveBuffers = 64;  // Received packets the stack can hold before buffers are allocated
 
 constexpr uint8_t BTPROTO_HCI = 1;
 constexpr uint16_t HCI_CHANNEL_USER = 1;
@@ -237,7 +239,7 @@ class HciHalHost : public HciHal {
     std::vector<uint8_t> packet = std::move(command);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
     packet.insert(packet.cbegin(), kH4Command);
-    write_to_fd(packet);
+    write_to_fd(std::move(packet));
   }
 
   void sendAclData(HciPacket data) override {
@@ -246,7 +248,7 @@ class HciHalHost : public HciHal {
     std::vector<uint8_t> packet = std::move(data);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
     packet.insert(packet.cbegin(), kH4Acl);
-    write_to_fd(packet);
+    write_to_fd(std::move(packet));
   }
 
   void sendScoData(HciPacket data) override {
@@ -255,7 +257,7 @@ class HciHalHost : public HciHal {
     std::vector<uint8_t> packet = std::move(data);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::SCO);
     packet.insert(packet.cbegin(), kH4Sco);
-    write_to_fd(packet);
+    write_to_fd(std::move(packet));
   }
 
   void sendIsoData(HciPacket data) override {
@@ -264,7 +266,23 @@ class HciHalHost : public HciHal {
     std::vector<uint8_t> packet = std::move(data);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ISO);
     packet.insert(packet.cbegin(), kH4Iso);
-    write_to_fd(packet);
+    write_to_fd(std::move(packet));
+  }
+
+  size_t getOutgoingPacketHeadroom() const override {
+    return kH4HeaderSize;
+  }
+
+  void sendAclDataWithHeadroom(HciPacket data) override {
+    send_with_headroom(std::move(data), kH4Acl, SnoopLogger::PacketType::ACL);
+  }
+
+  void sendScoDataWithHeadroom(HciPacket data) override {
+    send_with_headroom(std::move(data), kH4Sco, SnoopLogger::PacketType::SCO);
+  }
+
+  void sendIsoDataWithHeadroom(HciPacket data) override {
+    send_with_headroom(std::move(data), kH4Iso, SnoopLogger::PacketType::ISO);
   }
 
   uint16_t getMsftOpcode() override {
@@ -325,27 +343,39 @@ class HciHalHost : public HciHal {
   bluetooth::os::Thread hci_incoming_thread_ =
       bluetooth::os::Thread("hci_incoming_thread", bluetooth::os::Thread::Priority::NORMAL);
   bluetooth::os::Reactor::Reactable* reactable_ = nullptr;
-  std::queue<std::vector<uint8_t>> hci_outgoing_queue_;
+  // The HCI user channel is a datagram socket: each message is one packet.
+  H4Writer hci_outgoing_queue_{true};
   SnoopLogger* btsnoop_logger_ = nullptr;
+  HciPacketPool packet_pool_{kNumReceiveBuffers, kBufSize - kH4HeaderSize};
+  H4Reader hci_incoming_reader_{true, kBufSize - kH4HeaderSize, &packet_pool_};
+
+  // The H4 packet type is written into the headroom, so the packet is queued without being copied.
+  void send_with_headroom(HciPacket packet, uint8_t h4_type, SnoopLogger::PacketType type) {
+    std::lock_guard<std::mutex> lock(api_mutex_);
+    ASSERT(sock_fd_ != INVALID_FD);
+    ASSERT(packet.size() >= kH4HeaderSize);
+    btsnoop_logger_->Capture(
+        packet.data() + kH4HeaderSize, packet.size() - kH4HeaderSize, SnoopLogger::Direction::OUTGOING, type);
+    packet[0] = h4_type;
+    write_to_fd(std::move(packet));
+  }
 
   void write_to_fd(HciPacket packet) {
     // TODO: replace this with new queue when it's ready
-    hci_outgoing_queue_.emplace(packet);
-    if (hci_outgoing_queue_.size() == 1) {
+    hci_outgoing_queue_.Enqueue(std::move(packet));
+    if (hci_outgoing_queue_.Size() == 1) {
       hci_incoming_thread_.GetReactor()->ModifyRegistration(reactable_, os::Reactor::REACT_ON_READ_WRITE);
     }
   }
 
   void send_packet_ready() {
     std::lock_guard<std::mutex> lock(api_mutex_);
-    if (hci_outgoing_queue_.empty()) return;
-    auto packet_to_send = hci_outgoing_queue_.front();
-    auto bytes_written = write(sock_fd_, (void*)packet_to_send.data(), packet_to_send.size());
-    hci_outgoing_queue_.pop();
-    if (bytes_written == -1) {
+    if (hci_outgoing_queue_.IsEmpty()) return;
+    // Sends the queued packets in batches, one system call each
+    if (!hci_outgoing_queue_.Write(sock_fd_)) {
       abort();
     }
-    if (hci_outgoing_queue_.empty()) {
+    if (hci_outgoing_queue_.IsEmpty()) {
       hci_incoming_thread_.GetReactor()->ModifyRegistration(reactable_, os::Reactor::REACT_ON_READ_ONLY);
     }
   }
@@ -358,10 +388,15 @@ class HciHalHost : public HciHal {
         return;
       }
     }
-    uint8_t buf[kBufSize] = {};
-
-    ssize_t received_size;
-    RUN_NO_INTR(received_size = read(sock_fd_, buf, kBufSize));
+    // The packets waiting on the socket are read at once into pooled buffers, which are then shared with the stack
+    // without copying
+    ssize_t received_size = hci_incoming_reader_.Read(
+        sock_fd_, [this](uint8_t h4_type, std::shared_ptr<std::vector<uint8_t>> packet) {
+          handle_incoming_packet(h4_type, std::move(packet));
+        });
+    if (received_size == -1 && errno == EAGAIN) {
+      return;
+    }
     ASSERT_LOG(received_size != -1, "Can't receive from socket: %s", strerror(errno));
     if (received_size == 0) {
       LOG_WARN("Can't read H4 header. EOF received");
@@ -370,11 +405,15 @@ class HciHalHost : public HciHal {
       raise(SIGINT);
       return;
     }
+  }
+
+  void handle_incoming_packet(uint8_t h4_type, std::shared_ptr<std::vector<uint8_t>> packet) {
+    size_t received_size = packet->size() + kH4HeaderSize;
 
-    if (buf[0] == kH4Event) {
+    if (h4_type == kH4Event) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciEvtHeaderSize, "Received bad HCI_EVT packet size: %zu", received_size);
-      uint8_t hci_evt_parameter_total_length = buf[2];
+      uint8_t hci_evt_parameter_total_length = (*packet)[1];
       ssize_t payload_size = received_size - (kH4HeaderSize + kHciEvtHeaderSize);
       ASSERT_LOG(
           payload_size == hci_evt_parameter_total_length,
@@ -382,24 +421,22 @@ class HciHalHost : public HciHal {
           payload_size,
           hci_evt_parameter_total_length);
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciEvtHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an event after processing");
           return;
         }
-        incoming_packet_callback_->hciEventReceived(receivedHciPacket);
+        incoming_packet_callback_->hciEventBufferReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Acl) {
+    if (h4_type == kH4Acl) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciAclHeaderSize, "Received bad HCI_ACL packet size: %zu", received_size);
       int payload_size = received_size - (kH4HeaderSize + kHciAclHeaderSize);
-      uint16_t hci_acl_data_total_length = (buf[4] << 8) + buf[3];
+      uint16_t hci_acl_data_total_length = ((*packet)[3] << 8) + (*packet)[2];
       ASSERT_LOG(
           payload_size == hci_acl_data_total_length,
           "malformed ACL length received: %d != %d",
@@ -407,67 +444,60 @@ class HciHalHost : public HciHal {
           hci_acl_data_total_length);
       ASSERT_LOG(hci_acl_data_total_length <= kBufSize - kH4HeaderSize - kHciAclHeaderSize, "packet too long");
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciAclHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an ACL packet after processing");
           return;
         }
-        incoming_packet_callback_->aclDataReceived(receivedHciPacket);
+        incoming_packet_callback_->aclDataBufferReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Sco) {
+    if (h4_type == kH4Sco) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciScoHeaderSize, "Received bad HCI_SCO packet size: %zu", received_size);
       int payload_size = received_size - (kH4HeaderSize + kHciScoHeaderSize);
-      uint8_t hci_sco_data_total_length = buf[3];
+      uint8_t hci_sco_data_total_length = (*packet)[2];
       ASSERT_LOG(
           payload_size == hci_sco_data_total_length,
           "malformed SCO length received: %d != %d",
           payload_size,
           hci_sco_data_total_length);
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciScoHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a SCO packet after processing");
           return;
         }
-        incoming_packet_callback_->scoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->scoDataBufferReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Iso) {
+    if (h4_type == kH4Iso) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciIsoHeaderSize, "Received bad HCI_ISO packet size: %zu", received_size);
       int payload_size = received_size - (kH4HeaderSize + kHciIsoHeaderSize);
-      uint16_t hci_iso_data_total_length = ((buf[4] & 0x3f) << 8) + buf[3];
+      uint16_t hci_iso_data_total_length = (((*packet)[3] & 0x3f) << 8) + (*packet)[2];
       ASSERT_LOG(
           payload_size == hci_iso_data_total_length,
           "malformed ISO length received: %d != %d",
           payload_size,
           hci_iso_data_total_length);
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciIsoHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ISO);
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ISO);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a ISO packet after processing");
           return;
         }
-        incoming_packet_callback_->isoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->isoDataBufferReceived(std::move(packet));
       }
     }
-    memset(buf, 0, kBufSize);
   }
 };
 
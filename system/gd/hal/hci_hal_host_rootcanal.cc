@@ -26,9 +26,10 @@
 #include <chrono>
 #include <csignal>
 #include <mutex>
-#include <queue>
 
+#include "hal/h4_socket.h"
 #include "hal/hci_hal.h"
+#include "hal/hci_packet_pool.h"
 #include "hal/snoop_logger.h"
 #include "metrics/counter_metrics.h"
 #include "os/log.h"
@@ -45,11 +46,8 @@ constexpr uint8_t kH4Event = 0x04;
 constexpr uint8_t kH4Iso = 0x05;
 
 constexpr uint8_t kH4HeaderSize = 1;
-constexpr uint8_t kHciAclHeaderSize = 4;
-constexpr uint8_t kHciScoHeaderSize = 3;
-constexpr uint8_t kHciEvtHeaderSize = 2;
-constexpr uint8_t kHciIsoHeaderSize = 4;
 constexpr int kBufSize = 1024 + 4 + 1;  // DeviceProperties::acl_data_packet_size_ + ACL header + H4 header
+constexpr size_t kNumReceiveBuffers = 64;  // Received packets the stack can hold before buffers are allocated
 
 int ConnectToSocket() {
   auto* config = bluetooth::hal::HciHalHostRootcanalConfig::Get();
@@ -210,45 +208,31 @@ class HciHalHost : public HciHal {
   bluetooth::os::Thread hci_incoming_thread_ =
       bluetooth::os::Thread("hci_incoming_thread", bluetooth::os::Thread::Priority::NORMAL);
   bluetooth::os::Reactor::Reactable* reactable_ = nullptr;
-  std::queue<std::vector<uint8_t>> hci_outgoing_queue_;
+  // Rootcanal is a stream socket: packets are gathered into each write, and split from the received bytes.
+  H4Writer hci_outgoing_queue_{false};
+  HciPacketPool packet_pool_{kNumReceiveBuffers, kBufSize - kH4HeaderSize};
+  H4Reader hci_incoming_reader_{false, kBufSize - kH4HeaderSize, &packet_pool_};
   SnoopLogger* btsnoop_logger_ = nullptr;
 
   void write_to_fd(HciPacket packet) {
     // TODO: replace this with new queue when it's ready
-    hci_outgoing_queue_.emplace(packet);
-    if (hci_outgoing_queue_.size() == 1) {
+    hci_outgoing_queue_.Enqueue(std::move(packet));
+    if (hci_outgoing_queue_.Size() == 1) {
       hci_incoming_thread_.GetReactor()->ModifyRegistration(reactable_, os::Reactor::REACT_ON_READ_WRITE);
     }
   }
 
   void send_packet_ready() {
     std::lock_guard<std::mutex> lock(api_mutex_);
-    if (hci_outgoing_queue_.empty()) return;
-    auto packet_to_send = hci_outgoing_queue_.front();
-    auto bytes_written = write(sock_fd_, (void*)packet_to_send.data(), packet_to_send.size());
-    hci_outgoing_queue_.pop();
-    if (bytes_written == -1) {
+    if (hci_outgoing_queue_.IsEmpty()) return;
+    if (!hci_outgoing_queue_.Write(sock_fd_)) {
       abort();
     }
-    if (hci_outgoing_queue_.empty()) {
+    if (hci_outgoing_queue_.IsEmpty()) {
       hci_incoming_thread_.GetReactor()->ModifyRegistration(reactable_, os::Reactor::REACT_ON_READ_ONLY);
     }
   }
 
-  bool socketRecvAll(void* buffer, int bufferLen) {
-    auto buf = static_cast<char*>(buffer);
-    while (bufferLen > 0) {
-      ssize_t ret;
-      RUN_NO_INTR(ret = recv(sock_fd_, buf, bufferLen, 0));
-      if (ret <= 0) {
-        return false;
-      }
-      buf += ret;
-      bufferLen -= ret;
-    }
-    return true;
-  }
-
   void incoming_packet_received() {
     {
       std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
@@ -257,113 +241,70 @@ class HciHalHost : public HciHal {
         return;
       }
     }
-    uint8_t buf[kBufSize] = {};
-
-    ssize_t received_size;
-    RUN_NO_INTR(received_size = recv(sock_fd_, buf, kH4HeaderSize, 0));
+    // All the bytes available are read at once, and each complete packet is handed to the stack in a pooled buffer
+    ssize_t received_size = hci_incoming_reader_.Read(
+        sock_fd_, [this](uint8_t h4_type, std::shared_ptr<std::vector<uint8_t>> packet) {
+          handle_incoming_packet(h4_type, std::move(packet));
+        });
+    if (received_size == -1 && errno == EAGAIN) {
+      return;
+    }
     ASSERT_LOG(received_size != -1, "Can't receive from socket: %s", strerror(errno));
     if (received_size == 0) {
       LOG_WARN("Can't read H4 header. EOF received");
       raise(SIGINT);
       return;
     }
+  }
 
-    if (buf[0] == kH4Event) {
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize, kHciEvtHeaderSize), "Can't receive from socket: %s", strerror(errno));
-
-      uint8_t hci_evt_parameter_total_length = buf[2];
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize + kHciEvtHeaderSize, hci_evt_parameter_total_length),
-          "Can't receive from socket: %s",
-          strerror(errno));
-
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(
-          buf + kH4HeaderSize, buf + kH4HeaderSize + kHciEvtHeaderSize + hci_evt_parameter_total_length);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
+  void handle_incoming_packet(uint8_t h4_type, std::shared_ptr<std::vector<uint8_t>> packet) {
+    if (h4_type == kH4Event) {
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an event after processing");
           return;
         }
-        incoming_packet_callback_->hciEventReceived(receivedHciPacket);
+        incoming_packet_callback_->hciEventBufferReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Acl) {
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize, kHciAclHeaderSize), "Can't receive from socket: %s", strerror(errno));
-
-      uint16_t hci_acl_data_total_length = (buf[4] << 8) + buf[3];
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize + kHciAclHeaderSize, hci_acl_data_total_length),
-          "Can't receive from socket: %s",
-          strerror(errno));
-
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(
-          buf + kH4HeaderSize, buf + kH4HeaderSize + kHciAclHeaderSize + hci_acl_data_total_length);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
+    if (h4_type == kH4Acl) {
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an ACL packet after processing");
           return;
         }
-        incoming_packet_callback_->aclDataReceived(receivedHciPacket);
+        incoming_packet_callback_->aclDataBufferReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Sco) {
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize, kHciScoHeaderSize), "Can't receive from socket: %s", strerror(errno));
-
-      uint8_t hci_sco_data_total_length = buf[3];
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize + kHciScoHeaderSize, hci_sco_data_total_length),
-          "Can't receive from socket: %s",
-          strerror(errno));
-
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(
-          buf + kH4HeaderSize, buf + kH4HeaderSize + kHciScoHeaderSize + hci_sco_data_total_length);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
+    if (h4_type == kH4Sco) {
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a SCO packet after processing");
           return;
         }
-        incoming_packet_callback_->scoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->scoDataBufferReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Iso) {
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize, kHciIsoHeaderSize), "Can't receive from socket: %s", strerror(errno));
-
-      uint16_t hci_iso_data_total_length = ((buf[4] & 0x3f) << 8) + buf[3];
-      ASSERT_LOG(
-          socketRecvAll(buf + kH4HeaderSize + kHciIsoHeaderSize, hci_iso_data_total_length),
-          "Can't receive from socket: %s",
-          strerror(errno));
-
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(
-          buf + kH4HeaderSize, buf + kH4HeaderSize + kHciIsoHeaderSize + hci_iso_data_total_length);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ISO);
+    if (h4_type == kH4Iso) {
+      btsnoop_logger_->Capture(*packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ISO);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a ISO packet after processing");
           return;
         }
-        incoming_packet_callback_->isoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->isoDataBufferReceived(std::move(packet));
       }
     }
-    memset(buf, 0, kBufSize);
   }
 };
 
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/hci_packet_pool.h"
+
+#include <atomic>
+
+namespace bluetooth {
+namespace hal {
+
+HciPacketPool::HciPacketPool(size_t num_buffers, size_t buffer_capacity) : buffer_capacity_(buffer_capacity) {
+  buffers_.reserve(num_buffers);
+  for (size_t i = 0; i < num_buffers; i++) {
+    auto buffer = std::make_shared<std::vector<uint8_t>>();
+    buffer->reserve(buffer_capacity_);
+    buffers_.push_back(std::move(buffer));
+  }
+}
+
+std::shared_ptr<std::vector<uint8_t>> HciPacketPool::Get() {
+  for (size_t i = 0; i < buffers_.size(); i++) {
+    auto& buffer = buffers_[next_];
+    next_ = (next_ + 1) % buffers_.size();
+    // Only the pool refers to the buffer, and only the pool can hand out new references to it
+    if (buffer.use_count() == 1) {
+      // Order the reuse after the accesses made through the last released reference, on another thread
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return buffer;
+    }
+  }
+  overflow_count_++;
+  auto buffer = std::make_shared<std::vector<uint8_t>>();
+  buffer->reserve(buffer_capacity_);
+  return buffer;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+
+// Reusable buffers for the packets received from the controller. A buffer is handed out as a shared pointer, from
+// which the packet views are built without copying, and is reused once its last reference is gone. Getting a buffer
+// only allocates when all of them are still referenced.
+//
+// Buffers must be obtained from a single thread, e.g. the HAL thread. References may be dropped on any thread.
+class HciPacketPool {
+ public:
+  HciPacketPool(size_t num_buffers, size_t buffer_capacity);
+  HciPacketPool(const HciPacketPool&) = delete;
+  HciPacketPool& operator=(const HciPacketPool&) = delete;
+
+  // Returns a buffer with unspecified content, to be resized by the caller.
+  std::shared_ptr<std::vector<uint8_t>> Get();
+
+  // Number of buffers allocated because all of the pool was in use.
+  size_t GetOverflowCount() const {
+    return overflow_count_;
+  }
+
+ private:
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> buffers_;
+  size_t buffer_capacity_;
+  size_t next_ = 0;
+  size_t overflow_count_ = 0;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hal/hci_hal.h"
+#include "hal/hci_packet_pool.h"
+#include "hci/hci_packets.h"
+#include "packet/packet_view.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+using ::bluetooth::hal::HciPacket;
+using ::bluetooth::hal::HciPacketPool;
+using ::bluetooth::hci::AclView;
+using ::bluetooth::packet::kLittleEndian;
+using ::bluetooth::packet::PacketView;
+
+namespace {
+// Allocations made by the benchmark thread while counting
+thread_local bool count_allocations = false;
+thread_local size_t allocations = 0;
+}  // namespace
+
+void* operator new(size_t size) {
+  if (count_allocations) {
+    allocations++;
+  }
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+constexpr size_t kBufSize = 1024 + 4 + 1;  // As read by HciHalHost: H4 header, ACL header and payload
+// ACL packets the upper layers hold at a time, e.g. while reassembling L2CAP frames
+constexpr size_t kPacketsInFlight = 16;
+
+std::vector<uint8_t> MakeH4Acl(size_t payload_size) {
+  std::vector<uint8_t> h4 = {
+      0x02, 0x40, 0x20, static_cast<uint8_t>(payload_size), static_cast<uint8_t>(payload_size >> 8)};
+  h4.resize(h4.size() + payload_size, 0x5a);
+  return h4;
+}
+
+template <typename Receive>
+void ReceiveAcl(State& state, Receive receive) {
+  std::vector<uint8_t> h4 = MakeH4Acl(state.range(0));
+  std::deque<AclView> in_flight;
+  size_t bytes = 0;
+
+  allocations = 0;
+  count_allocations = true;
+  for (auto _ : state) {
+    AclView acl = AclView::Create(receive(h4));
+    ::benchmark::DoNotOptimize(acl.IsValid());
+    bytes += acl.size();
+    in_flight.push_back(std::move(acl));
+    if (in_flight.size() > kPacketsInFlight) {
+      in_flight.pop_front();
+    }
+  }
+  count_allocations = false;
+
+  state.SetBytesProcessed(bytes);
+  state.counters["allocs_per_packet"] = Counter(allocations, Counter::kAvgIterations);
+}
+
+// Previous receive path: the HAL copies the packet into a new vector, which is copied again into the callback and
+// wrapped into a new shared pointer by the HCI layer.
+void BM_ReceiveAclCopied(State& state) {
+  ReceiveAcl(state, [](const std::vector<uint8_t>& h4) {
+    HciPacket received;
+    received.assign(h4.begin() + 1, h4.end());
+    HciPacket callback_argument = received;
+    return PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::move(callback_argument)));
+  });
+}
+
+// The HAL reads the packet into a pooled buffer, shared with the views. The copy stands for the read from the socket.
+void BM_ReceiveAclPooled(State& state) {
+  HciPacketPool pool(64, kBufSize - 1);
+  ReceiveAcl(state, [&pool](const std::vector<uint8_t>& h4) {
+    auto packet = pool.Get();
+    packet->resize(kBufSize - 1);
+    size_t size = h4.size() - 1;
+    std::memcpy(packet->data(), h4.data() + 1, size);
+    packet->resize(size);
+    return PacketView<kLittleEndian>(std::move(packet));
+  });
+}
+
+BENCHMARK(BM_ReceiveAclCopied)->ArgName("payload")->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_ReceiveAclPooled)->ArgName("payload")->Arg(27)->Arg(251)->Arg(1021);
+
+}  // namespace
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/hci_packet_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+TEST(HciPacketPoolTest, buffers_are_reserved) {
+  HciPacketPool pool(2, 1029);
+  auto buffer = pool.Get();
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_GE(buffer->capacity(), 1029u);
+}
+
+TEST(HciPacketPoolTest, released_buffer_is_reused) {
+  HciPacketPool pool(1, 16);
+  auto buffer = pool.Get();
+  buffer->assign({1, 2, 3});
+  const std::vector<uint8_t>* data = buffer.get();
+  buffer.reset();
+
+  auto reused = pool.Get();
+  EXPECT_EQ(reused.get(), data);
+  EXPECT_EQ(pool.GetOverflowCount(), 0u);
+}
+
+TEST(HciPacketPoolTest, referenced_buffer_is_not_reused) {
+  HciPacketPool pool(2, 16);
+  auto first = pool.Get();
+  std::shared_ptr<const std::vector<uint8_t>> view = pool.Get();
+  auto third = pool.Get();
+
+  EXPECT_NE(first, third);
+  EXPECT_NE(view.get(), third.get());
+  EXPECT_EQ(pool.GetOverflowCount(), 1u);
+
+  first.reset();
+  EXPECT_NE(pool.Get(), nullptr);
+  EXPECT_EQ(pool.GetOverflowCount(), 1u);
+}
+
+TEST(HciPacketPoolTest, buffer_released_on_another_thread) {
+  HciPacketPool pool(4, 16);
+  for (int i = 0; i < 1000; i++) {
+    auto buffer = pool.Get();
+    buffer->assign(8, static_cast<uint8_t>(i));
+    std::thread receiver([packet = std::move(buffer), i]() { EXPECT_EQ((*packet)[7], static_cast<uint8_t>(i)); });
+    receiver.join();
+  }
+  EXPECT_EQ(pool.GetOverflowCount(), 0u);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
@@ -17,14 +17,14 @@
 #include "hal/snoop_logger.h"
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <bitset>
 #include <chrono>
-#include <sstream>
 
-#include "common/circular_buffer.h"
 #include "common/init_flags.h"
 #include "common/strings.h"
 #include "hal/snoop_logger_common.h"
@@ -369,7 +369,7 @@ void delete_old_btsnooz_files(const std::string& log_path, const std::chrono::mi
 }
 
 size_t get_btsnooz_packet_length_to_write(
-    const HciPacket& packet, SnoopLogger::PacketType type, bool qualcomm_debug_log_enabled) {
+    const uint8_t* packet, size_t packet_size, SnoopLogger::PacketType type, bool qualcomm_debug_log_enabled) {
   static const size_t kAclHeaderSize = 4;
   static const size_t kL2capHeaderSize = 4;
   static const size_t kL2capCidOffset = (kAclHeaderSize + 2);
@@ -387,14 +387,14 @@ size_t get_btsnooz_packet_length_to_write(
   switch (type) {
     case SnoopLogger::PacketType::CMD:
     case SnoopLogger::PacketType::EVT:
-      included_length = packet.size();
+      included_length = packet_size;
       break;
 
     case SnoopLogger::PacketType::ACL: {
       // Log ACL and L2CAP header by default
       size_t len_hci_acl = kAclHeaderSize + kL2capHeaderSize;
       // Check if we have enough data for an L2CAP header
-      if (packet.size() > len_hci_acl) {
+      if (packet_size > len_hci_acl) {
         uint16_t l2cap_cid =
             static_cast<uint16_t>(packet[kL2capCidOffset]) |
             static_cast<uint16_t>((static_cast<uint16_t>(packet[kL2capCidOffset + 1]) << static_cast<uint16_t>(8)));
@@ -407,15 +407,15 @@ size_t get_btsnooz_packet_length_to_write(
           // For the signaling CID, take the full packet.
           // That way, the PSM setup is captured, allowing decoding of PSMs down
           // the road.
-          return packet.size();
+          return packet_size;
         } else if (qualcomm_debug_log_enabled && hci_acl_packet_handle == kQualcommDebugLogHandle) {
-          return packet.size();
+          return packet_size;
         } else {
           // Otherwise, return as much as we reasonably can
           len_hci_acl = kMaxBtsnoozAclSize;
         }
       }
-      included_length = std::min(len_hci_acl, packet.size());
+      included_length = std::min(len_hci_acl, packet_size);
       break;
     }
 
@@ -432,10 +432,12 @@ size_t get_btsnooz_packet_length_to_write(
 
 // system properties
 const std::string SnoopLogger::kBtSnoopMaxPacketsPerFileProperty = "persist.bluetooth.btsnoopsize";
+const std::string SnoopLogger::kBtSnoozBufferSizeProperty = "persist.bluetooth.btsnoozbuffersize";
 const std::string SnoopLogger::kIsDebuggableProperty = "ro.debuggable";
 const std::string SnoopLogger::kBtSnoopLogModeProperty = "persist.bluetooth.btsnooplogmode";
 const std::string SnoopLogger::kBtSnoopDefaultLogModeProperty = "persist.bluetooth.btsnoopdefaultmode";
 const std::string SnoopLogger::kBtSnoopLogPersists = "persist.bluetooth.btsnooplogpersists";
+const std::string SnoopLogger::kBtSnoopAsyncWriterProperty = "persist.bluetooth.btsnoopasyncwriter";
 // Truncates ACL packets (non-fragment) to fixed (MAX_HCI_ACL_LEN) number of bytes
 const std::string SnoopLogger::kBtSnoopLogFilterHeadersProperty =
     "persist.bluetooth.snooplogfilter.headers.enabled";
@@ -480,20 +482,22 @@ SnoopLogger::SnoopLogger(
     std::string snoop_log_path,
     std::string snooz_log_path,
     size_t max_packets_per_file,
-    size_t max_packets_per_buffer,
+    size_t snooz_buffer_size,
     const std::string& btsnoop_mode,
     bool qualcomm_debug_log_enabled,
     const std::chrono::milliseconds snooz_log_life_time,
     const std::chrono::milliseconds snooz_log_delete_alarm_interval,
-    bool snoop_log_persists)
+    bool snoop_log_persists,
+    bool async_writer)
     : snoop_log_path_(std::move(snoop_log_path)),
       snooz_log_path_(std::move(snooz_log_path)),
       max_packets_per_file_(max_packets_per_file),
-      btsnooz_buffer_(max_packets_per_buffer),
+      btsnooz_buffer_(snooz_buffer_size),
       qualcomm_debug_log_enabled_(qualcomm_debug_log_enabled),
       snooz_log_life_time_(snooz_log_life_time),
       snooz_log_delete_alarm_interval_(snooz_log_delete_alarm_interval),
-      snoop_log_persists(snoop_log_persists) {
+      snoop_log_persists(snoop_log_persists),
+      async_writer_enabled_(async_writer) {
   btsnoop_mode_ = btsnoop_mode;
 
   if (btsnoop_mode_ == kBtSnoopLogModeFiltered &&
@@ -538,10 +542,7 @@ void SnoopLogger::CloseCurrentSnoopLogFile() {
   packet_counter_ = 0;
 }
 
-void SnoopLogger::OpenNextSnoopLogFile() {
-  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
-  CloseCurrentSnoopLogFile();
-
+void SnoopLogger::MoveCurrentSnoopLogFileToLast() {
   auto last_file_path = get_last_log_path(snoop_log_path_);
 
   if (os::FileExists(snoop_log_path_)) {
@@ -554,6 +555,12 @@ void SnoopLogger::OpenNextSnoopLogFile() {
   } else {
     LOG_INFO("Previous log file \"%s\" does not exist, skip renaming", snoop_log_path_.c_str());
   }
+}
+
+void SnoopLogger::OpenNextSnoopLogFile() {
+  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  CloseCurrentSnoopLogFile();
+  MoveCurrentSnoopLogFileToLast();
 
   mode_t prevmask = umask(0);
   // do not use std::ios::app as we want override the existing file
@@ -575,6 +582,26 @@ void SnoopLogger::OpenNextSnoopLogFile() {
   }
 }
 
+int SnoopLogger::OpenNextSnoopLogFd() {
+  // Called on the async writer thread, which owns the file; file_mutex_ is not needed.
+  MoveCurrentSnoopLogFileToLast();
+
+  int fd = open(snoop_log_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+#ifdef USE_FAKE_TIMERS
+  file_creation_time = fake_timerfd_get_clock();
+#endif
+  if (fd < 0) {
+    LOG_ALWAYS_FATAL("Unable to open snoop log at \"%s\", error: \"%s\"", snoop_log_path_.c_str(), strerror(errno));
+  }
+  // Match the permissions of OpenNextSnoopLogFile without changing the process wide umask from this thread
+  fchmod(fd, 0666);
+  if (write(fd, &SnoopLoggerCommon::kBtSnoopFileHeader, sizeof(SnoopLoggerCommon::FileHeaderType)) !=
+      sizeof(SnoopLoggerCommon::FileHeaderType)) {
+    LOG_ALWAYS_FATAL("Unable to write file header to \"%s\", error: \"%s\"", snoop_log_path_.c_str(), strerror(errno));
+  }
+  return fd;
+}
+
 void SnoopLogger::EnableFilters() {
   if (btsnoop_mode_ != kBtSnoopLogModeFiltered) {
     return;
@@ -1149,7 +1176,9 @@ void SnoopLogger::SetL2capChannelClose(uint16_t handle, uint16_t local_cid, uint
 }
 
 void SnoopLogger::FilterCapturedPacket(
-    HciPacket& packet,
+    const uint8_t*& packet,
+    size_t packet_size,
+    HciPacket& scratch,
     Direction direction,
     PacketType type,
     uint32_t& length,
@@ -1159,41 +1188,48 @@ void SnoopLogger::FilterCapturedPacket(
   }
 
   if (IsFilterEnabled(kBtSnoopLogFilterProfileA2dpProperty)) {
-    if (IsA2dpMediaPacket(direction == Direction::INCOMING, (uint8_t*)packet.data())) {
+    if (IsA2dpMediaPacket(direction == Direction::INCOMING, (uint8_t*)packet)) {
       length = 0;
       return;
     }
   }
 
   if (IsFilterEnabled(kBtSnoopLogFilterHeadersProperty)) {
-    CalculateAclPacketLength(length, (uint8_t*)packet.data(), direction == Direction::INCOMING);
+    CalculateAclPacketLength(length, (uint8_t*)packet, direction == Direction::INCOMING);
   }
 
   if (IsFilterEnabled(kBtSnoopLogFilterProfilePbapModeProperty) ||
       IsFilterEnabled(kBtSnoopLogFilterProfileMapModeProperty)) {
     // If HeadersFiltered applied, do not use ProfilesFiltered
     if (length == ntohl(header.length_original)) {
-      if (packet.size() + EXTRA_BUF_SIZE > DEFAULT_PACKET_SIZE) {
+      // Profile filtering rewrites the payload, so work on a copy.
+      scratch.assign(packet, packet + packet_size);
+      if (scratch.size() + EXTRA_BUF_SIZE > DEFAULT_PACKET_SIZE) {
         // Add additional bytes for magic string in case
         // payload length is less than the length of magic string.
-        packet.resize((size_t)(packet.size() + EXTRA_BUF_SIZE));
+        scratch.resize((size_t)(scratch.size() + EXTRA_BUF_SIZE));
       }
+      packet = scratch.data();
 
-      length = FilterProfiles(direction == Direction::INCOMING, (uint8_t*)packet.data());
+      length = FilterProfiles(direction == Direction::INCOMING, scratch.data());
       if (length == 0) return;
     }
   }
 
   if (IsFilterEnabled(kBtSnoopLogFilterProfileRfcommProperty)) {
     bool shouldFilter =
-        SnoopLogger::ShouldFilterLog(direction == Direction::INCOMING, (uint8_t*)packet.data());
+        SnoopLogger::ShouldFilterLog(direction == Direction::INCOMING, (uint8_t*)packet);
     if (shouldFilter) {
       length = L2CAP_HEADER_SIZE + PACKET_TYPE_LENGTH;
     }
   }
 }
 
-void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType type) {
+void SnoopLogger::Capture(const HciPacket& packet, Direction direction, PacketType type) {
+  Capture(packet.data(), packet.size(), direction, type);
+}
+
+void SnoopLogger::Capture(const uint8_t* packet, size_t packet_size, Direction direction, PacketType type) {
   uint64_t timestamp_us =
       std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
           .count();
@@ -1214,7 +1250,7 @@ void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType typ
       flags.set(1, true);
       break;
   }
-  uint32_t length = packet.size() + /* type byte */ PACKET_TYPE_LENGTH;
+  uint32_t length = packet_size + /* type byte */ PACKET_TYPE_LENGTH;
   PacketHeaderType header = {.length_original = htonl(length),
                              .length_captured = htonl(length),
                              .flags = htonl(static_cast<uint32_t>(flags.to_ulong())),
@@ -1225,20 +1261,15 @@ void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType typ
     std::lock_guard<std::recursive_mutex> lock(file_mutex_);
     if (btsnoop_mode_ == kBtSnoopLogModeDisabled) {
       // btsnoop disabled, log in-memory btsnooz log only
-      std::stringstream ss;
-      size_t included_length = get_btsnooz_packet_length_to_write(packet, type, qualcomm_debug_log_enabled_);
+      size_t included_length =
+          get_btsnooz_packet_length_to_write(packet, packet_size, type, qualcomm_debug_log_enabled_);
       header.length_captured = htonl(included_length + /* type byte */ PACKET_TYPE_LENGTH);
-      if (!ss.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
-        LOG_ERROR("Failed to write packet header for btsnooz, error: \"%s\"", strerror(errno));
-      }
-      if (!ss.write(reinterpret_cast<const char*>(packet.data()), included_length)) {
-        LOG_ERROR("Failed to write packet payload for btsnooz, error: \"%s\"", strerror(errno));
-      }
-      btsnooz_buffer_.Push(ss.str());
+      btsnooz_buffer_.Push(&header, sizeof(PacketHeaderType), packet, included_length);
       return;
     }
 
-    FilterCapturedPacket(packet, direction, type, length, header);
+    HciPacket filtered_packet;
+    FilterCapturedPacket(packet, packet_size, filtered_packet, direction, type, length, header);
 
     if (length == 0) {
       return;
@@ -1246,6 +1277,16 @@ void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType typ
       header.length_captured = htonl(length);
     }
 
+    if (async_writer_ != nullptr) {
+      // The writer thread does the file I/O and rotation; a full ring drops the record instead of blocking.
+      async_writer_->Enqueue(&header, sizeof(PacketHeaderType), packet, length - 1);
+      if (socket_ != nullptr) {
+        socket_->Write(&header, sizeof(PacketHeaderType));
+        socket_->Write(packet, packet_size);
+      }
+      return;
+    }
+
     packet_counter_++;
     if (packet_counter_ > max_packets_per_file_) {
       OpenNextSnoopLogFile();
@@ -1253,13 +1294,13 @@ void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType typ
     if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
       LOG_ERROR("Failed to write packet header for btsnoop, error: \"%s\"", strerror(errno));
     }
-    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet.data()), length - 1)) {
+    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet), length - 1)) {
       LOG_ERROR("Failed to write packet payload for btsnoop, error: \"%s\"", strerror(errno));
     }
 
     if (socket_ != nullptr) {
       socket_->Write(&header, sizeof(PacketHeaderType));
-      socket_->Write(packet.data(), packet.size());
+      socket_->Write(packet, packet_size);
     }
 
     // std::ofstream::flush() pushes user data into kernel memory. The data will be written even if this process
@@ -1272,7 +1313,7 @@ void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType typ
   }
 }
 
-void SnoopLogger::DumpSnoozLogToFile(const std::vector<std::string>& data) const {
+void SnoopLogger::DumpSnoozLogToFile(const std::vector<uint8_t>& data) const {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   if (btsnoop_mode_ != kBtSnoopLogModeDisabled) {
     LOG_DEBUG("btsnoop log is enabled, skip dumping btsnooz log");
@@ -1304,10 +1345,8 @@ void SnoopLogger::DumpSnoozLogToFile(const std::vector<std::string>& data) const
           sizeof(SnoopLoggerCommon::FileHeaderType))) {
     LOG_ALWAYS_FATAL("Unable to write file header to \"%s\", error: \"%s\"", snooz_log_path_.c_str(), strerror(errno));
   }
-  for (const auto& packet : data) {
-    if (!btsnooz_ostream.write(packet.data(), packet.size())) {
-      LOG_ERROR("Failed to write packet payload for btsnooz, error: \"%s\"", strerror(errno));
-    }
+  if (!btsnooz_ostream.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+    LOG_ERROR("Failed to write packet payload for btsnooz, error: \"%s\"", strerror(errno));
   }
   if (!btsnooz_ostream.flush()) {
     LOG_ERROR("Failed to flush, error: \"%s\"", strerror(errno));
@@ -1321,7 +1360,13 @@ void SnoopLogger::ListDependencies(ModuleList* list) const {
 void SnoopLogger::Start() {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   if (btsnoop_mode_ != kBtSnoopLogModeDisabled) {
-    OpenNextSnoopLogFile();
+    if (async_writer_enabled_) {
+      async_writer_ = std::make_unique<SnoopLoggerAsyncWriter>(
+          SnoopLoggerAsyncWriter::kDefaultRingSize, max_packets_per_file_, [this]() { return OpenNextSnoopLogFd(); });
+      async_writer_->Start();
+    } else {
+      OpenNextSnoopLogFile();
+    }
 
     if (btsnoop_mode_ == kBtSnoopLogModeFiltered) {
       EnableFilters();
@@ -1349,6 +1394,14 @@ void SnoopLogger::Start() {
 void SnoopLogger::Stop() {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   LOG_DEBUG("Closing btsnoop log data at %s", snoop_log_path_.c_str());
+  if (async_writer_ != nullptr) {
+    async_writer_->Stop();
+    LOG_INFO(
+        "btsnoop async writer wrote %zu records, dropped %zu",
+        async_writer_->GetWrittenRecords(),
+        async_writer_->GetDroppedRecords());
+    async_writer_.reset();
+  }
   CloseCurrentSnoopLogFile();
 
   if (snoop_logger_socket_thread_ != nullptr) {
@@ -1373,6 +1426,15 @@ void SnoopLogger::Stop() {
 
 DumpsysDataFinisher SnoopLogger::GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const {
   LOG_DEBUG("Dumping btsnooz log data to %s", snooz_log_path_.c_str());
+  {
+    std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+    if (async_writer_ != nullptr) {
+      LOG_INFO(
+          "btsnoop async writer wrote %zu records, dropped %zu",
+          async_writer_->GetWrittenRecords(),
+          async_writer_->GetDroppedRecords());
+    }
+  }
   DumpSnoozLogToFile(btsnooz_buffer_.Pull());
   return Module::GetDumpsysData(builder);
 }
@@ -1392,14 +1454,21 @@ size_t SnoopLogger::GetMaxPacketsPerFile() {
   return max_packets_per_file;
 }
 
-size_t SnoopLogger::GetMaxPacketsPerBuffer() {
+size_t SnoopLogger::GetSnoozBufferSize() {
   // We want to use at most 256 KB memory for btsnooz log for release builds
-  // and 512 KB memory for userdebug/eng builds
+  // and 1 MB memory for userdebug/eng builds
   auto is_debuggable = os::GetSystemPropertyBool(kIsDebuggableProperty, false);
-
   size_t btsnooz_max_memory_usage_bytes = (is_debuggable ? 1024 : 256) * 1024;
-  // Calculate max number of packets based on max memory usage and max packet size
-  return btsnooz_max_memory_usage_bytes / kDefaultBtSnoozMaxBytesPerPacket;
+
+  // Allow override buffer size via system property
+  auto snooz_buffer_size_prop = os::GetSystemProperty(kBtSnoozBufferSizeProperty);
+  if (snooz_buffer_size_prop) {
+    auto snooz_buffer_size_number = common::Uint64FromString(snooz_buffer_size_prop.value());
+    if (snooz_buffer_size_number) {
+      btsnooz_max_memory_usage_bytes = snooz_buffer_size_number.value();
+    }
+  }
+  return btsnooz_max_memory_usage_bytes;
 }
 
 std::string SnoopLogger::GetBtSnoopMode() {
@@ -1447,6 +1516,10 @@ bool SnoopLogger::IsBtSnoopLogPersisted() {
   return is_debuggable && os::GetSystemPropertyBool(kBtSnoopLogPersists, false);
 }
 
+bool SnoopLogger::IsBtSnoopAsyncWriterEnabled() {
+  return os::GetSystemPropertyBool(kBtSnoopAsyncWriterProperty, false);
+}
+
 bool SnoopLogger::IsQualcommDebugLogEnabled() {
   // Check system prop if the soc manufacturer is Qualcomm
   bool qualcomm_debug_log_enabled = false;
@@ -1463,12 +1536,13 @@ const ModuleFactory SnoopLogger::Factory = ModuleFactory([]() {
       os::ParameterProvider::SnoopLogFilePath(),
       os::ParameterProvider::SnoozLogFilePath(),
       GetMaxPacketsPerFile(),
-      GetMaxPacketsPerBuffer(),
+      GetSnoozBufferSize(),
       GetBtSnoopMode(),
       IsQualcommDebugLogEnabled(),
       kBtSnoozLogLifeTime,
       kBtSnoozLogDeleteRepeatingAlarmInterval,
-      IsBtSnoopLogPersisted());
+      IsBtSnoopLogPersisted(),
+      IsBtSnoopAsyncWriterEnabled());
 });
 
 }  // namespace hal
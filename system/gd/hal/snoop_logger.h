@@ -23,8 +23,9 @@
 #include <unordered_map>
 #include <unordered_set>
 
-#include "common/circular_buffer.h"
 #include "hal/hci_hal.h"
+#include "hal/snoop_logger_async_writer.h"
+#include "hal/snoop_logger_snooz_buffer.h"
 #include "hal/snoop_logger_socket_thread.h"
 #include "hal/syscall_wrapper_impl.h"
 #include "module.h"
@@ -142,9 +143,11 @@ class SnoopLogger : public ::bluetooth::Module {
   static const ModuleFactory Factory;
 
   static const std::string kBtSnoopMaxPacketsPerFileProperty;
+  static const std::string kBtSnoozBufferSizeProperty;
   static const std::string kIsDebuggableProperty;
   static const std::string kBtSnoopLogModeProperty;
   static const std::string kBtSnoopLogPersists;
+  static const std::string kBtSnoopAsyncWriterProperty;
   static const std::string kBtSnoopDefaultLogModeProperty;
   static const std::string kBtSnoopLogFilterHeadersProperty;
   static const std::string kBtSnoopLogFilterProfileA2dpProperty;
@@ -194,7 +197,9 @@ class SnoopLogger : public ::bluetooth::Module {
   // Changes to this value is only effective after restarting Bluetooth
   static size_t GetMaxPacketsPerFile();
 
-  static size_t GetMaxPacketsPerBuffer();
+  // Returns the size in bytes of the in-memory btsnooz log
+  // Changes to this value is only effective after restarting Bluetooth
+  static size_t GetSnoozBufferSize();
 
   // Get snoop logger mode based on current system setup
   // Changes to this values is only effective after restarting Bluetooth
@@ -207,6 +212,10 @@ class SnoopLogger : public ::bluetooth::Module {
   // Returns whether snoop log persists even after restarting Bluetooth
   static bool IsBtSnoopLogPersisted();
 
+  // Returns whether btsnoop records are written to file by a dedicated thread instead of on the capturing thread
+  // Changes to this value is only effective after restarting Bluetooth
+  static bool IsBtSnoopAsyncWriterEnabled();
+
   // Has to be defined from 1 to 4 per btsnoop format
   enum PacketType {
     CMD = 1,
@@ -221,7 +230,10 @@ class SnoopLogger : public ::bluetooth::Module {
     OUTGOING,
   };
 
-  void Capture(HciPacket& packet, Direction direction, PacketType type);
+  void Capture(const HciPacket& packet, Direction direction, PacketType type);
+
+  // Same as above, for HALs that keep transport headroom in front of the HCI packet.
+  void Capture(const uint8_t* packet, size_t length, Direction direction, PacketType type);
 
   // Set a L2CAP channel as acceptlisted, allowing packets with that L2CAP CID
   // to show up in the snoop logs.
@@ -283,15 +295,18 @@ class SnoopLogger : public ::bluetooth::Module {
       std::string snoop_log_path,
       std::string snooz_log_path,
       size_t max_packets_per_file,
-      size_t max_packets_per_buffer,
+      size_t snooz_buffer_size,
       const std::string& btsnoop_mode,
       bool qualcomm_debug_log_enabled,
       const std::chrono::milliseconds snooz_log_life_time,
       const std::chrono::milliseconds snooz_log_delete_alarm_interval,
-      bool snoop_log_persists);
+      bool snoop_log_persists,
+      bool async_writer = false);
   void CloseCurrentSnoopLogFile();
   void OpenNextSnoopLogFile();
-  void DumpSnoozLogToFile(const std::vector<std::string>& data) const;
+  // Same as OpenNextSnoopLogFile, but returns the new file as a descriptor for the async writer
+  int OpenNextSnoopLogFd();
+  void DumpSnoozLogToFile(const std::vector<uint8_t>& data) const;
   // Enable filters according to their sysprops
   void EnableFilters();
   // Disable all filters
@@ -324,8 +339,11 @@ class SnoopLogger : public ::bluetooth::Module {
       uint16_t l2cap_channel,
       uint32_t& offset,
       uint32_t total_length);
+  // May point |packet| at a filtered copy held in |scratch|; the caller's buffer is never modified.
   void FilterCapturedPacket(
-      HciPacket& packet,
+      const uint8_t*& packet,
+      size_t packet_size,
+      HciPacket& scratch,
       Direction direction,
       PacketType type,
       uint32_t& length,
@@ -339,7 +357,7 @@ class SnoopLogger : public ::bluetooth::Module {
   std::string snooz_log_path_;
   std::ofstream btsnoop_ostream_;
   size_t max_packets_per_file_;
-  common::CircularBuffer<std::string> btsnooz_buffer_;
+  SnoozBuffer btsnooz_buffer_;
   bool qualcomm_debug_log_enabled_ = false;
   size_t packet_counter_ = 0;
   mutable std::recursive_mutex file_mutex_;
@@ -349,6 +367,11 @@ class SnoopLogger : public ::bluetooth::Module {
   SnoopLoggerSocketInterface* socket_;
   SyscallWrapperImpl syscall_if;
   bool snoop_log_persists = false;
+  bool async_writer_enabled_ = false;
+  std::unique_ptr<SnoopLoggerAsyncWriter> async_writer_;
+
+  // Renames the current snoop log file, if any, to its ".last" path
+  void MoveCurrentSnoopLogFileToLast();
 };
 
 }  // namespace hal
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_logger_async_writer.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace hal {
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+SnoopLoggerAsyncWriter::SnoopLoggerAsyncWriter(
+    size_t ring_size, size_t max_records_per_file, std::function<int()> open_next_file)
+    : ring_size_(RoundUpToPowerOfTwo(std::max<size_t>(ring_size, 2))),
+      mask_(ring_size_ - 1),
+      max_records_per_file_(std::max<size_t>(max_records_per_file, 1)),
+      open_next_file_(std::move(open_next_file)),
+      ring_(new Record[ring_size_]) {
+  for (size_t i = 0; i < ring_size_; i++) {
+    ring_[i].sequence.store(i, std::memory_order_relaxed);
+    ring_[i].data.reserve(kRecordReserveBytes);
+  }
+}
+
+SnoopLoggerAsyncWriter::~SnoopLoggerAsyncWriter() {
+  Stop();
+}
+
+void SnoopLoggerAsyncWriter::Start() {
+  ASSERT(!writer_thread_.joinable());
+  stop_.store(false);
+  RotateFile();
+  writer_thread_ = std::thread(&SnoopLoggerAsyncWriter::Run, this);
+}
+
+void SnoopLoggerAsyncWriter::Stop() {
+  if (!writer_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(wakeup_mutex_);
+    stop_.store(true);
+  }
+  wakeup_.notify_one();
+  writer_thread_.join();
+  if (fd_ != -1) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool SnoopLoggerAsyncWriter::Enqueue(
+    const void* header, size_t header_length, const void* payload, size_t payload_length) {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Record* record;
+  while (true) {
+    record = &ring_[pos & mask_];
+    size_t sequence = record->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      dropped_records_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  auto header_bytes = static_cast<const uint8_t*>(header);
+  auto payload_bytes = static_cast<const uint8_t*>(payload);
+  record->data.assign(header_bytes, header_bytes + header_length);
+  record->data.insert(record->data.end(), payload_bytes, payload_bytes + payload_length);
+  record->sequence.store(pos + 1, std::memory_order_release);
+
+  // Let records accumulate into batches; only wake the writer early once the ring is half full.
+  if (pos - dequeue_pos_.load(std::memory_order_relaxed) >= ring_size_ / 2 &&
+      writer_sleeping_.load(std::memory_order_relaxed)) {
+    wakeup_.notify_one();
+  }
+  return true;
+}
+
+void SnoopLoggerAsyncWriter::Run() {
+  while (true) {
+    bool stopping = stop_.load();
+    if (WriteBatch() != 0) {
+      continue;
+    }
+    if (stopping) {
+      break;
+    }
+    std::unique_lock<std::mutex> lock(wakeup_mutex_);
+    writer_sleeping_.store(true);
+    wakeup_.wait_for(lock, kFlushInterval, [this]() { return stop_.load(); });
+    writer_sleeping_.store(false);
+  }
+}
+
+size_t SnoopLoggerAsyncWriter::WriteBatch() {
+  if (records_in_file_ >= max_records_per_file_) {
+    RotateFile();
+  }
+
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  size_t limit = std::min(kMaxRecordsPerBatch, max_records_per_file_ - records_in_file_);
+  struct iovec iov[kMaxRecordsPerBatch];
+  size_t count = 0;
+  while (count < limit) {
+    Record& record = ring_[(pos + count) & mask_];
+    if (record.sequence.load(std::memory_order_acquire) != pos + count + 1) {
+      break;
+    }
+    iov[count].iov_base = record.data.data();
+    iov[count].iov_len = record.data.size();
+    count++;
+  }
+  if (count == 0) {
+    return 0;
+  }
+
+  if (fd_ != -1 && !WriteFully(iov, count)) {
+    LOG_ERROR("Failed to write %zu btsnoop records, error: \"%s\"", count, strerror(errno));
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    ring_[(pos + i) & mask_].sequence.store(pos + i + ring_size_, std::memory_order_release);
+  }
+  dequeue_pos_.store(pos + count, std::memory_order_relaxed);
+  records_in_file_ += count;
+  written_records_.fetch_add(count, std::memory_order_relaxed);
+  return count;
+}
+
+void SnoopLoggerAsyncWriter::RotateFile() {
+  if (fd_ != -1) {
+    ::close(fd_);
+  }
+  fd_ = open_next_file_();
+  records_in_file_ = 0;
+}
+
+bool SnoopLoggerAsyncWriter::WriteFully(struct iovec* iov, int iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t written = ::writev(fd_, iov, iovcnt);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    // Skip the fully written buffers and adjust the partially written one
+    size_t remaining = written;
+    while (iovcnt > 0 && remaining >= iov->iov_len) {
+      remaining -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + remaining;
+      iov->iov_len -= remaining;
+    }
+  }
+  return true;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
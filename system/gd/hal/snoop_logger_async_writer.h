@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+
+// Moves btsnoop records off the HCI data path. Enqueue() copies a record into a bounded ring without taking a lock
+// or touching the file; a dedicated thread drains the ring in batches with writev() and rotates the log file after
+// |max_records_per_file| records. Records that do not fit in the ring are dropped and counted.
+class SnoopLoggerAsyncWriter {
+ public:
+  static constexpr size_t kDefaultRingSize = 1024;
+  // Records up to this size are copied into preallocated storage.
+  static constexpr size_t kRecordReserveBytes = 1056;
+  // Upper bound on the time a record stays in the ring when the log is mostly idle.
+  static constexpr std::chrono::milliseconds kFlushInterval = std::chrono::milliseconds(20);
+
+  // |open_next_file| is called on Start() and whenever a file is full. It must rotate the previous file and return a
+  // file descriptor positioned after the btsnoop file header. The writer owns and closes the returned descriptor.
+  SnoopLoggerAsyncWriter(size_t ring_size, size_t max_records_per_file, std::function<int()> open_next_file);
+  SnoopLoggerAsyncWriter(const SnoopLoggerAsyncWriter&) = delete;
+  SnoopLoggerAsyncWriter& operator=(const SnoopLoggerAsyncWriter&) = delete;
+  ~SnoopLoggerAsyncWriter();
+
+  void Start();
+
+  // Writes every enqueued record and closes the file. Must not be called concurrently with Enqueue().
+  void Stop();
+
+  // Appends a record made of |header| followed by |payload|. Safe to call from multiple threads.
+  // Returns false if the ring is full and the record was dropped.
+  bool Enqueue(const void* header, size_t header_length, const void* payload, size_t payload_length);
+
+  size_t GetWrittenRecords() const {
+    return written_records_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetDroppedRecords() const {
+    return dropped_records_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t kMaxRecordsPerBatch = 64;
+
+  struct Record {
+    std::atomic<size_t> sequence;
+    std::vector<uint8_t> data;
+  };
+
+  void Run();
+  // Writes the records that are ready, up to one batch. Returns the number of records consumed.
+  size_t WriteBatch();
+  void RotateFile();
+  bool WriteFully(struct iovec* iov, int iovcnt);
+
+  const size_t ring_size_;
+  const size_t mask_;
+  const size_t max_records_per_file_;
+  std::function<int()> open_next_file_;
+  std::unique_ptr<Record[]> ring_;
+
+  std::atomic<size_t> enqueue_pos_{0};
+  std::atomic<size_t> dequeue_pos_{0};
+  std::atomic<size_t> written_records_{0};
+  std::atomic<size_t> dropped_records_{0};
+
+  std::thread writer_thread_;
+  std::mutex wakeup_mutex_;
+  std::condition_variable wakeup_;
+  std::atomic<bool> writer_sleeping_{false};
+  std::atomic<bool> stop_{false};
+
+  // Only accessed by the writer thread once started
+  int fd_ = -1;
+  size_t records_in_file_ = 0;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_logger_async_writer.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+constexpr uint8_t kHeader[] = {'h', 'd', 'r'};
+
+class SnoopLoggerAsyncWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const testing::TestInfo* const test_info = testing::UnitTest::GetInstance()->current_test_info();
+    base_path_ = std::filesystem::temp_directory_path() / (std::string(test_info->name()) + "_btsnoop");
+  }
+
+  void TearDown() override {
+    for (const auto& path : files_) {
+      std::filesystem::remove(path);
+    }
+  }
+
+  int OpenNextFile() {
+    files_.push_back(base_path_.string() + "." + std::to_string(files_.size()));
+    return open(files_.back().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  }
+
+  std::vector<uint8_t> ReadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  static std::vector<uint8_t> Record(uint8_t value) {
+    std::vector<uint8_t> record(std::begin(kHeader), std::end(kHeader));
+    record.insert(record.end(), value % 16 + 1, value);
+    return record;
+  }
+
+  bool Enqueue(SnoopLoggerAsyncWriter& writer, uint8_t value) {
+    std::vector<uint8_t> payload(value % 16 + 1, value);
+    return writer.Enqueue(kHeader, sizeof(kHeader), payload.data(), payload.size());
+  }
+
+  std::filesystem::path base_path_;
+  std::vector<std::string> files_;
+};
+
+TEST_F(SnoopLoggerAsyncWriterTest, writes_records_in_order) {
+  SnoopLoggerAsyncWriter writer(256, 1000, [this]() { return OpenNextFile(); });
+  writer.Start();
+  std::vector<uint8_t> expected;
+  for (int i = 0; i < 200; i++) {
+    ASSERT_TRUE(Enqueue(writer, i));
+    auto record = Record(i);
+    expected.insert(expected.end(), record.begin(), record.end());
+  }
+  writer.Stop();
+
+  ASSERT_EQ(1u, files_.size());
+  ASSERT_EQ(expected, ReadFile(files_[0]));
+  ASSERT_EQ(200u, writer.GetWrittenRecords());
+  ASSERT_EQ(0u, writer.GetDroppedRecords());
+}
+
+TEST_F(SnoopLoggerAsyncWriterTest, rotates_after_max_records_per_file) {
+  SnoopLoggerAsyncWriter writer(64, 10, [this]() { return OpenNextFile(); });
+  writer.Start();
+  for (int i = 0; i < 25; i++) {
+    ASSERT_TRUE(Enqueue(writer, i));
+  }
+  writer.Stop();
+
+  ASSERT_EQ(3u, files_.size());
+  for (size_t file = 0; file < files_.size(); file++) {
+    std::vector<uint8_t> expected;
+    for (size_t i = file * 10; i < std::min<size_t>(25, (file + 1) * 10); i++) {
+      auto record = Record(i);
+      expected.insert(expected.end(), record.begin(), record.end());
+    }
+    ASSERT_EQ(expected, ReadFile(files_[file]));
+  }
+}
+
+TEST_F(SnoopLoggerAsyncWriterTest, drops_records_when_ring_is_full) {
+  SnoopLoggerAsyncWriter writer(4, 1000, [this]() { return OpenNextFile(); });
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(Enqueue(writer, i));
+  }
+  ASSERT_FALSE(Enqueue(writer, 4));
+  ASSERT_EQ(1u, writer.GetDroppedRecords());
+
+  writer.Start();
+  writer.Stop();
+  ASSERT_EQ(4u, writer.GetWrittenRecords());
+  ASSERT_EQ(1u, files_.size());
+}
+
+TEST_F(SnoopLoggerAsyncWriterTest, concurrent_producers) {
+  constexpr int kProducers = 4;
+  constexpr int kRecordsPerProducer = 5000;
+  SnoopLoggerAsyncWriter writer(64, kProducers * kRecordsPerProducer, [this]() { return OpenNextFile(); });
+  writer.Start();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([this, &writer, p]() {
+      for (int i = 0; i < kRecordsPerProducer; i++) {
+        Enqueue(writer, p);
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  writer.Stop();
+
+  ASSERT_EQ(
+      static_cast<size_t>(kProducers * kRecordsPerProducer), writer.GetWrittenRecords() + writer.GetDroppedRecords());
+
+  // Every record must be intact, whatever the interleaving
+  auto contents = ReadFile(files_[0]);
+  size_t offset = 0;
+  size_t records = 0;
+  while (offset < contents.size()) {
+    ASSERT_LE(offset + sizeof(kHeader) + 1, contents.size());
+    uint8_t value = contents[offset + sizeof(kHeader)];
+    auto record = Record(value);
+    ASSERT_TRUE(std::equal(record.begin(), record.end(), contents.begin() + offset));
+    offset += record.size();
+    records++;
+  }
+  ASSERT_EQ(writer.GetWrittenRecords(), records);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
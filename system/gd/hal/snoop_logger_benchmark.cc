@@ -0,0 +1,83 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hal/snoop_logger.h"
+#include "module.h"
+
+using ::benchmark::State;
+using ::bluetooth::TestModuleRegistry;
+using ::bluetooth::hal::HciPacket;
+using ::bluetooth::hal::SnoopLogger;
+using namespace std::chrono_literals;
+
+namespace {
+
+enum CaptureMode { kSnoozOnly, kFullSync, kFullAsync };
+
+// Expose protected constructor for benchmark
+class BenchmarkSnoopLogger : public SnoopLogger {
+ public:
+  BenchmarkSnoopLogger(std::string snoop_log_path, std::string snooz_log_path, CaptureMode mode)
+      : SnoopLogger(
+            std::move(snoop_log_path),
+            std::move(snooz_log_path),
+            SnoopLogger::GetMaxPacketsPerFile(),
+            SnoopLogger::GetSnoozBufferSize(),
+            mode == kSnoozOnly ? SnoopLogger::kBtSnoopLogModeDisabled : SnoopLogger::kBtSnoopLogModeFull,
+            false,
+            1h,
+            1h,
+            false,
+            mode == kFullAsync) {}
+};
+
+void BM_SnoopLoggerCapture(State& state) {
+  auto mode = static_cast<CaptureMode>(state.range(0));
+  const auto temp_dir = std::filesystem::temp_directory_path();
+  const auto snoop_log = temp_dir / "snoop_logger_benchmark_btsnoop_hci.log";
+  const auto snooz_log = temp_dir / "snoop_logger_benchmark_btsnooz_hci.log";
+
+  TestModuleRegistry registry;
+  auto* snoop_logger = new BenchmarkSnoopLogger(snoop_log.string(), snooz_log.string(), mode);
+  registry.InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  // ACL packet on a dynamic L2CAP channel with |range(1)| bytes of payload
+  size_t payload_size = state.range(1);
+  HciPacket packet = {0x40, 0x20, static_cast<uint8_t>(payload_size + 4), static_cast<uint8_t>((payload_size + 4) >> 8),
+                      static_cast<uint8_t>(payload_size), static_cast<uint8_t>(payload_size >> 8), 0x41, 0x00};
+  packet.resize(packet.size() + payload_size, 0x5a);
+
+  for (auto _ : state) {
+    snoop_logger->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * packet.size());
+
+  registry.StopAll();
+  std::filesystem::remove(snoop_log);
+  std::filesystem::remove(snoop_log.string() + ".last");
+  std::filesystem::remove(snooz_log);
+  std::filesystem::remove(snooz_log.string() + ".last");
+}
+BENCHMARK(BM_SnoopLoggerCapture)
+    ->ArgNames({"mode", "payload"})
+    ->ArgsProduct({{kSnoozOnly, kFullSync, kFullAsync}, {27, 1017}});
+
+}  // namespace
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_logger_snooz_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace bluetooth {
+namespace hal {
+
+SnoozBuffer::SnoozBuffer(size_t capacity_bytes) : capacity_(capacity_bytes), arena_(new uint8_t[capacity_bytes]) {}
+
+void SnoozBuffer::Push(const void* header, size_t header_length, const void* payload, size_t payload_length) {
+  size_t record_length = header_length + payload_length;
+  size_t needed = sizeof(LengthType) + record_length;
+  if (record_length > std::numeric_limits<LengthType>::max() || needed > capacity_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (capacity_ - used_ < needed) {
+    size_t evicted = sizeof(LengthType) + ReadLength(head_);
+    head_ = (head_ + evicted) % capacity_;
+    used_ -= evicted;
+    num_records_--;
+  }
+
+  size_t tail = (head_ + used_) % capacity_;
+  LengthType length = static_cast<LengthType>(record_length);
+  CopyIn(tail, &length, sizeof(length));
+  CopyIn((tail + sizeof(length)) % capacity_, header, header_length);
+  CopyIn((tail + sizeof(length) + header_length) % capacity_, payload, payload_length);
+  used_ += needed;
+  num_records_++;
+}
+
+std::vector<uint8_t> SnoozBuffer::Pull() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<uint8_t> records(used_ - num_records_ * sizeof(LengthType));
+  size_t offset = head_;
+  size_t out = 0;
+  for (size_t i = 0; i < num_records_; i++) {
+    LengthType length = ReadLength(offset);
+    CopyOut((offset + sizeof(length)) % capacity_, records.data() + out, length);
+    offset = (offset + sizeof(length) + length) % capacity_;
+    out += length;
+  }
+  return records;
+}
+
+void SnoozBuffer::CopyIn(size_t offset, const void* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  size_t first = std::min(length, capacity_ - offset);
+  std::memcpy(arena_.get() + offset, data, first);
+  std::memcpy(arena_.get(), static_cast<const uint8_t*>(data) + first, length - first);
+}
+
+void SnoozBuffer::CopyOut(size_t offset, void* data, size_t length) const {
+  size_t first = std::min(length, capacity_ - offset);
+  std::memcpy(data, arena_.get() + offset, first);
+  std::memcpy(static_cast<uint8_t*>(data) + first, arena_.get(), length - first);
+}
+
+SnoozBuffer::LengthType SnoozBuffer::ReadLength(size_t offset) const {
+  LengthType length;
+  CopyOut(offset, &length, sizeof(length));
+  return length;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+
+// In-memory btsnooz log. Records are stored back to back in a fixed size byte arena, each preceded by a 16 bit
+// length, so pushing a record never allocates. The oldest records are evicted to make room for new ones.
+class SnoozBuffer {
+ public:
+  explicit SnoozBuffer(size_t capacity_bytes);
+  SnoozBuffer(const SnoozBuffer&) = delete;
+  SnoozBuffer& operator=(const SnoozBuffer&) = delete;
+
+  // Appends a record made of |header| followed by |payload|. Records that can never fit are dropped.
+  void Push(const void* header, size_t header_length, const void* payload, size_t payload_length);
+
+  // Returns the stored records, oldest first, concatenated without their length prefixes.
+  std::vector<uint8_t> Pull() const;
+
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
+ private:
+  using LengthType = uint16_t;
+
+  void CopyIn(size_t offset, const void* data, size_t length);
+  void CopyOut(size_t offset, void* data, size_t length) const;
+  LengthType ReadLength(size_t offset) const;
+
+  const size_t capacity_;
+  std::unique_ptr<uint8_t[]> arena_;
+  size_t head_ = 0;
+  size_t used_ = 0;
+  size_t num_records_ = 0;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_logger_snooz_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+constexpr uint8_t kHeader[] = {0xaa, 0xbb};
+
+std::vector<uint8_t> Record(uint8_t value, size_t payload_length) {
+  std::vector<uint8_t> record(std::begin(kHeader), std::end(kHeader));
+  record.insert(record.end(), payload_length, value);
+  return record;
+}
+
+void Push(SnoozBuffer& buffer, uint8_t value, size_t payload_length) {
+  std::vector<uint8_t> payload(payload_length, value);
+  buffer.Push(kHeader, sizeof(kHeader), payload.data(), payload.size());
+}
+
+void Append(std::vector<uint8_t>& data, const std::vector<uint8_t>& record) {
+  data.insert(data.end(), record.begin(), record.end());
+}
+
+TEST(SnoozBufferTest, empty) {
+  SnoozBuffer buffer(64);
+  ASSERT_TRUE(buffer.Pull().empty());
+}
+
+TEST(SnoozBufferTest, keeps_records_in_order) {
+  SnoozBuffer buffer(64);
+  Push(buffer, 1, 3);
+  Push(buffer, 2, 0);
+  Push(buffer, 3, 5);
+
+  std::vector<uint8_t> expected;
+  Append(expected, Record(1, 3));
+  Append(expected, Record(2, 0));
+  Append(expected, Record(3, 5));
+  ASSERT_EQ(expected, buffer.Pull());
+}
+
+TEST(SnoozBufferTest, evicts_oldest_records_and_wraps) {
+  // Each record takes 2 bytes of length, 2 bytes of header and 6 bytes of payload
+  SnoozBuffer buffer(25);
+  for (uint8_t i = 0; i < 10; i++) {
+    Push(buffer, i, 6);
+  }
+
+  std::vector<uint8_t> expected;
+  Append(expected, Record(8, 6));
+  Append(expected, Record(9, 6));
+  ASSERT_EQ(expected, buffer.Pull());
+
+  // A larger record evicts as many old records as needed
+  Push(buffer, 10, 14);
+  ASSERT_EQ(Record(10, 14), buffer.Pull());
+}
+
+TEST(SnoozBufferTest, drops_records_larger_than_buffer) {
+  SnoozBuffer buffer(16);
+  Push(buffer, 1, 4);
+  Push(buffer, 2, 13);
+  ASSERT_EQ(Record(1, 4), buffer.Pull());
+}
+
+TEST(SnoozBufferTest, random_sizes_match_reference) {
+  constexpr size_t kCapacity = 1000;
+  SnoozBuffer buffer(kCapacity);
+  std::vector<std::vector<uint8_t>> reference;
+  size_t reference_bytes = 0;
+  for (size_t i = 0; i < 2000; i++) {
+    size_t payload_length = (i * 37) % 150;
+    Push(buffer, static_cast<uint8_t>(i), payload_length);
+    reference.push_back(Record(static_cast<uint8_t>(i), payload_length));
+    reference_bytes += reference.back().size() + sizeof(uint16_t);
+    while (reference_bytes > kCapacity) {
+      reference_bytes -= reference.front().size() + sizeof(uint16_t);
+      reference.erase(reference.begin());
+    }
+
+    std::vector<uint8_t> expected;
+    for (const auto& record : reference) {
+      Append(expected, record);
+    }
+    ASSERT_EQ(expected, buffer.Pull()) << "after record " << i;
+  }
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
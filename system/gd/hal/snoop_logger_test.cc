@@ -129,17 +129,19 @@ class TestSnoopLoggerModule : public SnoopLogger {
       size_t max_packets_per_file,
       const std::string& btsnoop_mode,
       bool qualcomm_debug_log_enabled,
-      bool snoop_log_persists)
+      bool snoop_log_persists,
+      bool async_writer = false)
       : SnoopLogger(
             std::move(snoop_log_path),
             std::move(snooz_log_path),
             max_packets_per_file,
-            SnoopLogger::GetMaxPacketsPerBuffer(),
+            SnoopLogger::GetSnoozBufferSize(),
             btsnoop_mode,
             qualcomm_debug_log_enabled,
             20ms,
             5ms,
-            snoop_log_persists) {}
+            snoop_log_persists,
+            async_writer) {}
 
   std::string ToString() const override {
     return std::string("TestSnoopLoggerModule");
@@ -553,6 +555,64 @@ TEST_F(SnoopLoggerModuleTest, rotate_file_after_full_test) {
           (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 10);
 }
 
+TEST_F(SnoopLoggerModuleTest, async_writer_capture_packets_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(),
+      temp_snooz_log_.string(),
+      100,
+      SnoopLogger::kBtSnoopLogModeFull,
+      false,
+      false,
+      true);
+  test_registry->InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  for (int i = 0; i < 3; i++) {
+    snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  }
+
+  test_registry->StopAll();
+
+  // Verify states after test
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_));
+  ASSERT_FALSE(std::filesystem::exists(temp_snoop_log_last_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_),
+      sizeof(SnoopLoggerCommon::FileHeaderType) +
+          (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 3);
+}
+
+TEST_F(SnoopLoggerModuleTest, async_writer_rotate_file_after_full_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(),
+      temp_snooz_log_.string(),
+      10,
+      SnoopLogger::kBtSnoopLogModeFull,
+      false,
+      false,
+      true);
+  test_registry->InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  for (int i = 0; i < 11; i++) {
+    snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  }
+
+  test_registry->StopAll();
+
+  // Verify states after test
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_));
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_last_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_),
+      sizeof(SnoopLoggerCommon::FileHeaderType) +
+          (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 1);
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_last_),
+      sizeof(SnoopLoggerCommon::FileHeaderType) +
+          (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 10);
+}
+
 TEST_F(SnoopLoggerModuleTest, qualcomm_debug_log_test) {
   auto* snoop_logger = new TestSnoopLoggerModule(
       temp_snoop_log_.string(),
@@ -417,6 +417,10 @@ void AclManager::HACK_SetNonAclDisconnectCallback(std::function<void(uint16_t, u
   pimpl_->classic_impl_->HACK_SetNonAclDisconnectCallback(callback);
 }
 
+void AclManager::SetAclTxQos(uint16_t handle, acl_manager::LatencyClass latency_class, uint8_t weight) {
+  CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetLinkQos, handle, latency_class, weight);
+}
+
 void AclManager::HACK_SetAclTxPriority(uint8_t handle, bool high_priority) {
   CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetLinkPriority, handle, high_priority);
 }
@@ -23,6 +23,7 @@
 #include "common/bidi_queue.h"
 #include "common/callback.h"
 #include "hci/acl_manager/connection_callbacks.h"
+#include "hci/acl_manager/deficit_round_robin.h"
 #include "hci/acl_manager/le_acceptlist_callbacks.h"
 #include "hci/acl_manager/le_connection_callbacks.h"
 #include "hci/address.h"
@@ -131,6 +132,10 @@ public:
  virtual uint16_t ReadDefaultLinkPolicySettings();
  virtual void WriteDefaultLinkPolicySettings(uint16_t default_link_policy_settings);
 
+ // Schedules the outgoing data of a connection ahead of the connections of a lower latency class, and gives it a share
+ // of the controller buffers in proportion to |weight| among the connections of its class.
+ virtual void SetAclTxQos(uint16_t handle, acl_manager::LatencyClass latency_class, uint8_t weight);
+
  // Callback from Advertising Manager to notify the advitiser (local) address
  virtual void OnAdvertisingSetTerminated(
      ErrorCode status,
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/acl_manager/acl_fragmenter.h"
+#include "hci/hci_packets.h"
+#include "l2cap/l2cap_packets.h"
+#include "packet/bit_inserter.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::AclBuilder;
+using ::bluetooth::hci::BroadcastFlag;
+using ::bluetooth::hci::PacketBoundaryFlag;
+using ::bluetooth::hci::acl_manager::AclFragmenter;
+using ::bluetooth::l2cap::BasicFrameBuilder;
+using ::bluetooth::packet::BitInserter;
+using ::bluetooth::packet::RawBuilder;
+
+namespace {
+
+constexpr uint16_t kHandle = 0x040;
+constexpr uint16_t kCid = 0x0041;
+constexpr size_t kAclMtu = 1021;
+constexpr uint8_t kH4Acl = 0x02;
+constexpr size_t kH4HeaderSize = 1;
+
+std::unique_ptr<AclBuilder> MakeAclFragment(std::unique_ptr<RawBuilder> fragment, bool first) {
+  return AclBuilder::Create(
+      kHandle,
+      first ? PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE : PacketBoundaryFlag::CONTINUING_FRAGMENT,
+      BroadcastFlag::POINT_TO_POINT,
+      std::move(fragment));
+}
+
+// Fragments an L2CAP basic frame carrying |sdu| and hands every H4 framed fragment to |send|, the way
+// RoundRobinScheduler, HciLayer and HciHalHost do.
+template <typename Serializer, typename Sender>
+size_t SendSdu(const std::vector<uint8_t>& sdu, Serializer serialize, Sender send) {
+  auto frame = BasicFrameBuilder::Create(kCid, std::make_unique<RawBuilder>(sdu));
+  auto fragments = AclFragmenter(kAclMtu, std::move(frame)).GetFragments();
+  size_t bytes = 0;
+  for (size_t i = 0; i < fragments.size(); i++) {
+    auto acl = MakeAclFragment(std::move(fragments[i]), i == 0);
+    std::vector<uint8_t> packet = serialize(*acl);
+    bytes += packet.size();
+    send(std::move(packet));
+  }
+  return bytes;
+}
+
+// Serialize into an unreserved vector, then prepend the H4 packet type.
+void BM_SerializeAclGrowAndPrepend(State& state) {
+  std::vector<uint8_t> sdu(state.range(0), 0x5a);
+  size_t bytes = 0;
+  for (auto _ : state) {
+    bytes += SendSdu(
+        sdu,
+        [](const AclBuilder& acl) {
+          std::vector<uint8_t> packet;
+          BitInserter it(packet);
+          acl.Serialize(it);
+          packet.insert(packet.cbegin(), kH4Acl);
+          return packet;
+        },
+        [](std::vector<uint8_t> packet) { benchmark::DoNotOptimize(packet.data()); });
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_SerializeAclGrowAndPrepend)->Arg(64)->Arg(1000)->Arg(8000)->Arg(65000);
+
+// Serialize once into a buffer sized upfront, writing the H4 packet type into the headroom.
+void BM_SerializeAclWithHeadroom(State& state) {
+  std::vector<uint8_t> sdu(state.range(0), 0x5a);
+  size_t bytes = 0;
+  for (auto _ : state) {
+    bytes += SendSdu(
+        sdu,
+        [](const AclBuilder& acl) {
+          std::vector<uint8_t> packet = acl.SerializeToBytes(kH4HeaderSize);
+          packet[0] = kH4Acl;
+          return packet;
+        },
+        [](std::vector<uint8_t> packet) { benchmark::DoNotOptimize(packet.data()); });
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_SerializeAclWithHeadroom)->Arg(64)->Arg(1000)->Arg(8000)->Arg(65000);
+
+}  // namespace
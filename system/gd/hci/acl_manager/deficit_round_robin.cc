@@ -0,0 +1,123 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/acl_manager/deficit_round_robin.h"
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+void DeficitRoundRobin::Add(uint16_t handle) {
+  ASSERT(links_.count(handle) == 0);
+  links_.emplace(handle, Link{});
+}
+
+void DeficitRoundRobin::Remove(uint16_t handle) {
+  links_.erase(handle);
+}
+
+void DeficitRoundRobin::SetLatencyClass(uint16_t handle, LatencyClass latency_class) {
+  auto link = links_.find(handle);
+  if (link == links_.end()) {
+    LOG_WARN("handle %d is invalid", handle);
+    return;
+  }
+  link->second.latency_class = latency_class;
+}
+
+LatencyClass DeficitRoundRobin::GetLatencyClass(uint16_t handle) const {
+  auto link = links_.find(handle);
+  return link == links_.end() ? LatencyClass::DEFAULT : link->second.latency_class;
+}
+
+void DeficitRoundRobin::SetWeight(uint16_t handle, uint8_t weight) {
+  auto link = links_.find(handle);
+  if (link == links_.end()) {
+    LOG_WARN("handle %d is invalid", handle);
+    return;
+  }
+  if (weight == 0) {
+    LOG_WARN("weight 0 of handle %d is raised to 1", handle);
+    weight = 1;
+  }
+  link->second.weight = weight;
+}
+
+void DeficitRoundRobin::SetNextPacketSize(uint16_t handle, size_t size) {
+  auto link = links_.find(handle);
+  ASSERT(link != links_.end());
+  link->second.next_packet_size = size;
+}
+
+std::optional<uint16_t> DeficitRoundRobin::Select(
+    LatencyClass min_latency_class, const std::function<bool(uint16_t)>& can_send) {
+  for (int latency_class = kNumLatencyClasses - 1; latency_class >= static_cast<int>(min_latency_class);
+       latency_class--) {
+    auto handle = select_in_class(static_cast<LatencyClass>(latency_class), can_send);
+    if (handle.has_value()) {
+      return handle;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<uint16_t> DeficitRoundRobin::select_in_class(
+    LatencyClass latency_class, const std::function<bool(uint16_t)>& can_send) {
+  uint16_t& last = last_[static_cast<int>(latency_class)];
+  uint32_t& round = round_[static_cast<int>(latency_class)];
+  while (true) {
+    // Connections send one packet at a time, in turn from the one after the last to send, while their deficit allows
+    bool any_ready = false;
+    auto it = links_.upper_bound(last);
+    for (size_t i = 0; i < links_.size(); i++, it++) {
+      if (it == links_.end()) {
+        it = links_.begin();
+      }
+      Link& link = it->second;
+      if (link.latency_class != latency_class || link.next_packet_size == 0 || !can_send(it->first)) {
+        continue;
+      }
+      any_ready = true;
+      // The quantum of the round is given on the first turn with a packet, so that a connection which was idle at the
+      // start of the round still gets it
+      if (link.round != round) {
+        link.round = round;
+        size_t quantum = quantum_ * link.weight;
+        // A backlogged connection carries over less than its next packet. One which ran out of packets keeps at most a
+        // quantum, so that it cannot build up credit while sending little, then hold the others back when it turns bulk
+        link.deficit = std::min(link.deficit, std::max(quantum, link.next_packet_size - 1)) + quantum;
+      }
+      if (link.deficit >= link.next_packet_size) {
+        link.deficit -= link.next_packet_size;
+        link.next_packet_size = 0;
+        last = it->first;
+        return it->first;
+      }
+    }
+    if (!any_ready) {
+      return std::nullopt;
+    }
+    round++;
+  }
+}
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+// Latency class of the outgoing ACL data of a connection. Connections of a higher class are always served first, so
+// the classes above DEFAULT are meant for low rate traffic such as HID reports or A2DP.
+enum class LatencyClass : uint8_t {
+  DEFAULT = 0,
+  INTERACTIVE = 1,
+  REAL_TIME = 2,
+};
+
+constexpr int kNumLatencyClasses = 3;
+
+// Chooses the connection which sends the next ACL packet. Within a latency class, each round gives the connections
+// with a packet to send |quantum| bytes times their weight, added to what they did not use of the previous rounds
+// (deficit round robin), and ends when no connection has enough left for its next packet. A connection which ran out
+// of packets carries over at most one quantum. Connections so share the
+// controller in proportion to their weights, counted in bytes rather than in packets. Within a round, connections send
+// one packet at a time in turn, so that small packets are not held behind a burst from another connection.
+class DeficitRoundRobin {
+ public:
+  explicit DeficitRoundRobin(size_t quantum) : quantum_(quantum) {}
+
+  void Add(uint16_t handle);
+  void Remove(uint16_t handle);
+  void SetLatencyClass(uint16_t handle, LatencyClass latency_class);
+  LatencyClass GetLatencyClass(uint16_t handle) const;
+  // Weight of the connection among those of its latency class, at least 1
+  void SetWeight(uint16_t handle, uint8_t weight);
+
+  // Size of the next packet of the connection, or 0 if it has nothing to send
+  void SetNextPacketSize(uint16_t handle, size_t size);
+
+  // Returns the connection which sends its next packet, among those of at least |min_latency_class| that have a
+  // packet and for which |can_send| is true. The packet is charged to the deficit of the connection, and the size of
+  // its next packet is to be set again.
+  std::optional<uint16_t> Select(
+      LatencyClass min_latency_class, const std::function<bool(uint16_t)>& can_send = [](uint16_t) { return true; });
+
+ private:
+  struct Link {
+    LatencyClass latency_class = LatencyClass::DEFAULT;
+    uint8_t weight = 1;
+    size_t next_packet_size = 0;
+    // Bytes the connection may still send in this round
+    size_t deficit = 0;
+    // Last round which gave the connection its quantum
+    uint32_t round = 0;
+  };
+
+  std::optional<uint16_t> select_in_class(LatencyClass latency_class, const std::function<bool(uint16_t)>& can_send);
+
+  size_t quantum_;
+  std::map<uint16_t, Link> links_;
+  // Last connection which sent, in each latency class
+  std::array<uint16_t, kNumLatencyClasses> last_{};
+  // Current round, in each latency class
+  std::array<uint32_t, kNumLatencyClasses> round_{};
+};
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
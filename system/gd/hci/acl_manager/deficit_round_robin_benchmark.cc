@@ -0,0 +1,193 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/acl_manager/deficit_round_robin.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::acl_manager::DeficitRoundRobin;
+using ::bluetooth::hci::acl_manager::LatencyClass;
+
+namespace {
+
+// Simulated controller: 8 ACL buffers, drained over the air at 2 Mbps
+constexpr int kControllerBuffers = 8;
+constexpr int64_t kUsPerByte = 4;
+constexpr int64_t kDurationUs = 10'000'000;
+constexpr size_t kQuantum = 1021;
+
+struct Traffic {
+  const char* name;
+  LatencyClass latency_class;
+  uint8_t weight;
+  size_t packet_size;
+  int64_t period_us;  // 0 for a connection which always has data to send
+};
+
+// HID reports, A2DP media and two bulk transfers (a file transfer and GATT) sharing one controller
+const std::vector<Traffic> kTraffic = {
+    {"hid", LatencyClass::INTERACTIVE, 1, 14, 7'500},
+    {"a2dp", LatencyClass::REAL_TIME, 1, 660, 15'000},
+    {"file", LatencyClass::DEFAULT, 1, 1021, 0},
+    {"gatt", LatencyClass::DEFAULT, 1, 247, 0},
+};
+
+struct Link {
+  Traffic traffic;
+  std::deque<int64_t> arrivals;
+  int64_t next_arrival_us = 0;
+  size_t bytes_sent = 0;
+  std::vector<int64_t> latencies_us;
+};
+
+// Returns the index of the link which sends next, among |links| with a packet waiting
+using Policy = std::function<std::optional<size_t>(const std::vector<Link>&)>;
+
+// Previous scheduling: A2DP first, then one packet per connection in turn, whatever its size
+Policy PerPacketRoundRobin() {
+  return [last = size_t{0}](const std::vector<Link>& links) mutable -> std::optional<size_t> {
+    for (size_t i = 0; i < links.size(); i++) {
+      if (links[i].traffic.latency_class == LatencyClass::REAL_TIME && !links[i].arrivals.empty()) {
+        return i;
+      }
+    }
+    for (size_t i = 1; i <= links.size(); i++) {
+      size_t link = (last + i) % links.size();
+      if (!links[link].arrivals.empty()) {
+        last = link;
+        return link;
+      }
+    }
+    return std::nullopt;
+  };
+}
+
+Policy LatencyClassesAndDeficitRoundRobin() {
+  auto drr = std::make_shared<DeficitRoundRobin>(kQuantum);
+  for (size_t i = 0; i < kTraffic.size(); i++) {
+    drr->Add(i);
+    drr->SetLatencyClass(i, kTraffic[i].latency_class);
+    drr->SetWeight(i, kTraffic[i].weight);
+  }
+  return [drr](const std::vector<Link>& links) -> std::optional<size_t> {
+    for (size_t i = 0; i < links.size(); i++) {
+      drr->SetNextPacketSize(i, links[i].arrivals.empty() ? 0 : links[i].traffic.packet_size);
+    }
+    return drr->Select(LatencyClass::DEFAULT);
+  };
+}
+
+// Runs the connections for kDurationUs, and returns them with what they sent and the time their packets waited for
+// the scheduler.
+std::vector<Link> Simulate(Policy policy) {
+  std::vector<Link> links;
+  for (const auto& traffic : kTraffic) {
+    links.push_back(Link{traffic});
+  }
+  std::deque<int64_t> completions_us;  // Of the packets in the controller buffers
+  int64_t air_free_us = 0;
+  int64_t now_us = 0;
+  while (now_us < kDurationUs) {
+    for (auto& link : links) {
+      if (link.traffic.period_us == 0) {
+        if (link.arrivals.empty()) {
+          link.arrivals.push_back(now_us);
+        }
+        continue;
+      }
+      while (link.next_arrival_us <= now_us) {
+        link.arrivals.push_back(link.next_arrival_us);
+        link.next_arrival_us += link.traffic.period_us;
+      }
+    }
+    while (!completions_us.empty() && completions_us.front() <= now_us) {
+      completions_us.pop_front();
+    }
+    while (completions_us.size() < kControllerBuffers) {
+      auto next = policy(links);
+      if (!next.has_value()) {
+        break;
+      }
+      Link& link = links[*next];
+      link.latencies_us.push_back(now_us - link.arrivals.front());
+      link.arrivals.pop_front();
+      link.bytes_sent += link.traffic.packet_size;
+      air_free_us = std::max(air_free_us, now_us) + link.traffic.packet_size * kUsPerByte;
+      completions_us.push_back(air_free_us);
+      if (link.traffic.period_us == 0) {
+        link.arrivals.push_back(now_us);
+      }
+    }
+
+    int64_t next_us = kDurationUs;
+    if (!completions_us.empty()) {
+      next_us = std::min(next_us, completions_us.front());
+    }
+    for (const auto& link : links) {
+      if (link.traffic.period_us != 0) {
+        next_us = std::min(next_us, link.next_arrival_us);
+      }
+    }
+    now_us = std::max(next_us, now_us + 1);
+  }
+  return links;
+}
+
+double Percentile(std::vector<int64_t> values, double percentile) {
+  if (values.empty()) {
+    return 0;
+  }
+  auto nth = values.begin() + static_cast<size_t>(percentile * (values.size() - 1));
+  std::nth_element(values.begin(), nth, values.end());
+  return *nth;
+}
+
+void RunSimulation(State& state, std::function<Policy()> make_policy) {
+  std::vector<Link> links;
+  for (auto _ : state) {
+    links = Simulate(make_policy());
+  }
+  for (const auto& link : links) {
+    std::string name = link.traffic.name;
+    state.counters[name + "_kBps"] = link.bytes_sent * 1000.0 / kDurationUs;
+    if (link.traffic.period_us != 0) {
+      state.counters[name + "_p50_ms"] = Percentile(link.latencies_us, 0.5) / 1000;
+      state.counters[name + "_p99_ms"] = Percentile(link.latencies_us, 0.99) / 1000;
+    }
+  }
+}
+
+void BM_AclSchedulerPerPacketRoundRobin(State& state) {
+  RunSimulation(state, PerPacketRoundRobin);
+}
+
+void BM_AclSchedulerDeficitRoundRobin(State& state) {
+  RunSimulation(state, LatencyClassesAndDeficitRoundRobin);
+}
+
+BENCHMARK(BM_AclSchedulerPerPacketRoundRobin)->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_AclSchedulerDeficitRoundRobin)->Unit(::benchmark::kMillisecond);
+
+}  // namespace
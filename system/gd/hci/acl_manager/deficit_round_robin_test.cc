@@ -0,0 +1,211 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/acl_manager/deficit_round_robin.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+namespace {
+
+constexpr size_t kQuantum = 1000;
+
+class DeficitRoundRobinTest : public ::testing::Test {
+ protected:
+  // Selects |count| packets while every connection in |packet_sizes| stays backlogged, and returns the bytes sent by
+  // each connection.
+  std::map<uint16_t, size_t> Run(const std::map<uint16_t, size_t>& packet_sizes, size_t count) {
+    for (const auto& [handle, size] : packet_sizes) {
+      drr_.SetNextPacketSize(handle, size);
+    }
+    std::map<uint16_t, size_t> bytes;
+    for (size_t i = 0; i < count; i++) {
+      auto handle = drr_.Select(LatencyClass::DEFAULT);
+      EXPECT_TRUE(handle.has_value());
+      bytes[*handle] += packet_sizes.at(*handle);
+      drr_.SetNextPacketSize(*handle, packet_sizes.at(*handle));
+    }
+    return bytes;
+  }
+
+  DeficitRoundRobin drr_{kQuantum};
+};
+
+TEST_F(DeficitRoundRobinTest, nothing_to_send) {
+  drr_.Add(1);
+  EXPECT_FALSE(drr_.Select(LatencyClass::DEFAULT).has_value());
+}
+
+TEST_F(DeficitRoundRobinTest, connections_take_turns_for_each_packet) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.Add(3);
+  drr_.SetNextPacketSize(1, 10);
+  drr_.SetNextPacketSize(3, 10);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  drr_.SetNextPacketSize(1, 10);
+  drr_.SetNextPacketSize(2, 10);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 2);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 3);
+  drr_.SetNextPacketSize(3, 10);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 3);
+  EXPECT_FALSE(drr_.Select(LatencyClass::DEFAULT).has_value());
+}
+
+TEST_F(DeficitRoundRobinTest, bytes_are_shared_fairly_between_packet_sizes) {
+  drr_.Add(1);
+  drr_.Add(2);
+  auto bytes = Run({{1, 1000}, {2, 100}}, 1100);
+  EXPECT_EQ(bytes[1], 100000u);
+  EXPECT_EQ(bytes[2], 100000u);
+}
+
+TEST_F(DeficitRoundRobinTest, bytes_are_shared_by_weight) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.Add(3);
+  drr_.SetWeight(2, 3);
+  auto bytes = Run({{1, 250}, {2, 250}, {3, 1000}}, 680);
+  // 40 rounds of 17 packets, in which 2 sends 3 times as much as 1 and 3
+  EXPECT_EQ(bytes[1], 40000u);
+  EXPECT_EQ(bytes[2], 120000u);
+  EXPECT_EQ(bytes[3], 40000u);
+}
+
+TEST_F(DeficitRoundRobinTest, packets_larger_than_the_quantum) {
+  drr_.Add(1);
+  drr_.Add(2);
+  auto bytes = Run({{1, 2500}, {2, 500}}, 120);
+  EXPECT_EQ(bytes[1], 50000u);
+  EXPECT_EQ(bytes[2], 50000u);
+}
+
+TEST_F(DeficitRoundRobinTest, higher_latency_class_goes_first) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.SetLatencyClass(2, LatencyClass::REAL_TIME);
+  drr_.SetNextPacketSize(1, 100);
+  drr_.SetNextPacketSize(2, 100);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 2);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  EXPECT_EQ(drr_.GetLatencyClass(2), LatencyClass::REAL_TIME);
+}
+
+TEST_F(DeficitRoundRobinTest, min_latency_class) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.SetLatencyClass(2, LatencyClass::INTERACTIVE);
+  drr_.SetNextPacketSize(1, 100);
+  EXPECT_FALSE(drr_.Select(LatencyClass::INTERACTIVE).has_value());
+  drr_.SetNextPacketSize(2, 100);
+  EXPECT_EQ(drr_.Select(LatencyClass::INTERACTIVE), 2);
+}
+
+TEST_F(DeficitRoundRobinTest, connections_which_cannot_send_are_skipped) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.SetNextPacketSize(1, 100);
+  drr_.SetNextPacketSize(2, 100);
+  auto only_2 = [](uint16_t handle) { return handle == 2; };
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT, only_2), 2);
+  EXPECT_FALSE(drr_.Select(LatencyClass::DEFAULT, only_2).has_value());
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+}
+
+TEST_F(DeficitRoundRobinTest, idle_connection_gets_one_quantum_per_round) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.SetNextPacketSize(1, 600);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  // 1 has 400 bytes left in this round, and does not get another quantum when it has a packet again
+  drr_.SetNextPacketSize(1, 600);
+  drr_.SetNextPacketSize(2, 600);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 2);
+  drr_.SetNextPacketSize(2, 600);
+  // Next round: 1 has 1400 bytes, 2 has 1400
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  drr_.SetNextPacketSize(1, 600);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 2);
+  drr_.SetNextPacketSize(2, 600);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 2);
+
+  // For many rounds, 1 only sends a small packet per round while 2 sends a full one
+  for (int i = 0; i < 100; i++) {
+    drr_.SetNextPacketSize(1, 100);
+    drr_.SetNextPacketSize(2, 1000);
+    auto first = drr_.Select(LatencyClass::DEFAULT);
+    auto second = drr_.Select(LatencyClass::DEFAULT);
+    ASSERT_TRUE(first.has_value() && second.has_value());
+    EXPECT_NE(*first, *second);
+  }
+  // 1 did not build up the quanta it left unused, it kept at most one: it sends one packet more than 2 in the next
+  // round, then they share the bytes evenly
+  drr_.SetNextPacketSize(1, 1000);
+  drr_.SetNextPacketSize(2, 1000);
+  auto bytes = Run({{1, 1000}, {2, 1000}}, 3);
+  EXPECT_EQ(bytes[1], 2000u);
+  EXPECT_EQ(bytes[2], 1000u);
+  bytes = Run({{1, 1000}, {2, 1000}}, 100);
+  EXPECT_EQ(bytes[1], 50000u);
+  EXPECT_EQ(bytes[2], 50000u);
+}
+
+TEST_F(DeficitRoundRobinTest, occasional_sender_turning_bulk_does_not_starve_the_others) {
+  drr_.Add(1);
+  drr_.Add(2);
+  // 1 sends a small packet for every 10 packets of 2
+  for (int i = 0; i < 20000; i++) {
+    if (i % 11 == 0) {
+      drr_.SetNextPacketSize(1, 20);
+    }
+    drr_.SetNextPacketSize(2, 1000);
+    EXPECT_TRUE(drr_.Select(LatencyClass::DEFAULT).has_value());
+  }
+
+  // 1 turns bulk, and 2 gets its turn within a couple of packets
+  drr_.SetNextPacketSize(1, 1000);
+  drr_.SetNextPacketSize(2, 1000);
+  size_t consecutive = 0;
+  while (drr_.Select(LatencyClass::DEFAULT) == 1 && consecutive < 10000) {
+    drr_.SetNextPacketSize(1, 1000);
+    consecutive++;
+  }
+  EXPECT_LE(consecutive, 2u);
+}
+
+TEST_F(DeficitRoundRobinTest, removed_connection) {
+  drr_.Add(1);
+  drr_.Add(2);
+  drr_.SetNextPacketSize(1, 100);
+  drr_.SetNextPacketSize(2, 100);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 1);
+  drr_.Remove(1);
+  EXPECT_EQ(drr_.Select(LatencyClass::DEFAULT), 2);
+  drr_.Remove(2);
+  EXPECT_FALSE(drr_.Select(LatencyClass::DEFAULT).has_value());
+}
+
+}  // namespace
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
@@ -21,9 +21,15 @@ namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+// Bytes a connection of weight 1 may send per turn, about one maximum size packet of BR/EDR controllers
+constexpr size_t kDeficitRoundRobinQuantum = 1021;
+
 RoundRobinScheduler::RoundRobinScheduler(
     os::Handler* handler, Controller* controller, common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end)
-    : handler_(handler), controller_(controller), hci_queue_end_(hci_queue_end) {
+    : handler_(handler),
+      controller_(controller),
+      deficit_round_robin_(kDeficitRoundRobinQuantum),
+      hci_queue_end_(hci_queue_end) {
   max_acl_packet_credits_ = controller_->GetNumAclPacketBuffers();
   acl_packet_credits_ = max_acl_packet_credits_;
   hci_mtu_ = controller_->GetAclPacketLength();
@@ -42,16 +48,17 @@ RoundRobinScheduler::~RoundRobinScheduler() {
 void RoundRobinScheduler::Register(ConnectionType connection_type, uint16_t handle,
                                    std::shared_ptr<acl_manager::AclConnection::Queue> queue) {
   ASSERT(acl_queue_handlers_.count(handle) == 0);
-  acl_queue_handler acl_queue_handler = {connection_type, std::move(queue), false, 0};
-  acl_queue_handlers_.insert(std::pair<uint16_t, RoundRobinScheduler::acl_queue_handler>(handle, acl_queue_handler));
-  if (fragments_to_send_.size() == 0) {
-    start_round_robin();
-  }
+  acl_queue_handler acl_queue_handler;
+  acl_queue_handler.connection_type_ = connection_type;
+  acl_queue_handler.queue_ = std::move(queue);
+  acl_queue_handlers_.emplace(handle, std::move(acl_queue_handler));
+  deficit_round_robin_.Add(handle);
+  register_dequeue(handle);
 }
 
 void RoundRobinScheduler::Unregister(uint16_t handle) {
   ASSERT(acl_queue_handlers_.count(handle) == 1);
-  auto acl_queue_handler = acl_queue_handlers_.find(handle)->second;
+  auto& acl_queue_handler = acl_queue_handlers_.find(handle)->second;
   // Reclaim outstanding packets
   if (acl_queue_handler.connection_type_ == ConnectionType::CLASSIC) {
     acl_packet_credits_ += acl_queue_handler.number_of_sent_packets_;
@@ -65,16 +72,24 @@ void RoundRobinScheduler::Unregister(uint16_t handle) {
     acl_queue_handler.queue_->GetDownEnd()->UnregisterDequeue();
   }
   acl_queue_handlers_.erase(handle);
-  starting_point_ = acl_queue_handlers_.begin();
+  deficit_round_robin_.Remove(handle);
 }
 
 void RoundRobinScheduler::SetLinkPriority(uint16_t handle, bool high_priority) {
-  auto acl_queue_handler = acl_queue_handlers_.find(handle);
-  if (acl_queue_handler == acl_queue_handlers_.end()) {
+  if (acl_queue_handlers_.count(handle) == 0) {
+    LOG_WARN("handle %d is invalid", handle);
+    return;
+  }
+  deficit_round_robin_.SetLatencyClass(handle, high_priority ? LatencyClass::REAL_TIME : LatencyClass::DEFAULT);
+}
+
+void RoundRobinScheduler::SetLinkQos(uint16_t handle, LatencyClass latency_class, uint8_t weight) {
+  if (acl_queue_handlers_.count(handle) == 0) {
     LOG_WARN("handle %d is invalid", handle);
     return;
   }
-  acl_queue_handler->second.high_priority_ = high_priority;
+  deficit_round_robin_.SetLatencyClass(handle, latency_class);
+  deficit_round_robin_.SetWeight(handle, weight);
 }
 
 uint16_t RoundRobinScheduler::GetCredits() {
@@ -89,89 +104,113 @@ void RoundRobinScheduler::start_round_robin() {
   if (acl_packet_credits_ == 0 && le_acl_packet_credits_ == 0) {
     return;
   }
-  if (!fragments_to_send_.empty()) {
-    auto connection_type = fragments_to_send_.front().first;
-    bool classic_buffer_full = acl_packet_credits_ == 0 && connection_type == ConnectionType::CLASSIC;
-    bool le_buffer_full = le_acl_packet_credits_ == 0 && connection_type == ConnectionType::LE;
-    if (classic_buffer_full || le_buffer_full) {
-      LOG_WARN("Buffer of connection_type %d is full", connection_type);
-      return;
+  // Only a connection of a higher latency class may overtake the fragments waiting to be sent
+  int min_latency_class = 0;
+  for (int latency_class = 0; latency_class < kNumLatencyClasses; latency_class++) {
+    if (fragments_per_latency_class_[latency_class] > 0) {
+      min_latency_class = latency_class + 1;
+    }
+  }
+  if (min_latency_class < kNumLatencyClasses) {
+    // A connection with fragments waiting must not interleave them with another packet
+    auto handle = deficit_round_robin_.Select(static_cast<LatencyClass>(min_latency_class), [this](uint16_t handle) {
+      const auto& acl_queue_handler = acl_queue_handlers_.find(handle)->second;
+      return acl_queue_handler.number_of_queued_fragments_ == 0 && has_credits(acl_queue_handler.connection_type_);
+    });
+    if (handle.has_value()) {
+      fragment_next_packet(*handle);
     }
-    send_next_fragment();
-    return;
   }
-  if (acl_queue_handlers_.empty()) {
-    LOG_INFO("No any acl connection");
+  if (fragments_to_send_.empty()) {
     return;
   }
 
-  if (acl_queue_handlers_.size() == 1 || starting_point_ == acl_queue_handlers_.end()) {
-    starting_point_ = acl_queue_handlers_.begin();
+  auto connection_type = fragments_to_send_.front().connection_type_;
+  if (!has_credits(connection_type)) {
+    LOG_WARN("Buffer of connection_type %d is full", connection_type);
+    return;
   }
-  size_t count = acl_queue_handlers_.size();
+  send_next_fragment();
+}
 
-  for (auto acl_queue_handler = starting_point_; count > 0; count--) {
-    // Prevent registration when credits is zero
-    bool classic_buffer_full =
-        acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::CLASSIC;
-    bool le_buffer_full =
-        le_acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::LE;
-    if (!acl_queue_handler->second.dequeue_is_registered_ && !classic_buffer_full && !le_buffer_full) {
-      acl_queue_handler->second.dequeue_is_registered_ = true;
-      uint16_t acl_handle = acl_queue_handler->first;
-      acl_queue_handler->second.queue_->GetDownEnd()->RegisterDequeue(
-          handler_, common::Bind(&RoundRobinScheduler::buffer_packet, common::Unretained(this), acl_handle));
-    }
-    acl_queue_handler = std::next(acl_queue_handler);
-    if (acl_queue_handler == acl_queue_handlers_.end()) {
-      acl_queue_handler = acl_queue_handlers_.begin();
-    }
-  }
+bool RoundRobinScheduler::has_credits(ConnectionType connection_type) const {
+  return connection_type == ConnectionType::CLASSIC ? acl_packet_credits_ > 0 : le_acl_packet_credits_ > 0;
+}
 
-  starting_point_ = std::next(starting_point_);
+void RoundRobinScheduler::register_dequeue(uint16_t handle) {
+  auto& acl_queue_handler = acl_queue_handlers_.find(handle)->second;
+  if (acl_queue_handler.dequeue_is_registered_ || acl_queue_handler.next_packet_ != nullptr) {
+    return;
+  }
+  acl_queue_handler.dequeue_is_registered_ = true;
+  acl_queue_handler.queue_->GetDownEnd()->RegisterDequeue(
+      handler_, common::Bind(&RoundRobinScheduler::buffer_packet, common::Unretained(this), handle));
 }
 
 void RoundRobinScheduler::buffer_packet(uint16_t acl_handle) {
-  BroadcastFlag broadcast_flag = BroadcastFlag::POINT_TO_POINT;
   auto acl_queue_handler = acl_queue_handlers_.find(acl_handle);
   if( acl_queue_handler == acl_queue_handlers_.end()) {
     LOG_ERROR("Ignore since ACL connection vanished with handle: 0x%X", acl_handle);
     return;
   }
 
+  // Hold one packet per connection until it is scheduled
+  auto packet = acl_queue_handler->second.queue_->GetDownEnd()->TryDequeue();
+  ASSERT(packet != nullptr);
+  acl_queue_handler->second.dequeue_is_registered_ = false;
+  acl_queue_handler->second.queue_->GetDownEnd()->UnregisterDequeue();
+  deficit_round_robin_.SetNextPacketSize(acl_handle, packet->size());
+  acl_queue_handler->second.next_packet_ = std::move(packet);
+
+  start_round_robin();
+}
+
+void RoundRobinScheduler::fragment_next_packet(uint16_t acl_handle) {
+  BroadcastFlag broadcast_flag = BroadcastFlag::POINT_TO_POINT;
+  auto acl_queue_handler = acl_queue_handlers_.find(acl_handle);
+  ASSERT(acl_queue_handler != acl_queue_handlers_.end());
+
   // Wrap packet and enqueue it
   uint16_t handle = acl_queue_handler->first;
-  auto packet = acl_queue_handler->second.queue_->GetDownEnd()->TryDequeue();
+  auto packet = std::move(acl_queue_handler->second.next_packet_);
   ASSERT(packet != nullptr);
+  register_dequeue(handle);
 
   ConnectionType connection_type = acl_queue_handler->second.connection_type_;
+  LatencyClass latency_class = deficit_round_robin_.GetLatencyClass(handle);
   size_t mtu = connection_type == ConnectionType::CLASSIC ? hci_mtu_ : le_hci_mtu_;
   PacketBoundaryFlag packet_boundary_flag = (packet->IsFlushable())
                                                 ? PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE
                                                 : PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE;
 
-  int acl_priority = acl_queue_handler->second.high_priority_ ? 1 : 0;
+  size_t number_of_fragments = 0;
   if (packet->size() <= mtu) {
     fragments_to_send_.push(
-        std::make_pair(
-            connection_type, AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet))),
-        acl_priority);
+        acl_fragment{
+            handle,
+            connection_type,
+            latency_class,
+            AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet))},
+        static_cast<int>(latency_class));
+    number_of_fragments = 1;
   } else {
     auto fragments = AclFragmenter(mtu, std::move(packet)).GetFragments();
     for (size_t i = 0; i < fragments.size(); i++) {
       fragments_to_send_.push(
-          std::make_pair(
+          acl_fragment{
+              handle,
               connection_type,
-              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i]))),
-          acl_priority);
+              latency_class,
+              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i]))},
+          static_cast<int>(latency_class));
       packet_boundary_flag = PacketBoundaryFlag::CONTINUING_FRAGMENT;
     }
+    number_of_fragments = fragments.size();
   }
-  ASSERT(fragments_to_send_.size() > 0);
-  unregister_all_connections();
-
-  acl_queue_handler->second.number_of_sent_packets_ += fragments_to_send_.size();
-  send_next_fragment();
+  ASSERT(number_of_fragments > 0);
+  fragments_per_latency_class_[static_cast<int>(latency_class)] += number_of_fragments;
+  acl_queue_handler->second.number_of_queued_fragments_ += number_of_fragments;
+  acl_queue_handler->second.number_of_sent_packets_ += number_of_fragments;
 }
 
 void RoundRobinScheduler::unregister_all_connections() {
@@ -193,7 +232,7 @@ void RoundRobinScheduler::send_next_fragment() {
 
 // Invoked from some external Queue Reactable context 1
 std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment() {
-  ConnectionType connection_type = fragments_to_send_.front().first;
+  ConnectionType connection_type = fragments_to_send_.front().connection_type_;
   if (connection_type == ConnectionType::CLASSIC) {
     ASSERT(acl_packet_credits_ > 0);
     acl_packet_credits_ -= 1;
@@ -202,7 +241,12 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     le_acl_packet_credits_ -= 1;
   }
 
-  auto raw_pointer = fragments_to_send_.front().second.release();
+  fragments_per_latency_class_[static_cast<int>(fragments_to_send_.front().latency_class_)]--;
+  auto acl_queue_handler = acl_queue_handlers_.find(fragments_to_send_.front().handle_);
+  if (acl_queue_handler != acl_queue_handlers_.end()) {
+    acl_queue_handler->second.number_of_queued_fragments_--;
+  }
+  auto raw_pointer = fragments_to_send_.front().packet_.release();
   fragments_to_send_.pop();
   if (fragments_to_send_.empty()) {
     if (enqueue_registered_.exchange(false)) {
@@ -210,7 +254,7 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     }
     handler_->Post(common::BindOnce(&RoundRobinScheduler::start_round_robin, common::Unretained(this)));
   } else {
-    ConnectionType next_connection_type = fragments_to_send_.front().first;
+    ConnectionType next_connection_type = fragments_to_send_.front().connection_type_;
     bool classic_buffer_full = next_connection_type == ConnectionType::CLASSIC && acl_packet_credits_ == 0;
     bool le_buffer_full = next_connection_type == ConnectionType::LE && le_acl_packet_credits_ == 0;
     if ((classic_buffer_full || le_buffer_full) && enqueue_registered_.exchange(false)) {
@@ -18,9 +18,12 @@
 
 #include <stdint.h>
 
+#include <array>
+
 #include "common/bidi_queue.h"
 #include "common/multi_priority_queue.h"
 #include "hci/acl_manager.h"
+#include "hci/acl_manager/deficit_round_robin.h"
 #include "hci/controller.h"
 #include "hci/hci_packets.h"
 #include "os/handler.h"
@@ -29,6 +32,9 @@ namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+// Sends the outgoing ACL data of the connections within the controller buffers. The next connection to send is chosen
+// by latency class, then by deficit round robin on the bytes sent (see DeficitRoundRobin). The fragments of a packet
+// go out back to back, unless a connection of a higher latency class has a packet to send.
 class RoundRobinScheduler {
  public:
   RoundRobinScheduler(
@@ -42,19 +48,32 @@ class RoundRobinScheduler {
     std::shared_ptr<acl_manager::AclConnection::Queue> queue_;
     bool dequeue_is_registered_ = false;
     uint16_t number_of_sent_packets_ = 0;  // Track credits
-    bool high_priority_ = false;           // For A2dp use
+    size_t number_of_queued_fragments_ = 0;
+    // Next packet of the connection, dequeued ahead so that its size is known when scheduling
+    std::unique_ptr<packet::BasePacketBuilder> next_packet_;
   };
 
   void Register(ConnectionType connection_type, uint16_t handle,
                 std::shared_ptr<acl_manager::AclConnection::Queue> queue);
   void Unregister(uint16_t handle);
-  void SetLinkPriority(uint16_t handle, bool high_priority);
+  void SetLinkPriority(uint16_t handle, bool high_priority);  // For A2dp use
+  void SetLinkQos(uint16_t handle, LatencyClass latency_class, uint8_t weight);
   uint16_t GetCredits();
   uint16_t GetLeCredits();
 
  private:
+  struct acl_fragment {
+    uint16_t handle_;
+    ConnectionType connection_type_;
+    LatencyClass latency_class_;
+    std::unique_ptr<AclBuilder> packet_;
+  };
+
   void start_round_robin();
+  bool has_credits(ConnectionType connection_type) const;
+  void register_dequeue(uint16_t handle);
   void buffer_packet(uint16_t acl_handle);
+  void fragment_next_packet(uint16_t acl_handle);
   void unregister_all_connections();
   void send_next_fragment();
   std::unique_ptr<AclBuilder> handle_enqueue_next_fragment();
@@ -63,7 +82,9 @@ class RoundRobinScheduler {
   os::Handler* handler_ = nullptr;
   Controller* controller_ = nullptr;
   std::map<uint16_t, acl_queue_handler> acl_queue_handlers_;
-  common::MultiPriorityQueue<std::pair<ConnectionType, std::unique_ptr<AclBuilder>>, 2> fragments_to_send_;
+  DeficitRoundRobin deficit_round_robin_;
+  common::MultiPriorityQueue<acl_fragment, kNumLatencyClasses> fragments_to_send_;
+  std::array<size_t, kNumLatencyClasses> fragments_per_latency_class_{};
   uint16_t max_acl_packet_credits_ = 0;
   uint16_t acl_packet_credits_ = 0;
   uint16_t le_max_acl_packet_credits_ = 0;
@@ -72,8 +93,6 @@ class RoundRobinScheduler {
   size_t le_hci_mtu_{0};
   std::atomic_bool enqueue_registered_ = false;
   common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end_ = nullptr;
-  // first register queue end for the Round-robin schedule
-  std::map<uint16_t, acl_queue_handler>::iterator starting_point_;
 };
 
 }  // namespace acl_manager
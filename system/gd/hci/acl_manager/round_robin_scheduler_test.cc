@@ -412,6 +412,45 @@ TEST_F(RoundRobinSchedulerTest, receive_le_credit_when_next_fragment_is_classic)
   round_robin_scheduler_->Unregister(le_handle);
 }
 
+TEST_F(RoundRobinSchedulerTest, higher_latency_class_is_sent_first) {
+  uint16_t handle = 0x01;
+  uint16_t high_priority_handle = 0x02;
+  auto connection_queue = std::make_shared<AclConnection::Queue>(15);
+  auto high_priority_connection_queue = std::make_shared<AclConnection::Queue>(15);
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, handle, connection_queue);
+  round_robin_scheduler_->Register(
+      RoundRobinScheduler::ConnectionType::CLASSIC, high_priority_handle, high_priority_connection_queue);
+  round_robin_scheduler_->SetLinkQos(high_priority_handle, LatencyClass::REAL_TIME, 1);
+
+  // Use all the credits
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(controller_->max_acl_packet_credits_));
+  AclConnection::QueueUpEnd* queue_up_end = connection_queue->GetUpEnd();
+  for (uint8_t i = 0; i < controller_->max_acl_packet_credits_; i++) {
+    EnqueueAclUpEnd(queue_up_end, {0x01, i});
+  }
+  packet_future_->wait();
+  for (uint8_t i = 0; i < controller_->max_acl_packet_credits_; i++) {
+    VerifyPacket(handle, {0x01, i});
+  }
+  ASSERT_EQ(round_robin_scheduler_->GetCredits(), 0);
+
+  std::vector<uint8_t> packet = {0x01, 0x02, 0x03};
+  std::vector<uint8_t> high_priority_packet = {0x04, 0x05, 0x06};
+  EnqueueAclUpEnd(queue_up_end, packet);
+  EnqueueAclUpEnd(high_priority_connection_queue->GetUpEnd(), high_priority_packet);
+  enqueue_future_->wait();
+  sync_handler();
+
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(2));
+  controller_->SendCompletedAclPacketsCallback(handle, 2);
+  packet_future_->wait();
+  VerifyPacket(high_priority_handle, high_priority_packet);
+  VerifyPacket(handle, packet);
+
+  round_robin_scheduler_->Unregister(handle);
+  round_robin_scheduler_->Unregister(high_priority_handle);
+}
+
 }  // namespace
 }  // namespace acl_manager
 }  // namespace hci
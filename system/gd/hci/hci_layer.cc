@@ -16,11 +16,15 @@
 
 #include "hci/hci_layer.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "common/bind.h"
 #include "common/init_flags.h"
 #include "common/stop_watch.h"
 #include "hci/hci_metrics_logging.h"
 #include "os/alarm.h"
+#include "os/fake_timer/fake_timerfd.h"
 #include "os/metrics.h"
 #include "os/queue.h"
 #include "packet/packet_builder.h"
@@ -53,6 +57,63 @@ static void fail_if_reset_complete_not_success(CommandCompleteView complete) {
   ASSERT(reset_complete.GetStatus() == ErrorCode::SUCCESS);
 }
 
+// Commands which may be waiting for their response together. They read controller information without changing any
+// state, so their relative order does not matter. Any other command is only sent once every waiting command has
+// completed, and nothing is sent behind it until it completes, since it may depend on or change the state the
+// commands around it see (e.g. LE Set Scan Parameters followed by LE Set Scan Enable).
+static bool can_be_pipelined(OpCode op_code) {
+  switch (op_code) {
+    case OpCode::READ_LOCAL_VERSION_INFORMATION:
+    case OpCode::READ_LOCAL_SUPPORTED_COMMANDS:
+    case OpCode::READ_LOCAL_SUPPORTED_FEATURES:
+    case OpCode::READ_LOCAL_EXTENDED_FEATURES:
+    case OpCode::READ_BUFFER_SIZE:
+    case OpCode::READ_BD_ADDR:
+    case OpCode::READ_LOCAL_NAME:
+    case OpCode::READ_LOCAL_SUPPORTED_CODECS_V1:
+    case OpCode::READ_LOCAL_SUPPORTED_CODECS_V2:
+    case OpCode::READ_LOCAL_SIMPLE_PAIRING_OPTIONS:
+    case OpCode::READ_DEFAULT_ERRONEOUS_DATA_REPORTING:
+    case OpCode::LE_READ_BUFFER_SIZE_V1:
+    case OpCode::LE_READ_BUFFER_SIZE_V2:
+    case OpCode::LE_READ_LOCAL_SUPPORTED_FEATURES:
+    case OpCode::LE_READ_SUPPORTED_STATES:
+    case OpCode::LE_READ_FILTER_ACCEPT_LIST_SIZE:
+    case OpCode::LE_READ_RESOLVING_LIST_SIZE:
+    case OpCode::LE_READ_MAXIMUM_DATA_LENGTH:
+    case OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH:
+    case OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH:
+    case OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS:
+    case OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE:
+    case OpCode::LE_READ_TRANSMIT_POWER:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Milliseconds on the clock the HCI timeout alarm runs on
+static uint64_t get_clock_ms() {
+#ifdef USE_FAKE_TIMERS
+  return os::fake_timer::fake_timerfd_get_clock();
+#else
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static OpCode get_command_op_code(EventView event) {
+  if (event.GetEventCode() == EventCode::COMMAND_COMPLETE) {
+    auto view = CommandCompleteView::Create(event);
+    return view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+  }
+  if (event.GetEventCode() == EventCode::COMMAND_STATUS) {
+    auto view = CommandStatusView::Create(event);
+    return view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+  }
+  return OpCode::NONE;
+}
+
 static void abort_after_time_out(OpCode op_code) {
   bluetooth::os::LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
   ASSERT_LOG(false, "Done waiting for debug information after HCI timeout (%s)", OpCodeText(op_code).c_str());
@@ -76,6 +137,9 @@ class CommandQueueEntry {
 
   unique_ptr<CommandBuilder> command;
   unique_ptr<CommandView> command_view;
+  std::shared_ptr<std::vector<uint8_t>> command_bytes;
+  // Time the command was sent to the controller, from get_clock_ms()
+  uint64_t sent_time_ms = 0;
 
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
@@ -113,6 +177,7 @@ struct HciLayer::impl {
       delete hci_abort_alarm_;
     }
     command_queue_.clear();
+    waiting_commands_.clear();
   }
 
   void drop(EventView event) {
@@ -121,26 +186,17 @@ struct HciLayer::impl {
 
   void on_outbound_acl_ready() {
     auto packet = acl_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendAclData(bytes);
+    hal_->sendAclDataWithHeadroom(packet->SerializeToBytes(hal_->getOutgoingPacketHeadroom()));
   }
 
   void on_outbound_sco_ready() {
     auto packet = sco_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendScoData(bytes);
+    hal_->sendScoDataWithHeadroom(packet->SerializeToBytes(hal_->getOutgoingPacketHeadroom()));
   }
 
   void on_outbound_iso_ready() {
     auto packet = iso_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendIsoData(bytes);
+    hal_->sendIsoDataWithHeadroom(packet->SerializeToBytes(hal_->getOutgoingPacketHeadroom()));
   }
 
   template <typename TResponse>
@@ -181,26 +237,28 @@ struct HciLayer::impl {
     bool is_status = logging_id == "status";
 
     ASSERT_LOG(
-        !command_queue_.empty(),
+        !waiting_commands_.empty(),
         "Unexpected %s event with OpCode 0x%02hx (%s)",
         logging_id.c_str(),
         op_code,
         OpCodeText(op_code).c_str());
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
+    OpCode oldest_op_code = waiting_commands_.front().command_view->GetOpCode();
+    if (oldest_op_code == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
       LOG_ERROR("Discarding event that came after timeout 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
       return;
     }
+    auto command = find_waiting_command(op_code);
     ASSERT_LOG(
-        waiting_command_ == op_code,
+        command != waiting_commands_.end(),
         "Waiting for 0x%02hx (%s), got 0x%02hx (%s)",
-        waiting_command_,
-        OpCodeText(waiting_command_).c_str(),
+        oldest_op_code,
+        OpCodeText(oldest_op_code).c_str(),
         op_code,
         OpCodeText(op_code).c_str());
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !command->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected,
       // we can't treat this as hard failure since we have no way of probing this lack of support at
@@ -208,36 +266,56 @@ struct HciLayer::impl {
       // packet, which will be interpreted as invalid response.
       CommandCompleteView command_complete_view = CommandCompleteView::Create(
           EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-      command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(
-          std::move(command_complete_view));
+      command->GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
     } else {
-      if (command_queue_.front().waiting_for_status_ == is_status) {
-        command_queue_.front().GetCallback<TResponse>()->Invoke(std::move(response_view));
+      if (command->waiting_for_status_ == is_status) {
+        command->GetCallback<TResponse>()->Invoke(std::move(response_view));
       } else {
         CommandCompleteView command_complete_view = CommandCompleteView::Create(
             EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-        command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
+        command->GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
       }
     }
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
+    bool was_oldest = command == waiting_commands_.begin();
+    waiting_commands_.erase(command);
     if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
+      // The timeout keeps running for the oldest command while younger ones complete
+      if (was_oldest) {
+        hci_timeout_alarm_->Cancel();
+        if (!waiting_commands_.empty()) {
+          schedule_hci_timeout(waiting_commands_.front());
+        }
+      }
       send_next_command();
     }
   }
 
+  std::list<CommandQueueEntry>::iterator find_waiting_command(OpCode op_code) {
+    return std::find_if(waiting_commands_.begin(), waiting_commands_.end(), [op_code](const CommandQueueEntry& entry) {
+      return entry.command_view->GetOpCode() == op_code;
+    });
+  }
+
+  // Schedule the timeout of |command| for the time it has left since it was sent
+  void schedule_hci_timeout(const CommandQueueEntry& command) {
+    uint64_t waited_ms = get_clock_ms() - command.sent_time_ms;
+    std::chrono::milliseconds time_left =
+        std::max(kHciTimeoutMs - std::chrono::milliseconds(waited_ms), std::chrono::milliseconds(0));
+    hci_timeout_alarm_->Schedule(
+        BindOnce(&impl::on_hci_timeout, common::Unretained(this), command.command_view->GetOpCode()), time_left);
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     LOG_ERROR("Timed out waiting for 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
     // TODO: LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
 
-    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size());
+    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size() + waiting_commands_.size());
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
+    waiting_commands_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
     // Ignore the response, since we don't know what might come back.
     enqueue_command(ControllerDebugInfoBuilder::Create(), module_.GetHandler()->BindOnce([](CommandCompleteView) {}));
     // Don't time out for this one;
@@ -254,33 +332,56 @@ struct HciLayer::impl {
     }
   }
 
-  void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
+  // Commands are sent in the order they were enqueued, as long as the controller has credits for them. A command is
+  // held back, with the ones behind it, unless it and every waiting command can be pipelined, and while a command with
+  // the same opcode is waiting, so that each response matches a single command.
+  bool can_send(const CommandQueueEntry& command) const {
+    if (waiting_commands_.empty()) {
+      return true;
     }
-    if (waiting_command_ != OpCode::NONE) {
-      return;
+    OpCode op_code = command.command_view->GetOpCode();
+    if (!can_be_pipelined(op_code)) {
+      return false;
     }
-    if (command_queue_.size() == 0) {
-      return;
+    for (const auto& waiting : waiting_commands_) {
+      OpCode waiting_op_code = waiting.command_view->GetOpCode();
+      if (waiting_op_code == op_code || !can_be_pipelined(waiting_op_code)) {
+        return false;
+      }
     }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
-
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    ASSERT(cmd_view.IsValid());
-    OpCode op_code = cmd_view.GetOpCode();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), kHciTimeoutMs);
-    } else {
-      LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+    return true;
+  }
+
+  void send_next_command() {
+    while (command_credits_ > 0 && !command_queue_.empty()) {
+      CommandQueueEntry& command = command_queue_.front();
+      if (command.command_view == nullptr) {
+        command.command_bytes = std::make_shared<std::vector<uint8_t>>();
+        BitInserter bi(*command.command_bytes);
+        command.command->Serialize(bi);
+        auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(command.command_bytes));
+        ASSERT(cmd_view.IsValid());
+        command.command_view = std::make_unique<CommandView>(std::move(cmd_view));
+      }
+      if (!can_send(command)) {
+        return;
+      }
+
+      hal_->sendHciCommand(*command.command_bytes);
+      OpCode op_code = command.command_view->GetOpCode();
+      log_link_layer_connection_command(command.command_view);
+      log_classic_pairing_command_status(command.command_view, ErrorCode::STATUS_UNKNOWN);
+      command_credits_--;
+      command.sent_time_ms = get_clock_ms();
+      // The timeout applies to the oldest waiting command
+      if (hci_timeout_alarm_ != nullptr) {
+        if (waiting_commands_.empty()) {
+          schedule_hci_timeout(command);
+        }
+      } else {
+        LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+      }
+      waiting_commands_.splice(waiting_commands_.end(), command_queue_, command_queue_.begin());
     }
   }
 
@@ -339,7 +440,7 @@ struct HciLayer::impl {
 
   void on_hci_event(EventView event) {
     ASSERT(event.IsValid());
-    if (command_queue_.empty()) {
+    if (waiting_commands_.empty()) {
       auto event_code = event.GetEventCode();
       // BT Core spec 5.2 (Volume 4, Part E section 4.4) allows anytime
       // COMMAND_COMPLETE and COMMAND_STATUS with opcode 0x0 for flow control
@@ -370,7 +471,11 @@ struct HciLayer::impl {
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
       log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
     } else {
-      log_hci_event(command_queue_.front().command_view, event, module_.GetDependency<storage::StorageModule>());
+      auto command = find_waiting_command(get_command_op_code(event));
+      if (command == waiting_commands_.end()) {
+        command = waiting_commands_.begin();
+      }
+      log_hci_event(command->command_view, event, module_.GetDependency<storage::StorageModule>());
     }
     EventCode event_code = event.GetEventCode();
     // Root Inflamation is a special case, since it aborts here
@@ -424,10 +529,12 @@ struct HciLayer::impl {
 
   // Command Handling
   std::list<CommandQueueEntry> command_queue_;
+  // Commands sent to the controller and waiting for their Command Complete or Command Status, oldest first
+  std::list<CommandQueueEntry> waiting_commands_;
 
   std::map<EventCode, ContextualCallback<void(EventView)>> event_handlers_;
   std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> subevent_handlers_;
-  OpCode waiting_command_{OpCode::NONE};
+  // Number of commands the controller can accept, as last reported by Num_HCI_Command_Packets
   uint8_t command_credits_{1};  // Send reset first
   Alarm* hci_timeout_alarm_{nullptr};
   Alarm* hci_abort_alarm_{nullptr};
@@ -450,28 +557,42 @@ struct HciLayer::hal_callbacks : public hal::HciHalCallbacks {
   hal_callbacks(HciLayer& module) : module_(module) {}
 
   void hciEventReceived(hal::HciPacket event_bytes) override {
-    auto packet = packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(event_bytes));
+    hciEventBufferReceived(std::make_shared<std::vector<uint8_t>>(std::move(event_bytes)));
+  }
+
+  void aclDataReceived(hal::HciPacket data_bytes) override {
+    aclDataBufferReceived(std::make_shared<std::vector<uint8_t>>(std::move(data_bytes)));
+  }
+
+  void scoDataReceived(hal::HciPacket data_bytes) override {
+    scoDataBufferReceived(std::make_shared<std::vector<uint8_t>>(std::move(data_bytes)));
+  }
+
+  void isoDataReceived(hal::HciPacket data_bytes) override {
+    isoDataBufferReceived(std::make_shared<std::vector<uint8_t>>(std::move(data_bytes)));
+  }
+
+  // The views refer to the HAL buffer, which is released with the last of them
+  void hciEventBufferReceived(hal::SharedHciPacket event_bytes) override {
+    auto packet = packet::PacketView<packet::kLittleEndian>(std::move(event_bytes));
     EventView event = EventView::Create(packet);
     module_.CallOn(module_.impl_, &impl::on_hci_event, std::move(event));
   }
 
-  void aclDataReceived(hal::HciPacket data_bytes) override {
-    auto packet = packet::PacketView<packet::kLittleEndian>(
-        std::make_shared<std::vector<uint8_t>>(std::move(data_bytes)));
+  void aclDataBufferReceived(hal::SharedHciPacket data_bytes) override {
+    auto packet = packet::PacketView<packet::kLittleEndian>(std::move(data_bytes));
     auto acl = std::make_unique<AclView>(AclView::Create(packet));
     module_.impl_->incoming_acl_buffer_.Enqueue(std::move(acl), module_.GetHandler());
   }
 
-  void scoDataReceived(hal::HciPacket data_bytes) override {
-    auto packet = packet::PacketView<packet::kLittleEndian>(
-        std::make_shared<std::vector<uint8_t>>(std::move(data_bytes)));
+  void scoDataBufferReceived(hal::SharedHciPacket data_bytes) override {
+    auto packet = packet::PacketView<packet::kLittleEndian>(std::move(data_bytes));
     auto sco = std::make_unique<ScoView>(ScoView::Create(packet));
     module_.impl_->incoming_sco_buffer_.Enqueue(std::move(sco), module_.GetHandler());
   }
 
-  void isoDataReceived(hal::HciPacket data_bytes) override {
-    auto packet = packet::PacketView<packet::kLittleEndian>(
-        std::make_shared<std::vector<uint8_t>>(std::move(data_bytes)));
+  void isoDataBufferReceived(hal::SharedHciPacket data_bytes) override {
+    auto packet = packet::PacketView<packet::kLittleEndian>(std::move(data_bytes));
     auto iso = std::make_unique<IsoView>(IsoView::Create(packet));
     module_.impl_->incoming_iso_buffer_.Enqueue(std::move(iso), module_.GetHandler());
   }
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hal/hci_hal.h"
+#include "hci/hci_layer.h"
+#include "hci/hci_packets.h"
+#include "module.h"
+#include "packet/bit_inserter.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+using ::bluetooth::TestModuleRegistry;
+using ::bluetooth::hal::HciHal;
+using ::bluetooth::hal::HciHalCallbacks;
+using ::bluetooth::hal::HciPacket;
+using ::bluetooth::hci::CommandBuilder;
+using ::bluetooth::hci::CommandCompleteBuilder;
+using ::bluetooth::hci::CommandCompleteView;
+using ::bluetooth::hci::ErrorCode;
+using ::bluetooth::hci::HciLayer;
+using ::bluetooth::hci::OpCode;
+using ::bluetooth::packet::BitInserter;
+using ::bluetooth::packet::RawBuilder;
+
+namespace {
+
+// Round trip of a command to a controller over UART, from sending the command to receiving its Command Complete
+constexpr std::chrono::microseconds kRoundTrip = std::chrono::microseconds(500);
+
+// A controller which completes each command after kRoundTrip, and processes up to |credits| commands at once
+class FakeController : public HciHal {
+ public:
+  explicit FakeController(uint8_t credits) : credits_(credits), responder_(&FakeController::respond, this) {}
+
+  ~FakeController() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    cv_.notify_one();
+    responder_.join();
+  }
+
+  void registerIncomingPacketCallback(HciHalCallbacks* callbacks) override {
+    callbacks_ = callbacks;
+  }
+
+  void unregisterIncomingPacketCallback() override {
+    callbacks_ = nullptr;
+  }
+
+  void sendHciCommand(HciPacket command) override {
+    OpCode op_code = static_cast<OpCode>(command[0] | (command[1] << 8));
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pending_.push({std::chrono::steady_clock::now() + kRoundTrip, op_code});
+    }
+    cv_.notify_one();
+  }
+
+  void sendAclData(HciPacket) override {}
+  void sendScoData(HciPacket) override {}
+  void sendIsoData(HciPacket) override {}
+
+  void Start() override {}
+  void Stop() override {}
+  void ListDependencies(bluetooth::ModuleList*) const override {}
+  std::string ToString() const override {
+    return std::string("FakeController");
+  }
+
+ private:
+  struct Response {
+    std::chrono::steady_clock::time_point time;
+    OpCode op_code;
+  };
+
+  void respond() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return stopped_ || !pending_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      Response response = pending_.front();
+      pending_.pop();
+      lock.unlock();
+      std::this_thread::sleep_until(response.time);
+
+      auto complete = CommandCompleteBuilder::Create(
+          credits_, response.op_code, std::make_unique<RawBuilder>(std::vector<uint8_t>{0x00 /* SUCCESS */}));
+      std::vector<uint8_t> bytes;
+      BitInserter bi(bytes);
+      complete->Serialize(bi);
+      callbacks_->hciEventReceived(bytes);
+      lock.lock();
+    }
+  }
+
+  uint8_t credits_;
+  HciHalCallbacks* callbacks_ = nullptr;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::queue<Response> pending_;
+  bool stopped_ = false;
+  std::thread responder_;
+};
+
+// The controller reads issued by Controller::Start before the stack can be used
+std::vector<std::function<std::unique_ptr<CommandBuilder>()>> kStartUpCommands = {
+    [] { return bluetooth::hci::ReadLocalNameBuilder::Create(); },
+    [] { return bluetooth::hci::ReadLocalVersionInformationBuilder::Create(); },
+    [] { return bluetooth::hci::ReadLocalSupportedCommandsBuilder::Create(); },
+    [] { return bluetooth::hci::ReadLocalSupportedFeaturesBuilder::Create(); },
+    [] { return bluetooth::hci::ReadBufferSizeBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadBufferSizeV1Builder::Create(); },
+    [] { return bluetooth::hci::LeReadLocalSupportedFeaturesBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadSupportedStatesBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadMaximumDataLengthBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadSuggestedDefaultDataLengthBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadFilterAcceptListSizeBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadResolvingListSizeBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadMaximumAdvertisingDataLengthBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadNumberOfSupportedAdvertisingSetsBuilder::Create(); },
+    [] { return bluetooth::hci::LeReadPeriodicAdvertiserListSizeBuilder::Create(); },
+    [] { return bluetooth::hci::ReadBdAddrBuilder::Create(); },
+};
+
+struct StartUp {
+  size_t remaining;
+  std::promise<void> done;
+};
+
+void OnCommandComplete(StartUp* start_up, CommandCompleteView view) {
+  if (--start_up->remaining == 0) {
+    start_up->done.set_value();
+  }
+}
+
+// Time for the HCI layer to get the start-up reads through a controller granting |credits| commands at once
+void BM_HciStartUpCommands(State& state) {
+  TestModuleRegistry registry;
+  registry.InjectTestModule(&HciHal::Factory, new FakeController(state.range(0)));
+  registry.Start<HciLayer>(&registry.GetTestThread());
+  auto hci = registry.GetModuleUnderTest<HciLayer>();
+  auto handler = registry.GetTestModuleHandler(&HciLayer::Factory);
+
+  for (auto _ : state) {
+    StartUp start_up{kStartUpCommands.size(), {}};
+    auto done = start_up.done.get_future();
+    for (const auto& command : kStartUpCommands) {
+      hci->EnqueueCommand(command(), handler->BindOnce(&OnCommandComplete, &start_up));
+    }
+    done.wait();
+  }
+
+  state.counters["commands_per_sec"] =
+      Counter(state.iterations() * kStartUpCommands.size(), Counter::kIsRate);
+  registry.StopAll();
+}
+
+BENCHMARK(BM_HciStartUpCommands)->ArgName("credits")->Arg(1)->Arg(4)->UseRealTime()->Unit(::benchmark::kMillisecond);
+
+}  // namespace
@@ -458,6 +458,136 @@ TEST_F(HciTest, creditsTest) {
                   .IsValid());
 }
 
+TEST_F(HciTest, pipelinedCommandsTest) {
+  // Allow three commands
+  uint8_t num_packets = 3;
+  hal->callbacks->hciEventReceived(GetPacketBytes(NoCommandCompleteBuilder::Create(num_packets)));
+
+  upper->SendHciCommandExpectingComplete(ReadLocalVersionInformationBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedCommandsBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalVersionInformationBuilder::Create());
+
+  // Verify that the first two are sent
+  auto sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ReadLocalVersionInformationView::Create(CommandView::Create(*sent_command)).IsValid());
+  sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ReadLocalSupportedCommandsView::Create(CommandView::Create(*sent_command)).IsValid());
+
+  // Verify that the third one waits for the first one, which has the same opcode
+  sent_command = hal->GetSentCommand(std::chrono::milliseconds(10));
+  ASSERT_FALSE(sent_command.has_value());
+
+  // Respond to the second one first
+  ErrorCode error_code = ErrorCode::SUCCESS;
+  std::array<uint8_t, 64> supported_commands{};
+  hal->callbacks->hciEventReceived(GetPacketBytes(ReadLocalSupportedCommandsCompleteBuilder::Create(
+      num_packets, error_code, supported_commands)));
+
+  auto event = upper->GetReceivedEvent();
+  ASSERT_TRUE(event.has_value());
+  ASSERT_TRUE(ReadLocalSupportedCommandsCompleteView::Create(CommandCompleteView::Create(*event))
+                  .IsValid());
+  sent_command = hal->GetSentCommand(std::chrono::milliseconds(10));
+  ASSERT_FALSE(sent_command.has_value());
+
+  LocalVersionInformation local_version_information;
+  local_version_information.hci_version_ = HciVersion::V_5_0;
+  local_version_information.hci_revision_ = 0x1234;
+  local_version_information.lmp_version_ = LmpVersion::V_4_2;
+  local_version_information.manufacturer_name_ = 0xBAD;
+  local_version_information.lmp_subversion_ = 0x5678;
+  hal->callbacks->hciEventReceived(GetPacketBytes(
+      ReadLocalVersionInformationCompleteBuilder::Create(num_packets, error_code, local_version_information)));
+
+  event = upper->GetReceivedEvent();
+  ASSERT_TRUE(event.has_value());
+  ASSERT_TRUE(ReadLocalVersionInformationCompleteView::Create(
+                  CommandCompleteView::Create(EventView::Create(*event)))
+                  .IsValid());
+
+  // Verify that the third one is sent
+  sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ReadLocalVersionInformationView::Create(CommandView::Create(*sent_command)).IsValid());
+}
+
+TEST_F(HciTest, resetIsSentAlone) {
+  uint8_t num_packets = 3;
+  hal->callbacks->hciEventReceived(GetPacketBytes(NoCommandCompleteBuilder::Create(num_packets)));
+
+  upper->SendHciCommandExpectingComplete(ReadLocalVersionInformationBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ResetBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedCommandsBuilder::Create());
+
+  auto sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ReadLocalVersionInformationView::Create(CommandView::Create(*sent_command)).IsValid());
+
+  // Verify that Reset waits for the first command, and the last one for Reset
+  sent_command = hal->GetSentCommand(std::chrono::milliseconds(10));
+  ASSERT_FALSE(sent_command.has_value());
+
+  ErrorCode error_code = ErrorCode::SUCCESS;
+  LocalVersionInformation local_version_information;
+  hal->callbacks->hciEventReceived(GetPacketBytes(
+      ReadLocalVersionInformationCompleteBuilder::Create(num_packets, error_code, local_version_information)));
+  ASSERT_TRUE(upper->GetReceivedEvent().has_value());
+
+  sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ResetView::Create(CommandView::Create(*sent_command)).IsValid());
+  sent_command = hal->GetSentCommand(std::chrono::milliseconds(10));
+  ASSERT_FALSE(sent_command.has_value());
+
+  hal->callbacks->hciEventReceived(GetPacketBytes(ResetCompleteBuilder::Create(num_packets, error_code)));
+  ASSERT_TRUE(upper->GetReceivedEvent().has_value());
+
+  sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ReadLocalSupportedCommandsView::Create(CommandView::Create(*sent_command)).IsValid());
+}
+
+TEST_F(HciTest, stateChangingCommandsAreNotPipelined) {
+  uint8_t num_packets = 3;
+  hal->callbacks->hciEventReceived(GetPacketBytes(NoCommandCompleteBuilder::Create(num_packets)));
+
+  Address random_address({0x01, 0x02, 0x03, 0x04, 0x05, 0xc6});
+  upper->SendHciCommandExpectingComplete(LeSetRandomAddressBuilder::Create(random_address));
+  upper->SendHciCommandExpectingComplete(LeSetScanEnableBuilder::Create(Enable::ENABLED, Enable::DISABLED));
+  upper->SendHciCommandExpectingComplete(ReadLocalVersionInformationBuilder::Create());
+
+  auto sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(
+      LeSetRandomAddressView::Create(LeAdvertisingCommandView::Create(CommandView::Create(*sent_command))).IsValid());
+
+  // Verify that the scan is only enabled once the random address is set
+  sent_command = hal->GetSentCommand(std::chrono::milliseconds(10));
+  ASSERT_FALSE(sent_command.has_value());
+
+  ErrorCode error_code = ErrorCode::SUCCESS;
+  hal->callbacks->hciEventReceived(GetPacketBytes(LeSetRandomAddressCompleteBuilder::Create(num_packets, error_code)));
+  ASSERT_TRUE(upper->GetReceivedEvent().has_value());
+
+  sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(
+      LeSetScanEnableView::Create(LeScanningCommandView::Create(CommandView::Create(*sent_command))).IsValid());
+
+  // Verify that a read which could be pipelined still waits behind it
+  sent_command = hal->GetSentCommand(std::chrono::milliseconds(10));
+  ASSERT_FALSE(sent_command.has_value());
+
+  hal->callbacks->hciEventReceived(GetPacketBytes(LeSetScanEnableCompleteBuilder::Create(num_packets, error_code)));
+  ASSERT_TRUE(upper->GetReceivedEvent().has_value());
+
+  sent_command = hal->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  ASSERT_TRUE(ReadLocalVersionInformationView::Create(CommandView::Create(*sent_command)).IsValid());
+}
+
 TEST_F(HciTest, leSecurityInterfaceTest) {
   // Send LeRand to the controller
   upper->SendLeSecurityCommandExpectingComplete(LeRandBuilder::Create());
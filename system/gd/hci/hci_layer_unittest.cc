@@ -136,6 +136,34 @@ TEST_F(HciLayerTest, controller_debug_info_requested_on_hci_timeout) {
   ASSERT_TRUE(debug_info_view.IsValid());
 }
 
+TEST_F(HciLayerTest, hci_timeout_runs_from_oldest_command_sent) {
+  FailIfResetNotSent();
+  hal_->InjectEvent(ResetCompleteBuilder::Create(3, ErrorCode::SUCCESS));
+  hci_->EnqueueCommand(
+      ReadLocalVersionInformationBuilder::Create(), hci_handler_->BindOnce([](CommandCompleteView view) {}));
+  hci_->EnqueueCommand(
+      ReadLocalSupportedCommandsBuilder::Create(), hci_handler_->BindOnce([](CommandCompleteView view) {}));
+  sync_handler();
+  ASSERT_TRUE(hal_->GetSentCommand().has_value());
+  ASSERT_TRUE(hal_->GetSentCommand().has_value());
+
+  uint64_t half_timeout_ms = HciLayer::kHciTimeoutMs.count() / 2;
+  FakeTimerAdvance(half_timeout_ms);
+  std::array<uint8_t, 64> supported_commands{};
+  hal_->InjectEvent(
+      ReadLocalSupportedCommandsCompleteBuilder::Create(1, ErrorCode::SUCCESS, supported_commands));
+  sync_handler();
+
+  // The response to the younger command does not restart the timeout of the oldest one
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() - half_timeout_ms);
+  sync_handler();
+
+  auto sent_command = hal_->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  auto debug_info_view = ControllerDebugInfoView::Create(VendorCommandView::Create(*sent_command));
+  ASSERT_TRUE(debug_info_view.IsValid());
+}
+
 TEST_F(HciLayerTest, abort_after_hci_restart_timeout) {
   FailIfResetNotSent();
   FakeTimerAdvance(HciLayer::kHciTimeoutMs.count());
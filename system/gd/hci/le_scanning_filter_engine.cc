@@ -0,0 +1,349 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_scanning_filter_engine.h"
+
+#include <initializer_list>
+
+#include "os/log.h"
+
+namespace bluetooth::hci {
+
+namespace {
+
+/// Bluetooth Base UUID in little endian. 16-bit and 32-bit UUIDs replace its last four octets.
+constexpr std::array<uint8_t, Uuid::kNumBytes128> kBaseUuidLE = {
+    0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+constexpr size_t kShortUuidOffset = 12;
+
+std::bitset<256> AdTypes(std::initializer_list<uint8_t> types) {
+  std::bitset<256> ad_types;
+  for (uint8_t type : types) {
+    ad_types.set(type);
+  }
+  return ad_types;
+}
+
+/// Size of the UUIDs listed in an AD structure of this type.
+size_t UuidListElementSize(uint8_t type) {
+  switch (type) {
+    case static_cast<uint8_t>(GapDataType::INCOMPLETE_LIST_16_BIT_UUIDS):
+    case static_cast<uint8_t>(GapDataType::COMPLETE_LIST_16_BIT_UUIDS):
+    case static_cast<uint8_t>(GapDataType::LIST_16BIT_SERVICE_SOLICITATION_UUIDS):
+      return Uuid::kNumBytes16;
+    case static_cast<uint8_t>(GapDataType::INCOMPLETE_LIST_32_BIT_UUIDS):
+    case static_cast<uint8_t>(GapDataType::COMPLETE_LIST_32_BIT_UUIDS):
+    case static_cast<uint8_t>(GapDataType::LIST_32BIT_SERVICE_SOLICITATION_UUIDS):
+      return Uuid::kNumBytes32;
+    default:
+      return Uuid::kNumBytes128;
+  }
+}
+
+/// Pattern and mask of the same size from filter data, a missing mask matches all the data octets.
+void AppendPattern(
+    const std::vector<uint8_t>& data,
+    const std::vector<uint8_t>& data_mask,
+    std::vector<uint8_t>* pattern,
+    std::vector<uint8_t>* mask) {
+  pattern->insert(pattern->end(), data.begin(), data.end());
+  if (data_mask.empty()) {
+    mask->insert(mask->end(), data.size(), 0xff);
+  } else {
+    mask->insert(mask->end(), data_mask.begin(), data_mask.end());
+  }
+}
+
+}  // namespace
+
+void LeScanningFilterEngine::SetFilteringParameters(
+    ApcfAction action, uint8_t filter_index, const AdvertisingFilterParameter& parameter) {
+  switch (action) {
+    case ApcfAction::ADD: {
+      FilterProgram& program = programs_[filter_index];
+      program.has_parameters = true;
+      program.feature_selection = parameter.feature_selection;
+      program.list_logic_type = parameter.list_logic_type;
+      program.and_features = parameter.filter_logic_type != 0;
+      program.rssi_threshold = static_cast<int8_t>(parameter.rssi_high_thresh);
+      break;
+    }
+    case ApcfAction::DELETE:
+      programs_.erase(filter_index);
+      break;
+    case ApcfAction::CLEAR:
+      programs_.clear();
+      break;
+    default:
+      LOG_ERROR("Unknown action type: %d", (uint16_t)action);
+      break;
+  }
+}
+
+void LeScanningFilterEngine::AddFilters(
+    uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& filters) {
+  FilterProgram& program = programs_[filter_index];
+  for (const auto& filter : filters) {
+    size_t feature = static_cast<size_t>(filter.filter_type);
+    if (feature >= kFeatureCount) {
+      LOG_ERROR("Unknown filter type: %d", (uint16_t)filter.filter_type);
+      continue;
+    }
+    Instruction instruction;
+    if (!Compile(filter, &instruction)) {
+      continue;
+    }
+    program.features[feature].push_back(std::move(instruction));
+  }
+}
+
+bool LeScanningFilterEngine::Compile(const AdvertisingPacketContentFilterCommand& filter, Instruction* instruction) {
+  if (!filter.data.empty() && !filter.data_mask.empty() && filter.data.size() != filter.data_mask.size()) {
+    LOG_ERROR("data and data_mask are of different size");
+    return false;
+  }
+
+  switch (filter.filter_type) {
+    case ApcfFilterType::BROADCASTER_ADDRESS: {
+      // Resolvable addresses are only resolved by the upper layers
+      bool has_irk = false;
+      for (uint8_t octet : filter.irk) {
+        has_irk |= octet != 0;
+      }
+      if (!has_irk) {
+        instruction->opcode = Opcode::ADDRESS;
+        instruction->address = filter.address;
+      }
+      return true;
+    }
+    case ApcfFilterType::SERVICE_UUID:
+    case ApcfFilterType::SERVICE_SOLICITATION_UUID: {
+      if (filter.filter_type == ApcfFilterType::SERVICE_UUID) {
+        instruction->ad_types = AdTypes({
+            static_cast<uint8_t>(GapDataType::INCOMPLETE_LIST_16_BIT_UUIDS),
+            static_cast<uint8_t>(GapDataType::COMPLETE_LIST_16_BIT_UUIDS),
+            static_cast<uint8_t>(GapDataType::INCOMPLETE_LIST_32_BIT_UUIDS),
+            static_cast<uint8_t>(GapDataType::COMPLETE_LIST_32_BIT_UUIDS),
+            static_cast<uint8_t>(GapDataType::INCOMPLETE_LIST_128_BIT_UUIDS),
+            static_cast<uint8_t>(GapDataType::COMPLETE_LIST_128_BIT_UUIDS),
+        });
+      } else {
+        instruction->ad_types = AdTypes({
+            static_cast<uint8_t>(GapDataType::LIST_16BIT_SERVICE_SOLICITATION_UUIDS),
+            static_cast<uint8_t>(GapDataType::LIST_32BIT_SERVICE_SOLICITATION_UUIDS),
+            static_cast<uint8_t>(GapDataType::LIST_128BIT_SERVICE_SOLICITATION_UUIDS),
+        });
+      }
+      instruction->opcode = Opcode::UUID_LIST;
+      auto uuid = filter.uuid.To128BitLE();
+      instruction->pattern.assign(uuid.begin(), uuid.end());
+      if (filter.uuid_mask.IsEmpty()) {
+        instruction->mask.assign(Uuid::kNumBytes128, 0xff);
+      } else {
+        auto uuid_mask = filter.uuid_mask.To128BitLE();
+        instruction->mask.assign(uuid_mask.begin(), uuid_mask.end());
+      }
+
+      // 16-bit and 32-bit UUIDs are compared without extending them, when the base UUID matches the filter
+      static constexpr uint8_t kZeros[Uuid::kNumBytes16] = {};
+      const uint8_t* pattern = instruction->pattern.data();
+      const uint8_t* mask = instruction->mask.data();
+      instruction->matches_32_bit_uuids = MaskedEquals(kBaseUuidLE.data(), pattern, mask, kShortUuidOffset);
+      size_t zeros_offset = kShortUuidOffset + Uuid::kNumBytes16;
+      instruction->matches_16_bit_uuids =
+          instruction->matches_32_bit_uuids &&
+          MaskedEquals(kZeros, pattern + zeros_offset, mask + zeros_offset, sizeof(kZeros));
+      return true;
+    }
+    case ApcfFilterType::LOCAL_NAME: {
+      // The upper layers compare the whole name, the names it starts with are kept
+      instruction->opcode = Opcode::AD_PREFIX;
+      instruction->ad_types = AdTypes({
+          static_cast<uint8_t>(GapDataType::SHORTENED_LOCAL_NAME),
+          static_cast<uint8_t>(GapDataType::COMPLETE_LOCAL_NAME),
+      });
+      AppendPattern(filter.name, {}, &instruction->pattern, &instruction->mask);
+      return true;
+    }
+    case ApcfFilterType::MANUFACTURER_DATA: {
+      instruction->opcode = Opcode::AD_PREFIX;
+      instruction->ad_types = AdTypes({static_cast<uint8_t>(GapDataType::MANUFACTURER_SPECIFIC_DATA)});
+      uint16_t company_mask = filter.company_mask != 0 ? filter.company_mask : 0xffff;
+      instruction->pattern = {static_cast<uint8_t>(filter.company), static_cast<uint8_t>(filter.company >> 8)};
+      instruction->mask = {static_cast<uint8_t>(company_mask), static_cast<uint8_t>(company_mask >> 8)};
+      AppendPattern(filter.data, filter.data_mask, &instruction->pattern, &instruction->mask);
+      return true;
+    }
+    case ApcfFilterType::SERVICE_DATA: {
+      // The data starts with the service UUID
+      instruction->opcode = Opcode::AD_PREFIX;
+      instruction->ad_types = AdTypes({
+          static_cast<uint8_t>(GapDataType::SERVICE_DATA_16_BIT_UUIDS),
+          static_cast<uint8_t>(GapDataType::SERVICE_DATA_32_BIT_UUIDS),
+          static_cast<uint8_t>(GapDataType::SERVICE_DATA_128_BIT_UUIDS),
+      });
+      AppendPattern(filter.data, filter.data_mask, &instruction->pattern, &instruction->mask);
+      return true;
+    }
+    case ApcfFilterType::TRANSPORT_DISCOVERY_DATA: {
+      // Only the organization and the flags are compared, the blocks that follow are variable
+      instruction->opcode = Opcode::AD_PREFIX;
+      instruction->ad_types = AdTypes({static_cast<uint8_t>(GapDataType::TRANSPORT_DISCOVERY_DATA)});
+      instruction->pattern = {filter.org_id, filter.tds_flags};
+      instruction->mask = {0xff, filter.tds_flags_mask};
+      return true;
+    }
+    case ApcfFilterType::AD_TYPE: {
+      instruction->opcode = Opcode::AD_PREFIX;
+      instruction->ad_types = AdTypes({filter.ad_type});
+      AppendPattern(filter.data, filter.data_mask, &instruction->pattern, &instruction->mask);
+      return true;
+    }
+    default:
+      // Matches any report
+      return true;
+  }
+}
+
+bool LeScanningFilterEngine::Matches(
+    uint8_t address_type, Address address, int8_t rssi, const std::vector<uint8_t>& advertising_data) {
+  if (!enabled_) {
+    return true;
+  }
+
+  address_is_rpa_ = AddressWithType(address, static_cast<AddressType>(address_type)).IsRpa();
+
+  // Parse the AD structures once for all filters
+  ad_structures_.clear();
+  ad_types_present_.reset();
+  for (size_t offset = 0; offset + 1 < advertising_data.size();) {
+    uint8_t length = advertising_data[offset];
+    if (length == 0) {
+      offset++;
+      continue;
+    }
+    if (offset + 1 + length > advertising_data.size()) {
+      break;
+    }
+    uint8_t type = advertising_data[offset + 1];
+    ad_structures_.push_back({type, static_cast<uint16_t>(offset + 2), static_cast<uint8_t>(length - 1)});
+    ad_types_present_.set(type);
+    offset += 1 + length;
+  }
+
+  for (const auto& [filter_index, program] : programs_) {
+    if (program.has_parameters && Evaluate(program, address, rssi, advertising_data.data())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LeScanningFilterEngine::Evaluate(
+    const FilterProgram& program, Address address, int8_t rssi, const uint8_t* data) const {
+  if (rssi != kRssiUnknown && rssi < program.rssi_threshold) {
+    return false;
+  }
+
+  bool has_features = false;
+  for (size_t feature = 0; feature < kFeatureCount; feature++) {
+    const auto& instructions = program.features[feature];
+    if (!(program.feature_selection & (1 << feature)) || instructions.empty()) {
+      continue;
+    }
+    has_features = true;
+
+    // Instructions of a feature are combined with the list logic, features with the filter logic
+    bool and_instructions = program.list_logic_type & (1 << feature);
+    bool feature_matches = and_instructions;
+    for (const auto& instruction : instructions) {
+      if (Execute(instruction, address, data) != and_instructions) {
+        feature_matches = !and_instructions;
+        break;
+      }
+    }
+
+    if (feature_matches != program.and_features) {
+      return feature_matches;
+    }
+  }
+
+  // Without any selected feature, the filter accepts all reports
+  return !has_features || program.and_features;
+}
+
+bool LeScanningFilterEngine::Execute(const Instruction& instruction, Address address, const uint8_t* data) const {
+  switch (instruction.opcode) {
+    case Opcode::ANY:
+      return true;
+    case Opcode::ADDRESS:
+      // The identity address the filter is for is only known after resolution
+      return address_is_rpa_ || address == instruction.address;
+    case Opcode::AD_PREFIX:
+    case Opcode::UUID_LIST:
+      break;
+  }
+
+  if ((ad_types_present_ & instruction.ad_types).none()) {
+    return false;
+  }
+
+  for (const AdStructure& ad : ad_structures_) {
+    if (!instruction.ad_types.test(ad.type)) {
+      continue;
+    }
+    const uint8_t* ad_data = data + ad.offset;
+
+    if (instruction.opcode == Opcode::AD_PREFIX) {
+      if (ad.length >= instruction.pattern.size() &&
+          MaskedEquals(ad_data, instruction.pattern.data(), instruction.mask.data(), instruction.pattern.size())) {
+        return true;
+      }
+      continue;
+    }
+
+    size_t element_size = UuidListElementSize(ad.type);
+    const uint8_t* pattern = instruction.pattern.data();
+    const uint8_t* mask = instruction.mask.data();
+    if (element_size == Uuid::kNumBytes32 && !instruction.matches_32_bit_uuids) {
+      continue;
+    }
+    if (element_size == Uuid::kNumBytes16 && !instruction.matches_16_bit_uuids) {
+      continue;
+    }
+    if (element_size != Uuid::kNumBytes128) {
+      pattern += kShortUuidOffset;
+      mask += kShortUuidOffset;
+    }
+    for (size_t offset = 0; offset + element_size <= ad.length; offset += element_size) {
+      if (MaskedEquals(ad_data + offset, pattern, mask, element_size)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool LeScanningFilterEngine::MaskedEquals(
+    const uint8_t* data, const uint8_t* pattern, const uint8_t* mask, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if ((data[i] & mask[i]) != (pattern[i] & mask[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "hci/address.h"
+#include "hci/address_with_type.h"
+#include "hci/hci_packets.h"
+#include "hci/le_scanning_callback.h"
+
+namespace bluetooth::hci {
+
+/// The LE Scanning filter engine applies the advertising packet content
+/// filters on the host, for controllers without the APCF vendor
+/// commands, so that unmatched advertising reports are dropped before
+/// they are delivered to the scanning callbacks.
+///
+/// The filters are given with the same parameters as the APCF commands,
+/// and each content filter is compiled into an instruction matching the
+/// AD structures of the advertising data. The advertising data is
+/// parsed once per report, then the instructions of every filter index
+/// are evaluated against the parsed structures.
+///
+/// The engine never rejects a report the upper layers would accept:
+/// where the controller semantics cannot be reproduced on the host
+/// (e.g. addresses to resolve with an IRK), the filter matches. The
+/// upper layers match the address after resolving it, so a resolvable
+/// private address matches any address filter.
+
+class LeScanningFilterEngine {
+ public:
+  LeScanningFilterEngine(){};
+  LeScanningFilterEngine(const LeScanningFilterEngine&) = delete;
+  LeScanningFilterEngine& operator=(const LeScanningFilterEngine&) = delete;
+
+  /// Enable or disable the filtering. All reports match while disabled.
+  void SetEnabled(bool enabled) {
+    enabled_ = enabled;
+  }
+  bool IsEnabled() const {
+    return enabled_;
+  }
+
+  /// Add, delete or clear the filtering parameters of a filter index.
+  /// Deleting a filter index also removes its content filters.
+  void SetFilteringParameters(ApcfAction action, uint8_t filter_index, const AdvertisingFilterParameter& parameter);
+
+  /// Compile and add content filters to a filter index.
+  void AddFilters(uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& filters);
+
+  /// Returns true if the complete advertising data matches any filter
+  /// index, or if the filtering is disabled. |address_type| and |address|
+  /// are the advertiser address as received, before resolution.
+  bool Matches(uint8_t address_type, Address address, int8_t rssi, const std::vector<uint8_t>& advertising_data);
+
+ private:
+  /// Number of filter types that can be selected in feature_selection.
+  static constexpr size_t kFeatureCount = static_cast<size_t>(ApcfFilterType::AD_TYPE) + 1;
+  /// RSSI reported when not available.
+  static constexpr int8_t kRssiUnknown = 127;
+
+  enum class Opcode : uint8_t {
+    /// Always matches.
+    ANY,
+    /// Matches the advertiser address.
+    ADDRESS,
+    /// Matches the first octets of an AD structure of one of the AD types.
+    AD_PREFIX,
+    /// Matches any UUID in an AD structure listing UUIDs of one of the AD types.
+    UUID_LIST,
+  };
+
+  struct Instruction {
+    Opcode opcode{Opcode::ANY};
+    Address address;
+    /// AD types the instruction applies to.
+    std::bitset<256> ad_types;
+    /// Pattern and mask of the same size, compared with the AD structure data.
+    /// For UUID_LIST they are the 128-bit UUID in little endian, and the
+    /// listed 16-bit and 32-bit UUIDs are compared with its octets 12 to 15.
+    std::vector<uint8_t> pattern;
+    std::vector<uint8_t> mask;
+    /// For UUID_LIST, whether UUIDs listed in 16-bit or 32-bit can match.
+    bool matches_16_bit_uuids{false};
+    bool matches_32_bit_uuids{false};
+  };
+
+  struct FilterProgram {
+    bool has_parameters{false};
+    uint16_t feature_selection{0};
+    uint16_t list_logic_type{0};
+    bool and_features{false};
+    int8_t rssi_threshold{INT8_MIN};
+    std::array<std::vector<Instruction>, kFeatureCount> features;
+  };
+
+  struct AdStructure {
+    uint8_t type;
+    uint16_t offset;
+    uint8_t length;
+  };
+
+  /// Compile one content filter, returns false if it cannot be used.
+  static bool Compile(const AdvertisingPacketContentFilterCommand& filter, Instruction* instruction);
+
+  bool Evaluate(const FilterProgram& program, Address address, int8_t rssi, const uint8_t* data) const;
+  bool Execute(const Instruction& instruction, Address address, const uint8_t* data) const;
+
+  static bool MaskedEquals(const uint8_t* data, const uint8_t* pattern, const uint8_t* mask, size_t length);
+
+  bool enabled_{false};
+  std::map<uint8_t, FilterProgram> programs_;
+
+  /// AD structures of the report being matched, kept to avoid allocating
+  /// for each report.
+  std::vector<AdStructure> ad_structures_;
+  std::bitset<256> ad_types_present_;
+  /// Whether the advertiser address of the report being matched is a
+  /// resolvable private address.
+  bool address_is_rpa_{false};
+};
+
+}  // namespace bluetooth::hci
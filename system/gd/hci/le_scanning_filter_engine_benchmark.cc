@@ -0,0 +1,128 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/address.h"
+#include "hci/le_scanning_filter_engine.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+using ::bluetooth::hci::Address;
+using ::bluetooth::hci::AddressType;
+using ::bluetooth::hci::AdvertisingFilterParameter;
+using ::bluetooth::hci::AdvertisingPacketContentFilterCommand;
+using ::bluetooth::hci::ApcfAction;
+using ::bluetooth::hci::ApcfFilterType;
+using ::bluetooth::hci::DeliveryMode;
+using ::bluetooth::hci::LeScanningFilterEngine;
+using ::bluetooth::hci::Uuid;
+
+namespace {
+
+constexpr size_t kDevices = 500;
+// Public addresses, so that the address filters are not matched by resolvable private addresses.
+constexpr uint8_t kAddressType = static_cast<uint8_t>(AddressType::PUBLIC_DEVICE_ADDRESS);
+// Filters are spread over this many kinds, see MakeFilter.
+constexpr size_t kFilterKinds = 4;
+
+struct Report {
+  Address address;
+  int8_t rssi;
+  std::vector<uint8_t> advertising_data;
+};
+
+// Advertisers of a crowded scan, each with flags, a 16-bit UUID list, a local name and manufacturer data.
+std::vector<Report> MakeTrace() {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> rssi(-95, -45);
+
+  std::vector<Report> trace(kDevices);
+  for (size_t i = 0; i < kDevices; i++) {
+    Report& report = trace[i];
+    report.address = Address({0xc0, 0x11, 0x22, 0x33, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)});
+    report.rssi = static_cast<int8_t>(rssi(generator));
+    uint8_t id = static_cast<uint8_t>(i);
+    uint8_t digit = static_cast<uint8_t>('0' + i % 10);
+    // Flags, 16-bit UUIDs, complete local name and iBeacon manufacturer data
+    report.advertising_data = {0x02, 0x01, 0x06, 0x05, 0x03, 0x0a, 0x18, id,   0xfe, 0x06, 0x09, 'd', 'e', 'v',
+                               digit, id,   0x0b, 0xff, 0x4c, 0x00, 0x02, 0x15, id,   id,   id,   id,  id,  id};
+  }
+  return trace;
+}
+
+// Filters of an application looking for a set of known devices by UUID, name, manufacturer data or address.
+AdvertisingPacketContentFilterCommand MakeFilter(size_t i) {
+  AdvertisingPacketContentFilterCommand filter{};
+  // Devices are matched by every other filter
+  uint8_t id = static_cast<uint8_t>(i % 2 == 0 ? i : 0xff - i);
+  switch (i % kFilterKinds) {
+    case 0:
+      filter.filter_type = ApcfFilterType::SERVICE_UUID;
+      filter.uuid = Uuid::From16Bit(0xfe00 | id);
+      break;
+    case 1:
+      filter.filter_type = ApcfFilterType::LOCAL_NAME;
+      filter.name = {'d', 'e', 'v', static_cast<uint8_t>('0' + i % 10), id};
+      break;
+    case 2:
+      filter.filter_type = ApcfFilterType::MANUFACTURER_DATA;
+      filter.company = 0x004c;
+      filter.data = {0x02, 0x15, id, id};
+      filter.data_mask = {0xff, 0xff, 0xff, 0xff};
+      break;
+    case 3:
+      filter.filter_type = ApcfFilterType::BROADCASTER_ADDRESS;
+      filter.address = Address({0xc0, 0x11, 0x22, 0x33, 0x00, id});
+      break;
+  }
+  return filter;
+}
+
+// Replays the trace through the engine. Argument is the number of filter indexes, with one content filter each.
+void BM_ScanFilterEngineMatches(State& state) {
+  static const std::vector<Report> trace = MakeTrace();
+  LeScanningFilterEngine engine;
+  engine.SetEnabled(true);
+  for (uint8_t i = 0; i < state.range(0); i++) {
+    AdvertisingPacketContentFilterCommand filter = MakeFilter(i);
+    AdvertisingFilterParameter parameter{};
+    parameter.feature_selection = 1 << static_cast<uint8_t>(filter.filter_type);
+    parameter.rssi_high_thresh = static_cast<uint8_t>(-128);
+    parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+    engine.SetFilteringParameters(ApcfAction::ADD, i, parameter);
+    engine.AddFilters(i, {filter});
+  }
+
+  size_t reports = 0;
+  size_t matched = 0;
+  for (auto _ : state) {
+    for (const Report& report : trace) {
+      matched += engine.Matches(kAddressType, report.address, report.rssi, report.advertising_data);
+    }
+    reports += trace.size();
+  }
+
+  state.counters["matches_per_sec"] = Counter(reports, Counter::kIsRate);
+  state.counters["matched_ratio"] = Counter(static_cast<double>(matched) / reports);
+}
+
+BENCHMARK(BM_ScanFilterEngineMatches)->ArgName("filters")->Arg(1)->Arg(8)->Arg(64);
+
+}  // namespace
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_filter_engine.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth::hci {
+
+// Test addresses and data.
+static const Address kTestAddress = Address({0, 1, 2, 3, 4, 5});
+static const Address kOtherAddress = Address({0, 1, 2, 3, 4, 6});
+static const Address kResolvableAddress = Address({0, 1, 2, 3, 4, 0x45});
+static constexpr uint8_t kPublicAddressType = static_cast<uint8_t>(AddressType::PUBLIC_DEVICE_ADDRESS);
+static constexpr uint8_t kRandomAddressType = static_cast<uint8_t>(AddressType::RANDOM_DEVICE_ADDRESS);
+static constexpr int8_t kRssi = -50;
+static constexpr uint8_t kFilterIndex = 0x01;
+static constexpr uint8_t kOtherFilterIndex = 0x02;
+
+// Flags, complete local name "abc", manufacturer data of company 0x004c.
+static const std::vector<uint8_t> kNameAndManufacturerData = {
+    0x02, 0x01, 0x06, 0x04, 0x09, 'a', 'b', 'c', 0x05, 0xff, 0x4c, 0x00, 0x12, 0x34};
+// Complete list of 128-bit UUIDs with 0000180f-0000-1000-8000-00805f9b34fb, then 16-bit service data of 0x180f.
+static const std::vector<uint8_t> kUuidAndServiceData = {
+    0x11, 0x07, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10,
+    0x00, 0x00, 0x0f, 0x18, 0x00, 0x00, 0x04, 0x16, 0x0f, 0x18, 0x64};
+
+class LeScanningFilterEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    engine_.SetEnabled(true);
+  }
+
+  void SetParameters(
+      uint8_t filter_index,
+      uint16_t feature_selection,
+      uint16_t list_logic_type = 0,
+      uint8_t filter_logic_type = 0,
+      int8_t rssi_threshold = -128) {
+    AdvertisingFilterParameter parameter{};
+    parameter.feature_selection = feature_selection;
+    parameter.list_logic_type = list_logic_type;
+    parameter.filter_logic_type = filter_logic_type;
+    parameter.rssi_high_thresh = static_cast<uint8_t>(rssi_threshold);
+    parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+    engine_.SetFilteringParameters(ApcfAction::ADD, filter_index, parameter);
+  }
+
+  static uint16_t Feature(ApcfFilterType filter_type) {
+    return 1 << static_cast<uint8_t>(filter_type);
+  }
+
+  static AdvertisingPacketContentFilterCommand ManufacturerFilter(
+      uint16_t company, std::vector<uint8_t> data, std::vector<uint8_t> data_mask = {}) {
+    AdvertisingPacketContentFilterCommand filter{};
+    filter.filter_type = ApcfFilterType::MANUFACTURER_DATA;
+    filter.company = company;
+    filter.data = std::move(data);
+    filter.data_mask = std::move(data_mask);
+    return filter;
+  }
+
+  static AdvertisingPacketContentFilterCommand NameFilter(std::string name) {
+    AdvertisingPacketContentFilterCommand filter{};
+    filter.filter_type = ApcfFilterType::LOCAL_NAME;
+    filter.name = std::vector<uint8_t>(name.begin(), name.end());
+    return filter;
+  }
+
+  static AdvertisingPacketContentFilterCommand AddressFilter(Address address) {
+    AdvertisingPacketContentFilterCommand filter{};
+    filter.filter_type = ApcfFilterType::BROADCASTER_ADDRESS;
+    filter.address = address;
+    return filter;
+  }
+
+  LeScanningFilterEngine engine_;
+};
+
+TEST_F(LeScanningFilterEngineTest, disabled_matches_everything) {
+  engine_.SetEnabled(false);
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::LOCAL_NAME));
+  engine_.AddFilters(kFilterIndex, {NameFilter("xyz")});
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, enabled_without_filters_matches_nothing) {
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+
+  // A filter index without selected features accepts all reports.
+  SetParameters(kFilterIndex, 0);
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, local_name_prefix) {
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::LOCAL_NAME));
+  engine_.AddFilters(kFilterIndex, {NameFilter("ab")});
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kUuidAndServiceData));
+
+  engine_.SetFilteringParameters(ApcfAction::CLEAR, 0, {});
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::LOCAL_NAME));
+  engine_.AddFilters(kFilterIndex, {NameFilter("abcd")});
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, manufacturer_data_with_mask) {
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::MANUFACTURER_DATA));
+  engine_.AddFilters(kFilterIndex, {ManufacturerFilter(0x004c, {0x10, 0x00}, {0xf0, 0x00})});
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+
+  engine_.SetFilteringParameters(ApcfAction::CLEAR, 0, {});
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::MANUFACTURER_DATA));
+  engine_.AddFilters(kFilterIndex, {ManufacturerFilter(0x004c, {0x20, 0x00}, {0xf0, 0x00})});
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+
+  engine_.SetFilteringParameters(ApcfAction::CLEAR, 0, {});
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::MANUFACTURER_DATA));
+  engine_.AddFilters(kFilterIndex, {ManufacturerFilter(0x00e0, {})});
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, service_uuid_in_any_list_size) {
+  AdvertisingPacketContentFilterCommand filter{};
+  filter.filter_type = ApcfFilterType::SERVICE_UUID;
+  filter.uuid = Uuid::From16Bit(0x180f);
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::SERVICE_UUID));
+  engine_.AddFilters(kFilterIndex, {filter});
+
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kUuidAndServiceData));
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, {0x05, 0x03, 0x0a, 0x18, 0x0f, 0x18}));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, {0x03, 0x03, 0x0a, 0x18}));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, service_data) {
+  AdvertisingPacketContentFilterCommand filter{};
+  filter.filter_type = ApcfFilterType::SERVICE_DATA;
+  filter.data = {0x0f, 0x18};
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::SERVICE_DATA));
+  engine_.AddFilters(kFilterIndex, {filter});
+
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kUuidAndServiceData));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, list_and_filter_logic) {
+  // Any of the names, and the address.
+  SetParameters(
+      kFilterIndex,
+      Feature(ApcfFilterType::LOCAL_NAME) | Feature(ApcfFilterType::BROADCASTER_ADDRESS),
+      /* list_logic_type */ 0,
+      /* filter_logic_type */ 1);
+  engine_.AddFilters(kFilterIndex, {NameFilter("xyz"), NameFilter("abc"), AddressFilter(kTestAddress)});
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kOtherAddress, kRssi, kNameAndManufacturerData));
+
+  // All of the names, or the address.
+  SetParameters(
+      kFilterIndex,
+      Feature(ApcfFilterType::LOCAL_NAME) | Feature(ApcfFilterType::BROADCASTER_ADDRESS),
+      Feature(ApcfFilterType::LOCAL_NAME),
+      /* filter_logic_type */ 0);
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kOtherAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, rssi_threshold) {
+  SetParameters(kFilterIndex, 0, 0, 0, /* rssi_threshold */ -60);
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, -60, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, -61, kNameAndManufacturerData));
+  // The RSSI is not available.
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, 127, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, any_filter_index_matches) {
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::LOCAL_NAME));
+  engine_.AddFilters(kFilterIndex, {NameFilter("xyz")});
+  SetParameters(kOtherFilterIndex, Feature(ApcfFilterType::BROADCASTER_ADDRESS));
+  engine_.AddFilters(kOtherFilterIndex, {AddressFilter(kTestAddress)});
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kOtherAddress, kRssi, kNameAndManufacturerData));
+
+  engine_.SetFilteringParameters(ApcfAction::DELETE, kOtherFilterIndex, {});
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, resolvable_address_matches) {
+  AdvertisingPacketContentFilterCommand filter = AddressFilter(kOtherAddress);
+  filter.irk[0] = 0x01;
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::BROADCASTER_ADDRESS));
+  engine_.AddFilters(kFilterIndex, {filter});
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, resolvable_private_address_matches_any_address) {
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::BROADCASTER_ADDRESS));
+  engine_.AddFilters(kFilterIndex, {AddressFilter(kTestAddress)});
+  // The address may resolve to the identity address of the filter.
+  ASSERT_TRUE(engine_.Matches(kRandomAddressType, kResolvableAddress, kRssi, kNameAndManufacturerData));
+  // The same address is not resolvable when public, nor random non-resolvable or static ones.
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kResolvableAddress, kRssi, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kRandomAddressType, kOtherAddress, kRssi, kNameAndManufacturerData));
+  ASSERT_FALSE(engine_.Matches(kRandomAddressType, Address({0, 1, 2, 3, 4, 0xc5}), kRssi, kNameAndManufacturerData));
+}
+
+TEST_F(LeScanningFilterEngineTest, malformed_advertising_data) {
+  SetParameters(kFilterIndex, Feature(ApcfFilterType::LOCAL_NAME));
+  engine_.AddFilters(kFilterIndex, {NameFilter("ab")});
+  // The name overflows the advertising data.
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, {0x04, 0x09, 'a', 'b'}));
+  ASSERT_FALSE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, {}));
+  ASSERT_TRUE(engine_.Matches(kPublicAddressType, kTestAddress, kRssi, {0x00, 0x03, 0x09, 'a', 'b'}));
+}
+
+}  // namespace bluetooth::hci
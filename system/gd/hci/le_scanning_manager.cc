@@ -23,10 +23,13 @@
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/le_periodic_sync_manager.h"
+#include "hci/le_scanning_filter_engine.h"
 #include "hci/le_scanning_interface.h"
 #include "hci/le_scanning_reassembler.h"
+#include "hci/le_scanning_result_cache.h"
 #include "hci/vendor_specific_event_manager.h"
 #include "module.h"
+#include "os/alarm.h"
 #include "os/handler.h"
 #include "os/log.h"
 #include "os/system_properties.h"
@@ -55,9 +58,15 @@ constexpr uint8_t kScanResponseBit = 3;
 constexpr uint8_t kLegacyBit = 4;
 constexpr uint8_t kDataStatusBits = 5;
 
+// Scan results held at most while batching, before they are delivered early
+constexpr size_t kMaxBatchedScanResults = 256;
+
 // system properties
 const std::string kLeRxPathLossCompProperty = "bluetooth.hardware.radio.le_rx_path_loss_comp_db";
 const std::string kPropertyDisableApcfExtendedFeatures = "bluetooth.le.disable_apcf_extended_features";
+const std::string kPropertyScanResultRssiThreshold = "bluetooth.le.scan_result_dedup_rssi_threshold_db";
+const std::string kPropertyScanResultBatchInterval = "bluetooth.le.scan_result_batch_interval_ms";
+const std::string kPropertyHostScanFiltering = "bluetooth.le.host_scan_filtering.enabled";
 bool kDisableApcfExtendedFeatures = false;
 
 const ModuleFactory LeScanningManager::Factory = ModuleFactory([]() { return new LeScanningManager(); });
@@ -226,6 +235,8 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     batch_scan_config_.current_state = BatchScanState::DISABLED_STATE;
     batch_scan_config_.ref_value = kInvalidScannerId;
     le_rx_path_loss_comp_ = get_rx_path_loss_compensation();
+    scan_result_batch_alarm_ = std::make_unique<os::Alarm>(module_handler_);
+    set_scan_result_delivery_parameters(get_scan_result_delivery_parameters());
   }
 
   void stop() {
@@ -239,6 +250,8 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     }
     batch_scan_config_.current_state = BatchScanState::DISABLED_STATE;
     batch_scan_config_.ref_value = kInvalidScannerId;
+    scan_result_batch_alarm_.reset();
+    pending_scan_results_.clear();
     scanning_callbacks_ = &null_scanning_callback_;
     periodic_sync_manager_.SetScanningCallback(scanning_callbacks_);
   }
@@ -309,6 +322,24 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     return compensation;
   }
 
+  ScanResultDeliveryParameters get_scan_result_delivery_parameters() {
+    ScanResultDeliveryParameters parameters;
+    auto threshold_prop = os::GetSystemProperty(kPropertyScanResultRssiThreshold);
+    if (threshold_prop) {
+      auto threshold_number = common::Int64FromString(threshold_prop.value());
+      if (threshold_number && threshold_number.value() >= 0 && threshold_number.value() <= UINT8_MAX) {
+        parameters.deduplicate = true;
+        parameters.rssi_change_threshold = threshold_number.value();
+      } else {
+        LOG_ERROR("Invalid scan result RSSI change threshold: %s", threshold_prop.value().c_str());
+      }
+    }
+    parameters.batch_interval =
+        std::chrono::milliseconds(os::GetSystemPropertyUint32(kPropertyScanResultBatchInterval, 0));
+    parameters.filter_on_host = os::GetSystemPropertyBool(kPropertyHostScanFiltering, false);
+    return parameters;
+  }
+
   int8_t get_rssi_after_calibration(int8_t rssi) {
     if (le_rx_path_loss_comp_ == 0 || rssi == kLeScanRssiUnknown) {
       return rssi;
@@ -452,7 +483,34 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
           break;
       }
 
-      scanning_callbacks_->OnScanResult(
+      // Without APCF, the filters may be applied on the host before the report is delivered
+      if (filter_on_host_ &&
+          !host_filter_engine_.Matches(address_type, address, rssi, complete_advertising_data.value())) {
+        return;
+      }
+
+      int8_t calibrated_rssi = get_rssi_after_calibration(rssi);
+      if (!scanning_result_cache_.ShouldDeliver(
+              address_type, address, advertising_sid, calibrated_rssi, complete_advertising_data.value())) {
+        return;
+      }
+
+      if (scan_result_batch_interval_.count() == 0) {
+        scanning_callbacks_->OnScanResult(
+            event_type,
+            address_type,
+            address,
+            primary_phy,
+            secondary_phy,
+            advertising_sid,
+            tx_power,
+            calibrated_rssi,
+            periodic_advertising_interval,
+            std::move(complete_advertising_data.value()));
+        return;
+      }
+
+      pending_scan_results_.push_back(ScanResult{
           event_type,
           address_type,
           address,
@@ -460,12 +518,28 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
           secondary_phy,
           advertising_sid,
           tx_power,
-          get_rssi_after_calibration(rssi),
+          calibrated_rssi,
           periodic_advertising_interval,
-          complete_advertising_data.value());
+          std::move(complete_advertising_data.value())});
+      if (pending_scan_results_.size() >= kMaxBatchedScanResults) {
+        flush_scan_results();
+      } else if (pending_scan_results_.size() == 1) {
+        scan_result_batch_alarm_->Schedule(
+            common::BindOnce(&impl::flush_scan_results, common::Unretained(this)), scan_result_batch_interval_);
+      }
     }
   }
 
+  void flush_scan_results() {
+    scan_result_batch_alarm_->Cancel();
+    if (pending_scan_results_.empty()) {
+      return;
+    }
+    std::vector<ScanResult> scan_results;
+    scan_results.swap(pending_scan_results_);
+    scanning_callbacks_->OnScanResults(std::move(scan_results));
+  }
+
   void configure_scan() {
     std::vector<PhyScanParameters> parameter_vector;
     PhyScanParameters phy_scan_parameters;
@@ -547,6 +621,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void scan(bool start) {
     if (start) {
+      scanning_result_cache_.Clear();
       configure_scan();
       start_scan();
     } else {
@@ -556,6 +631,10 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
         paused_ = false;
       }
       stop_scan();
+      LOG_INFO(
+          "Scan results delivered:%zu suppressed:%zu",
+          scanning_result_cache_.GetDeliveredCount(),
+          scanning_result_cache_.GetSuppressedCount());
     }
   }
 
@@ -593,6 +672,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
     is_scanning_ = false;
+    flush_scan_results();
 
     switch (api_type_) {
       case ScanApiType::EXTENDED:
@@ -646,9 +726,35 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     filter_policy_ = filter_policy;
   }
 
+  void set_scan_result_delivery_parameters(ScanResultDeliveryParameters parameters) {
+    LOG_INFO(
+        "deduplicate:%d rssi_change_threshold:%hhu batch_interval_ms:%lld filter_on_host:%d",
+        parameters.deduplicate,
+        parameters.rssi_change_threshold,
+        static_cast<long long>(parameters.batch_interval.count()),
+        parameters.filter_on_host);
+    scanning_result_cache_.SetParameters(parameters.deduplicate, parameters.rssi_change_threshold);
+    scan_result_batch_interval_ = parameters.batch_interval;
+    if (scan_result_batch_interval_.count() == 0) {
+      flush_scan_results();
+    }
+
+    // The controller applies the filters itself when it supports APCF
+    bool filter_on_host = parameters.filter_on_host && !is_filter_supported_;
+    if (filter_on_host_ && !filter_on_host) {
+      host_filter_engine_.SetEnabled(false);
+      host_filter_engine_.SetFilteringParameters(ApcfAction::CLEAR, 0, {});
+    }
+    filter_on_host_ = filter_on_host;
+  }
+
   void scan_filter_enable(bool enable) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      if (filter_on_host_) {
+        host_filter_engine_.SetEnabled(enable);
+      } else {
+        LOG_WARN("Advertising filter is not supported");
+      }
       return;
     }
 
@@ -672,7 +778,11 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   void scan_filter_parameter_setup(
       ApcfAction action, uint8_t filter_index, AdvertisingFilterParameter advertising_filter_parameter) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      if (filter_on_host_) {
+        host_filter_engine_.SetFilteringParameters(action, filter_index, advertising_filter_parameter);
+      } else {
+        LOG_WARN("Advertising filter is not supported");
+      }
       return;
     }
 
@@ -735,7 +845,11 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void scan_filter_add(uint8_t filter_index, std::vector<AdvertisingPacketContentFilterCommand> filters) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      if (filter_on_host_) {
+        host_filter_engine_.AddFilters(filter_index, filters);
+      } else {
+        LOG_WARN("Advertising filter is not supported");
+      }
       return;
     }
 
@@ -1639,6 +1753,12 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   bool scan_on_resume_ = false;
   bool paused_ = false;
   LeScanningReassembler scanning_reassembler_;
+  LeScanningResultCache scanning_result_cache_;
+  bool filter_on_host_ = false;
+  LeScanningFilterEngine host_filter_engine_;
+  std::chrono::milliseconds scan_result_batch_interval_{0};
+  std::unique_ptr<os::Alarm> scan_result_batch_alarm_;
+  std::vector<ScanResult> pending_scan_results_;
   bool is_filter_supported_ = false;
   bool is_ad_type_filter_supported_ = false;
   bool is_batch_scan_supported_ = false;
@@ -1732,6 +1852,10 @@ void LeScanningManager::SetScanFilterPolicy(LeScanningFilterPolicy filter_policy
   CallOn(pimpl_.get(), &impl::set_scan_filter_policy, filter_policy);
 }
 
+void LeScanningManager::SetScanResultDeliveryParameters(ScanResultDeliveryParameters parameters) {
+  CallOn(pimpl_.get(), &impl::set_scan_result_delivery_parameters, parameters);
+}
+
 void LeScanningManager::ScanFilterEnable(bool enable) {
   CallOn(pimpl_.get(), &impl::scan_filter_enable, enable);
 }
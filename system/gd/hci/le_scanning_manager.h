@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include "common/callback.h"
@@ -34,6 +35,18 @@ enum class BatchScanMode : uint8_t {
   TRUNCATED_AND_FULL = 3,
 };
 
+struct ScanResultDeliveryParameters {
+  // Suppress the reports repeating an advertisement already delivered during the scan
+  bool deduplicate = false;
+  // Deliver a repeated advertisement again when its RSSI moved by more than this many dB
+  uint8_t rssi_change_threshold = 0;
+  // Deliver the scan results in batches at this interval, or each as it is received if zero
+  std::chrono::milliseconds batch_interval{0};
+  // Without APCF, apply the scan filters to the scan results on the host. The upper layers must then configure
+  // the filters of every scan client, with an all-pass filter index for the unfiltered ones.
+  bool filter_on_host = false;
+};
+
 class LeScanningManager : public bluetooth::Module {
  public:
   static constexpr uint8_t kMaxAppNum = 32;
@@ -56,6 +69,8 @@ class LeScanningManager : public bluetooth::Module {
 
   virtual void SetScanFilterPolicy(LeScanningFilterPolicy filter_policy);
 
+  virtual void SetScanResultDeliveryParameters(ScanResultDeliveryParameters parameters);
+
   /* Scan filter */
   virtual void ScanFilterEnable(bool enable);
 
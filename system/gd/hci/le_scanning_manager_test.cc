@@ -362,6 +362,160 @@ TEST_F(LeScanningManagerTest, start_scan_test) {
   test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
 }
 
+TEST_F(LeScanningManagerTest, scan_result_deduplication_test) {
+  start_le_scanning_manager();
+  le_scanning_manager->SetScanResultDeliveryParameters({.deduplicate = true, .rssi_change_threshold = 5});
+
+  // Enable scan
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The repeated report is only delivered once
+  LeAdvertisingResponse report = make_advertising_report();
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(1);
+
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report, report}));
+  sync_client_handler();
+}
+
+TEST_F(LeScanningManagerTest, scan_result_batching_test) {
+  start_le_scanning_manager();
+  le_scanning_manager->SetScanResultDeliveryParameters({.batch_interval = std::chrono::seconds(10)});
+
+  // Enable scan
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // Results are held until the end of the batching interval
+  LeAdvertisingResponse report = make_advertising_report();
+  LeAdvertisingResponse other_report = make_advertising_report();
+  Address::FromString("12:34:56:78:9a:bd", other_report.address_);
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(0);
+
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report, other_report}));
+  sync_client_handler();
+  ::testing::Mock::VerifyAndClearExpectations(&mock_callbacks_);
+
+  // Stopping the scan delivers them
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(2);
+  le_scanning_manager->Scan(false);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+}
+
+TEST_F(LeScanningManagerTest, scan_filter_on_host_test) {
+  start_le_scanning_manager();
+  le_scanning_manager->SetScanResultDeliveryParameters({.filter_on_host = true});
+
+  // Without APCF, the filters are applied to the reports on the host
+  AdvertisingFilterParameter advertising_filter_parameter{};
+  advertising_filter_parameter.feature_selection = 1 << static_cast<uint8_t>(ApcfFilterType::BROADCASTER_ADDRESS);
+  advertising_filter_parameter.rssi_high_thresh = static_cast<uint8_t>(-128);
+  advertising_filter_parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+  le_scanning_manager->ScanFilterParameterSetup(ApcfAction::ADD, 0x04, advertising_filter_parameter);
+  AdvertisingPacketContentFilterCommand filter = make_filter(ApcfFilterType::BROADCASTER_ADDRESS);
+  Address::FromString("12:34:56:78:9a:bc", filter.address);
+  le_scanning_manager->ScanFilterAdd(0x04, {filter});
+  le_scanning_manager->ScanFilterEnable(true);
+
+  // Enable scan
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // Only the report of the filtered address is delivered
+  LeAdvertisingResponse report = make_advertising_report();
+  LeAdvertisingResponse other_report = make_advertising_report();
+  Address::FromString("12:34:56:78:9a:bd", other_report.address_);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, report.address_, _, _, _, _, _, _, _)).Times(1);
+
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report, other_report}));
+  sync_client_handler();
+}
+
+TEST_F(LeScanningManagerTest, scan_filter_on_host_with_unfiltered_client_test) {
+  start_le_scanning_manager();
+  le_scanning_manager->SetScanResultDeliveryParameters({.filter_on_host = true});
+
+  // A batch client filters on an address
+  AdvertisingFilterParameter advertising_filter_parameter{};
+  advertising_filter_parameter.feature_selection = 1 << static_cast<uint8_t>(ApcfFilterType::BROADCASTER_ADDRESS);
+  advertising_filter_parameter.rssi_high_thresh = static_cast<uint8_t>(-128);
+  advertising_filter_parameter.delivery_mode = DeliveryMode::BATCH;
+  le_scanning_manager->ScanFilterEnable(true);
+  AdvertisingPacketContentFilterCommand filter = make_filter(ApcfFilterType::BROADCASTER_ADDRESS);
+  Address::FromString("12:34:56:78:9a:bc", filter.address);
+  le_scanning_manager->ScanFilterAdd(0x04, {filter});
+  le_scanning_manager->ScanFilterParameterSetup(ApcfAction::ADD, 0x04, advertising_filter_parameter);
+
+  // An unfiltered regular client gets the all-pass filter index
+  AdvertisingFilterParameter all_pass_filter_parameter{};
+  all_pass_filter_parameter.rssi_high_thresh = static_cast<uint8_t>(-128);
+  all_pass_filter_parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+  le_scanning_manager->ScanFilterEnable(true);
+  le_scanning_manager->ScanFilterParameterSetup(ApcfAction::ADD, 0x01, all_pass_filter_parameter);
+
+  // Enable scan
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The reports of every address are delivered to the unfiltered client
+  LeAdvertisingResponse report = make_advertising_report();
+  LeAdvertisingResponse other_report = make_advertising_report();
+  Address::FromString("12:34:56:78:9a:bd", other_report.address_);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, report.address_, _, _, _, _, _, _, _)).Times(1);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, other_report.address_, _, _, _, _, _, _, _)).Times(1);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report, other_report}));
+  sync_client_handler();
+
+  // Once the unfiltered client stops, only the filtered address is delivered
+  le_scanning_manager->ScanFilterParameterSetup(ApcfAction::DELETE, 0x01, all_pass_filter_parameter);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, report.address_, _, _, _, _, _, _, _)).Times(1);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, other_report.address_, _, _, _, _, _, _, _)).Times(0);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report, other_report}));
+  sync_client_handler();
+}
+
+TEST_F(LeScanningManagerTest, scan_filter_not_on_host_by_default_test) {
+  start_le_scanning_manager();
+
+  // Without APCF nor host filtering, the filters are ignored
+  AdvertisingFilterParameter advertising_filter_parameter{};
+  advertising_filter_parameter.feature_selection = 1 << static_cast<uint8_t>(ApcfFilterType::BROADCASTER_ADDRESS);
+  advertising_filter_parameter.rssi_high_thresh = static_cast<uint8_t>(-128);
+  advertising_filter_parameter.delivery_mode = DeliveryMode::BATCH;
+  le_scanning_manager->ScanFilterEnable(true);
+  AdvertisingPacketContentFilterCommand filter = make_filter(ApcfFilterType::BROADCASTER_ADDRESS);
+  Address::FromString("12:34:56:78:9a:bc", filter.address);
+  le_scanning_manager->ScanFilterAdd(0x04, {filter});
+  le_scanning_manager->ScanFilterParameterSetup(ApcfAction::ADD, 0x04, advertising_filter_parameter);
+
+  // Enable scan
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  LeAdvertisingResponse report = make_advertising_report();
+  LeAdvertisingResponse other_report = make_advertising_report();
+  Address::FromString("12:34:56:78:9a:bd", other_report.address_);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, report.address_, _, _, _, _, _, _, _)).Times(1);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, other_report.address_, _, _, _, _, _, _, _)).Times(1);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report, other_report}));
+  sync_client_handler();
+}
+
 TEST_F(LeScanningManagerTest, is_ad_type_filter_supported_false_test) {
   start_le_scanning_manager();
   ASSERT_TRUE(fake_registry_.IsStarted(&HciLayer::Factory));
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_scanning_result_cache.h"
+
+#include <cstdlib>
+
+namespace bluetooth::hci {
+
+void LeScanningResultCache::SetParameters(bool enabled, uint8_t rssi_change_threshold) {
+  enabled_ = enabled;
+  rssi_change_threshold_ = rssi_change_threshold;
+  cache_.clear();
+}
+
+bool LeScanningResultCache::ShouldDeliver(
+    uint8_t address_type,
+    Address address,
+    uint8_t advertising_sid,
+    int8_t rssi,
+    const std::vector<uint8_t>& advertising_data) {
+  if (!enabled_) {
+    delivered_count_++;
+    return true;
+  }
+
+  AdvertisingKey key{address, address_type, advertising_sid, HashAdvertisingData(advertising_data)};
+  auto it = cache_.find(key);
+  if (it != cache_.end()) {
+    if (std::abs(rssi - it->second) <= rssi_change_threshold_) {
+      suppressed_count_++;
+      return false;
+    }
+    it->second = rssi;
+  } else {
+    if (cache_.size() >= kMaximumCacheSize) {
+      cache_.clear();
+    }
+    cache_.emplace(key, rssi);
+  }
+
+  delivered_count_++;
+  return true;
+}
+
+uint64_t LeScanningResultCache::HashAdvertisingData(const std::vector<uint8_t>& advertising_data) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (uint8_t octet : advertising_data) {
+    hash = (hash ^ octet) * 0x100000001b3;
+  }
+  return hash;
+}
+
+}  // namespace bluetooth::hci
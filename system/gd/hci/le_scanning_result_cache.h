@@ -0,0 +1,105 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "hci/address.h"
+
+namespace bluetooth::hci {
+
+/// The LE Scanning result cache remembers the advertisements delivered
+/// to the scanning callbacks during a scan, so that an advertiser repeating
+/// the same advertising data at about the same RSSI is reported only once.
+/// Advertisements are keyed by address, address type, SID and a hash of
+/// the complete advertising data, so that new data is always delivered.
+
+class LeScanningResultCache {
+ public:
+  LeScanningResultCache(){};
+  LeScanningResultCache(const LeScanningResultCache&) = delete;
+  LeScanningResultCache& operator=(const LeScanningResultCache&) = delete;
+
+  /// Maximum number of advertisements remembered. The cache starts over
+  /// when it is full, e.g. with advertisers rotating their address.
+  static constexpr size_t kMaximumCacheSize = 1024;
+
+  /// Configure the deduplication. When enabled, a repeated advertisement is
+  /// delivered again only if its RSSI moved by more than
+  /// |rssi_change_threshold| dB since it was last delivered.
+  void SetParameters(bool enabled, uint8_t rssi_change_threshold);
+
+  /// Returns true if the complete advertisement must be delivered to the
+  /// scanning callbacks, false if it is a duplicate to suppress.
+  bool ShouldDeliver(
+      uint8_t address_type,
+      Address address,
+      uint8_t advertising_sid,
+      int8_t rssi,
+      const std::vector<uint8_t>& advertising_data);
+
+  /// Forget the delivered advertisements and reset the counters, e.g. when
+  /// a new scan starts.
+  void Clear() {
+    cache_.clear();
+    delivered_count_ = 0;
+    suppressed_count_ = 0;
+  }
+
+  /// Number of advertisements delivered and suppressed since the last Clear().
+  size_t GetDeliveredCount() const {
+    return delivered_count_;
+  }
+  size_t GetSuppressedCount() const {
+    return suppressed_count_;
+  }
+
+ private:
+  struct AdvertisingKey {
+    Address address;
+    uint8_t address_type;
+    uint8_t sid;
+    uint64_t data_hash;
+
+    bool operator==(const AdvertisingKey& other) const {
+      return address == other.address && address_type == other.address_type && sid == other.sid &&
+             data_hash == other.data_hash;
+    }
+  };
+
+  struct AdvertisingKeyHash {
+    size_t operator()(const AdvertisingKey& key) const {
+      return std::hash<Address>{}(key.address) ^ (key.data_hash + (key.sid << 8) + key.address_type);
+    }
+  };
+
+  /// FNV-1a hash of the advertising data.
+  static uint64_t HashAdvertisingData(const std::vector<uint8_t>& advertising_data);
+
+  bool enabled_{false};
+  uint8_t rssi_change_threshold_{0};
+
+  /// RSSI of the last delivered report for each advertisement.
+  std::unordered_map<AdvertisingKey, int8_t, AdvertisingKeyHash> cache_;
+
+  size_t delivered_count_{0};
+  size_t suppressed_count_{0};
+};
+
+}  // namespace bluetooth::hci
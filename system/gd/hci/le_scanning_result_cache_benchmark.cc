@@ -0,0 +1,108 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/address.h"
+#include "hci/le_scanning_result_cache.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+using ::bluetooth::hci::Address;
+using ::bluetooth::hci::LeScanningResultCache;
+
+namespace {
+
+// A crowded scan: 500 advertisers sending every 100 ms, for 10 seconds
+constexpr size_t kDevices = 500;
+constexpr size_t kReportsPerDevice = 100;
+// One in this many advertisers updates its data every second, e.g. a sensor value
+constexpr size_t kChangingDataRatio = 10;
+constexpr size_t kReportsPerSecond = 10;
+
+struct Report {
+  uint8_t address_type;
+  Address address;
+  uint8_t advertising_sid;
+  int8_t rssi;
+  std::vector<uint8_t> advertising_data;
+};
+
+// Reports of all advertisers interleaved in the order a controller would receive them. Each advertiser is a beacon
+// with its own 30 octets of manufacturer data, received at a stable RSSI with a few dB of noise.
+std::vector<Report> MakeTrace() {
+  std::mt19937 generator(42);
+  std::normal_distribution<float> noise(0.0f, 2.0f);
+  std::uniform_int_distribution<int> base_rssi(-95, -45);
+
+  std::vector<Report> devices(kDevices);
+  std::vector<int> device_rssi(kDevices);
+  for (size_t i = 0; i < kDevices; i++) {
+    Report& device = devices[i];
+    device.address_type = (i % 3 == 0) ? 0x00 : 0x01;
+    device.address = Address({0xc0, 0x11, 0x22, 0x33, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)});
+    device.advertising_sid = (i % 2 == 0) ? 0xff : 0x01;
+    device.advertising_data = {0x02, 0x01, 0x06, 0x1b, 0xff, 0x4c, 0x00};
+    for (uint8_t j = 0; j < 24; j++) {
+      device.advertising_data.push_back(static_cast<uint8_t>(i * 31 + j));
+    }
+    device_rssi[i] = base_rssi(generator);
+  }
+
+  std::vector<Report> trace;
+  trace.reserve(kDevices * kReportsPerDevice);
+  for (size_t n = 0; n < kReportsPerDevice; n++) {
+    for (size_t i = 0; i < kDevices; i++) {
+      Report report = devices[i];
+      report.rssi = static_cast<int8_t>(device_rssi[i] + static_cast<int>(noise(generator)));
+      if (i % kChangingDataRatio == 0) {
+        report.advertising_data.back() = static_cast<uint8_t>(n / kReportsPerSecond);
+      }
+      trace.push_back(std::move(report));
+    }
+  }
+  return trace;
+}
+
+// Replays the trace through the cache. Argument is the RSSI change threshold in dB, or -1 without deduplication.
+void BM_ScanResultCacheReplay(State& state) {
+  static const std::vector<Report> trace = MakeTrace();
+  LeScanningResultCache cache;
+  if (state.range(0) >= 0) {
+    cache.SetParameters(true, state.range(0));
+  }
+
+  size_t reports = 0;
+  size_t delivered = 0;
+  for (auto _ : state) {
+    cache.Clear();
+    for (const Report& report : trace) {
+      delivered += cache.ShouldDeliver(
+          report.address_type, report.address, report.advertising_sid, report.rssi, report.advertising_data);
+    }
+    reports += trace.size();
+  }
+
+  state.counters["reports_per_sec"] = Counter(reports, Counter::kIsRate);
+  state.counters["delivered_ratio"] = Counter(static_cast<double>(delivered) / reports);
+}
+
+BENCHMARK(BM_ScanResultCacheReplay)->ArgName("rssi_threshold")->Arg(-1)->Arg(0)->Arg(3)->Arg(6);
+
+}  // namespace
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_result_cache.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth::hci {
+
+// Defaults for the report fields.
+static constexpr uint8_t kPublicAddress = 0x00;
+static constexpr uint8_t kRandomAddress = 0x01;
+static constexpr uint8_t kSidNotPresent = 0xff;
+
+// Test addresses and data.
+static const Address kTestAddress = Address({0, 1, 2, 3, 4, 5});
+static const Address kOtherAddress = Address({0, 1, 2, 3, 4, 6});
+static const std::vector<uint8_t> kTestData = {0x02, 0x01, 0x06, 0x03, 0x09, 'a', 'b'};
+static const std::vector<uint8_t> kOtherData = {0x02, 0x01, 0x06, 0x03, 0x09, 'a', 'c'};
+
+class LeScanningResultCacheTest : public ::testing::Test {
+ public:
+  LeScanningResultCache cache_;
+};
+
+TEST_F(LeScanningResultCacheTest, disabled_delivers_everything) {
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  }
+  ASSERT_EQ(cache_.GetDeliveredCount(), 3u);
+  ASSERT_EQ(cache_.GetSuppressedCount(), 0u);
+}
+
+TEST_F(LeScanningResultCacheTest, suppress_repeated_advertisement) {
+  cache_.SetParameters(true, 0);
+
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_FALSE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+
+  // Any change of the key is a new advertisement.
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kOtherData));
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kOtherAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_TRUE(cache_.ShouldDeliver(kRandomAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, 0x01, -50, kTestData));
+
+  ASSERT_EQ(cache_.GetDeliveredCount(), 5u);
+  ASSERT_EQ(cache_.GetSuppressedCount(), 1u);
+}
+
+TEST_F(LeScanningResultCacheTest, rssi_change_threshold) {
+  cache_.SetParameters(true, 5);
+
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_FALSE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -55, kTestData));
+  ASSERT_FALSE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -45, kTestData));
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -56, kTestData));
+
+  // The threshold applies to the RSSI last delivered.
+  ASSERT_FALSE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -60, kTestData));
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+}
+
+TEST_F(LeScanningResultCacheTest, clear) {
+  cache_.SetParameters(true, 0);
+
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_FALSE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  cache_.Clear();
+  ASSERT_EQ(cache_.GetDeliveredCount(), 0u);
+  ASSERT_EQ(cache_.GetSuppressedCount(), 0u);
+
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_EQ(cache_.GetDeliveredCount(), 1u);
+}
+
+TEST_F(LeScanningResultCacheTest, full_cache_starts_over) {
+  cache_.SetParameters(true, 0);
+
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+  for (size_t i = 1; i < LeScanningResultCache::kMaximumCacheSize; i++) {
+    Address address({0xc0, 0, 0, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)});
+    ASSERT_TRUE(cache_.ShouldDeliver(kRandomAddress, address, kSidNotPresent, -50, kTestData));
+  }
+  ASSERT_FALSE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+
+  // One more advertiser does not fit, the first one is forgotten.
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kOtherAddress, kSidNotPresent, -50, kTestData));
+  ASSERT_TRUE(cache_.ShouldDeliver(kPublicAddress, kTestAddress, kSidNotPresent, -50, kTestData));
+}
+
+}  // namespace bluetooth::hci
@@ -16,7 +16,9 @@
 
 #include "os/handler.h"
 
+#include <algorithm>
 #include <cstring>
+#include <thread>
 
 #include "common/bind.h"
 #include "common/callback.h"
@@ -28,40 +30,31 @@ namespace bluetooth {
 namespace os {
 using common::OnceClosure;
 
-Handler::Handler(Thread* thread) : tasks_(new std::queue<OnceClosure>()), thread_(thread) {
+Handler::Handler(Thread* thread) : thread_(thread) {
   event_ = thread_->GetReactor()->NewEvent();
   reactable_ = thread_->GetReactor()->Register(
       event_->Id(), common::Bind(&Handler::handle_next_event, common::Unretained(this)), common::Closure());
 }
 
 Handler::~Handler() {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ASSERT_LOG(was_cleared(), "Handlers must be cleared before they are destroyed");
-  }
+  ASSERT_LOG(was_cleared(), "Handlers must be cleared before they are destroyed");
   event_->Close();
 }
 
 void Handler::Post(OnceClosure closure) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (was_cleared()) {
-      LOG_WARN("Posting to a handler which has been cleared");
-      return;
-    }
-    tasks_->emplace(std::move(closure));
+  if (was_cleared()) {
+    LOG_WARN("Posting to a handler which has been cleared");
+    return;
+  }
+  tasks_.Push(std::move(closure));
+  // Closures posted while the queue is non-empty are picked up by the batch already signaled
+  if (pending_tasks_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+    event_->Notify();
   }
-  event_->Notify();
 }
 
 void Handler::Clear() {
-  std::queue<OnceClosure>* tmp = nullptr;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ASSERT_LOG(!was_cleared(), "Handlers must only be cleared once");
-    std::swap(tasks_, tmp);
-  }
-  delete tmp;
+  ASSERT_LOG(!cleared_->exchange(true, std::memory_order_acq_rel), "Handlers must only be cleared once");
 
   event_->Clear();
 
@@ -75,20 +68,28 @@ void Handler::WaitUntilStopped(std::chrono::milliseconds timeout) {
 }
 
 void Handler::handle_next_event() {
-  common::OnceClosure closure;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    bool has_data = event_->Read();
-
-    if (was_cleared()) {
+  event_->Read();
+  // Only |cleared| may be read once a closure has run: a closure which clears its handler may also destroy it
+  std::shared_ptr<std::atomic<bool>> cleared = cleared_;
+  size_t batch = std::min(pending_tasks_.load(std::memory_order_acquire), kMaxTasksPerEvent);
+  for (size_t i = 0; i < batch; i++) {
+    if (cleared->load(std::memory_order_acquire)) {
       return;
     }
-    ASSERT_LOG(has_data, "Notified for work but no work available");
-
-    closure = std::move(tasks_->front());
-    tasks_->pop();
+    common::OnceClosure closure;
+    // The oldest closure may still be in the middle of being linked by its producer
+    while (!tasks_.TryPop(&closure)) {
+      std::this_thread::yield();
+    }
+    std::move(closure).Run();
+  }
+  if (cleared->load(std::memory_order_acquire)) {
+    return;
+  }
+  // Producers did not notify for closures posted during this batch, so schedule the next batch ourselves
+  if (pending_tasks_.fetch_sub(batch, std::memory_order_acq_rel) > batch) {
+    event_->Notify();
   }
-  std::move(closure).Run();
 }
 
 }  // namespace os
@@ -16,14 +16,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <memory>
-#include <mutex>
-#include <queue>
 
 #include "common/bind.h"
 #include "common/callback.h"
 #include "common/contextual_callback.h"
+#include "os/mpsc_queue.h"
 #include "os/thread.h"
 #include "os/utils.h"
 
@@ -32,7 +32,9 @@ namespace os {
 
 // A message-queue style handler for reactor-based thread to handle incoming events from different threads. When it's
 // constructed, it will register a reactable on the specified thread; when it's destroyed, it will unregister itself
-// from the thread.
+// from the thread. Posting is lock-free, and the reactor is only woken up when the queue becomes non-empty; queued
+// closures are then executed in batches. A closure may Clear() and destroy its own handler; the rest of its batch is
+// then dropped without touching the handler again.
 class Handler : public common::IPostableContext {
  public:
   // Create and register a handler on given thread
@@ -44,10 +46,12 @@ class Handler : public common::IPostableContext {
   // Unregister this handler from the thread and release resource. Unhandled events will be discarded and not executed.
   virtual ~Handler();
 
-  // Enqueue a closure to the queue of this handler
+  // Enqueue a closure to the queue of this handler. Thread safe and lock-free.
   virtual void Post(common::OnceClosure closure) override;
 
-  // Remove all pending events from the queue of this handler
+  // Stop executing pending events from the queue of this handler. They are discarded when the handler is destroyed.
+  // When called from another thread, the batch in progress may still be running: wait with WaitUntilStopped() before
+  // destroying the handler.
   void Clear();
 
   // Die if the current reactable doesn't stop before the timeout.  Must be called after Clear()
@@ -98,14 +102,20 @@ class Handler : public common::IPostableContext {
   friend class RepeatingAlarm;
 
  private:
+  // Upper bound of closures executed per reactor wake-up, so that other reactables on the thread are not starved
+  static constexpr size_t kMaxTasksPerEvent = 64;
+
   inline bool was_cleared() const {
-    return tasks_ == nullptr;
+    return cleared_->load(std::memory_order_acquire);
   };
-  std::queue<common::OnceClosure>* tasks_;
+  MpscQueue<common::OnceClosure> tasks_;
+  // Number of posted closures which have not been executed yet. |event_| is notified on the 0 -> 1 transition only.
+  std::atomic<size_t> pending_tasks_{0};
+  // Shared with the running batch, which checks it after each closure since the closure may have destroyed |this|
+  std::shared_ptr<std::atomic<bool>> cleared_ = std::make_shared<std::atomic<bool>>(false);
   Thread* thread_;
   std::unique_ptr<Reactor::Event> event_;
   Reactor::Reactable* reactable_;
-  mutable std::mutex mutex_;
   void handle_next_event();
 };
 
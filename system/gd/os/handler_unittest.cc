@@ -94,6 +94,35 @@ TEST_F(HandlerTest, post_task_cleared) {
   ASSERT_EQ(val, 1);
 }
 
+TEST_F(HandlerTest, post_task_clears_and_destroys_handler) {
+  std::promise<void> can_continue;
+  auto can_continue_future = can_continue.get_future();
+  handler_->Post(common::BindOnce([](std::future<void> future) { future.wait(); }, std::move(can_continue_future)));
+  std::promise<void> handler_destroyed;
+  auto handler_destroyed_future = handler_destroyed.get_future();
+  // The two closures below are queued while the first one blocks, so they end up in the same batch
+  handler_->Post(common::BindOnce(
+      [](Handler** handler, std::promise<void> handler_destroyed) {
+        (*handler)->Clear();
+        delete *handler;
+        *handler = nullptr;
+        handler_destroyed.set_value();
+      },
+      common::Unretained(&handler_),
+      std::move(handler_destroyed)));
+  handler_->Post(common::BindOnce([]() { ASSERT_TRUE(false); }));
+  can_continue.set_value();
+  handler_destroyed_future.wait();
+  // The reactor must not touch the destroyed handler, so posting to a new handler on the same thread still works
+  handler_ = new Handler(thread_);
+  std::promise<void> closure_ran;
+  auto closure_ran_future = closure_ran.get_future();
+  handler_->Post(
+      common::BindOnce([](std::promise<void> closure_ran) { closure_ran.set_value(); }, std::move(closure_ran)));
+  closure_ran_future.wait();
+  handler_->Clear();
+}
+
 void check_int(std::unique_ptr<int> number, std::shared_ptr<int> to_change) {
   *to_change = *number;
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace bluetooth {
+namespace os {
+
+// An unbounded multi-producer/single-consumer FIFO queue (Vyukov's node based algorithm).
+// Push() is wait-free and may be called from any thread concurrently. TryPop() must only be called from a single
+// consumer at a time. T must be default constructible and movable.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Drops the remaining items. No producer or consumer may be using the queue anymore.
+  ~MpscQueue() {
+    T item;
+    while (TryPop(&item)) {
+    }
+    delete tail_;
+  }
+
+  void Push(T item) {
+    Node* node = new Node(std::move(item));
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    // Between the exchange and this store the node is not reachable by the consumer yet
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Moves the oldest item into |item| and returns true. Returns false if the queue is empty, or if the oldest
+  // producer has not finished linking its item yet; in that case the item becomes available shortly.
+  bool TryPop(T* item) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *item = std::move(next->value);
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    explicit Node(T value) : value(std::move(value)) {}
+    std::atomic<Node*> next{nullptr};
+    T value;
+  };
+
+  // Producers append at |head_|, the consumer pops from |tail_|. |tail_| always points at a node whose value has
+  // already been consumed (initially a stub).
+  std::atomic<Node*> head_;
+  Node* tail_;
+};
+
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/mpsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+TEST(MpscQueueTest, empty) {
+  MpscQueue<int> queue;
+  int value = 0;
+  EXPECT_FALSE(queue.TryPop(&value));
+}
+
+TEST(MpscQueueTest, fifo_order) {
+  MpscQueue<int> queue;
+  for (int i = 0; i < 10; i++) {
+    queue.Push(i);
+  }
+  for (int i = 0; i < 10; i++) {
+    int value = -1;
+    ASSERT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  int value = 0;
+  EXPECT_FALSE(queue.TryPop(&value));
+}
+
+TEST(MpscQueueTest, move_only_items_destroyed_with_queue) {
+  auto counter = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(counter);
+    queue.Push(counter);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(MpscQueueTest, multiple_producers_keep_per_producer_order) {
+  constexpr int kProducers = 4;
+  constexpr int kItemsPerProducer = 10000;
+  MpscQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        queue.Push({p, i});
+      }
+    });
+  }
+
+  std::vector<int> next_expected(kProducers, 0);
+  int received = 0;
+  while (received < kProducers * kItemsPerProducer) {
+    std::pair<int, int> item;
+    if (!queue.TryPop(&item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(item.second, next_expected[item.first]);
+    next_expected[item.first]++;
+    received++;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  std::pair<int, int> item;
+  EXPECT_FALSE(queue.TryPop(&item));
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <future>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "common/bind.h"
@@ -115,3 +117,50 @@ BENCHMARK_REGISTER_F(BM_ReactorThread, sequential_execution)
     ->Arg(100000)
     ->Iterations(1)
     ->UseRealTime();
+
+class BM_ReactorThreadMultiProducer : public BM_ReactorThread {
+ protected:
+  void counted_callback() {
+    if (executed_.fetch_add(1, std::memory_order_relaxed) + 1 == num_messages_to_send_) {
+      counter_promise_.set_value();
+    }
+  }
+
+  std::atomic<int64_t> executed_;
+};
+
+BENCHMARK_DEFINE_F(BM_ReactorThreadMultiProducer, concurrent_post)(State& state) {
+  const int num_producers = static_cast<int>(state.range(0));
+  const int64_t messages_per_producer = state.range(1);
+  for (auto _ : state) {
+    num_messages_to_send_ = num_producers * messages_per_producer;
+    executed_ = 0;
+    counter_promise_ = std::promise<void>();
+    std::future<void> counter_future = counter_promise_.get_future();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; p++) {
+      producers.emplace_back([this, messages_per_producer]() {
+        for (int64_t i = 0; i < messages_per_producer; i++) {
+          handler_->Post(BindOnce(
+              &BM_ReactorThreadMultiProducer_concurrent_post_Benchmark::counted_callback,
+              bluetooth::common::Unretained(this)));
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+    counter_future.wait();
+  }
+  state.counters["posts_per_second"] = ::benchmark::Counter(
+      static_cast<double>(num_messages_to_send_) * state.iterations(), ::benchmark::Counter::kIsRate);
+  handler_->Clear();
+};
+
+BENCHMARK_REGISTER_F(BM_ReactorThreadMultiProducer, concurrent_post)
+    ->Args({1, 100000})
+    ->Args({2, 50000})
+    ->Args({4, 25000})
+    ->Args({8, 12500})
+    ->Iterations(1)
+    ->UseRealTime();
@@ -38,6 +38,17 @@ class BasePacketBuilder {
   // Write to the vector with the given iterator.
   virtual void Serialize(BitInserter& it) const = 0;
 
+  // Serialize into a buffer allocated once for |headroom| + size() bytes. The first |headroom| bytes are left
+  // zeroed for a lower layer header (e.g. the H4 packet type).
+  std::vector<uint8_t> SerializeToBytes(size_t headroom = 0) const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(headroom + size());
+    bytes.resize(headroom);
+    BitInserter it(bytes);
+    Serialize(it);
+    return bytes;
+  }
+
   void SetFlushable(bool is_flushable) {
     is_flushable_ = is_flushable;
   }
@@ -16,7 +16,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace bluetooth {
 namespace packet {
@@ -51,6 +55,28 @@ class ChecksumTypeChecker {
   // This checks which template was matched
   static constexpr bool value = (sizeof(Test<T, TRET>(0, 0, 0)) == sizeof(int));
 };
+
+template <typename C, typename = void>
+struct HasAddBytes : std::false_type {};
+
+template <typename C>
+struct HasAddBytes<C, std::void_t<decltype(std::declval<C&>().AddBytes(std::declval<const uint8_t*>(), size_t{}))>>
+    : std::true_type {};
+
+// Adds the bytes of |view| to |checksum|, all at once through AddBytes() when the checksum provides it and the view
+// is contiguous, otherwise one at a time through AddByte().
+template <typename C, typename View>
+void AddChecksumBytes(C& checksum, const View& view) {
+  if constexpr (HasAddBytes<C>::value) {
+    if (view.IsContiguous()) {
+      checksum.AddBytes(view.data(), view.size());
+      return;
+    }
+  }
+  for (uint8_t byte : view) {
+    checksum.AddByte(byte);
+  }
+}
 }  // namespace parser
 }  // namespace packet
 }  // namespace bluetooth
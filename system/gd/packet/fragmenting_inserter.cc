@@ -23,20 +23,22 @@ namespace packet {
 
 FragmentingInserter::FragmentingInserter(size_t mtu,
                                          std::back_insert_iterator<std::vector<std::unique_ptr<RawBuilder>>> iterator)
-    : BitInserter(to_construct_bit_inserter_), mtu_(mtu), curr_packet_(std::make_unique<RawBuilder>(mtu)),
-      iterator_(iterator) {}
+    : BitInserter(to_construct_bit_inserter_), mtu_(mtu), iterator_(iterator) {}
 
 void FragmentingInserter::insert_bits(uint8_t byte, size_t num_bits) {
-  ASSERT(curr_packet_ != nullptr);
+  ASSERT(!finalized_);
   size_t total_bits = num_bits + num_saved_bits_;
   uint16_t new_value = static_cast<uint8_t>(saved_bits_) | (static_cast<uint16_t>(byte) << num_saved_bits_);
   if (total_bits >= 8) {
     uint8_t new_byte = static_cast<uint8_t>(new_value);
     on_byte(new_byte);
-    curr_packet_->AddOctets1(new_byte);
-    if (curr_packet_->size() >= mtu_) {
-      iterator_ = std::move(curr_packet_);
-      curr_packet_ = std::make_unique<RawBuilder>(mtu_);
+    if (curr_fragment_.empty()) {
+      curr_fragment_.reserve(mtu_);
+    }
+    curr_fragment_.push_back(new_byte);
+    if (curr_fragment_.size() >= mtu_) {
+      iterator_ = std::make_unique<RawBuilder>(std::move(curr_fragment_));
+      curr_fragment_.clear();
     }
     total_bits -= 8;
     new_value = new_value >> 8;
@@ -47,10 +49,11 @@ void FragmentingInserter::insert_bits(uint8_t byte, size_t num_bits) {
 }
 
 void FragmentingInserter::finalize() {
-  if (curr_packet_->size() != 0) {
-    iterator_ = std::move(curr_packet_);
+  if (!curr_fragment_.empty()) {
+    iterator_ = std::make_unique<RawBuilder>(std::move(curr_fragment_));
+    curr_fragment_.clear();
   }
-  curr_packet_.reset();
+  finalized_ = true;
 }
 
 }  // namespace packet
@@ -38,7 +38,9 @@ class FragmentingInserter : public BitInserter {
  protected:
   std::vector<uint8_t> to_construct_bit_inserter_;
   size_t mtu_;
-  std::unique_ptr<RawBuilder> curr_packet_;
+  // Bytes of the fragment being filled; reserved to |mtu_| so each fragment is allocated once.
+  std::vector<uint8_t> curr_fragment_;
+  bool finalized_{false};
   std::back_insert_iterator<std::vector<std::unique_ptr<RawBuilder>>> iterator_;
 };
 
@@ -16,6 +16,9 @@
 
 #include "packet/iterator.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "os/log.h"
 
 namespace bluetooth {
@@ -30,6 +33,8 @@ Iterator<little_endian>::Iterator(const std::forward_list<View>& data, size_t of
   for (auto& view : data) {
     end_ += view.size();
   }
+  bool single_fragment = !data_.empty() && std::next(data_.begin()) == data_.end();
+  contiguous_data_ = single_fragment ? data_.front().data() : nullptr;
 }
 
 template <bool little_endian>
@@ -84,6 +89,7 @@ Iterator<little_endian>& Iterator<little_endian>::operator=(const Iterator<littl
     return *this;
   }
   this->data_ = itr.data_;
+  this->contiguous_data_ = itr.contiguous_data_;
   this->begin_ = itr.begin_;
   this->end_ = itr.end_;
   this->index_ = itr.index_;
@@ -128,9 +134,12 @@ uint8_t Iterator<little_endian>::operator*() const {
       index_,
       begin_,
       end_);
+  if (contiguous_data_ != nullptr) {
+    return contiguous_data_[index_];
+  }
   size_t index = index_;
 
-  for (auto view : data_) {
+  for (const auto& view : data_) {
     if (index < view.size()) {
       return view[index];
     }
@@ -164,6 +173,34 @@ Iterator<little_endian> Iterator<little_endian>::Subrange(size_t index, size_t l
   return to_return;
 }
 
+template <bool little_endian>
+size_t Iterator<little_endian>::CopyTo(uint8_t* destination, size_t length) {
+  size_t to_copy = std::min(length, NumBytesRemaining());
+  if (contiguous_data_ != nullptr) {
+    std::memcpy(destination, contiguous_data_ + index_, to_copy);
+    index_ += to_copy;
+    return to_copy;
+  }
+  // Copy fragment by fragment, skipping the fragments before the current index
+  size_t skip = index_;
+  size_t copied = 0;
+  for (const auto& view : data_) {
+    if (copied == to_copy) {
+      break;
+    }
+    if (skip >= view.size()) {
+      skip -= view.size();
+      continue;
+    }
+    size_t chunk = std::min(view.size() - skip, to_copy - copied);
+    std::memcpy(destination + copied, view.data() + skip, chunk);
+    copied += chunk;
+    skip = 0;
+  }
+  index_ += copied;
+  return copied;
+}
+
 // Explicit instantiations for both types of Iterators.
 template class Iterator<true>;
 template class Iterator<false>;
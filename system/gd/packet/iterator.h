@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <forward_list>
 #include <memory>
 #include <type_traits>
@@ -76,6 +77,10 @@ class Iterator : public IteratorTraits {
 
   Iterator Subrange(size_t index, size_t length) const;
 
+  // Copy up to |length| bytes into |destination| and advance past them. Returns the number of bytes copied, which is
+  // smaller than |length| if fewer bytes remain. Uses one memcpy per underlying fragment.
+  size_t CopyTo(uint8_t* destination, size_t length);
+
   // Get the next sizeof(FixedWidthPODType) bytes and return the filled type
   template <typename FixedWidthPODType, typename std::enable_if<std::is_pod<FixedWidthPODType>::value, int>::type = 0>
   FixedWidthPODType extract() {
@@ -83,6 +88,10 @@ class Iterator : public IteratorTraits {
     FixedWidthPODType extracted_value{};
     uint8_t* value_ptr = (uint8_t*)&extracted_value;
 
+    if (contiguous_data_ != nullptr && NumBytesRemaining() >= sizeof(FixedWidthPODType)) {
+      extract_contiguous(value_ptr, sizeof(FixedWidthPODType));
+      return extracted_value;
+    }
     for (size_t i = 0; i < sizeof(FixedWidthPODType); i++) {
       size_t index = (little_endian ? i : sizeof(FixedWidthPODType) - i - 1);
       value_ptr[index] = this->operator*();
@@ -94,6 +103,10 @@ class Iterator : public IteratorTraits {
   template <typename T, typename std::enable_if<std::is_base_of_v<CustomFieldFixedSizeInterface<T>, T>, int>::type = 0>
   T extract() {
     T extracted_value{};
+    if (contiguous_data_ != nullptr && NumBytesRemaining() >= CustomFieldFixedSizeInterface<T>::length()) {
+      extract_contiguous(extracted_value.data(), CustomFieldFixedSizeInterface<T>::length());
+      return extracted_value;
+    }
     for (size_t i = 0; i < CustomFieldFixedSizeInterface<T>::length(); i++) {
       size_t index = (little_endian ? i : CustomFieldFixedSizeInterface<T>::length() - i - 1);
       extracted_value.data()[index] = this->operator*();
@@ -103,7 +116,23 @@ class Iterator : public IteratorTraits {
   }
 
  private:
+  // Copy |length| bytes at the current position into |value_ptr| in host order and advance.
+  // The caller must check that the data is contiguous and that enough bytes remain.
+  void extract_contiguous(uint8_t* value_ptr, size_t length) {
+    const uint8_t* source = contiguous_data_ + index_;
+    if (little_endian) {
+      std::memcpy(value_ptr, source, length);
+    } else {
+      for (size_t i = 0; i < length; i++) {
+        value_ptr[length - i - 1] = source[i];
+      }
+    }
+    index_ += length;
+  }
+
   std::forward_list<View> data_;
+  // First byte of the data when it is backed by a single fragment, nullptr otherwise.
+  const uint8_t* contiguous_data_;
   size_t index_;
   size_t begin_;
   size_t end_;
@@ -40,14 +40,6 @@ class PacketBuilder : public BasePacketBuilder, protected EndianInserter<little_
 
   // Classes which need fragmentation should define a function like this:
   // std::forward_list<DerivedBuilder>& Fragment(size_t max_size);
-
-  // Serialize the packet to a byte vector.
-  std::vector<uint8_t> SerializeToBytes() const {
-    std::vector<uint8_t> output;
-    BitInserter it(output);
-    Serialize(it);
-    return output;
-  }
 };
 
 }  // namespace packet
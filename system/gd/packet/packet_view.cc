@@ -17,6 +17,7 @@
 #include "packet/packet_view.h"
 
 #include <algorithm>
+#include <iterator>
 
 #include "os/log.h"
 
@@ -53,6 +54,9 @@ uint8_t PacketView<little_endian>::operator[](size_t index) const {
 template <bool little_endian>
 uint8_t PacketView<little_endian>::at(size_t index) const {
   ASSERT_LOG(index < length_, "Index %zu out of bounds", index);
+  if (IsContiguous()) {
+    return fragments_.front().data()[index];
+  }
   for (const auto& fragment : fragments_) {
     if (index < fragment.size()) {
       return fragment[index];
@@ -68,6 +72,16 @@ size_t PacketView<little_endian>::size() const {
   return length_;
 }
 
+template <bool little_endian>
+bool PacketView<little_endian>::IsContiguous() const {
+  return !fragments_.empty() && std::next(fragments_.begin()) == fragments_.end();
+}
+
+template <bool little_endian>
+const uint8_t* PacketView<little_endian>::data() const {
+  return IsContiguous() ? fragments_.front().data() : nullptr;
+}
+
 template <bool little_endian>
 std::forward_list<View> PacketView<little_endian>::GetSubviewList(size_t begin, size_t end) const {
   ASSERT(begin <= end);
@@ -84,6 +98,10 @@ std::forward_list<View> PacketView<little_endian>::GetSubviewList(size_t begin,
       length -= view.size();
       it = view_list.insert_after(it, view);
       begin = 0;
+      // Don't add empty trailing fragments, so that subviews of a single fragment stay contiguous
+      if (length == 0) {
+        break;
+      }
     }
   }
   return view_list;
@@ -47,6 +47,12 @@ class PacketView {
 
   size_t size() const;
 
+  // True if the packet is backed by a single fragment, which allows direct access through data().
+  bool IsContiguous() const;
+
+  // Pointer to the first byte of a contiguous packet, nullptr if the packet is fragmented.
+  const uint8_t* data() const;
+
   PacketView<true> GetLittleEndianSubview(size_t begin, size_t end) const;
   PacketView<false> GetBigEndianSubview(size_t begin, size_t end) const;
 
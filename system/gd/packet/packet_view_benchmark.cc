@@ -0,0 +1,145 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <forward_list>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/hci_packets.h"
+#include "l2cap/l2cap_packets.h"
+#include "packet/packet_view.h"
+#include "packet/view.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::AclView;
+using ::bluetooth::hci::EventView;
+using ::bluetooth::hci::LeAdvertisingReportRawView;
+using ::bluetooth::hci::LeMetaEventView;
+using ::bluetooth::l2cap::BasicFrameView;
+using ::bluetooth::packet::kLittleEndian;
+using ::bluetooth::packet::PacketView;
+using ::bluetooth::packet::View;
+
+namespace {
+
+constexpr uint16_t kAttCid = 0x0004;
+constexpr uint8_t kAttReadByTypeResponse = 0x09;
+constexpr size_t kAttMtu = 517;
+
+// ACL packet carrying an L2CAP basic frame with an ATT Read By Type Response made of 4-byte handle/value pairs.
+std::shared_ptr<std::vector<uint8_t>> MakeAttAclPacket() {
+  std::vector<uint8_t> att = {kAttReadByTypeResponse, 4};
+  for (uint16_t handle = 1; att.size() + 4 <= kAttMtu; handle++) {
+    att.insert(att.end(), {static_cast<uint8_t>(handle), static_cast<uint8_t>(handle >> 8), 0xaa, 0x55});
+  }
+  uint16_t l2cap_size = att.size();
+  uint16_t acl_size = l2cap_size + 4;
+  auto bytes = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t>{
+      0x40,
+      0x20,  // Handle 0x040, first automatically flushable
+      static_cast<uint8_t>(acl_size),
+      static_cast<uint8_t>(acl_size >> 8),
+      static_cast<uint8_t>(l2cap_size),
+      static_cast<uint8_t>(l2cap_size >> 8),
+      static_cast<uint8_t>(kAttCid),
+      static_cast<uint8_t>(kAttCid >> 8)});
+  bytes->insert(bytes->end(), att.begin(), att.end());
+  return bytes;
+}
+
+// LE Advertising Report event with |num_reports| legacy reports of 31 bytes of advertising data each.
+std::shared_ptr<std::vector<uint8_t>> MakeLeAdvertisingReportEvent(uint8_t num_reports) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bytes->push_back(static_cast<uint8_t>(bluetooth::hci::EventCode::LE_META_EVENT));
+  bytes->push_back(0);  // Parameter length, filled below
+  bytes->push_back(static_cast<uint8_t>(bluetooth::hci::SubeventCode::ADVERTISING_REPORT));
+  bytes->push_back(num_reports);
+  for (uint8_t i = 0; i < num_reports; i++) {
+    bytes->insert(bytes->end(), {0x00 /* ADV_IND */, 0x01 /* random */, i, 0x11, 0x22, 0x33, 0x44, 0xc5, 31});
+    for (uint8_t b = 0; b < 31; b++) {
+      bytes->push_back(b);
+    }
+    bytes->push_back(static_cast<uint8_t>(-60));
+  }
+  (*bytes)[1] = static_cast<uint8_t>(bytes->size() - 2);
+  return bytes;
+}
+
+// Wrap |bytes| in a PacketView, either as a single fragment or split in |num_fragments| fragments.
+PacketView<kLittleEndian> MakeView(std::shared_ptr<std::vector<uint8_t>> bytes, size_t num_fragments) {
+  std::shared_ptr<const std::vector<uint8_t>> data = bytes;
+  std::forward_list<View> fragments;
+  size_t fragment_size = (data->size() + num_fragments - 1) / num_fragments;
+  auto it = fragments.before_begin();
+  for (size_t begin = 0; begin < data->size(); begin += fragment_size) {
+    it = fragments.insert_after(it, View(data, begin, begin + fragment_size));
+  }
+  return PacketView<kLittleEndian>(fragments);
+}
+
+void BM_ParseAttOverAcl(State& state) {
+  auto bytes = MakeAttAclPacket();
+  auto packet = MakeView(bytes, state.range(0));
+  for (auto _ : state) {
+    auto acl = AclView::Create(packet);
+    if (!acl.IsValid()) {
+      state.SkipWithError("Invalid ACL packet");
+      break;
+    }
+    benchmark::DoNotOptimize(acl.GetHandle());
+    auto basic_frame = BasicFrameView::Create(acl.GetPayload());
+    if (!basic_frame.IsValid() || basic_frame.GetChannelId() != kAttCid) {
+      state.SkipWithError("Invalid L2CAP basic frame");
+      break;
+    }
+    auto att = basic_frame.GetPayload();
+    auto it = att.begin();
+    uint8_t opcode = it.extract<uint8_t>();
+    uint8_t pair_length = it.extract<uint8_t>();
+    uint32_t checksum = opcode;
+    while (it.NumBytesRemaining() >= pair_length) {
+      checksum += it.extract<uint16_t>();
+      checksum += it.extract<uint16_t>();
+    }
+    benchmark::DoNotOptimize(checksum);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes->size());
+}
+BENCHMARK(BM_ParseAttOverAcl)->Arg(1)->Arg(2)->Arg(8);
+
+void BM_ParseLeAdvertisingReport(State& state) {
+  auto bytes = MakeLeAdvertisingReportEvent(static_cast<uint8_t>(state.range(1)));
+  auto packet = MakeView(bytes, state.range(0));
+  for (auto _ : state) {
+    auto le_meta_event = LeMetaEventView::Create(EventView::Create(packet));
+    if (!le_meta_event.IsValid()) {
+      state.SkipWithError("Invalid LE meta event");
+      break;
+    }
+    auto report = LeAdvertisingReportRawView::Create(le_meta_event);
+    if (!report.IsValid()) {
+      state.SkipWithError("Invalid LE advertising report");
+      break;
+    }
+    auto responses = report.GetResponses();
+    benchmark::DoNotOptimize(responses.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes->size());
+}
+BENCHMARK(BM_ParseLeAdvertisingReport)->Args({1, 1})->Args({1, 6})->Args({2, 6})->Args({8, 6});
+
+}  // namespace
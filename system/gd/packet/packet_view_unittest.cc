@@ -552,6 +552,50 @@ TEST_F(PacketViewMultiViewTest, arrayOperatorTest) {
   ASSERT_DEATH(multi_view[single_view.size()], "");
 }
 
+TEST_F(PacketViewMultiViewTest, contiguousTest) {
+  ASSERT_TRUE(single_view.IsContiguous());
+  ASSERT_EQ(single_view.data()[5], count_all[5]);
+  ASSERT_FALSE(multi_view.IsContiguous());
+  ASSERT_EQ(multi_view.data(), nullptr);
+  ASSERT_TRUE(multi_view.GetLittleEndianSubview(4, 12).IsContiguous());
+  ASSERT_FALSE(multi_view.GetLittleEndianSubview(2, 12).IsContiguous());
+}
+
+TEST_F(PacketViewMultiViewTest, extractMatchesFragmentedTest) {
+  auto single_itr = single_view.begin() + 1;
+  auto multi_itr = multi_view.begin() + 1;
+  ASSERT_EQ(single_itr.extract<uint32_t>(), multi_itr.extract<uint32_t>());
+  ASSERT_EQ(single_itr.extract<uint64_t>(), multi_itr.extract<uint64_t>());
+  ASSERT_EQ(single_itr.extract<Address>(), multi_itr.extract<Address>());
+  ASSERT_EQ(single_itr, multi_itr);
+}
+
+TEST_F(PacketViewMultiViewTest, copyToTest) {
+  vector<uint8_t> single_bytes(count_all.size() + 4, 0xff);
+  vector<uint8_t> multi_bytes(count_all.size() + 4, 0xff);
+  auto single_itr = single_view.begin() + 2;
+  auto multi_itr = multi_view.begin() + 2;
+  ASSERT_EQ(single_itr.CopyTo(single_bytes.data(), single_bytes.size()), count_all.size() - 2);
+  ASSERT_EQ(multi_itr.CopyTo(multi_bytes.data(), multi_bytes.size()), count_all.size() - 2);
+  ASSERT_EQ(single_bytes, multi_bytes);
+  ASSERT_EQ(single_bytes[0], count_all[2]);
+  ASSERT_EQ(single_itr, single_view.end());
+  ASSERT_EQ(multi_itr, multi_view.end());
+  ASSERT_EQ(single_itr.CopyTo(single_bytes.data(), 1), 0u);
+}
+
+TEST_F(PacketViewMultiViewTest, copyToInChunksTest) {
+  vector<uint8_t> bytes(count_all.size(), 0xff);
+  auto multi_itr = multi_view.begin() + 1;
+  size_t copied = 1;
+  while (multi_itr != multi_view.end()) {
+    copied += multi_itr.CopyTo(bytes.data() + copied, 3);
+  }
+  ASSERT_EQ(copied, count_all.size());
+  bytes[0] = count_all[0];
+  ASSERT_EQ(bytes, count_all);
+}
+
 TEST_F(PacketViewMultiViewAppendTest, sizeTestAppend) {
   ASSERT_EQ(single_view.size(), multi_view.size());
 }
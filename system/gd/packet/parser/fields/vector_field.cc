@@ -109,6 +109,10 @@ std::string VectorField::GetDataType() const {
 
 void VectorField::GenExtractor(std::ostream& s, int num_leading_bits, bool for_struct) const {
   s << "auto " << element_field_->GetName() << "_it = " << GetName() << "_it;";
+  if (element_field_->GetFieldType() == ScalarField::kFieldType && element_size_.bits() == 8 && num_leading_bits == 0) {
+    GenByteVectorExtractor(s, for_struct);
+    return;
+  }
   if (size_field_ != nullptr && size_field_->GetFieldType() == CountField::kFieldType) {
     s << "size_t " << element_field_->GetName() << "_count = ";
     if (for_struct) {
@@ -144,6 +148,25 @@ void VectorField::GenExtractor(std::ostream& s, int num_leading_bits, bool for_s
   s << "}";
 }
 
+void VectorField::GenByteVectorExtractor(std::ostream& s, bool for_struct) const {
+  // Copy the bytes in bulk instead of extracting them one by one; this is a single memcpy for contiguous views.
+  const auto& element_name = element_field_->GetName();
+  s << "size_t " << element_name << "_count = " << element_name << "_it.NumBytesRemaining();";
+  if (size_field_ != nullptr && size_field_->GetFieldType() == CountField::kFieldType) {
+    s << element_name << "_count = std::min(" << element_name << "_count, static_cast<size_t>(";
+    if (for_struct) {
+      s << "to_fill->" << size_field_->GetName() << "_extracted_";
+    } else {
+      s << "Get" << util::UnderscoreToCamelCase(size_field_->GetName()) << "()";
+    }
+    s << "));";
+  }
+  s << "size_t " << element_name << "_offset = " << GetName() << "_ptr->size();";
+  s << GetName() << "_ptr->resize(" << element_name << "_offset + " << element_name << "_count);";
+  s << element_name << "_it.CopyTo(" << GetName() << "_ptr->data() + " << element_name << "_offset, " << element_name
+    << "_count);";
+}
+
 std::string VectorField::GetGetterFunctionName() const {
   std::stringstream ss;
   ss << "Get" << util::UnderscoreToCamelCase(GetName());
@@ -77,6 +77,9 @@ class VectorField : public PacketField {
 
   void GenBoundsCheck(std::ostream& s, Size start_offset, Size end_offset, std::string parent_name) const override;
 
+  // Extractor for vectors of plain bytes, which copies them in bulk.
+  void GenByteVectorExtractor(std::ostream& s, bool for_struct) const;
+
   const std::string name_;
 
   const PacketField* element_field_{nullptr};
@@ -80,6 +80,7 @@ bool generate_cpp_headers_one_file(
       R"(
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <sstream>
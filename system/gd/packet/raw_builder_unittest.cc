@@ -105,5 +105,17 @@ TEST(RawBuilderTest, testMaxBytes) {
   ASSERT_EQ(count, packet);
 }
 
+TEST(RawBuilderTest, serializeToBytesTest) {
+  std::unique_ptr<RawBuilder> count_builder = std::make_unique<RawBuilder>(count);
+  ASSERT_EQ(count, count_builder->SerializeToBytes());
+
+  constexpr size_t kHeadroom = 4;
+  std::vector<uint8_t> packet = count_builder->SerializeToBytes(kHeadroom);
+  ASSERT_EQ(kHeadroom + count.size(), packet.size());
+  ASSERT_EQ(packet.size(), packet.capacity());
+  ASSERT_EQ(std::vector<uint8_t>(kHeadroom, 0), std::vector<uint8_t>(packet.begin(), packet.begin() + kHeadroom));
+  ASSERT_EQ(count, std::vector<uint8_t>(packet.begin() + kHeadroom, packet.end()));
+}
+
 }  // namespace packet
 }  // namespace bluetooth
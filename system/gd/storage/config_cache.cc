@@ -17,6 +17,7 @@
 #include "storage/config_cache.h"
 
 #include <ios>
+#include <limits>
 #include <sstream>
 #include <utility>
 
@@ -43,6 +44,37 @@ bool InEncryptKeyNameList(std::string key) {
   return kEncryptKeyNameList.find(key) != kEncryptKeyNameList.end();
 }
 
+int HexDigitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Parse a "xx:xx:xx:xx:xx:xx" section name into the 48 bit address it names, without going through a string stream
+bool ParseDeviceSection(const std::string& section, uint64_t* packed_address) {
+  if (section.size() != 17) {
+    return false;
+  }
+  uint64_t address = 0;
+  for (size_t i = 0; i < section.size(); i += 3) {
+    int high = HexDigitValue(section[i]);
+    int low = HexDigitValue(section[i + 1]);
+    if (high < 0 || low < 0 || (i + 2 < section.size() && section[i + 2] != ':')) {
+      return false;
+    }
+    address = (address << 8) | (high << 4) | low;
+  }
+  *packed_address = address;
+  return true;
+}
+
 }  // namespace
 
 namespace bluetooth {
@@ -62,21 +94,61 @@ ConfigCache::ConfigCache(size_t temp_device_capacity, std::unordered_set<std::st
     : persistent_property_names_(std::move(persistent_property_names)),
       information_sections_(),
       persistent_devices_(),
-      temporary_devices_(temp_device_capacity) {}
+      temporary_devices_(temp_device_capacity) {
+  for (const auto& property : persistent_property_names_) {
+    InternPropertyName(std::string(property));
+  }
+}
+
+size_t ConfigCache::DeviceSectionHash::operator()(const std::string& section) const {
+  uint64_t packed_address;
+  if (ParseDeviceSection(section, &packed_address)) {
+    return std::hash<uint64_t>{}(packed_address);
+  }
+  return std::hash<std::string>{}(section);
+}
+
+std::optional<ConfigCache::PropertyId> ConfigCache::FindPropertyId(const std::string& property) const {
+  auto iter = property_names_.find(property);
+  if (iter == property_names_.end()) {
+    return std::nullopt;
+  }
+  return static_cast<PropertyId>(iter - property_names_.begin());
+}
+
+ConfigCache::PropertyId ConfigCache::InternPropertyName(const std::string& property) {
+  auto result = property_names_.try_emplace_back(property, IsPersistentProperty(property));
+  if (result.second) {
+    ASSERT_LOG(property_names_.size() <= std::numeric_limits<PropertyId>::max(), "Too many property names");
+  }
+  return static_cast<PropertyId>(result.first - property_names_.begin());
+}
+
+const std::string& ConfigCache::GetPropertyName(PropertyId property_id) const {
+  return (property_names_.begin() + property_id)->first;
+}
 
 void ConfigCache::SetPersistentConfigChangedCallback(std::function<void()> persistent_config_changed_callback) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   persistent_config_changed_callback_ = std::move(persistent_config_changed_callback);
 }
 
+void ConfigCache::SetPersistentMutationCallback(
+    std::function<void(const MutationEntry&)> persistent_mutation_callback) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  persistent_mutation_callback_ = std::move(persistent_mutation_callback);
+}
+
 ConfigCache::ConfigCache(ConfigCache&& other) noexcept
     : persistent_config_changed_callback_(nullptr),
+      persistent_mutation_callback_(nullptr),
       persistent_property_names_(std::move(other.persistent_property_names_)),
+      property_names_(std::move(other.property_names_)),
       information_sections_(std::move(other.information_sections_)),
       persistent_devices_(std::move(other.persistent_devices_)),
       temporary_devices_(std::move(other.temporary_devices_)) {
   ASSERT_LOG(
-      other.persistent_config_changed_callback_ == nullptr,
+      other.persistent_config_changed_callback_ == nullptr && other.persistent_mutation_callback_ == nullptr,
       "Can't assign after setting the callback");
 }
 
@@ -87,22 +159,50 @@ ConfigCache& ConfigCache::operator=(ConfigCache&& other) noexcept {
   std::lock_guard<std::recursive_mutex> my_lock(mutex_);
   std::lock_guard<std::recursive_mutex> others_lock(other.mutex_);
   ASSERT_LOG(
-      other.persistent_config_changed_callback_ == nullptr,
+      other.persistent_config_changed_callback_ == nullptr && other.persistent_mutation_callback_ == nullptr,
       "Can't assign after setting the callback");
   persistent_config_changed_callback_ = {};
+  persistent_mutation_callback_ = {};
   persistent_property_names_ = std::move(other.persistent_property_names_);
+  property_names_ = std::move(other.property_names_);
   information_sections_ = std::move(other.information_sections_);
   persistent_devices_ = std::move(other.persistent_devices_);
   temporary_devices_ = std::move(other.temporary_devices_);
   return *this;
 }
 
+template <typename Sections>
+bool ConfigCache::SectionsEqual(
+    const ConfigCache& lhs, const Sections& lhs_sections, const ConfigCache& rhs, const Sections& rhs_sections) {
+  if (lhs_sections.size() != rhs_sections.size()) {
+    return false;
+  }
+  auto rhs_section = rhs_sections.begin();
+  for (const auto& lhs_section : lhs_sections) {
+    if (lhs_section.first != rhs_section->first || lhs_section.second.size() != rhs_section->second.size()) {
+      return false;
+    }
+    auto rhs_property = rhs_section->second.begin();
+    for (const auto& lhs_property : lhs_section.second) {
+      if (lhs.GetPropertyName(lhs_property.first) != rhs.GetPropertyName(rhs_property->first) ||
+          lhs_property.second != rhs_property->second) {
+        return false;
+      }
+      rhs_property++;
+    }
+    rhs_section++;
+  }
+  return true;
+}
+
 bool ConfigCache::operator==(const ConfigCache& rhs) const {
   std::lock_guard<std::recursive_mutex> my_lock(mutex_);
   std::lock_guard<std::recursive_mutex> others_lock(rhs.mutex_);
   return persistent_property_names_ == rhs.persistent_property_names_ &&
-         information_sections_ == rhs.information_sections_ && persistent_devices_ == rhs.persistent_devices_ &&
-         temporary_devices_ == rhs.temporary_devices_;
+         SectionsEqual(*this, information_sections_, rhs, rhs.information_sections_) &&
+         SectionsEqual(*this, persistent_devices_, rhs, rhs.persistent_devices_) &&
+         temporary_devices_.capacity() == rhs.temporary_devices_.capacity() &&
+         SectionsEqual(*this, temporary_devices_, rhs, rhs.temporary_devices_);
 }
 
 bool ConfigCache::operator!=(const ConfigCache& rhs) const {
@@ -112,10 +212,16 @@ bool ConfigCache::operator!=(const ConfigCache& rhs) const {
 void ConfigCache::Clear() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (information_sections_.size() > 0) {
+    for (const auto& section : information_sections_) {
+      PersistentMutationCallback(MutationEntry::EntryType::REMOVE_SECTION, section.first);
+    }
     information_sections_.clear();
     PersistentConfigChangedCallback();
   }
   if (persistent_devices_.size() > 0) {
+    for (const auto& section : persistent_devices_) {
+      PersistentMutationCallback(MutationEntry::EntryType::REMOVE_SECTION, section.first);
+    }
     persistent_devices_.clear();
     PersistentConfigChangedCallback();
   }
@@ -132,34 +238,42 @@ bool ConfigCache::HasSection(const std::string& section) const {
 
 bool ConfigCache::HasProperty(const std::string& section, const std::string& property) const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto property_id = FindPropertyId(property);
+  if (!property_id) {
+    return false;
+  }
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
-    return section_iter->second.find(property) != section_iter->second.end();
+    return section_iter->second.contains(*property_id);
   }
-  section_iter = persistent_devices_.find(section);
-  if (section_iter != persistent_devices_.end()) {
-    return section_iter->second.find(property) != section_iter->second.end();
+  auto device_iter = persistent_devices_.find(section);
+  if (device_iter != persistent_devices_.end()) {
+    return device_iter->second.contains(*property_id);
   }
   section_iter = temporary_devices_.find(section);
   if (section_iter != temporary_devices_.end()) {
-    return section_iter->second.find(property) != section_iter->second.end();
+    return section_iter->second.contains(*property_id);
   }
   return false;
 }
 
 std::optional<std::string> ConfigCache::GetProperty(const std::string& section, const std::string& property) const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto property_id = FindPropertyId(property);
+  if (!property_id) {
+    return std::nullopt;
+  }
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
-    auto property_iter = section_iter->second.find(property);
+    auto property_iter = section_iter->second.find(*property_id);
     if (property_iter != section_iter->second.end()) {
       return property_iter->second;
     }
   }
-  section_iter = persistent_devices_.find(section);
-  if (section_iter != persistent_devices_.end()) {
-    auto property_iter = section_iter->second.find(property);
-    if (property_iter != section_iter->second.end()) {
+  auto device_iter = persistent_devices_.find(section);
+  if (device_iter != persistent_devices_.end()) {
+    auto property_iter = device_iter->second.find(*property_id);
+    if (property_iter != device_iter->second.end()) {
       std::string value = property_iter->second;
       if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && value == kEncryptedStr) {
         return os::ParameterProvider::GetBtKeystoreInterface()->get_key(section + "-" + property);
@@ -169,7 +283,7 @@ std::optional<std::string> ConfigCache::GetProperty(const std::string& section,
   }
   section_iter = temporary_devices_.find(section);
   if (section_iter != temporary_devices_.end()) {
-    auto property_iter = section_iter->second.find(property);
+    auto property_iter = section_iter->second.find(*property_id);
     if (property_iter != section_iter->second.end()) {
       return property_iter->second;
     }
@@ -184,26 +298,33 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
   TrimAfterNewLine(value);
   ASSERT_LOG(!section.empty(), "Empty section name not allowed");
   ASSERT_LOG(!property.empty(), "Empty property name not allowed");
+  PropertyId property_id = InternPropertyName(property);
   if (!IsDeviceSection(section)) {
     auto section_iter = information_sections_.find(section);
     if (section_iter == information_sections_.end()) {
-      section_iter = information_sections_.try_emplace_back(section, common::ListMap<std::string, std::string>{}).first;
+      section_iter = information_sections_.try_emplace_back(section, SectionProperties{}).first;
     }
-    section_iter->second.insert_or_assign(property, std::move(value));
+    PersistentMutationCallback(MutationEntry::EntryType::SET, section, property, value);
+    section_iter->second.insert_or_assign(property_id, std::move(value));
     PersistentConfigChangedCallback();
     return;
   }
-  auto section_iter = persistent_devices_.find(section);
-  if (section_iter == persistent_devices_.end() && IsPersistentProperty(property)) {
+  auto device_iter = persistent_devices_.find(section);
+  if (device_iter == persistent_devices_.end() && (property_names_.begin() + property_id)->second) {
     // move paired devices or create new paired device when a link key is set
     auto section_properties = temporary_devices_.extract(section);
     if (section_properties) {
-      section_iter = persistent_devices_.try_emplace_back(section, std::move(section_properties->second)).first;
+      // properties of a temporary device were never reported, report them as they now go to disk
+      for (const auto& moved_property : section_properties->second) {
+        PersistentMutationCallback(
+            MutationEntry::EntryType::SET, section, GetPropertyName(moved_property.first), moved_property.second);
+      }
+      device_iter = persistent_devices_.try_emplace_back(section, std::move(section_properties->second)).first;
     } else {
-      section_iter = persistent_devices_.try_emplace_back(section, common::ListMap<std::string, std::string>{}).first;
+      device_iter = persistent_devices_.try_emplace_back(section, SectionProperties{}).first;
     }
   }
-  if (section_iter != persistent_devices_.end()) {
+  if (device_iter != persistent_devices_.end()) {
     bool is_encrypted = value == kEncryptedStr;
     if ((!value.empty()) && os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
         os::ParameterProvider::IsCommonCriteriaMode() && InEncryptKeyNameList(property) && !is_encrypted) {
@@ -212,22 +333,24 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
         value = kEncryptedStr;
       }
     }
-    section_iter->second.insert_or_assign(property, std::move(value));
+    PersistentMutationCallback(MutationEntry::EntryType::SET, section, property, value);
+    device_iter->second.insert_or_assign(property_id, std::move(value));
     PersistentConfigChangedCallback();
     return;
   }
-  section_iter = temporary_devices_.find(section);
+  auto section_iter = temporary_devices_.find(section);
   if (section_iter == temporary_devices_.end()) {
-    auto triple = temporary_devices_.try_emplace(section, common::ListMap<std::string, std::string>{});
+    auto triple = temporary_devices_.try_emplace(section, SectionProperties{});
     section_iter = std::get<0>(triple);
   }
-  section_iter->second.insert_or_assign(property, std::move(value));
+  section_iter->second.insert_or_assign(property_id, std::move(value));
 }
 
 bool ConfigCache::RemoveSection(const std::string& section) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   // sections are unique among all three maps, hence removing from one of them is enough
   if (information_sections_.extract(section) || persistent_devices_.extract(section)) {
+    PersistentMutationCallback(MutationEntry::EntryType::REMOVE_SECTION, section);
     PersistentConfigChangedCallback();
     return true;
   } else {
@@ -237,32 +360,38 @@ bool ConfigCache::RemoveSection(const std::string& section) {
 
 bool ConfigCache::RemoveProperty(const std::string& section, const std::string& property) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto property_id = FindPropertyId(property);
+  if (!property_id) {
+    return false;
+  }
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
-    auto value = section_iter->second.extract(property);
+    auto value = section_iter->second.extract(*property_id);
     // if section is empty after removal, remove the whole section as empty section is not allowed
     if (section_iter->second.size() == 0) {
       information_sections_.erase(section_iter);
     }
     if (value.has_value()) {
+      PersistentMutationCallback(MutationEntry::EntryType::REMOVE_PROPERTY, section, property);
       PersistentConfigChangedCallback();
       return true;
     } else {
       return false;
     }
   }
-  section_iter = persistent_devices_.find(section);
-  if (section_iter != persistent_devices_.end()) {
-    auto value = section_iter->second.extract(property);
+  auto device_iter = persistent_devices_.find(section);
+  if (device_iter != persistent_devices_.end()) {
+    auto value = device_iter->second.extract(*property_id);
     // if section is empty after removal, remove the whole section as empty section is not allowed
-    if (section_iter->second.size() == 0) {
-      persistent_devices_.erase(section_iter);
+    if (device_iter->second.size() == 0) {
+      persistent_devices_.erase(device_iter);
     } else if (value && IsPersistentProperty(property)) {
       // move unpaired device
       auto section_properties = persistent_devices_.extract(section);
       temporary_devices_.insert_or_assign(section, std::move(section_properties->second));
     }
     if (value.has_value()) {
+      PersistentMutationCallback(MutationEntry::EntryType::REMOVE_PROPERTY, section, property);
       PersistentConfigChangedCallback();
       if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && os::ParameterProvider::IsCommonCriteriaMode() &&
           InEncryptKeyNameList(property)) {
@@ -275,7 +404,7 @@ bool ConfigCache::RemoveProperty(const std::string& section, const std::string&
   }
   section_iter = temporary_devices_.find(section);
   if (section_iter != temporary_devices_.end()) {
-    auto value = section_iter->second.extract(property);
+    auto value = section_iter->second.extract(*property_id);
     if (section_iter->second.size() == 0) {
       temporary_devices_.erase(section_iter);
     }
@@ -291,7 +420,11 @@ void ConfigCache::ConvertEncryptOrDecryptKeyIfNeeded() {
   for (const auto& section : persistent_sections) {
     auto section_iter = persistent_devices_.find(section);
     for (const auto& property : kEncryptKeyNameList) {
-      auto property_iter = section_iter->second.find(std::string(property));
+      auto property_id = FindPropertyId(std::string(property));
+      if (!property_id) {
+        continue;
+      }
+      auto property_iter = section_iter->second.find(*property_id);
       if (property_iter != section_iter->second.end()) {
         bool is_encrypted = property_iter->second == kEncryptedStr;
         if ((!property_iter->second.empty()) && os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
@@ -314,7 +447,8 @@ void ConfigCache::ConvertEncryptOrDecryptKeyIfNeeded() {
 }
 
 bool ConfigCache::IsDeviceSection(const std::string& section) {
-  return hci::Address::IsValidAddress(section);
+  uint64_t packed_address;
+  return ParseDeviceSection(section, &packed_address);
 }
 
 bool ConfigCache::IsPersistentProperty(const std::string& property) const {
@@ -323,20 +457,27 @@ bool ConfigCache::IsPersistentProperty(const std::string& property) const {
 
 void ConfigCache::RemoveSectionWithProperty(const std::string& property) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto property_id = FindPropertyId(property);
+  if (!property_id) {
+    return;
+  }
   size_t num_persistent_removed = 0;
-  for (auto* config_section : {&information_sections_, &persistent_devices_}) {
-    for (auto it = config_section->begin(); it != config_section->end();) {
-      if (it->second.contains(property)) {
+  auto remove_persistent_sections = [&](auto& config_section) {
+    for (auto it = config_section.begin(); it != config_section.end();) {
+      if (it->second.contains(*property_id)) {
         LOG_INFO("Removing persistent section %s with property %s", it->first.c_str(), property.c_str());
-        it = config_section->erase(it);
+        PersistentMutationCallback(MutationEntry::EntryType::REMOVE_SECTION, it->first);
+        it = config_section.erase(it);
         num_persistent_removed++;
         continue;
       }
       it++;
     }
-  }
+  };
+  remove_persistent_sections(information_sections_);
+  remove_persistent_sections(persistent_devices_);
   for (auto it = temporary_devices_.begin(); it != temporary_devices_.end();) {
-    if (it->second.contains(property)) {
+    if (it->second.contains(*property_id)) {
       LOG_INFO("Removing temporary section %s with property %s", it->first.c_str(), property.c_str());
       it = temporary_devices_.erase(it);
       continue;
@@ -381,15 +522,17 @@ void ConfigCache::Commit(std::queue<MutationEntry>& mutation_entries) {
 std::string ConfigCache::SerializeToLegacyFormat() const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   std::stringstream serialized;
-  for (const auto* config_section : {&information_sections_, &persistent_devices_}) {
-    for (const auto& section : *config_section) {
+  auto serialize_sections = [&](const auto& config_section) {
+    for (const auto& section : config_section) {
       serialized << "[" << section.first << "]" << std::endl;
       for (const auto& property : section.second) {
-        serialized << property.first << " = " << property.second << std::endl;
+        serialized << GetPropertyName(property.first) << " = " << property.second << std::endl;
       }
       serialized << std::endl;
     }
-  }
+  };
+  serialize_sections(information_sections_);
+  serialize_sections(persistent_devices_);
   return serialized.str();
 }
 
@@ -397,17 +540,22 @@ std::vector<ConfigCache::SectionAndPropertyValue> ConfigCache::GetSectionNamesWi
     const std::string& property) const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   std::vector<SectionAndPropertyValue> result;
-  for (auto* config_section : {&information_sections_, &persistent_devices_}) {
-    for (const auto& elem : *config_section) {
-      auto it = elem.second.find(property);
+  auto property_id = FindPropertyId(property);
+  if (!property_id) {
+    return result;
+  }
+  auto find_in_sections = [&](const auto& config_section) {
+    for (const auto& elem : config_section) {
+      auto it = elem.second.find(*property_id);
       if (it != elem.second.end()) {
         result.emplace_back(SectionAndPropertyValue{.section = elem.first, .property = it->second});
-        continue;
       }
     }
-  }
+  };
+  find_in_sections(information_sections_);
+  find_in_sections(persistent_devices_);
   for (const auto& elem : temporary_devices_) {
-    auto it = elem.second.find(property);
+    auto it = elem.second.find(*property_id);
     if (it != elem.second.end()) {
       result.emplace_back(SectionAndPropertyValue{.section = elem.first, .property = it->second});
       continue;
@@ -416,14 +564,13 @@ std::vector<ConfigCache::SectionAndPropertyValue> ConfigCache::GetSectionNamesWi
   return result;
 }
 
-namespace {
-
-bool FixDeviceTypeInconsistencyInSection(
-    const std::string& section_name, common::ListMap<std::string, std::string>& device_section_entries) {
-  if (!hci::Address::IsValidAddress(section_name)) {
+bool ConfigCache::FixDeviceTypeInconsistencyInSection(
+    const std::string& section_name, SectionProperties& device_section_entries) {
+  if (!IsDeviceSection(section_name)) {
     return false;
   }
-  auto device_type_iter = device_section_entries.find("DevType");
+  PropertyId device_type_id = InternPropertyName("DevType");
+  auto device_type_iter = device_section_entries.find(device_type_id);
   if (device_type_iter != device_section_entries.end() &&
       device_type_iter->second == std::to_string(hci::DeviceType::DUAL)) {
     // We might only have one of classic/LE keys for a dual device, but it is still a dual device,
@@ -438,10 +585,11 @@ bool FixDeviceTypeInconsistencyInSection(
   // default
   hci::DeviceType device_type = hci::DeviceType::BR_EDR;
   for (const auto& entry : device_section_entries) {
-    if (kLePropertyNames.find(entry.first) != kLePropertyNames.end()) {
+    const std::string& property = GetPropertyName(entry.first);
+    if (kLePropertyNames.find(property) != kLePropertyNames.end()) {
       is_le = true;
     }
-    if (kClassicPropertyNames.find(entry.first) != kClassicPropertyNames.end()) {
+    if (kClassicPropertyNames.find(property) != kClassicPropertyNames.end()) {
       is_classic = true;
     }
   }
@@ -460,23 +608,26 @@ bool FixDeviceTypeInconsistencyInSection(
       device_type_iter->second = std::move(device_type_str);
     }
   } else {
-    device_section_entries.insert_or_assign("DevType", std::move(device_type_str));
+    device_section_entries.insert_or_assign(device_type_id, std::move(device_type_str));
   }
   return inconsistent;
 }
 
-}  // namespace
-
 bool ConfigCache::FixDeviceTypeInconsistencies() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   bool persistent_device_changed = false;
-  for (auto* config_section : {&information_sections_, &persistent_devices_}) {
-    for (auto& elem : *config_section) {
+  auto fix_persistent_sections = [&](auto& config_section) {
+    for (auto& elem : config_section) {
       if (FixDeviceTypeInconsistencyInSection(elem.first, elem.second)) {
+        PropertyId device_type_id = InternPropertyName("DevType");
+        PersistentMutationCallback(
+            MutationEntry::EntryType::SET, elem.first, "DevType", elem.second.find(device_type_id)->second);
         persistent_device_changed = true;
       }
     }
-  }
+  };
+  fix_persistent_sections(information_sections_);
+  fix_persistent_sections(persistent_devices_);
   bool temp_device_changed = false;
   for (auto& elem : temporary_devices_) {
     if (FixDeviceTypeInconsistencyInSection(elem.first, elem.second)) {
@@ -492,7 +643,7 @@ bool ConfigCache::FixDeviceTypeInconsistencies() {
 bool ConfigCache::HasAtLeastOneMatchingPropertiesInSection(
     const std::string& section, const std::unordered_set<std::string_view>& property_names) const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
-  const common::ListMap<std::string, std::string>* section_ptr;
+  const SectionProperties* section_ptr;
   if (!IsDeviceSection(section)) {
     auto section_iter = information_sections_.find(section);
     if (section_iter == information_sections_.end()) {
@@ -500,17 +651,19 @@ bool ConfigCache::HasAtLeastOneMatchingPropertiesInSection(
     }
     section_ptr = &section_iter->second;
   } else {
-    auto section_iter = persistent_devices_.find(section);
-    if (section_iter == persistent_devices_.end()) {
-      section_iter = temporary_devices_.find(section);
+    auto device_iter = persistent_devices_.find(section);
+    if (device_iter != persistent_devices_.end()) {
+      section_ptr = &device_iter->second;
+    } else {
+      auto section_iter = temporary_devices_.find(section);
       if (section_iter == temporary_devices_.end()) {
         return false;
       }
+      section_ptr = &section_iter->second;
     }
-    section_ptr = &section_iter->second;
   }
   for (const auto& property : *section_ptr) {
-    if (property_names.count(property.first) > 0) {
+    if (property_names.count(GetPropertyName(property.first)) > 0) {
       return true;
     }
   }
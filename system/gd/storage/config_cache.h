@@ -26,6 +26,7 @@
 #include <utility>
 #include <vector>
 
+#include "common/flat_list_map.h"
 #include "common/list_map.h"
 #include "common/lru_cache.h"
 #include "hci/address.h"
@@ -111,6 +112,10 @@ class ConfigCache {
   virtual void Clear();
   // Set a callback to notify interested party that a persistent config change has just happened
   virtual void SetPersistentConfigChangedCallback(std::function<void()> persistent_config_changed_callback);
+  // Set a callback to receive each change to sections that are written to disk, as a mutation entry that reproduces
+  // the change when committed to a cache that held the same content. Called while holding the config mutex
+  virtual void SetPersistentMutationCallback(
+      std::function<void(const MutationEntry&)> persistent_mutation_callback);
 
   // Device config specific methods
   // TODO: methods here should be moved to a device specific config cache if this config cache is supposed to be generic
@@ -125,19 +130,42 @@ class ConfigCache {
   static const std::string kDefaultSectionName;
 
  private:
+  // Property names are interned, sections refer to them by their position in property_names_
+  using PropertyId = uint16_t;
+  // Properties of a section in insertion order
+  using SectionProperties = common::FlatListMap<PropertyId, std::string>;
+  // Hashes device sections by the address they name
+  struct DeviceSectionHash {
+    size_t operator()(const std::string& section) const;
+  };
+
+  // Return the id of |property| if it was ever interned
+  std::optional<PropertyId> FindPropertyId(const std::string& property) const;
+  PropertyId InternPropertyName(const std::string& property);
+  const std::string& GetPropertyName(PropertyId property_id) const;
+  bool FixDeviceTypeInconsistencyInSection(const std::string& section_name, SectionProperties& properties);
+  // Compare sections by property name, as each cache interns property names independently
+  template <typename Sections>
+  static bool SectionsEqual(
+      const ConfigCache& lhs, const Sections& lhs_sections, const ConfigCache& rhs, const Sections& rhs_sections);
+
   mutable std::recursive_mutex mutex_;
   // A callback to notify interested party that a persistent config change has just happened, empty by default
   std::function<void()> persistent_config_changed_callback_;
+  // A callback to report each persistent change as a mutation entry, empty by default
+  std::function<void(const MutationEntry&)> persistent_mutation_callback_;
   // A set of property names that if set would make a section persistent and if non of these properties are set, a
   // section would become temporary again
   std::unordered_set<std::string_view> persistent_property_names_;
+  // Interned property names in order of first use, the value is true for persistent properties
+  common::FlatListMap<std::string, bool> property_names_;
   // Common section that does not relate to remote device, will be written to disk
-  common::ListMap<std::string, common::ListMap<std::string, std::string>> information_sections_;
+  common::ListMap<std::string, SectionProperties> information_sections_;
   // Information about persistent devices, normally paired, will be written to disk
-  common::ListMap<std::string, common::ListMap<std::string, std::string>> persistent_devices_;
+  common::FlatListMap<std::string, SectionProperties, DeviceSectionHash> persistent_devices_;
   // Information about temporary devices, normally unpaired, will not be written to disk, will be evicted automatically
   // if capacity exceeds given value during initialization
-  common::LruCache<std::string, common::ListMap<std::string, std::string>> temporary_devices_;
+  common::LruCache<std::string, SectionProperties> temporary_devices_;
 
   // Convenience method to check if the callback is valid before calling it
   inline void PersistentConfigChangedCallback() const {
@@ -145,6 +173,18 @@ class ConfigCache {
       persistent_config_changed_callback_();
     }
   }
+
+  // Convenience method to check if the callback is valid before building the entry and calling it
+  inline void PersistentMutationCallback(
+      MutationEntry::EntryType entry_type,
+      const std::string& section,
+      const std::string& property = "",
+      const std::string& value = "") const {
+    if (persistent_mutation_callback_) {
+      persistent_mutation_callback_(
+          MutationEntry(entry_type, MutationEntry::PropertyType::NORMAL, section, property, value));
+    }
+  }
 };
 
 }  // namespace storage
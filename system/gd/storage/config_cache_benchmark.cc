@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "storage/config_cache.h"
+
+using ::benchmark::State;
+using ::bluetooth::storage::ConfigCache;
+
+namespace {
+
+const std::unordered_set<std::string_view> kLinkKeyProperties = {
+    "LinkKey", "LE_KEY_PENC", "LE_KEY_PID", "LE_KEY_PCSRK", "LE_KEY_PLK"};
+
+// Properties typically stored for a bonded dual mode device
+const std::vector<std::string> kDeviceProperties = {
+    "Name",      "DevClass", "DevType",     "AddrType",  "Timestamp", "Manufacturer", "LmpVer",
+    "LmpSubVer", "Service",  "LinkKeyType", "PinLength", "LinkKey",   "LE_KEY_PENC",  "LE_KEY_PID",
+    "LE_KEY_LENC", "LE_KEY_PCSRK", "DevManufacturer"};
+
+std::string DeviceSection(int i) {
+  char section[18];
+  std::snprintf(section, sizeof(section), "00:11:22:33:%02x:%02x", (i >> 8) & 0xff, i & 0xff);
+  return section;
+}
+
+class BM_ConfigCache : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    config_ = std::make_unique<ConfigCache>(100, kLinkKeyProperties);
+    config_->SetProperty("Adapter", "Address", "01:02:03:04:05:06");
+    config_->SetProperty("Adapter", "Name", "Bluetooth");
+    for (int i = 0; i < st.range(0); i++) {
+      sections_.push_back(DeviceSection(i));
+      for (const auto& property : kDeviceProperties) {
+        config_->SetProperty(sections_.back(), property, "0123456789abcdef0123456789abcdef");
+      }
+    }
+  }
+
+  void TearDown(State& st) override {
+    config_.reset();
+    sections_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::unique_ptr<ConfigCache> config_;
+  std::vector<std::string> sections_;
+};
+
+BENCHMARK_DEFINE_F(BM_ConfigCache, GetProperty)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(
+        config_->GetProperty(sections_[i % sections_.size()], kDeviceProperties[i % kDeviceProperties.size()]));
+    i++;
+  }
+}
+
+BENCHMARK_DEFINE_F(BM_ConfigCache, SetProperty)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    config_->SetProperty(sections_[i % sections_.size()], "Timestamp", std::to_string(i));
+    i++;
+  }
+}
+
+BENCHMARK_DEFINE_F(BM_ConfigCache, GetPersistentSections)(State& state) {
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(config_->GetPersistentSections());
+  }
+}
+
+BENCHMARK_DEFINE_F(BM_ConfigCache, SerializeToLegacyFormat)(State& state) {
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(config_->SerializeToLegacyFormat());
+  }
+}
+
+BENCHMARK_REGISTER_F(BM_ConfigCache, GetProperty)->ArgName("devices")->Arg(1000);
+BENCHMARK_REGISTER_F(BM_ConfigCache, SetProperty)->ArgName("devices")->Arg(1000);
+BENCHMARK_REGISTER_F(BM_ConfigCache, GetPersistentSections)->ArgName("devices")->Arg(1000);
+BENCHMARK_REGISTER_F(BM_ConfigCache, SerializeToLegacyFormat)->ArgName("devices")->Arg(1000);
+
+}  // namespace
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_journal.h"
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <queue>
+
+#include "os/files.h"
+#include "os/log.h"
+
+namespace {
+
+// "BTCJ", followed by the config checksum
+constexpr uint32_t kJournalMagic = 0x4A435442;
+constexpr size_t kJournalHeaderSize = 2 * sizeof(uint32_t);
+// Record header is the payload length followed by the payload checksum
+constexpr size_t kRecordHeaderSize = 2 * sizeof(uint32_t);
+// Entry type followed by the length of section, property and value
+constexpr size_t kMinPayloadSize = sizeof(uint8_t) + 3 * sizeof(uint32_t);
+
+// Table for the reflected CRC-32 polynomial 0x04C11DB7, as used by zlib
+constexpr std::array<uint32_t, 256> MakeCrc32Table() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < table.size(); i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrc32Table = MakeCrc32Table();
+
+uint32_t Crc32(const char* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc = kCrc32Table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
+void PutUint32(uint32_t value, std::string& buffer) {
+  for (int i = 0; i < 4; i++) {
+    buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+void PutUint32At(uint32_t value, std::string& buffer, size_t offset) {
+  for (int i = 0; i < 4; i++) {
+    buffer[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+uint32_t GetUint32(const char* data) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+  }
+  return value;
+}
+
+void PutString(const std::string& value, std::string& buffer) {
+  PutUint32(static_cast<uint32_t>(value.size()), buffer);
+  buffer.append(value);
+}
+
+// Read a length prefixed string at |offset| of a payload of |size| bytes and advance |offset| past it
+bool GetString(const char* payload, size_t size, size_t& offset, std::string& value) {
+  if (size - offset < sizeof(uint32_t)) {
+    return false;
+  }
+  uint32_t length = GetUint32(payload + offset);
+  offset += sizeof(uint32_t);
+  if (size - offset < length) {
+    return false;
+  }
+  value.assign(payload + offset, length);
+  offset += length;
+  return true;
+}
+
+// Sync the directory holding |path| so that a newly created file survives a power loss
+void SyncParentDirectory(const std::string& path) {
+  // inputs to dirname() may be modified, hence work on a copy
+  std::string path_for_dir(path);
+  std::string directory_path(dirname(path_for_dir.data()));
+  int dir_fd = open(directory_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd < 0) {
+    LOG_WARN("unable to open dir '%s', error: %s", directory_path.c_str(), strerror(errno));
+    return;
+  }
+  if (fsync(dir_fd) != 0) {
+    LOG_WARN("unable to fsync dir '%s', error: %s", directory_path.c_str(), strerror(errno));
+  }
+  close(dir_fd);
+}
+
+}  // namespace
+
+namespace bluetooth {
+namespace storage {
+
+ConfigJournal::ConfigJournal(std::string path) : path_(std::move(path)) {
+  ASSERT(!path_.empty());
+}
+
+void ConfigJournal::EncodeRecord(const MutationEntry& entry, std::string& buffer) {
+  size_t header_offset = buffer.size();
+  buffer.append(kRecordHeaderSize, '\0');
+  size_t payload_offset = buffer.size();
+  buffer.push_back(static_cast<char>(entry.entry_type));
+  PutString(entry.section, buffer);
+  PutString(entry.property, buffer);
+  PutString(entry.value, buffer);
+  size_t payload_size = buffer.size() - payload_offset;
+  PutUint32At(static_cast<uint32_t>(payload_size), buffer, header_offset);
+  PutUint32At(Crc32(buffer.data() + payload_offset, payload_size), buffer, header_offset + sizeof(uint32_t));
+}
+
+uint32_t ConfigJournal::Checksum(const std::string& config_content) {
+  return Crc32(config_content.data(), config_content.size());
+}
+
+bool ConfigJournal::Append(const std::vector<MutationEntry>& entries, uint32_t config_checksum) {
+  if (entries.empty()) {
+    return true;
+  }
+  bool is_new_file = !os::FileExists(path_);
+  std::string buffer;
+  // The header goes out in the same write as the first records, a partial write fails the header check on replay
+  if (is_new_file || Size() == 0) {
+    PutUint32(kJournalMagic, buffer);
+    PutUint32(config_checksum, buffer);
+  }
+  for (const auto& entry : entries) {
+    EncodeRecord(entry, buffer);
+  }
+  int fd = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fd < 0) {
+    LOG_ERROR("unable to open file '%s', error: %s", path_.c_str(), strerror(errno));
+    return false;
+  }
+  const char* data = buffer.data();
+  size_t remaining = buffer.size();
+  while (remaining > 0) {
+    ssize_t written = write(fd, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_ERROR("unable to write to file '%s', error: %s", path_.c_str(), strerror(errno));
+      close(fd);
+      return false;
+    }
+    data += written;
+    remaining -= written;
+  }
+  // Unlike a full config write, an append that did not make it to disk cannot be recovered from a backup
+  if (fsync(fd) != 0) {
+    LOG_ERROR("unable to fsync file '%s', error: %s", path_.c_str(), strerror(errno));
+    close(fd);
+    return false;
+  }
+  if (close(fd) != 0) {
+    LOG_ERROR("unable to close file '%s', error: %s", path_.c_str(), strerror(errno));
+    return false;
+  }
+  if (is_new_file) {
+    SyncParentDirectory(path_);
+  }
+  return true;
+}
+
+size_t ConfigJournal::Replay(ConfigCache& cache, uint32_t config_checksum) const {
+  auto journal = os::ReadSmallFile(path_);
+  if (!journal) {
+    return 0;
+  }
+  if (journal->size() < kJournalHeaderSize || GetUint32(journal->data()) != kJournalMagic) {
+    LOG_WARN("invalid header in %s", path_.c_str());
+    return 0;
+  }
+  if (GetUint32(journal->data() + sizeof(uint32_t)) != config_checksum) {
+    LOG_WARN("%s was not started on top of the current config", path_.c_str());
+    return 0;
+  }
+  std::queue<MutationEntry> entries;
+  size_t offset = kJournalHeaderSize;
+  while (journal->size() - offset >= kRecordHeaderSize) {
+    const char* header = journal->data() + offset;
+    uint32_t payload_size = GetUint32(header);
+    uint32_t checksum = GetUint32(header + sizeof(uint32_t));
+    const char* payload = header + kRecordHeaderSize;
+    if (payload_size < kMinPayloadSize || journal->size() - offset - kRecordHeaderSize < payload_size) {
+      LOG_WARN("truncated record at offset %zu of %s", offset, path_.c_str());
+      break;
+    }
+    if (Crc32(payload, payload_size) != checksum) {
+      LOG_WARN("corrupted record at offset %zu of %s", offset, path_.c_str());
+      break;
+    }
+    auto entry_type = static_cast<MutationEntry::EntryType>(payload[0]);
+    if (entry_type != MutationEntry::EntryType::SET && entry_type != MutationEntry::EntryType::REMOVE_PROPERTY &&
+        entry_type != MutationEntry::EntryType::REMOVE_SECTION) {
+      LOG_WARN("unknown entry type %d at offset %zu of %s", payload[0], offset, path_.c_str());
+      break;
+    }
+    std::string section, property, value;
+    size_t payload_offset = sizeof(uint8_t);
+    if (!GetString(payload, payload_size, payload_offset, section) ||
+        !GetString(payload, payload_size, payload_offset, property) ||
+        !GetString(payload, payload_size, payload_offset, value) || payload_offset != payload_size) {
+      LOG_WARN("malformed record at offset %zu of %s", offset, path_.c_str());
+      break;
+    }
+    entries.push(MutationEntry(
+        entry_type, MutationEntry::PropertyType::NORMAL, std::move(section), std::move(property), std::move(value)));
+    offset += kRecordHeaderSize + payload_size;
+  }
+  size_t num_entries = entries.size();
+  cache.Commit(entries);
+  return num_entries;
+}
+
+size_t ConfigJournal::Size() const {
+  struct stat journal_stat {};
+  if (stat(path_.c_str(), &journal_stat) != 0) {
+    return 0;
+  }
+  return journal_stat.st_size;
+}
+
+bool ConfigJournal::Delete() {
+  if (!os::FileExists(path_)) {
+    LOG_WARN("Journal file at \"%s\" does not exist", path_.c_str());
+    return false;
+  }
+  return os::RemoveFile(path_);
+}
+
+}  // namespace storage
+}  // namespace bluetooth
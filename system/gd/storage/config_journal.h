@@ -0,0 +1,73 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/config_cache.h"
+#include "storage/mutation_entry.h"
+
+namespace bluetooth {
+namespace storage {
+
+// Append-only log of the changes made to a config since it was last written out in full by LegacyConfigFile
+//
+// The journal starts with a header of:
+//   - uint32_t magic, little endian
+//   - uint32_t CRC-32 of the config file the journal was started on top of, little endian
+// A journal is only replayed on top of a config file with that checksum. A crash after the config was rewritten but
+// before the journal was deleted thus leaves a journal that is ignored, instead of one that rolls back newer values.
+//
+// Each mutation entry is then stored as a record of:
+//   - uint32_t payload length, little endian
+//   - uint32_t CRC-32 of the payload, little endian
+//   - payload: uint8_t entry type, then section, property and value, each as a little endian uint32_t length
+//     followed by that many bytes
+//
+// A crash can leave a partially written record at the end of the journal. Such a record fails its length or checksum
+// check and replay stops there, so the config is restored to the last batch that made it to disk. Since new records
+// are appended after it, the owner must rewrite the full config and delete the journal after replaying a journal or
+// failing to append to it.
+class ConfigJournal {
+ public:
+  static ConfigJournal FromPath(std::string path) {
+    return ConfigJournal(std::move(path));
+  }
+  explicit ConfigJournal(std::string path);
+  // Append |entries| with a single write and sync them to disk. |config_checksum| is the Checksum() of the config file
+  // on disk, and is recorded when the journal is created. Return false if the journal could not be written
+  bool Append(const std::vector<MutationEntry>& entries, uint32_t config_checksum);
+  // Commit the intact entries of the journal to |cache| in order and return the number of entries replayed. Nothing is
+  // replayed unless the journal was started on top of a config file with |config_checksum|
+  size_t Replay(ConfigCache& cache, uint32_t config_checksum) const;
+  // Return the size of the journal on disk in bytes, 0 if it does not exist
+  size_t Size() const;
+  bool Delete();
+
+  // Return the checksum of the content of a config file, as given to Append() and Replay()
+  static uint32_t Checksum(const std::string& config_content);
+
+  // Append the record for |entry| to |buffer|
+  static void EncodeRecord(const MutationEntry& entry, std::string& buffer);
+
+ private:
+  std::string path_;
+};
+
+}  // namespace storage
+}  // namespace bluetooth
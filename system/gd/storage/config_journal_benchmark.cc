@@ -0,0 +1,119 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "storage/config_cache.h"
+#include "storage/config_journal.h"
+#include "storage/legacy_config_file.h"
+
+using ::benchmark::State;
+using ::bluetooth::storage::ConfigCache;
+using ::bluetooth::storage::ConfigJournal;
+using ::bluetooth::storage::LegacyConfigFile;
+using ::bluetooth::storage::MutationEntry;
+
+namespace {
+
+const std::unordered_set<std::string_view> kLinkKeyProperties = {
+    "LinkKey", "LE_KEY_PENC", "LE_KEY_PID", "LE_KEY_PCSRK", "LE_KEY_PLK"};
+
+// Properties typically stored for a bonded dual mode device
+const std::vector<std::string> kDeviceProperties = {
+    "Name",      "DevClass", "DevType",     "AddrType",  "Timestamp", "Manufacturer", "LmpVer",
+    "LmpSubVer", "Service",  "LinkKeyType", "PinLength", "LinkKey",   "LE_KEY_PENC",  "LE_KEY_PID",
+    "LE_KEY_LENC", "LE_KEY_PCSRK", "DevManufacturer"};
+
+std::string DeviceSection(int i) {
+  char section[18];
+  std::snprintf(section, sizeof(section), "00:11:22:33:%02x:%02x", (i >> 8) & 0xff, i & 0xff);
+  return section;
+}
+
+// Persists one property change at a time, the way a stream of connection timestamps would be, either by writing the
+// full config file or by appending to the journal
+class BM_ConfigSave : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    auto temp_dir = std::filesystem::temp_directory_path();
+    config_path_ = (temp_dir / "bm_config.conf").string();
+    journal_path_ = (temp_dir / "bm_config.journal").string();
+    config_ = std::make_unique<ConfigCache>(100, kLinkKeyProperties);
+    config_->SetProperty("Adapter", "Address", "01:02:03:04:05:06");
+    config_->SetProperty("Adapter", "Name", "Bluetooth");
+    for (int i = 0; i < st.range(0); i++) {
+      sections_.push_back(DeviceSection(i));
+      for (const auto& property : kDeviceProperties) {
+        config_->SetProperty(sections_.back(), property, "0123456789abcdef0123456789abcdef");
+      }
+    }
+    config_->SetPersistentMutationCallback([this](const MutationEntry& entry) { mutations_.push_back(entry); });
+  }
+
+  void TearDown(State& st) override {
+    std::filesystem::remove(config_path_);
+    std::filesystem::remove(journal_path_);
+    config_.reset();
+    sections_.clear();
+    mutations_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void SetNextTimestamp(size_t i) {
+    config_->SetProperty(sections_[i % sections_.size()], "Timestamp", std::to_string(1700000000 + i));
+  }
+
+  std::string config_path_;
+  std::string journal_path_;
+  std::unique_ptr<ConfigCache> config_;
+  std::vector<std::string> sections_;
+  std::vector<MutationEntry> mutations_;
+};
+
+BENCHMARK_DEFINE_F(BM_ConfigSave, FullWrite)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    SetNextTimestamp(i++);
+    mutations_.clear();
+    LegacyConfigFile::FromPath(config_path_).Write(*config_);
+  }
+  state.counters["bytes_per_mutation"] = std::filesystem::file_size(config_path_);
+}
+
+BENCHMARK_DEFINE_F(BM_ConfigSave, JournalAppend)(State& state) {
+  auto journal = ConfigJournal::FromPath(journal_path_);
+  uint32_t config_checksum = ConfigJournal::Checksum(config_->SerializeToLegacyFormat());
+  size_t i = 0;
+  for (auto _ : state) {
+    SetNextTimestamp(i++);
+    journal.Append(mutations_, config_checksum);
+    mutations_.clear();
+  }
+  state.counters["bytes_per_mutation"] = static_cast<double>(journal.Size()) / i;
+}
+
+BENCHMARK_REGISTER_F(BM_ConfigSave, FullWrite)->ArgName("devices")->Arg(10)->Arg(100);
+BENCHMARK_REGISTER_F(BM_ConfigSave, JournalAppend)->ArgName("devices")->Arg(10)->Arg(100);
+
+}  // namespace
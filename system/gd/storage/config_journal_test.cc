@@ -0,0 +1,184 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_journal.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "os/files.h"
+#include "storage/device.h"
+
+namespace testing {
+
+using bluetooth::os::ReadSmallFile;
+using bluetooth::storage::ConfigCache;
+using bluetooth::storage::ConfigJournal;
+using bluetooth::storage::Device;
+using bluetooth::storage::MutationEntry;
+
+// Checksum of the config file the journals below are started on top of
+static const uint32_t kConfigChecksum = ConfigJournal::Checksum("[Adapter]\nAddress = 01:02:03:04:05:06\n");
+
+class ConfigJournalTest : public Test {
+ protected:
+  void SetUp() override {
+    temp_journal_ = std::filesystem::temp_directory_path() / "temp_config.journal";
+    std::filesystem::remove(temp_journal_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(temp_journal_);
+  }
+
+  // Config as it was when last written in full
+  static void FillConfig(ConfigCache& config) {
+    config.SetProperty("Adapter", "Address", "01:02:03:04:05:06");
+    config.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "AABBAABBCCDDEE");
+    config.SetProperty("CC:DD:EE:FF:00:11", "Name", "Headset");
+    config.SetProperty("CC:DD:EE:FF:00:22", "LinkKey", "AABBAABBCCDDFF");
+  }
+
+  // Journal records are binary, so they cannot go through os::WriteToFile()
+  void OverwriteJournal(const std::string& content) {
+    std::ofstream journal(temp_journal_, std::ios::binary | std::ios::trunc);
+    journal << content;
+  }
+
+  std::filesystem::path temp_journal_;
+};
+
+TEST_F(ConfigJournalTest, replay_reproduces_persistent_changes_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  FillConfig(config);
+  std::vector<MutationEntry> entries;
+  config.SetPersistentMutationCallback([&entries](const MutationEntry& entry) { entries.push_back(entry); });
+
+  config.SetProperty("Adapter", "Name", "Bluetooth");
+  // temporary devices are only journaled once they become persistent
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "Name", "Speaker");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "DevClass", "0x240404");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "0123456789ABCDEF");
+  config.SetProperty("11:22:33:44:55:66", "Name", "Phone");
+  config.RemoveProperty("CC:DD:EE:FF:00:11", "LinkKey");
+  config.RemoveSection("CC:DD:EE:FF:00:22");
+  EXPECT_EQ(entries.size(), 6u);
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, kConfigChecksum));
+
+  entries.clear();
+  config.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "AABBAABBCCDDEE");
+  config.RemoveSectionWithProperty("DevClass");
+  config.FixDeviceTypeInconsistencies();
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, kConfigChecksum));
+
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  FillConfig(replayed);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(replayed, kConfigChecksum), 6u + entries.size());
+  EXPECT_EQ(replayed.SerializeToLegacyFormat(), config.SerializeToLegacyFormat());
+  EXPECT_THAT(replayed.GetPersistentSections(), ElementsAre("CC:DD:EE:FF:00:11"));
+  EXPECT_THAT(replayed.GetProperty("CC:DD:EE:FF:00:11", "Name"), Optional(StrEq("Headset")));
+  EXPECT_FALSE(replayed.HasSection("AA:BB:CC:DD:EE:FF"));
+  EXPECT_FALSE(replayed.HasSection("11:22:33:44:55:66"));
+}
+
+TEST_F(ConfigJournalTest, missing_journal_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Size(), 0u);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(config, kConfigChecksum), 0u);
+  EXPECT_FALSE(ConfigJournal::FromPath(temp_journal_.string()).Delete());
+}
+
+TEST_F(ConfigJournalTest, truncated_record_is_ignored_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  std::vector<MutationEntry> entries;
+  config.SetPersistentMutationCallback([&entries](const MutationEntry& entry) { entries.push_back(entry); });
+  config.SetProperty("Adapter", "Address", "01:02:03:04:05:06");
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, kConfigChecksum));
+  size_t first_batch_size = ConfigJournal::FromPath(temp_journal_.string()).Size();
+  EXPECT_GT(first_batch_size, 0u);
+
+  entries.clear();
+  config.SetProperty("Adapter", "Name", "Bluetooth");
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, kConfigChecksum));
+
+  // Drop the last byte as a crash in the middle of the second append would
+  auto journal = ReadSmallFile(temp_journal_.string());
+  ASSERT_TRUE(journal);
+  journal->pop_back();
+  OverwriteJournal(*journal);
+
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(replayed, kConfigChecksum), 1u);
+  EXPECT_THAT(replayed.GetProperty("Adapter", "Address"), Optional(StrEq("01:02:03:04:05:06")));
+  EXPECT_FALSE(replayed.HasProperty("Adapter", "Name"));
+
+  // Only the header of the second record made it
+  journal->resize(first_batch_size + 4);
+  OverwriteJournal(*journal);
+  ConfigCache replayed_again(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(replayed_again, kConfigChecksum), 1u);
+}
+
+TEST_F(ConfigJournalTest, corrupted_record_stops_replay_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  std::vector<MutationEntry> entries;
+  config.SetPersistentMutationCallback([&entries](const MutationEntry& entry) { entries.push_back(entry); });
+  config.SetProperty("Adapter", "Address", "01:02:03:04:05:06");
+  config.SetProperty("Adapter", "Name", "Bluetooth");
+  config.SetProperty("Adapter", "ScanMode", "2");
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, kConfigChecksum));
+
+  // Flip a bit in the value of the second record
+  auto journal = ReadSmallFile(temp_journal_.string());
+  ASSERT_TRUE(journal);
+  size_t name_position = journal->find("Bluetooth");
+  ASSERT_NE(name_position, std::string::npos);
+  (*journal)[name_position] ^= 0x01;
+  OverwriteJournal(*journal);
+
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(replayed, kConfigChecksum), 1u);
+  EXPECT_THAT(replayed.GetProperty("Adapter", "Address"), Optional(StrEq("01:02:03:04:05:06")));
+  EXPECT_FALSE(replayed.HasProperty("Adapter", "Name"));
+  EXPECT_FALSE(replayed.HasProperty("Adapter", "ScanMode"));
+}
+
+TEST_F(ConfigJournalTest, journal_of_another_config_is_ignored_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  std::vector<MutationEntry> entries;
+  config.SetPersistentMutationCallback([&entries](const MutationEntry& entry) { entries.push_back(entry); });
+  config.SetProperty("Adapter", "Name", "Bluetooth");
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, kConfigChecksum));
+
+  // The config file was rewritten, but the journal of the previous one was not deleted
+  uint32_t new_config_checksum = ConfigJournal::Checksum("[Adapter]\nAddress = 01:02:03:04:05:07\n");
+  ASSERT_NE(new_config_checksum, kConfigChecksum);
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(replayed, new_config_checksum), 0u);
+  EXPECT_FALSE(replayed.HasProperty("Adapter", "Name"));
+
+  // Records appended later keep the checksum the journal was started with
+  entries.clear();
+  config.SetProperty("Adapter", "ScanMode", "2");
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(entries, new_config_checksum));
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(replayed, kConfigChecksum), 2u);
+}
+
+}  // namespace testing
@@ -30,6 +30,7 @@
 #include "os/parameter_provider.h"
 #include "os/system_properties.h"
 #include "storage/config_cache.h"
+#include "storage/config_journal.h"
 #include "storage/legacy_config_file.h"
 #include "storage/mutation.h"
 
@@ -49,6 +50,9 @@ static const std::chrono::milliseconds kDefaultConfigSaveDelay = std::chrono::mi
 // Writing a config to disk takes a minimum 10 ms on a decent x86_64 machine, and 20 ms if including backup file
 // The config saving delay must be bigger than this value to avoid overwhelming the disk
 static const std::chrono::milliseconds kMinConfigSaveDelay = std::chrono::milliseconds(20);
+// Appending a change to the journal writes a few dozen bytes instead of the whole config. Once the journal outgrows a
+// typical config, fold it back into the config file so that it does not grow without bound
+static const size_t kMaxConfigJournalSize = 64 * 1024;
 
 const int kConfigFileComparePass = 1;
 const int kConfigBackupComparePass = 2;
@@ -75,6 +79,8 @@ StorageModule::StorageModule(
       is_single_user_mode_(is_single_user_mode) {
   // e.g. "/data/misc/bluedroid/bt_config.conf" to "/data/misc/bluedroid/bt_config.bak"
   config_backup_path_ = config_file_path_.substr(0, config_file_path_.find_last_of('.')) + ".bak";
+  // e.g. "/data/misc/bluedroid/bt_config.conf" to "/data/misc/bluedroid/bt_config.journal"
+  config_journal_path_ = config_file_path_.substr(0, config_file_path_.find_last_of('.')) + ".journal";
   ASSERT_LOG(
       config_save_delay > kMinConfigSaveDelay,
       "Config save delay of %lld ms is not enough, must be at least %lld ms to avoid overwhelming the disk",
@@ -99,6 +105,15 @@ struct StorageModule::impl {
   ConfigCache cache_;
   ConfigCache memory_only_cache_;
   bool has_pending_config_save_ = false;
+  // Journal of changes since the config file was last written, std::nullopt when every save writes the full config
+  std::optional<ConfigJournal> journal_;
+  // Set when the next delayed save must write the full config instead of appending to the journal
+  bool is_full_save_needed_ = false;
+  // Checksum of the config file on disk, which journal_ applies on top of
+  uint32_t config_checksum_ = 0;
+  // Changes not yet appended to the journal, reported by cache_ on the thread that made them
+  std::mutex pending_mutations_mutex_;
+  std::vector<MutationEntry> pending_mutations_;
 };
 
 Mutation StorageModule::Modify() {
@@ -112,25 +127,62 @@ void StorageModule::SaveDelayed() {
     return;
   }
   pimpl_->config_save_alarm_.Schedule(
-      common::BindOnce(&StorageModule::SaveImmediately, common::Unretained(this)), config_save_delay_);
+      common::BindOnce(&StorageModule::SaveChanges, common::Unretained(this)), config_save_delay_);
   pimpl_->has_pending_config_save_ = true;
 }
 
+void StorageModule::SaveChanges() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  pimpl_->has_pending_config_save_ = false;
+  if (!pimpl_->journal_ || pimpl_->is_full_save_needed_) {
+    SaveImmediately();
+    return;
+  }
+  std::vector<MutationEntry> mutations;
+  {
+    std::lock_guard<std::mutex> mutations_lock(pimpl_->pending_mutations_mutex_);
+    mutations.swap(pimpl_->pending_mutations_);
+  }
+  // A failed append may leave a partial record behind, which would hide any record appended after it
+  if (!pimpl_->journal_->Append(mutations, pimpl_->config_checksum_)) {
+    LOG_WARN("unable to append to %s, saving full config instead", config_journal_path_.c_str());
+    SaveImmediately();
+    return;
+  }
+  if (pimpl_->journal_->Size() > kMaxConfigJournalSize) {
+    SaveImmediately();
+  }
+}
+
 void StorageModule::SaveImmediately() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (pimpl_->has_pending_config_save_) {
     pimpl_->config_save_alarm_.Cancel();
     pimpl_->has_pending_config_save_ = false;
   }
+  // 0. changes made from now on may or may not make it into the config written below, keep journaling them in order
+  // on top of it so that replaying them ends on their latest value
+  {
+    std::lock_guard<std::mutex> mutations_lock(pimpl_->pending_mutations_mutex_);
+    pimpl_->pending_mutations_.clear();
+  }
+  std::string config_content = pimpl_->cache_.SerializeToLegacyFormat();
   // 1. rename old config to backup name
   if (os::FileExists(config_file_path_)) {
     ASSERT(os::RenameFile(config_file_path_, config_backup_path_));
   }
-  // 2. write in-memory config to disk, if failed, backup can still be used
-  ASSERT(LegacyConfigFile::FromPath(config_file_path_).Write(pimpl_->cache_));
+  // 2. write in-memory config to disk, if failed, backup can still be used. From here on, the journal does not match
+  // the checksum of the config file and is not replayed if we crash before deleting it
+  ASSERT(os::WriteToFile(config_file_path_, config_content));
   // 3. now write back up to disk as well
-  ASSERT(LegacyConfigFile::FromPath(config_backup_path_).Write(pimpl_->cache_));
-  // 4. save checksum if it is running in common criteria mode
+  ASSERT(os::WriteToFile(config_backup_path_, config_content));
+  // 4. config and backup now hold every change in the journal, start over with an empty one
+  if (os::FileExists(config_journal_path_)) {
+    ASSERT(ConfigJournal::FromPath(config_journal_path_).Delete());
+  }
+  pimpl_->config_checksum_ = ConfigJournal::Checksum(config_content);
+  pimpl_->is_full_save_needed_ = false;
+  // 5. save checksum if it is running in common criteria mode
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
       bluetooth::os::ParameterProvider::IsCommonCriteriaMode()) {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->set_encrypt_key_or_remove_key(
@@ -154,6 +206,7 @@ void StorageModule::Start() {
     LOG_INFO("%s is true, delete config files", kFactoryResetProperty.c_str());
     LegacyConfigFile::FromPath(config_file_path_).Delete();
     LegacyConfigFile::FromPath(config_backup_path_).Delete();
+    ConfigJournal::FromPath(config_journal_path_).Delete();
     os::SetSystemProperty(kFactoryResetProperty, "false");
   }
   if (!is_config_checksum_pass(kConfigFileComparePass)) {
@@ -163,9 +216,11 @@ void StorageModule::Start() {
     LegacyConfigFile::FromPath(config_backup_path_).Delete();
   }
   bool save_needed = false;
+  std::string loaded_config_path = config_file_path_;
   auto config = LegacyConfigFile::FromPath(config_file_path_).Read(temp_devices_capacity_);
   if (!config || !config->HasSection(kAdapterSection)) {
     LOG_WARN("cannot load config at %s, using backup at %s.", config_file_path_.c_str(), config_backup_path_.c_str());
+    loaded_config_path = config_backup_path_;
     config = LegacyConfigFile::FromPath(config_backup_path_).Read(temp_devices_capacity_);
     file_source = "Backup";
     // Make sure to update the file, since it wasn't read from the config_file_path_
@@ -176,6 +231,27 @@ void StorageModule::Start() {
     config.emplace(temp_devices_capacity_, Device::kLinkKeyProperties);
     file_source = "Empty";
   }
+  // The checksum that protects the config files in common criteria mode does not cover the journal, so always save
+  // the full config in that mode
+  bool use_journal = bluetooth::os::ParameterProvider::GetBtKeystoreInterface() == nullptr ||
+                     !bluetooth::os::ParameterProvider::IsCommonCriteriaMode();
+  uint32_t config_checksum = 0;
+  if (file_source != "Empty") {
+    auto config_content = os::ReadSmallFile(loaded_config_path);
+    config_checksum = ConfigJournal::Checksum(config_content.value_or(""));
+  }
+  if (os::FileExists(config_journal_path_)) {
+    // Changes in the journal only make sense on top of the config they were made to
+    if (use_journal && file_source != "Empty") {
+      size_t num_replayed = ConfigJournal::FromPath(config_journal_path_).Replay(*config, config_checksum);
+      LOG_INFO("replayed %zu changes from %s", num_replayed, config_journal_path_.c_str());
+    } else {
+      LOG_WARN("discarding config journal at %s", config_journal_path_.c_str());
+      ConfigJournal::FromPath(config_journal_path_).Delete();
+    }
+    // The journal may end with a partial record, write the full config so that new changes go to a fresh journal
+    save_needed = true;
+  }
   if (!file_source.empty()) {
     config->SetProperty(kInfoSection, kFileSourceProperty, std::move(file_source));
   }
@@ -195,12 +271,23 @@ void StorageModule::Start() {
   config->FixDeviceTypeInconsistencies();
   // TODO (b/158035889) Migrate metrics module to GD
   pimpl_ = std::make_unique<impl>(GetHandler(), std::move(config.value()), temp_devices_capacity_);
+  pimpl_->config_checksum_ = config_checksum;
+  if (use_journal) {
+    pimpl_->journal_.emplace(config_journal_path_);
+  }
   if (save_needed) {
     // Set a timer and write the new config file to disk.
+    pimpl_->is_full_save_needed_ = true;
     SaveDelayed();
   }
   pimpl_->cache_.SetPersistentConfigChangedCallback(
       [this] { this->CallOn(this, &StorageModule::SaveDelayed); });
+  if (pimpl_->journal_) {
+    pimpl_->cache_.SetPersistentMutationCallback([module_impl = pimpl_.get()](const MutationEntry& entry) {
+      std::lock_guard<std::mutex> lock(module_impl->pending_mutations_mutex_);
+      module_impl->pending_mutations_.push_back(entry);
+    });
+  }
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr) {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->ConvertEncryptOrDecryptKeyIfNeeded();
   }
@@ -208,8 +295,8 @@ void StorageModule::Start() {
 
 void StorageModule::Stop() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
-  if (pimpl_->has_pending_config_save_) {
-    // Save pending changes before stopping the module.
+  if (pimpl_->has_pending_config_save_ || os::FileExists(config_journal_path_)) {
+    // Save pending changes and fold the journal into the config file before stopping the module.
     SaveImmediately();
   }
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr) {
@@ -125,15 +125,18 @@ class StorageModule : public bluetooth::Module {
   ConfigCache* GetMemoryOnlyConfigCache();
   // Normally, underlying config will be saved at most 3 seconds after the first config change in a series of changes
   // This method triggers the delayed saving automatically, the delay is equal to |config_save_delay_|
+  // Delayed saves append the changes to the config journal, and only write the full config once the journal grows
+  // too large
   void SaveDelayed();
   // In some cases, one may want to save the config immediately to disk. Call this method with caution as it runs
-  // immediately on the calling thread
+  // immediately on the calling thread. This writes the full config and clears the journal
   void SaveImmediately();
   // remove all content in this config cache, restore it to the state after the explicit constructor
   void Clear();
 
   // Create the storage module where:
-  // - config_file_path is the path to the config file on disk, a .bak file will be created with the original
+  // - config_file_path is the path to the config file on disk, a .bak file will be created with the original and
+  //   changes between full saves are journaled in a .journal file
   // - config_save_delay is the duration after which to dump config to disk after SaveDelayed() is called
   // - temp_devices_capacity is the number of temporary, typically unpaired devices to hold in a memory based LRU
   // - is_restricted_mode and is_single_user_mode are flags from upper layer
@@ -180,11 +183,14 @@ class StorageModule : public bluetooth::Module {
   std::unique_ptr<impl> pimpl_;
   std::string config_file_path_;
   std::string config_backup_path_;
+  std::string config_journal_path_;
   std::chrono::milliseconds config_save_delay_;
   size_t temp_devices_capacity_;
   bool is_restricted_mode_;
   bool is_single_user_mode_;
   static bool is_config_checksum_pass(int check_bit);
+  // Target of the delayed save, appends pending changes to the journal or saves the full config
+  void SaveChanges();
 };
 
 }  // namespace storage
@@ -22,6 +22,7 @@
 #include <chrono>
 #include <cstdio>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <optional>
 #include <thread>
@@ -31,6 +32,7 @@
 #include "os/fake_timer/fake_timerfd.h"
 #include "os/files.h"
 #include "storage/config_cache.h"
+#include "storage/config_journal.h"
 #include "storage/device.h"
 #include "storage/legacy_config_file.h"
 
@@ -40,8 +42,10 @@ using bluetooth::TestModuleRegistry;
 using bluetooth::hci::Address;
 using bluetooth::os::fake_timer::fake_timerfd_advance;
 using bluetooth::storage::ConfigCache;
+using bluetooth::storage::ConfigJournal;
 using bluetooth::storage::Device;
 using bluetooth::storage::LegacyConfigFile;
+using bluetooth::storage::MutationEntry;
 using bluetooth::storage::StorageModule;
 
 static const std::chrono::milliseconds kTestConfigSaveDelay = std::chrono::milliseconds(100);
@@ -99,6 +103,10 @@ class TestStorageModule : public StorageModule {
   void RemoveSectionPublic(const std::string& section) {
     return RemoveSection(section);
   }
+
+  void SaveImmediatelyPublic() {
+    return SaveImmediately();
+  }
 };
 
 class StorageModuleTest : public Test {
@@ -107,9 +115,11 @@ class StorageModuleTest : public Test {
     temp_dir_ = std::filesystem::temp_directory_path();
     temp_config_ = temp_dir_ / "temp_config.txt";
     temp_backup_config_ = temp_dir_ / "temp_config.bak";
+    temp_journal_ = temp_dir_ / "temp_config.journal";
     DeleteConfigFiles();
     ASSERT_FALSE(std::filesystem::exists(temp_config_));
     ASSERT_FALSE(std::filesystem::exists(temp_backup_config_));
+    ASSERT_FALSE(std::filesystem::exists(temp_journal_));
   }
 
   void TearDown() override {
@@ -124,6 +134,19 @@ class StorageModuleTest : public Test {
     if (std::filesystem::exists(temp_backup_config_)) {
       ASSERT_TRUE(std::filesystem::remove(temp_backup_config_));
     }
+    if (std::filesystem::exists(temp_journal_)) {
+      ASSERT_TRUE(std::filesystem::remove(temp_journal_));
+    }
+  }
+
+  // Read the config as the storage module would on start, with the journal applied on top of the config file
+  std::optional<ConfigCache> ReadSavedConfig() {
+    auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+    if (config) {
+      auto config_content = bluetooth::os::ReadSmallFile(temp_config_.string());
+      ConfigJournal::FromPath(temp_journal_.string()).Replay(*config, ConfigJournal::Checksum(*config_content));
+    }
+    return config;
   }
 
   void FakeTimerAdvance(std::chrono::milliseconds time) {
@@ -146,6 +169,7 @@ class StorageModuleTest : public Test {
   std::filesystem::path temp_dir_;
   std::filesystem::path temp_config_;
   std::filesystem::path temp_backup_config_;
+  std::filesystem::path temp_journal_;
 };
 
 TEST_F(StorageModuleTest, empty_config_no_op_test) {
@@ -234,7 +258,7 @@ TEST_F(StorageModuleTest, save_config_test) {
   ASSERT_THAT(storage->GetPropertyPublic("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
   ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
 
-  auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  auto config = ReadSavedConfig();
   ASSERT_TRUE(config);
   ASSERT_THAT(config->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
 
@@ -242,7 +266,7 @@ TEST_F(StorageModuleTest, save_config_test) {
   storage->RemovePropertyPublic("01:02:03:ab:cd:ea", "name");
   ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
   LOG_INFO("After waiting 2");
-  config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  config = ReadSavedConfig();
   ASSERT_TRUE(config);
   ASSERT_FALSE(config->HasProperty("01:02:03:ab:cd:ea", "name"));
 
@@ -250,15 +274,85 @@ TEST_F(StorageModuleTest, save_config_test) {
   storage->RemoveSectionPublic("01:02:03:ab:cd:ea");
   ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
   LOG_INFO("After waiting 3");
-  config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  config = ReadSavedConfig();
   ASSERT_TRUE(config);
   ASSERT_FALSE(config->HasSection("01:02:03:ab:cd:ea"));
 
   // Tear down
   test_registry_.StopAll();
 
-  // Verify states after test
+  // Verify states after test, the journal is folded into the config file on stop
   ASSERT_TRUE(std::filesystem::exists(temp_config_));
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+  config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  ASSERT_TRUE(config);
+  ASSERT_FALSE(config->HasSection("01:02:03:ab:cd:ea"));
+}
+
+TEST_F(StorageModuleTest, journal_replayed_on_start_test) {
+  // Prepare config file and a journal of changes made after it was written
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+  ASSERT_TRUE(ConfigJournal::FromPath(temp_journal_.string())
+                  .Append(
+                      {MutationEntry::Set(MutationEntry::PropertyType::NORMAL, "01:02:03:ab:cd:ea", "name", "foo"),
+                       MutationEntry::Remove(MutationEntry::PropertyType::NORMAL, "Metrics")},
+                      ConfigJournal::Checksum(kReadTestConfig)));
+
+  // Set up
+  auto* storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, false, false);
+  test_registry_.InjectTestModule(&StorageModule::Factory, storage);
+
+  // Test
+  ASSERT_THAT(storage->GetPropertyPublic("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
+  ASSERT_FALSE(storage->HasSectionPublic("Metrics"));
+
+  // Replaying a journal writes the full config
+  ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+  auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  ASSERT_TRUE(config);
+  ASSERT_THAT(config->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
+  ASSERT_FALSE(config->HasSection("Metrics"));
+
+  // Tear down
+  test_registry_.StopAll();
+}
+
+TEST_F(StorageModuleTest, journal_of_previous_config_not_replayed_test) {
+  // Prepare config file
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+
+  // Set up
+  auto* storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, false, false);
+  test_registry_.InjectTestModule(&StorageModule::Factory, storage);
+
+  // Journal a first value, then save a newer one in full
+  storage->SetPropertyPublic("01:02:03:ab:cd:ea", "name", "foo");
+  ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
+  auto journal = bluetooth::os::ReadSmallFile(temp_journal_.string());
+  ASSERT_TRUE(journal);
+  storage->SetPropertyPublic("01:02:03:ab:cd:ea", "name", "bar");
+  storage->SaveImmediatelyPublic();
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+  test_registry_.StopAll();
+
+  // Crash after the config was written but before the journal was deleted
+  {
+    std::ofstream journal_file(temp_journal_, std::ios::binary | std::ios::trunc);
+    journal_file << *journal;
+  }
+
+  // The stale journal must not roll the name back
+  storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, false, false);
+  test_registry_.InjectTestModule(&StorageModule::Factory, storage);
+  ASSERT_THAT(storage->GetPropertyPublic("01:02:03:ab:cd:ea", "name"), Optional(StrEq("bar")));
+
+  // The stale journal is dropped by the next full save
+  ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+
+  // Tear down
+  test_registry_.StopAll();
 }
 
 TEST_F(StorageModuleTest, get_bonded_devices_test) {
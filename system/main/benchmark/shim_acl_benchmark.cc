@@ -0,0 +1,108 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <forward_list>
+#include <memory>
+#include <vector>
+
+#include "main/shim/helpers.h"
+#include "osi/include/allocator.h"
+#include "packet/packet_view.h"
+#include "stack/include/bt_hdr.h"
+
+using ::benchmark::State;
+using ::bluetooth::packet::kLittleEndian;
+using ::bluetooth::packet::PacketView;
+using ::bluetooth::packet::View;
+
+namespace {
+
+// Size of the HCI ACL fragments a PDU is reassembled from
+constexpr size_t kAclFragmentSize = 251;
+
+// An L2CAP PDU of |size| bytes, either in one buffer or reassembled from ACL
+// fragments as done by the GD ACL assembler.
+PacketView<kLittleEndian> MakePdu(size_t size, bool fragmented) {
+  auto bytes = std::make_shared<const std::vector<uint8_t>>(size, 0x5a);
+  if (!fragmented) {
+    return PacketView<kLittleEndian>(bytes);
+  }
+  std::forward_list<View> fragments;
+  auto tail = fragments.before_begin();
+  for (size_t begin = 0; begin < size; begin += kAclFragmentSize) {
+    size_t end = std::min(size, begin + kAclFragmentSize);
+    tail = fragments.insert_after(tail, View(bytes, begin, end));
+  }
+  return PacketView<kLittleEndian>(fragments);
+}
+
+// Previous bridge: the PDU is copied into a temporary vector, then into a
+// zeroed BT_HDR after a preamble held in another vector.
+BT_HDR* MakeLegacyBtHdrPacketCopied(const PacketView<kLittleEndian>& packet,
+                                    uint16_t handle) {
+  uint16_t length = packet.size();
+  std::vector<uint8_t> preamble = {
+      static_cast<uint8_t>(handle), static_cast<uint8_t>(handle >> 8),
+      static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8)};
+  std::vector<uint8_t> packet_vector(packet.begin(), packet.end());
+  BT_HDR* buffer = static_cast<BT_HDR*>(
+      osi_calloc(packet_vector.size() + preamble.size() + sizeof(BT_HDR)));
+  std::copy(preamble.begin(), preamble.end(), buffer->data);
+  std::copy(packet_vector.begin(), packet_vector.end(),
+            buffer->data + preamble.size());
+  buffer->len = preamble.size() + packet_vector.size();
+  return buffer;
+}
+
+BT_HDR* MakeLegacyBtHdrPacketSingleCopy(
+    const PacketView<kLittleEndian>& packet, uint16_t handle) {
+  uint16_t length = packet.size();
+  const uint8_t preamble[] = {
+      static_cast<uint8_t>(handle), static_cast<uint8_t>(handle >> 8),
+      static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8)};
+  return bluetooth::MakeLegacyBtHdrPacket(packet, preamble, sizeof(preamble));
+}
+
+template <BT_HDR* (*Bridge)(const PacketView<kLittleEndian>&, uint16_t)>
+void BM_AclToLegacy(State& state) {
+  PacketView<kLittleEndian> pdu = MakePdu(state.range(0), state.range(1));
+  for (auto _ : state) {
+    BT_HDR* p_buf = Bridge(pdu, 0x0040);
+    ::benchmark::DoNotOptimize(p_buf->data[p_buf->len - 1]);
+    osi_free(p_buf);
+  }
+  state.SetBytesProcessed(state.iterations() * pdu.size());
+}
+
+BENCHMARK_TEMPLATE(BM_AclToLegacy, MakeLegacyBtHdrPacketCopied)
+    ->ArgNames({"size", "fragmented"})
+    ->ArgsProduct({{27, 1021, 4096}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_AclToLegacy, MakeLegacyBtHdrPacketSingleCopy)
+    ->ArgNames({"size", "fragmented"})
+    ->ArgsProduct({{27, 1021, 4096}, {0, 1}});
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -427,12 +427,9 @@ class ShimAclConnection {
   void data_ready_callback() {
     auto packet = queue_up_end_->TryDequeue();
     uint16_t length = packet->size();
-    std::vector<uint8_t> preamble;
-    preamble.push_back(LowByte(handle_));
-    preamble.push_back(HighByte(handle_));
-    preamble.push_back(LowByte(length));
-    preamble.push_back(HighByte(length));
-    BT_HDR* p_buf = MakeLegacyBtHdrPacket(std::move(packet), preamble);
+    const uint8_t preamble[] = {LowByte(handle_), HighByte(handle_),
+                                LowByte(length), HighByte(length)};
+    BT_HDR* p_buf = MakeLegacyBtHdrPacket(*packet, preamble, sizeof(preamble));
     ASSERT_LOG(p_buf != nullptr,
                "Unable to allocate BT_HDR legacy packet handle:%04x", handle_);
     if (send_data_upwards_ == nullptr) {
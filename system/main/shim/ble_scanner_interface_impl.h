@@ -21,6 +21,7 @@
 
 #include <queue>
 #include <set>
+#include <utility>
 
 #include "hci/le_scanning_callback.h"
 #include "include/hardware/ble_scanner.h"
@@ -107,6 +108,8 @@ class BleScannerInterfaceImpl : public ::BleScannerInterface,
                     int8_t tx_power, int8_t rssi,
                     uint16_t periodic_advertising_interval,
                     std::vector<uint8_t> advertising_data) override;
+  void OnScanResults(
+      std::vector<bluetooth::hci::ScanResult> scan_results) override;
   void OnTrackAdvFoundLost(bluetooth::hci::AdvertisingFilterOnFoundOnLostInfo
                                on_found_on_lost_info) override;
   void OnBatchScanReports(int client_if, int status, int report_format,
@@ -146,6 +149,13 @@ class BleScannerInterfaceImpl : public ::BleScannerInterface,
       ApcfCommand apcf_command);
   void handle_remote_properties(RawAddress bd_addr, tBLE_ADDR_TYPE addr_type,
                                 std::vector<uint8_t> advertising_data);
+  void handle_scan_results(
+      std::vector<std::pair<RawAddress, tBLE_ADDR_TYPE>> addresses,
+      std::vector<bluetooth::hci::ScanResult> scan_results);
+  // Resolves the advertiser address of |result| and reports it to the
+  // inquiry. Returns the address and type to report to the upper layers.
+  std::pair<RawAddress, tBLE_ADDR_TYPE> process_scan_result(
+      const bluetooth::hci::ScanResult& result);
 
   class AddressCache {
    public:
@@ -303,7 +303,8 @@ static BT_HDR* WrapPacketAndCopy(
   packet->len = data->size();
   packet->layer_specific = 0;
   packet->event = event;
-  std::copy(data->begin(), data->end(), packet->data);
+  auto it = data->begin();
+  it.CopyTo(packet->data, data->size());
   return packet;
 }
 
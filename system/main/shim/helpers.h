@@ -115,17 +115,21 @@ inline std::unique_ptr<bluetooth::packet::RawBuilder> MakeUniquePacket(
   return payload;
 }
 
+// Copies |preamble| followed by |packet| into a new BT_HDR. The payload is
+// copied once, straight from the fragments of |packet|.
 inline BT_HDR* MakeLegacyBtHdrPacket(
-    std::unique_ptr<bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>>
-        packet,
-    const std::vector<uint8_t>& preamble) {
-  std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
+    const bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>& packet,
+    const uint8_t* preamble, size_t preamble_size) {
+  size_t packet_size = packet.size();
   BT_HDR* buffer = static_cast<BT_HDR*>(
-      osi_calloc(packet_vector.size() + preamble.size() + sizeof(BT_HDR)));
-  std::copy(preamble.begin(), preamble.end(), buffer->data);
-  std::copy(packet_vector.begin(), packet_vector.end(),
-            buffer->data + preamble.size());
-  buffer->len = preamble.size() + packet_vector.size();
+      osi_malloc(sizeof(BT_HDR) + preamble_size + packet_size));
+  buffer->event = 0;
+  buffer->len = preamble_size + packet_size;
+  buffer->offset = 0;
+  buffer->layer_specific = 0;
+  std::copy(preamble, preamble + preamble_size, buffer->data);
+  auto it = packet.begin();
+  it.CopyTo(buffer->data + preamble_size, packet_size);
   return buffer;
 }
 
@@ -507,19 +507,23 @@ void BleScannerInterfaceImpl::OnScanResult(
     uint8_t primary_phy, uint8_t secondary_phy, uint8_t advertising_sid,
     int8_t tx_power, int8_t rssi, uint16_t periodic_advertising_interval,
     std::vector<uint8_t> advertising_data) {
-  RawAddress raw_address = ToRawAddress(address);
-  tBLE_ADDR_TYPE ble_addr_type = to_ble_addr_type(address_type);
-
-  btm_cb.neighbor.le_scan.results++;
-  if (ble_addr_type != BLE_ADDR_ANONYMOUS) {
-    btm_ble_process_adv_addr(raw_address, &ble_addr_type);
-  }
+  bluetooth::hci::ScanResult result{event_type,
+                                    address_type,
+                                    address,
+                                    primary_phy,
+                                    secondary_phy,
+                                    advertising_sid,
+                                    tx_power,
+                                    rssi,
+                                    periodic_advertising_interval,
+                                    std::move(advertising_data)};
+  auto [raw_address, ble_addr_type] = process_scan_result(result);
 
   do_in_jni_thread(
       FROM_HERE,
       base::BindOnce(&BleScannerInterfaceImpl::handle_remote_properties,
                      base::Unretained(this), raw_address, ble_addr_type,
-                     advertising_data));
+                     result.advertising_data));
 
   do_in_jni_thread(
       FROM_HERE,
@@ -527,13 +531,60 @@ void BleScannerInterfaceImpl::OnScanResult(
                      base::Unretained(scanning_callbacks_), event_type,
                      static_cast<uint8_t>(address_type), raw_address,
                      primary_phy, secondary_phy, advertising_sid, tx_power,
-                     rssi, periodic_advertising_interval, advertising_data));
+                     rssi, periodic_advertising_interval,
+                     std::move(result.advertising_data)));
+}
+
+void BleScannerInterfaceImpl::OnScanResults(
+    std::vector<bluetooth::hci::ScanResult> scan_results) {
+  std::vector<std::pair<RawAddress, tBLE_ADDR_TYPE>> addresses;
+  addresses.reserve(scan_results.size());
+  for (const auto& result : scan_results) {
+    addresses.push_back(process_scan_result(result));
+  }
+
+  // Hand the whole batch over to the JNI thread at once
+  do_in_jni_thread(
+      FROM_HERE,
+      base::BindOnce(&BleScannerInterfaceImpl::handle_scan_results,
+                     base::Unretained(this), std::move(addresses),
+                     std::move(scan_results)));
+}
+
+std::pair<RawAddress, tBLE_ADDR_TYPE>
+BleScannerInterfaceImpl::process_scan_result(
+    const bluetooth::hci::ScanResult& result) {
+  RawAddress raw_address = ToRawAddress(result.address);
+  tBLE_ADDR_TYPE ble_addr_type = to_ble_addr_type(result.address_type);
+
+  btm_cb.neighbor.le_scan.results++;
+  if (ble_addr_type != BLE_ADDR_ANONYMOUS) {
+    btm_ble_process_adv_addr(raw_address, &ble_addr_type);
+  }
 
   // TODO: Remove when StartInquiry in GD part implemented
   btm_ble_process_adv_pkt_cont_for_inquiry(
-      event_type, ble_addr_type, raw_address, primary_phy, secondary_phy,
-      advertising_sid, tx_power, rssi, periodic_advertising_interval,
-      advertising_data);
+      result.event_type, ble_addr_type, raw_address, result.primary_phy,
+      result.secondary_phy, result.advertising_sid, result.tx_power,
+      result.rssi, result.periodic_advertising_interval,
+      result.advertising_data);
+
+  return {raw_address, ble_addr_type};
+}
+
+void BleScannerInterfaceImpl::handle_scan_results(
+    std::vector<std::pair<RawAddress, tBLE_ADDR_TYPE>> addresses,
+    std::vector<bluetooth::hci::ScanResult> scan_results) {
+  for (size_t i = 0; i < scan_results.size(); i++) {
+    const auto& result = scan_results[i];
+    handle_remote_properties(addresses[i].first, addresses[i].second,
+                             result.advertising_data);
+    scanning_callbacks_->OnScanResult(
+        result.event_type, result.address_type, addresses[i].first,
+        result.primary_phy, result.secondary_phy, result.advertising_sid,
+        result.tx_power, result.rssi, result.periodic_advertising_interval,
+        result.advertising_data);
+  }
 }
 
 void BleScannerInterfaceImpl::OnTrackAdvFoundLost(
@@ -508,6 +508,24 @@ TEST_F(MainShimTest, helpers) {
   } while (++reason != 0);
 }
 
+TEST_F(MainShimTest, MakeLegacyBtHdrPacket_fragmented) {
+  std::vector<uint8_t> payload(300);
+  for (size_t i = 0; i < payload.size(); i++) payload[i] = i;
+  auto bytes = std::make_shared<const std::vector<uint8_t>>(payload);
+  packet::PacketView<packet::kLittleEndian> packet(
+      {packet::View(bytes, 0, 100), packet::View(bytes, 100, payload.size())});
+  ASSERT_FALSE(packet.IsContiguous());
+
+  const uint8_t preamble[] = {0x01, 0x02, 0x03, 0x04};
+  BT_HDR* p_buf = MakeLegacyBtHdrPacket(packet, preamble, sizeof(preamble));
+  ASSERT_EQ(p_buf->len, sizeof(preamble) + payload.size());
+  ASSERT_EQ(p_buf->offset, 0);
+  ASSERT_EQ(0, memcmp(p_buf->data, preamble, sizeof(preamble)));
+  ASSERT_EQ(0, memcmp(p_buf->data + sizeof(preamble), payload.data(),
+                      payload.size()));
+  osi_free(p_buf);
+}
+
 TEST_F(MainShimTest, connect_and_disconnect) {
   hci::Address address({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
 
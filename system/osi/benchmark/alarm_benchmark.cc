@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <hardware/bluetooth.h>
+
+#include <string>
+#include <vector>
+
+#include "common/message_loop_thread.h"
+#include "osi/include/alarm.h"
+#include "osi/include/osi.h"
+#include "osi/include/wakelock.h"
+#include "osi/semaphore.h"
+
+using ::benchmark::State;
+
+// Outstanding alarms are scheduled far enough in the future that they never
+// fire while a benchmark is running.
+static const uint64_t OUTSTANDING_ALARM_INTERVAL_MS = 60 * 60 * 1000;
+
+bluetooth::common::MessageLoopThread* get_main_thread() { return nullptr; }
+
+static int acquire_wake_lock_cb(const char* lock_name) {
+  return BT_STATUS_SUCCESS;
+}
+
+static int release_wake_lock_cb(const char* lock_name) {
+  return BT_STATUS_SUCCESS;
+}
+
+static bt_os_callouts_t bt_wakelock_callouts = {
+    sizeof(bt_os_callouts_t), NULL, acquire_wake_lock_cb, release_wake_lock_cb};
+
+static void noop_cb(UNUSED_ATTR void* data) {}
+
+static void post_cb(void* data) {
+  semaphore_post(static_cast<semaphore_t*>(data));
+}
+
+class BM_OsiAlarm : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    wakelock_set_os_callouts(&bt_wakelock_callouts);
+    alarm_set_queue_backend(static_cast<alarm_queue_backend_t>(st.range(0)));
+
+    // Spread the outstanding deadlines so that the queue is not degenerate.
+    size_t outstanding = static_cast<size_t>(st.range(1));
+    for (size_t i = 0; i < outstanding; i++) {
+      alarm_t* alarm = alarm_new("alarm_benchmark.outstanding");
+      alarm_set(alarm, OUTSTANDING_ALARM_INTERVAL_MS + (i * 7919) % 100000,
+                noop_cb, nullptr);
+      outstanding_.push_back(alarm);
+    }
+    st.SetLabel(st.range(0) == ALARM_QUEUE_HEAP ? "heap" : "sorted_list");
+  }
+
+  void TearDown(State& st) override {
+    for (alarm_t* alarm : outstanding_) alarm_free(alarm);
+    outstanding_.clear();
+    alarm_cleanup();
+    wakelock_cleanup();
+    wakelock_set_os_callouts(NULL);
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<alarm_t*> outstanding_;
+};
+
+BENCHMARK_DEFINE_F(BM_OsiAlarm, set_cancel)(State& state) {
+  alarm_t* alarm = alarm_new("alarm_benchmark.set_cancel");
+  uint64_t interval_ms = OUTSTANDING_ALARM_INTERVAL_MS / 2;
+  for (auto _ : state) {
+    alarm_set(alarm, interval_ms, noop_cb, nullptr);
+    alarm_cancel(alarm);
+  }
+  alarm_free(alarm);
+}
+
+BENCHMARK_DEFINE_F(BM_OsiAlarm, reschedule)(State& state) {
+  alarm_t* alarm = alarm_new("alarm_benchmark.reschedule");
+  uint64_t interval_ms = OUTSTANDING_ALARM_INTERVAL_MS / 2;
+  for (auto _ : state) {
+    // Re-arming a pending alarm removes it from the queue and re-inserts it.
+    alarm_set(alarm, interval_ms, noop_cb, nullptr);
+  }
+  alarm_free(alarm);
+}
+
+BENCHMARK_DEFINE_F(BM_OsiAlarm, fire)(State& state) {
+  semaphore_t* fired = semaphore_new(0);
+  alarm_t* alarm = alarm_new("alarm_benchmark.fire");
+  for (auto _ : state) {
+    alarm_set(alarm, 0, post_cb, fired);
+    semaphore_wait(fired);
+  }
+  alarm_free(alarm);
+  semaphore_free(fired);
+}
+
+static void OsiAlarmArguments(::benchmark::internal::Benchmark* b) {
+  for (int backend : {ALARM_QUEUE_SORTED_LIST, ALARM_QUEUE_HEAP}) {
+    for (int outstanding : {10, 1000, 100000}) {
+      b->Args({backend, outstanding});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(BM_OsiAlarm, set_cancel)->Apply(OsiAlarmArguments);
+BENCHMARK_REGISTER_F(BM_OsiAlarm, reschedule)->Apply(OsiAlarmArguments);
+BENCHMARK_REGISTER_F(BM_OsiAlarm, fire)
+    ->Apply(OsiAlarmArguments)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
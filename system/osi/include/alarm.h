@@ -28,6 +28,19 @@ typedef struct thread_t thread_t;
 // Prototype for the alarm callback function.
 typedef void (*alarm_callback_t)(void* data);
 
+// Data structure used to keep the pending alarms ordered by deadline.
+typedef enum {
+  // Sorted linked list: O(n) |alarm_set| and |alarm_cancel|.
+  ALARM_QUEUE_SORTED_LIST,
+  // Indexed 4-ary min-heap: O(log n) |alarm_set| and |alarm_cancel|.
+  ALARM_QUEUE_HEAP,
+} alarm_queue_backend_t;
+
+// Selects the |backend| used to order pending alarms. The default is
+// |ALARM_QUEUE_HEAP|. This function must be called before the first alarm is
+// created, or after |alarm_cleanup|.
+void alarm_set_queue_backend(alarm_queue_backend_t backend);
+
 // Creates a new one-time off alarm object with user-assigned
 // |name|. |name| may not be NULL, and a copy of the string will
 // be stored internally. The value of |name| has no semantic
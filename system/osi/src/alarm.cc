@@ -35,7 +35,9 @@
 
 #include <hardware/bluetooth.h>
 
+#include <algorithm>
 #include <mutex>
+#include <vector>
 
 #include "check.h"
 #include "osi/include/allocator.h"
@@ -104,6 +106,9 @@ struct alarm_t {
 
   bool for_msg_loop;  // True, if the alarm should be processed on message loop
   CancelableClosureInStruct closure;  // posted to message loop for processing
+
+  size_t heap_index;  // 1-based slot in |alarm_heap|, 0 if not in the heap
+  uint64_t sequence;  // Insertion order, breaks ties between equal deadlines
 };
 
 // If the next wakeup time is less than this threshold, we should acquire
@@ -113,11 +118,19 @@ struct alarm_t {
 int64_t TIMER_INTERVAL_FOR_WAKELOCK_IN_MS = 3000;
 static const clockid_t CLOCK_ID = CLOCK_BOOTTIME;
 
+// Number of children per node of the pending alarm heap. A 4-ary heap is
+// shallower than a binary one and keeps siblings in the same cache line.
+static const size_t ALARM_HEAP_ARITY = 4;
+
 // This mutex ensures that the |alarm_set|, |alarm_cancel|, and alarm callback
 // functions execute serially and not concurrently. As a result, this mutex
-// also protects the |alarms| list.
+// also protects the |alarms| list and the |alarm_heap|.
 static std::mutex alarms_mutex;
-static list_t* alarms;
+static bool alarms_initialized;
+static alarm_queue_backend_t alarm_backend = ALARM_QUEUE_HEAP;
+static list_t* alarms;                  // Pending alarms for the list backend
+static std::vector<alarm_t*> alarm_heap;  // Pending alarms for the heap backend
+static uint64_t alarm_sequence;
 static timer_t timer;
 static timer_t wakeup_timer;
 static bool timer_set;
@@ -139,6 +152,11 @@ static void alarm_set_internal(alarm_t* alarm, uint64_t period_ms,
                                fixed_queue_t* queue, bool for_msg_loop);
 static void alarm_cancel_internal(alarm_t* alarm);
 static void remove_pending_alarm(alarm_t* alarm);
+static bool pending_alarms_empty(void);
+static alarm_t* pending_alarms_front(void);
+static void pending_alarms_insert(alarm_t* alarm);
+static void pending_alarms_remove(alarm_t* alarm);
+static size_t pending_alarms_size(void);
 static void schedule_next_instance(alarm_t* alarm);
 static void reschedule_root_alarm(void);
 static void alarm_queue_ready(fixed_queue_t* queue, void* context);
@@ -165,8 +183,8 @@ alarm_t* alarm_new_periodic(const char* name) {
 }
 
 static alarm_t* alarm_new_internal(const char* name, bool is_periodic) {
-  // Make sure we have a list we can insert alarms into.
-  if (!alarms && !lazy_initialize()) {
+  // Make sure we have a queue we can insert alarms into.
+  if (!alarms_initialized && !lazy_initialize()) {
     CHECK(false);  // if initialization failed, we should not continue
     return NULL;
   }
@@ -210,6 +228,12 @@ uint64_t alarm_get_remaining_ms(const alarm_t* alarm) {
   return remaining_ms;
 }
 
+void alarm_set_queue_backend(alarm_queue_backend_t backend) {
+  std::lock_guard<std::mutex> lock(alarms_mutex);
+  CHECK(!alarms_initialized);
+  alarm_backend = backend;
+}
+
 void alarm_set(alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
                void* data) {
   alarm_set_internal(alarm, interval_ms, cb, data, default_callback_queue,
@@ -225,7 +249,7 @@ void alarm_set_on_mloop(alarm_t* alarm, uint64_t interval_ms,
 static void alarm_set_internal(alarm_t* alarm, uint64_t period_ms,
                                alarm_callback_t cb, void* data,
                                fixed_queue_t* queue, bool for_msg_loop) {
-  CHECK(alarms != NULL);
+  CHECK(alarms_initialized);
   CHECK(alarm != NULL);
   CHECK(cb != NULL);
 
@@ -243,7 +267,7 @@ static void alarm_set_internal(alarm_t* alarm, uint64_t period_ms,
 }
 
 void alarm_cancel(alarm_t* alarm) {
-  CHECK(alarms != NULL);
+  CHECK(alarms_initialized);
   if (!alarm) return;
 
   std::shared_ptr<std::recursive_mutex> local_mutex_ref;
@@ -260,8 +284,7 @@ void alarm_cancel(alarm_t* alarm) {
 // Internal implementation of canceling an alarm.
 // The caller must hold the |alarms_mutex|
 static void alarm_cancel_internal(alarm_t* alarm) {
-  bool needs_reschedule =
-      (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (pending_alarms_front() == alarm);
 
   remove_pending_alarm(alarm);
 
@@ -276,13 +299,13 @@ static void alarm_cancel_internal(alarm_t* alarm) {
 }
 
 bool alarm_is_scheduled(const alarm_t* alarm) {
-  if ((alarms == NULL) || (alarm == NULL)) return false;
+  if (!alarms_initialized || (alarm == NULL)) return false;
   return (alarm->callback != NULL);
 }
 
 void alarm_cleanup(void) {
   // If lazy_initialize never ran there is nothing else to do
-  if (!alarms) return;
+  if (!alarms_initialized) return;
 
   dispatcher_thread_active = false;
   semaphore_post(alarm_expired);
@@ -303,10 +326,13 @@ void alarm_cleanup(void) {
 
   list_free(alarms);
   alarms = NULL;
+  alarm_heap.clear();
+  alarm_heap.shrink_to_fit();
+  alarms_initialized = false;
 }
 
 static bool lazy_initialize(void) {
-  CHECK(alarms == NULL);
+  CHECK(!alarms_initialized);
 
   // timer_t doesn't have an invalid value so we must track whether
   // the |timer| variable is valid ourselves.
@@ -315,10 +341,12 @@ static bool lazy_initialize(void) {
 
   std::lock_guard<std::mutex> lock(alarms_mutex);
 
-  alarms = list_new(NULL);
-  if (!alarms) {
-    LOG_ERROR("%s unable to allocate alarm list.", __func__);
-    goto error;
+  if (alarm_backend == ALARM_QUEUE_SORTED_LIST) {
+    alarms = list_new(NULL);
+    if (!alarms) {
+      LOG_ERROR("%s unable to allocate alarm list.", __func__);
+      goto error;
+    }
   }
 
   if (!timer_create_internal(CLOCK_ID, &timer)) goto error;
@@ -360,6 +388,7 @@ static bool lazy_initialize(void) {
   }
   thread_set_rt_priority(dispatcher_thread, THREAD_RT_PRIORITY);
   thread_post(dispatcher_thread, callback_dispatch, NULL);
+  alarms_initialized = true;
   return true;
 
 error:
@@ -387,7 +416,7 @@ error:
 }
 
 static uint64_t now_ms(void) {
-  CHECK(alarms != NULL);
+  CHECK(alarms_initialized);
 
   struct timespec ts;
   if (clock_gettime(CLOCK_ID, &ts) == -1) {
@@ -401,7 +430,7 @@ static uint64_t now_ms(void) {
 // Remove alarm from internal alarm list and the processing queue
 // The caller must hold the |alarms_mutex|
 static void remove_pending_alarm(alarm_t* alarm) {
-  list_remove(alarms, alarm);
+  pending_alarms_remove(alarm);
 
   if (alarm->for_msg_loop) {
     alarm->closure.i.Cancel();
@@ -418,8 +447,7 @@ static void remove_pending_alarm(alarm_t* alarm) {
 static void schedule_next_instance(alarm_t* alarm) {
   // If the alarm is currently set and it's at the start of the list,
   // we'll need to re-schedule since we've adjusted the earliest deadline.
-  bool needs_reschedule =
-      (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (pending_alarms_front() == alarm);
   if (alarm->callback) remove_pending_alarm(alarm);
 
   // Calculate the next deadline for this alarm
@@ -430,33 +458,130 @@ static void schedule_next_instance(alarm_t* alarm) {
         ((just_now_ms - alarm->creation_time_ms) % alarm->period_ms);
   alarm->deadline_ms = just_now_ms + (alarm->period_ms - ms_into_period);
 
-  // Add it into the timer list sorted by deadline (earliest deadline first).
+  // Add it into the pending alarms ordered by deadline (earliest first).
+  pending_alarms_insert(alarm);
+
+  // If the new alarm has the earliest deadline, we need to re-evaluate our
+  // schedule.
+  if (needs_reschedule || pending_alarms_front() == alarm) {
+    reschedule_root_alarm();
+  }
+}
+
+// Returns true if |a| must fire before |b|. Alarms with the same deadline
+// fire in the order they were scheduled.
+static bool alarm_fires_before(const alarm_t* a, const alarm_t* b) {
+  if (a->deadline_ms != b->deadline_ms) return a->deadline_ms < b->deadline_ms;
+  return a->sequence < b->sequence;
+}
+
+static void heap_place(size_t index, alarm_t* alarm) {
+  alarm_heap[index] = alarm;
+  alarm->heap_index = index + 1;
+}
+
+static void heap_sift_up(size_t index) {
+  alarm_t* alarm = alarm_heap[index];
+  while (index > 0) {
+    size_t parent = (index - 1) / ALARM_HEAP_ARITY;
+    if (!alarm_fires_before(alarm, alarm_heap[parent])) break;
+    heap_place(index, alarm_heap[parent]);
+    index = parent;
+  }
+  heap_place(index, alarm);
+}
+
+static void heap_sift_down(size_t index) {
+  alarm_t* alarm = alarm_heap[index];
+  const size_t size = alarm_heap.size();
+  while (true) {
+    size_t first_child = index * ALARM_HEAP_ARITY + 1;
+    if (first_child >= size) break;
+    size_t last_child = std::min(first_child + ALARM_HEAP_ARITY, size);
+    size_t earliest = first_child;
+    for (size_t child = first_child + 1; child < last_child; child++) {
+      if (alarm_fires_before(alarm_heap[child], alarm_heap[earliest]))
+        earliest = child;
+    }
+    if (!alarm_fires_before(alarm_heap[earliest], alarm)) break;
+    heap_place(index, alarm_heap[earliest]);
+    index = earliest;
+  }
+  heap_place(index, alarm);
+}
+
+// NOTE: the pending_alarms_* functions must be called with |alarms_mutex| held
+static bool pending_alarms_empty(void) {
+  if (alarm_backend == ALARM_QUEUE_HEAP) return alarm_heap.empty();
+  return list_is_empty(alarms);
+}
+
+static alarm_t* pending_alarms_front(void) {
+  if (pending_alarms_empty()) return NULL;
+  if (alarm_backend == ALARM_QUEUE_HEAP) return alarm_heap.front();
+  return static_cast<alarm_t*>(list_front(alarms));
+}
+
+static size_t pending_alarms_size(void) {
+  if (alarm_backend == ALARM_QUEUE_HEAP) return alarm_heap.size();
+  return list_length(alarms);
+}
+
+static void pending_alarms_insert(alarm_t* alarm) {
+  alarm->sequence = alarm_sequence++;
+
+  if (alarm_backend == ALARM_QUEUE_HEAP) {
+    alarm_heap.push_back(alarm);
+    heap_sift_up(alarm_heap.size() - 1);
+    return;
+  }
+
   if (list_is_empty(alarms) ||
       ((alarm_t*)list_front(alarms))->deadline_ms > alarm->deadline_ms) {
     list_prepend(alarms, alarm);
-  } else {
-    for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
-         node = list_next(node)) {
-      list_node_t* next = list_next(node);
-      if (next == list_end(alarms) ||
-          ((alarm_t*)list_node(next))->deadline_ms > alarm->deadline_ms) {
-        list_insert_after(alarms, node, alarm);
-        break;
-      }
+    return;
+  }
+  for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
+       node = list_next(node)) {
+    list_node_t* next = list_next(node);
+    if (next == list_end(alarms) ||
+        ((alarm_t*)list_node(next))->deadline_ms > alarm->deadline_ms) {
+      list_insert_after(alarms, node, alarm);
+      break;
     }
   }
+}
 
-  // If the new alarm has the earliest deadline, we need to re-evaluate our
-  // schedule.
-  if (needs_reschedule ||
-      (!list_is_empty(alarms) && list_front(alarms) == alarm)) {
-    reschedule_root_alarm();
+static void pending_alarms_remove(alarm_t* alarm) {
+  if (alarm_backend != ALARM_QUEUE_HEAP) {
+    list_remove(alarms, alarm);
+    return;
+  }
+
+  if (alarm->heap_index == 0) return;  // Not pending
+
+  size_t index = alarm->heap_index - 1;
+  alarm->heap_index = 0;
+  // The heap is dropped by |alarm_cleanup|, leaving stale indexes behind.
+  if (index >= alarm_heap.size() || alarm_heap[index] != alarm) return;
+
+  alarm_t* last = alarm_heap.back();
+  alarm_heap.pop_back();
+  if (index == alarm_heap.size()) return;
+
+  // Move the last alarm into the vacated slot and restore the heap order.
+  heap_place(index, last);
+  if (index > 0 &&
+      alarm_fires_before(last, alarm_heap[(index - 1) / ALARM_HEAP_ARITY])) {
+    heap_sift_up(index);
+  } else {
+    heap_sift_down(index);
   }
 }
 
 // NOTE: must be called with |alarms_mutex| held
 static void reschedule_root_alarm(void) {
-  CHECK(alarms != NULL);
+  CHECK(alarms_initialized);
 
   const bool timer_was_set = timer_set;
   alarm_t* next;
@@ -466,9 +591,9 @@ static void reschedule_root_alarm(void) {
   struct itimerspec timer_time;
   memset(&timer_time, 0, sizeof(timer_time));
 
-  if (list_is_empty(alarms)) goto done;
+  if (pending_alarms_empty()) goto done;
 
-  next = static_cast<alarm_t*>(list_front(alarms));
+  next = pending_alarms_front();
   next_expiration = next->deadline_ms - now_ms();
   if (next_expiration < TIMER_INTERVAL_FOR_WAKELOCK_IN_MS) {
     if (!timer_set) {
@@ -628,14 +753,13 @@ static void callback_dispatch(UNUSED_ATTR void* context) {
     // Take into account that the alarm may get cancelled before we get to it.
     // We're done here if there are no alarms or the alarm at the front is in
     // the future. Exit right away since there's nothing left to do.
-    if (list_is_empty(alarms) ||
-        (alarm = static_cast<alarm_t*>(list_front(alarms)))->deadline_ms >
-            now_ms()) {
+    if (pending_alarms_empty() ||
+        (alarm = pending_alarms_front())->deadline_ms > now_ms()) {
       reschedule_root_alarm();
       continue;
     }
 
-    list_remove(alarms, alarm);
+    pending_alarms_remove(alarm);
 
     if (alarm->is_periodic) {
       alarm->prev_deadline_ms = alarm->deadline_ms;
@@ -727,19 +851,31 @@ void alarm_debug_dump(int fd) {
 
   std::lock_guard<std::mutex> lock(alarms_mutex);
 
-  if (alarms == NULL) {
+  if (!alarms_initialized) {
     dprintf(fd, "  None\n");
     return;
   }
 
   uint64_t just_now_ms = now_ms();
 
-  dprintf(fd, "  Total Alarms: %zu\n\n", list_length(alarms));
+  dprintf(fd, "  Queue backend: %s\n",
+          (alarm_backend == ALARM_QUEUE_HEAP) ? "HEAP" : "SORTED_LIST");
+  dprintf(fd, "  Total Alarms: %zu\n\n", pending_alarms_size());
+
+  // The heap is only partially ordered, so sort a snapshot for the dump.
+  std::vector<alarm_t*> pending;
+  if (alarm_backend == ALARM_QUEUE_HEAP) {
+    pending = alarm_heap;
+    std::sort(pending.begin(), pending.end(), alarm_fires_before);
+  } else {
+    for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
+         node = list_next(node)) {
+      pending.push_back((alarm_t*)list_node(node));
+    }
+  }
 
   // Dump info for each alarm
-  for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
-       node = list_next(node)) {
-    alarm_t* alarm = (alarm_t*)list_node(node);
+  for (alarm_t* alarm : pending) {
     alarm_stats_t* stats = &alarm->stats;
 
     dprintf(fd, "  Alarm : %s (%s)\n", stats->name,
@@ -56,6 +56,7 @@ class AlarmTest : public AlarmTestHarness {
   void TearDown() override {
     semaphore_free(semaphore);
     AlarmTestHarness::TearDown();
+    alarm_set_queue_backend(ALARM_QUEUE_HEAP);
   }
 };
 
@@ -296,6 +297,67 @@ TEST_F(AlarmTest, test_callback_ordering) {
   EXPECT_FALSE(WakeLockHeld());
 }
 
+// Test whether the callbacks are invoked in the expected order when the
+// pending alarms are kept in the legacy sorted list.
+TEST_F(AlarmTest, test_callback_ordering_sorted_list) {
+  alarm_set_queue_backend(ALARM_QUEUE_SORTED_LIST);
+  alarm_t* alarms[100];
+
+  for (int i = 0; i < 100; i++) {
+    const std::string alarm_name =
+        "alarm_test.test_callback_ordering_sorted_list[" + std::to_string(i) +
+        "]";
+    alarms[i] = alarm_new(alarm_name.c_str());
+  }
+
+  for (int i = 0; i < 100; i++) {
+    alarm_set(alarms[i], 100, ordered_cb, INT_TO_PTR(i));
+  }
+
+  for (int i = 1; i <= 100; i++) {
+    semaphore_wait(semaphore);
+    EXPECT_GE(cb_counter, i);
+  }
+  EXPECT_EQ(cb_counter, 100);
+  EXPECT_EQ(cb_misordered_counter, 0);
+
+  for (int i = 0; i < 100; i++) alarm_free(alarms[i]);
+
+  EXPECT_FALSE(WakeLockHeld());
+}
+
+// Test that cancelling alarms from the middle of the pending set keeps the
+// remaining alarms firing in deadline order.
+TEST_F(AlarmTest, test_cancel_interleaved_ordering) {
+  alarm_t* alarms[100];
+
+  for (int i = 0; i < 100; i++) {
+    const std::string alarm_name =
+        "alarm_test.test_cancel_interleaved_ordering[" + std::to_string(i) +
+        "]";
+    alarms[i] = alarm_new(alarm_name.c_str());
+  }
+
+  // Schedule in reverse deadline order to exercise out-of-order insertion.
+  for (int i = 99; i >= 0; i--) {
+    alarm_set(alarms[i], 100 + (i / 2) * 10, ordered_cb, INT_TO_PTR(i / 2));
+  }
+  for (int i = 1; i < 100; i += 2) {
+    alarm_cancel(alarms[i]);
+    EXPECT_FALSE(alarm_is_scheduled(alarms[i]));
+  }
+
+  for (int i = 1; i <= 50; i++) {
+    semaphore_wait(semaphore);
+  }
+  EXPECT_EQ(cb_counter, 50);
+  EXPECT_EQ(cb_misordered_counter, 0);
+
+  for (int i = 0; i < 100; i++) alarm_free(alarms[i]);
+
+  EXPECT_FALSE(WakeLockHeld());
+}
+
 // Test whether the callbacks are involed in the expected order on a
 // message loop.
 TEST_F(AlarmTest, test_callback_ordering_on_mloop) {
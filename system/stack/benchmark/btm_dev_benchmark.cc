@@ -0,0 +1,129 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "btif/include/btif_hh.h"
+#include "hci/include/hci_layer.h"
+#include "osi/include/allocator.h"
+#include "osi/include/list.h"
+#include "stack/btm/btm_dev.h"
+#include "stack/btm/btm_int_types.h"
+#include "stack/btm/btm_sec.h"
+#include "stack/include/hcidefs.h"
+#include "stack/l2cap/l2c_int.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+extern tBTM_CB btm_cb;
+
+uint8_t btif_trace_level = BT_TRACE_LEVEL_NONE;
+uint8_t appl_trace_level = BT_TRACE_LEVEL_NONE;
+btif_hh_cb_t btif_hh_cb;
+tL2C_CB l2cb;
+
+const hci_t* hci_layer_get_interface() { return nullptr; }
+
+// Predicate used by the list scan in btm_find_dev(), for the baseline
+bool is_address_equal(void* data, void* context);
+
+namespace {
+
+// Bonded records are restored from storage without going through the
+// allocator cap, so the list is populated directly to simulate large
+// databases.
+class BM_BtmDev : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    btm_cb.Init(BTM_SEC_MODE_SC);
+    for (int i = 0; i < st.range(0); i++) {
+      tBTM_SEC_DEV_REC* p_dev_rec =
+          static_cast<tBTM_SEC_DEV_REC*>(osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
+      // Public addresses so the lookup never attempts RPA resolution
+      p_dev_rec->bd_addr = RawAddress({0x00, 0x11, 0x22, 0x33,
+                                       static_cast<uint8_t>(i >> 8),
+                                       static_cast<uint8_t>(i)});
+      p_dev_rec->hci_handle = static_cast<uint16_t>(2 * i);
+      p_dev_rec->ble_hci_handle = static_cast<uint16_t>(2 * i + 1);
+      p_dev_rec->sec_flags = BTM_SEC_IN_USE | BTM_SEC_LINK_KEY_KNOWN;
+      list_append(btm_cb.sec_dev_rec, p_dev_rec);
+      addresses_.push_back(p_dev_rec->bd_addr);
+    }
+  }
+
+  void TearDown(State& st) override {
+    addresses_.clear();
+    btm_cb.Free();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<RawAddress> addresses_;
+};
+
+BENCHMARK_DEFINE_F(BM_BtmDev, find_dev_linear_scan)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(list_foreach(
+        btm_cb.sec_dev_rec, is_address_equal, &addresses_[i]));
+    i = (i + 1) % addresses_.size();
+  }
+}
+
+BENCHMARK_DEFINE_F(BM_BtmDev, find_dev)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(btm_find_dev(addresses_[i]));
+    i = (i + 1) % addresses_.size();
+  }
+}
+
+BENCHMARK_DEFINE_F(BM_BtmDev, find_dev_by_handle)(State& state) {
+  uint16_t handle = 0;
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(btm_find_dev_by_handle(handle));
+    handle = (handle + 1) % (2 * addresses_.size());
+  }
+}
+
+BENCHMARK_DEFINE_F(BM_BtmDev, find_dev_unknown)(State& state) {
+  const RawAddress unknown({0x00, 0x11, 0x22, 0xff, 0xff, 0xff});
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(btm_find_dev(unknown));
+  }
+}
+
+void BtmDevArguments(::benchmark::internal::Benchmark* b) {
+  b->ArgName("records")->Arg(10)->Arg(100)->Arg(500);
+}
+
+BENCHMARK_REGISTER_F(BM_BtmDev, find_dev_linear_scan)->Apply(BtmDevArguments);
+BENCHMARK_REGISTER_F(BM_BtmDev, find_dev)->Apply(BtmDevArguments);
+BENCHMARK_REGISTER_F(BM_BtmDev, find_dev_by_handle)->Apply(BtmDevArguments);
+BENCHMARK_REGISTER_F(BM_BtmDev, find_dev_unknown)->Apply(BtmDevArguments);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
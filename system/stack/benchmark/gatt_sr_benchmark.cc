@@ -0,0 +1,134 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <list>
+
+#include "osi/include/allocator.h"
+#include "stack/gatt/gatt_int.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/gatt_api.h"
+#include "stack/include/l2c_api.h"
+#include "test/mock/mock_stack_l2cap_api.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+using bluetooth::Uuid;
+
+namespace {
+
+constexpr uint16_t kFirstServiceHandle = 0x1000;
+constexpr uint16_t kCharacteristicsPerService = 50;
+// Service declaration plus declaration and value for each characteristic
+constexpr uint16_t kHandlesPerService = 1 + 2 * kCharacteristicsPerService;
+
+// Serves discovery requests from a peer over the fixed ATT channel. Each
+// request starts at a different handle, as a client walking the database
+// does, and responses are dropped at L2CAP.
+class BM_GattSr : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    test::mock::stack_l2cap_api::L2CA_SendFixedChnlData.body =
+        [](uint16_t fixed_cid, const RawAddress& rem_bda, BT_HDR* p_buf) {
+          osi_free(p_buf);
+          return static_cast<uint16_t>(L2CAP_DW_SUCCESS);
+        };
+    gatt_init();
+
+    uint16_t s_hdl = kFirstServiceHandle;
+    for (int i = 0; i < st.range(0); i++) {
+      tGATT_SVC_DB& db = dbs_.emplace_back();
+      gatts_init_service_db(db, Uuid::From16Bit(0x1800 + i), true, s_hdl,
+                            kHandlesPerService);
+      for (int j = 0; j < kCharacteristicsPerService; j++) {
+        gatts_add_characteristic(db, GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+                                 Uuid::From16Bit(0x2a00 + j));
+      }
+
+      tGATT_SRV_LIST_ELEM& elem = gatt_cb.srv_list_info->emplace_back();
+      elem.p_db = &db;
+      elem.s_hdl = s_hdl;
+      elem.e_hdl = s_hdl + kHandlesPerService - 1;
+      elem.type = GATT_UUID_PRI_SERVICE;
+      elem.is_primary = true;
+      s_hdl += kHandlesPerService;
+    }
+    gatt_sr_update_srv_list_index();
+    last_handle_ = s_hdl - 1;
+
+    tcb_ = &gatt_cb.tcb[0];
+    tcb_->in_use = true;
+    tcb_->transport = BT_TRANSPORT_LE;
+    tcb_->att_lcid = L2CAP_ATT_CID;
+    tcb_->payload_size = GATT_MAX_MTU_SIZE;
+  }
+
+  void TearDown(State& st) override {
+    gatt_free();
+    dbs_.clear();
+    test::mock::stack_l2cap_api::L2CA_SendFixedChnlData = {};
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  // Issues |op_code| for every start handle in the database in turn
+  void Serve(State& state, uint8_t op_code, bool with_uuid) {
+    uint8_t req[6];
+    uint16_t s_hdl = kFirstServiceHandle;
+    for (auto _ : state) {
+      uint8_t* p = req;
+      UINT16_TO_STREAM(p, s_hdl);
+      UINT16_TO_STREAM(p, 0xffff);
+      if (with_uuid) UINT16_TO_STREAM(p, GATT_UUID_CHAR_DECLARE);
+      gatt_server_handle_client_req(*tcb_, L2CAP_ATT_CID, op_code, p - req,
+                                    req);
+      s_hdl = (s_hdl == last_handle_) ? kFirstServiceHandle : s_hdl + 1;
+    }
+  }
+
+  std::list<tGATT_SVC_DB> dbs_;
+  tGATT_TCB* tcb_ = nullptr;
+  uint16_t last_handle_ = 0;
+};
+
+BENCHMARK_DEFINE_F(BM_GattSr, find_info)(State& state) {
+  Serve(state, GATT_REQ_FIND_INFO, false);
+}
+
+BENCHMARK_DEFINE_F(BM_GattSr, read_by_type)(State& state) {
+  Serve(state, GATT_REQ_READ_BY_TYPE, true);
+}
+
+void GattSrArguments(::benchmark::internal::Benchmark* b) {
+  // 101 and 2020 attributes
+  b->ArgName("services")->Arg(1)->Arg(20);
+}
+
+BENCHMARK_REGISTER_F(BM_GattSr, find_info)->Apply(GattSrArguments);
+BENCHMARK_REGISTER_F(BM_GattSr, read_by_type)->Apply(GattSrArguments);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
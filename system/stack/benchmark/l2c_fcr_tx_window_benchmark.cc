@@ -0,0 +1,215 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
+#include "osi/include/list.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/l2cap/l2c_fcr_tx_window.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+// Frames the sender keeps outstanding, the largest eRTM TxWindow
+constexpr uint8_t kTxWindow = 63;
+constexpr uint16_t kPduSize = 1017;
+
+BT_HDR* MakeFrame(uint8_t tx_seq) {
+  BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + kPduSize);
+  p_buf->offset = 0;
+  p_buf->len = kPduSize;
+  p_buf->event = tx_seq;
+  p_buf->layer_specific = 0;
+  return p_buf;
+}
+
+BT_HDR* Clone(const BT_HDR* p_buf) {
+  BT_HDR* p_clone = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + p_buf->len);
+  memcpy(p_clone, p_buf, sizeof(BT_HDR) + p_buf->len);
+  return p_clone;
+}
+
+// The lower layers copy the frame into their own packet and free it
+void SendToLower(BT_HDR* p_buf) {
+  ::benchmark::DoNotOptimize(p_buf->event);
+  osi_free(p_buf);
+}
+
+// Offsets in the window of the frames the peer does not receive, one in every
+// 100 / |loss_percent| frames
+std::vector<uint8_t> LostFrames(int loss_percent) {
+  std::vector<uint8_t> lost;
+  if (loss_percent == 0) return lost;
+  for (uint8_t i = 0; i < kTxWindow; i += 100 / loss_percent) {
+    lost.push_back(i);
+  }
+  return lost;
+}
+
+// Previous layout: the sent frames in a fixed_queue searched from the head for
+// each SREJ, and a copy of each frame to resend held in a second queue.
+void BM_ErtmFixedQueue(State& state) {
+  std::vector<uint8_t> lost = LostFrames(state.range(0));
+  fixed_queue_t* waiting_for_ack_q = fixed_queue_new(SIZE_MAX);
+  fixed_queue_t* retrans_q = fixed_queue_new(SIZE_MAX);
+  uint8_t next_tx_seq = 0;
+
+  for (auto _ : state) {
+    uint8_t first_seq = next_tx_seq;
+    for (uint8_t i = 0; i < kTxWindow; i++) {
+      BT_HDR* p_xmit = MakeFrame(next_tx_seq);
+      fixed_queue_enqueue(waiting_for_ack_q, Clone(p_xmit));
+      SendToLower(p_xmit);
+      next_tx_seq = (next_tx_seq + 1) & L2CAP_FCR_SEQ_MODULO;
+    }
+
+    for (uint8_t i : lost) {
+      uint8_t tx_seq = (first_seq + i) & L2CAP_FCR_SEQ_MODULO;
+      const list_t* list_ack = fixed_queue_get_list(waiting_for_ack_q);
+      for (const list_node_t* node = list_begin(list_ack);
+           node != list_end(list_ack); node = list_next(node)) {
+        BT_HDR* p_buf = (BT_HDR*)list_node(node);
+        if (p_buf->event == tx_seq) {
+          fixed_queue_enqueue(retrans_q, Clone(p_buf));
+          break;
+        }
+      }
+    }
+    while (!fixed_queue_is_empty(retrans_q)) {
+      SendToLower((BT_HDR*)fixed_queue_try_dequeue(retrans_q));
+    }
+
+    while (!fixed_queue_is_empty(waiting_for_ack_q)) {
+      osi_free(fixed_queue_try_dequeue(waiting_for_ack_q));
+    }
+  }
+
+  fixed_queue_free(retrans_q, osi_free);
+  fixed_queue_free(waiting_for_ack_q, osi_free);
+  state.counters["frames_per_sec"] =
+      Counter(state.iterations() * (kTxWindow + lost.size()), Counter::kIsRate);
+}
+
+// The sent frames in a ring indexed by TxSeq, resent frames copied when sent
+void BM_ErtmTxWindow(State& state) {
+  std::vector<uint8_t> lost = LostFrames(state.range(0));
+  tL2C_FCR_TX_WINDOW window = {};
+  uint8_t next_tx_seq = 0;
+
+  for (auto _ : state) {
+    uint8_t first_seq = next_tx_seq;
+    for (uint8_t i = 0; i < kTxWindow; i++) {
+      BT_HDR* p_xmit = MakeFrame(next_tx_seq);
+      window.Push(Clone(p_xmit));
+      SendToLower(p_xmit);
+      next_tx_seq = (next_tx_seq + 1) & L2CAP_FCR_SEQ_MODULO;
+    }
+
+    for (uint8_t i : lost) {
+      window.QueueRetransmission((first_seq + i) & L2CAP_FCR_SEQ_MODULO);
+    }
+    for (BT_HDR* p_wack = window.NextRetransmission(); p_wack != nullptr;
+         p_wack = window.NextRetransmission()) {
+      SendToLower(Clone(p_wack));
+    }
+
+    while (!window.IsEmpty()) osi_free(window.PopFront());
+  }
+
+  window.Clear();
+  state.counters["frames_per_sec"] =
+      Counter(state.iterations() * (kTxWindow + lost.size()), Counter::kIsRate);
+}
+
+// REJ from the peer, acknowledging |range(0)| frames of the window before the
+// sender gets to resend them.
+void BM_ErtmRejFixedQueue(State& state) {
+  uint8_t acked_before_resend = state.range(0);
+  fixed_queue_t* waiting_for_ack_q = fixed_queue_new(SIZE_MAX);
+  fixed_queue_t* retrans_q = fixed_queue_new(SIZE_MAX);
+
+  for (auto _ : state) {
+    for (uint8_t i = 0; i < kTxWindow; i++) {
+      fixed_queue_enqueue(waiting_for_ack_q, MakeFrame(i));
+    }
+
+    const list_t* list_ack = fixed_queue_get_list(waiting_for_ack_q);
+    for (const list_node_t* node = list_begin(list_ack);
+         node != list_end(list_ack); node = list_next(node)) {
+      fixed_queue_enqueue(retrans_q, Clone((BT_HDR*)list_node(node)));
+    }
+    for (uint8_t i = 0; i < acked_before_resend; i++) {
+      osi_free(fixed_queue_try_dequeue(waiting_for_ack_q));
+    }
+    while (!fixed_queue_is_empty(retrans_q)) {
+      SendToLower((BT_HDR*)fixed_queue_try_dequeue(retrans_q));
+    }
+
+    while (!fixed_queue_is_empty(waiting_for_ack_q)) {
+      osi_free(fixed_queue_try_dequeue(waiting_for_ack_q));
+    }
+  }
+
+  fixed_queue_free(retrans_q, osi_free);
+  fixed_queue_free(waiting_for_ack_q, osi_free);
+}
+
+void BM_ErtmRejTxWindow(State& state) {
+  uint8_t acked_before_resend = state.range(0);
+  tL2C_FCR_TX_WINDOW window = {};
+
+  for (auto _ : state) {
+    for (uint8_t i = 0; i < kTxWindow; i++) {
+      window.Push(MakeFrame(window.first_seq + i));
+    }
+
+    window.QueueAllRetransmissions();
+    for (uint8_t i = 0; i < acked_before_resend; i++) {
+      osi_free(window.PopFront());
+    }
+    for (BT_HDR* p_wack = window.NextRetransmission(); p_wack != nullptr;
+         p_wack = window.NextRetransmission()) {
+      SendToLower(Clone(p_wack));
+    }
+
+    while (!window.IsEmpty()) osi_free(window.PopFront());
+  }
+
+  window.Clear();
+}
+
+BENCHMARK(BM_ErtmFixedQueue)->ArgName("loss_percent")->Arg(0)->Arg(1)->Arg(5);
+BENCHMARK(BM_ErtmTxWindow)->ArgName("loss_percent")->Arg(0)->Arg(1)->Arg(5);
+BENCHMARK(BM_ErtmRejFixedQueue)->ArgName("acked")->Arg(0)->Arg(32);
+BENCHMARK(BM_ErtmRejTxWindow)->ArgName("acked")->Arg(0)->Arg(32);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -52,6 +52,21 @@ constexpr char kBtmLogTag[] = "BOND";
 
 }
 
+/* Returns the first record found for |bd_addr|, which may no longer match */
+static tBTM_SEC_DEV_REC* btm_sec_dev_rec_address_hint(
+    const RawAddress& bd_addr) {
+  auto it = btm_cb.sec_dev_rec_index.by_address.find(bd_addr);
+  if (it == btm_cb.sec_dev_rec_index.by_address.end()) return nullptr;
+  return it->second;
+}
+
+/* Returns the first record found for |handle|, which may no longer match */
+static tBTM_SEC_DEV_REC* btm_sec_dev_rec_handle_hint(uint16_t handle) {
+  auto it = btm_cb.sec_dev_rec_index.by_handle.find(handle);
+  if (it == btm_cb.sec_dev_rec_index.by_handle.end()) return nullptr;
+  return it->second;
+}
+
 /*******************************************************************************
  *
  * Function         BTM_SecAddDevice
@@ -84,6 +99,7 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
 
     p_dev_rec->bd_addr = bd_addr;
     p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+    btm_sec_dev_rec_update_index(p_dev_rec);
 
     /* use default value for background connection params */
     /* update conn params, use default value for background connection params */
@@ -142,6 +158,7 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
 void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec) {
   p_dev_rec->link_key.fill(0);
   memset(&p_dev_rec->ble.keys, 0, sizeof(tBTM_SEC_BLE_KEYS));
+  btm_cb.sec_dev_rec_index.Remove(p_dev_rec);
   list_remove(btm_cb.sec_dev_rec, p_dev_rec);
 }
 
@@ -279,6 +296,7 @@ tBTM_SEC_DEV_REC* btm_sec_alloc_dev(const RawAddress& bd_addr) {
 
   p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
   p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_dev_rec_update_index(p_dev_rec);
 
   return (p_dev_rec);
 }
@@ -351,8 +369,16 @@ bool is_handle_equal(void* data, void* context) {
  *
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle) {
+  tBTM_SEC_DEV_REC* p_hint = btm_sec_dev_rec_handle_hint(handle);
+  if (p_hint != nullptr && !is_handle_equal(p_hint, &handle)) return p_hint;
+
   list_node_t* n = list_foreach(btm_cb.sec_dev_rec, is_handle_equal, &handle);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    if (handle != HCI_INVALID_HANDLE)
+      btm_cb.sec_dev_rec_index.AddHandle(handle, p_dev_rec);
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -382,9 +408,17 @@ bool is_address_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
 
+  tBTM_SEC_DEV_REC* p_hint = btm_sec_dev_rec_address_hint(bd_addr);
+  if (p_hint != nullptr && !is_address_equal(p_hint, (void*)&bd_addr))
+    return p_hint;
+
   list_node_t* n =
       list_foreach(btm_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    btm_cb.sec_dev_rec_index.AddAddress(bd_addr, p_dev_rec);
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -409,6 +443,12 @@ static bool has_lenc_and_address_is_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev_with_lenc(const RawAddress& bd_addr) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
 
+  // The hint is the first record matching |bd_addr|, use it if it has an LTK
+  tBTM_SEC_DEV_REC* p_hint = btm_sec_dev_rec_address_hint(bd_addr);
+  if (p_hint != nullptr &&
+      !has_lenc_and_address_is_equal(p_hint, (void*)&bd_addr))
+    return p_hint;
+
   list_node_t* n = list_foreach(btm_cb.sec_dev_rec, has_lenc_and_address_is_equal,
                                 (void*)&bd_addr);
   if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
@@ -455,6 +495,7 @@ void btm_consolidate_dev(tBTM_SEC_DEV_REC* p_target_rec) {
 
       /* remove the combined record */
       wipe_secrets_and_remove(p_dev_rec);
+      btm_sec_dev_rec_update_index(p_target_rec);
       // p_dev_rec gets freed in list_remove, we should not  access it further
       continue;
     }
@@ -523,6 +564,7 @@ void btm_dev_consolidate_existing_connections(const RawAddress& bd_addr) {
 
       /* remove the old LE record */
       wipe_secrets_and_remove(p_dev_rec);
+      btm_sec_dev_rec_update_index(p_target_rec);
 
       btm_acl_consolidate(bd_addr, ble_conn_addr);
       L2CA_Consolidate(bd_addr, ble_conn_addr);
@@ -540,6 +582,47 @@ void btm_dev_consolidate_existing_connections(const RawAddress& bd_addr) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         btm_sec_dev_rec_update_index
+ *
+ * Description      Records the current address and connection handles of
+ *                  |p_dev_rec| in the lookup hints, mapped to the first
+ *                  record in the list with them. Called after any of them
+ *                  change so the next lookup does not need to scan the list.
+ *
+ * Returns          none
+ *
+ ******************************************************************************/
+void btm_sec_dev_rec_update_index(tBTM_SEC_DEV_REC* p_dev_rec) {
+  tBTM_SEC_DEV_REC_INDEX& index = btm_cb.sec_dev_rec_index;
+
+  // The hints must give the record the list scan would find, which is not
+  // |p_dev_rec| when an earlier record has the same address or handle
+  auto index_address = [&index](RawAddress bd_addr) {
+    list_node_t* n =
+        list_foreach(btm_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
+    if (n) {
+      index.AddAddress(bd_addr,
+                       static_cast<tBTM_SEC_DEV_REC*>(list_node(n)));
+    }
+  };
+  auto index_handle = [&index](uint16_t handle) {
+    list_node_t* n = list_foreach(btm_cb.sec_dev_rec, is_handle_equal, &handle);
+    if (n) {
+      index.AddHandle(handle, static_cast<tBTM_SEC_DEV_REC*>(list_node(n)));
+    }
+  };
+
+  index_address(p_dev_rec->bd_addr);
+  if (!p_dev_rec->ble.pseudo_addr.IsEmpty())
+    index_address(p_dev_rec->ble.pseudo_addr);
+  if (p_dev_rec->hci_handle != HCI_INVALID_HANDLE)
+    index_handle(p_dev_rec->hci_handle);
+  if (p_dev_rec->ble_hci_handle != HCI_INVALID_HANDLE)
+    index_handle(p_dev_rec->ble_hci_handle);
+}
+
 /*******************************************************************************
  *
  * Function         btm_find_or_alloc_dev
@@ -160,6 +160,20 @@ void btm_dev_consolidate_existing_connections(const RawAddress& bd_addr);
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_find_or_alloc_dev(const RawAddress& bd_addr);
 
+/*******************************************************************************
+ *
+ * Function         btm_sec_dev_rec_update_index
+ *
+ * Description      Records the current address and connection handles of
+ *                  |p_dev_rec| in the lookup hints, mapped to the first
+ *                  record in the list with them. Called after any of them
+ *                  change so the next lookup does not need to scan the list.
+ *
+ * Returns          none
+ *
+ ******************************************************************************/
+void btm_sec_dev_rec_update_index(tBTM_SEC_DEV_REC* p_dev_rec);
+
 /*******************************************************************************
  *
  * Function         btm_sec_allocate_dev_rec
@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "gd/common/circular_buffer.h"
 #include "osi/include/allocator.h"
@@ -64,6 +65,45 @@ class TimestampedStringCircularBuffer
   }
 };
 
+/*
+ * Lookup hints into the security device record list. Entries map an address
+ * or a connection handle to the first record in list order that matched it,
+ * so that duplicate records resolve as the list scan does. A hint is only
+ * used after checking it against the record itself, so entries going stale
+ * when record fields change is harmless. Entries must be dropped before the
+ * record they point to is freed.
+ */
+struct tBTM_SEC_DEV_REC_INDEX {
+  /* Resolved private addresses are cached too, so bound the address hints */
+  static constexpr size_t kMaxAddressHints = 4 * BTM_SEC_MAX_DEVICE_RECORDS;
+
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> by_address;
+  std::unordered_map<uint16_t, tBTM_SEC_DEV_REC*> by_handle;
+
+  void AddAddress(const RawAddress& bd_addr, tBTM_SEC_DEV_REC* p_dev_rec) {
+    if (by_address.size() >= kMaxAddressHints) by_address.clear();
+    by_address[bd_addr] = p_dev_rec;
+  }
+
+  void AddHandle(uint16_t handle, tBTM_SEC_DEV_REC* p_dev_rec) {
+    by_handle[handle] = p_dev_rec;
+  }
+
+  void Remove(const tBTM_SEC_DEV_REC* p_dev_rec) {
+    for (auto it = by_address.begin(); it != by_address.end();) {
+      it = (it->second == p_dev_rec) ? by_address.erase(it) : std::next(it);
+    }
+    for (auto it = by_handle.begin(); it != by_handle.end();) {
+      it = (it->second == p_dev_rec) ? by_handle.erase(it) : std::next(it);
+    }
+  }
+
+  void Clear() {
+    by_address.clear();
+    by_handle.clear();
+  }
+};
+
 /*
  * Local device configuration
  */
@@ -278,6 +318,7 @@ typedef struct tBTM_CB {
   uint8_t disc_reason{0};           /* for legacy devices */
   tBTM_SEC_SERV_REC sec_serv_rec[BTM_SEC_MAX_SERVICE_RECORDS];
   list_t* sec_dev_rec{nullptr}; /* list of tBTM_SEC_DEV_REC */
+  tBTM_SEC_DEV_REC_INDEX sec_dev_rec_index; /* lookup hints into sec_dev_rec */
   tBTM_SEC_SERV_REC* p_out_serv{nullptr};
   tBTM_MKEY_CALLBACK* mkey_cback{nullptr};
 
@@ -353,6 +394,7 @@ typedef struct tBTM_CB {
 #endif
     security_mode = initial_security_mode;
     pairing_bda = RawAddress::kAny;
+    sec_dev_rec_index.Clear();
     sec_dev_rec = list_new([](void* ptr) {
       // Invoke destructor for all record objects and reset to default
       // initialized value so memory may be properly freed
@@ -385,6 +427,7 @@ typedef struct tBTM_CB {
     fixed_queue_free(sec_pending_q, nullptr);
     sec_pending_q = nullptr;
 
+    sec_dev_rec_index.Clear();
     list_free(sec_dev_rec);
     sec_dev_rec = nullptr;
 
@@ -17,11 +17,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 
 #include "base/functional/bind.h"
 #include "base/functional/callback.h"
@@ -83,8 +86,28 @@ struct iso_base {
     uint64_t evt_last_lost_us = 0;
   };
 
+  struct tx_queue_stats {
+    size_t queued_count = 0;
+    size_t max_depth = 0;
+    size_t overflow_drop_count = 0;
+    size_t late_drop_count = 0;
+    uint64_t last_drop_us = 0;
+  };
+
+  /* Packet waiting for controller buffers, dropped if not sent by expiry_us */
+  struct tx_queue_entry {
+    BT_HDR* packet;
+    uint64_t expiry_us;
+  };
+
+  ~iso_base() {
+    for (auto& entry : tx_queue) osi_free(entry.packet);
+  }
+
   credits_stats cr_stats;
   event_stats evt_stats;
+  tx_queue_stats txq_stats;
+  std::deque<tx_queue_entry> tx_queue;
 };
 
 typedef iso_base iso_cis;
@@ -413,7 +436,10 @@ struct iso_impl {
                        "handle:0x%04x, status:%s", conn_handle,
                        hci_status_code_text((tHCI_STATUS)(status)).c_str()));
 
-    if (status == HCI_SUCCESS) iso->state_flags &= ~kStateFlagHasDataPathSet;
+    if (status == HCI_SUCCESS) {
+      iso->state_flags &= ~kStateFlagHasDataPathSet;
+      flush_iso_tx_queue(iso);
+    }
 
     if (iso->state_flags & kStateFlagIsBroadcast) {
       LOG_ASSERT(big_callbacks_ != nullptr) << "Invalid BIG callbacks";
@@ -557,26 +583,113 @@ struct iso_impl {
     uint32_t ts = bluetooth::common::time_get_os_boottime_us();
     iso->sync_info.seq_nb = (ts - iso->sync_info.first_sync_ts) / iso->sdu_itv;
 
-    if (iso_credits_ == 0 || data_len > iso_buffer_size_) {
-      iso->cr_stats.credits_underflow_bytes += data_len;
-      iso->cr_stats.credits_underflow_count++;
-      iso->cr_stats.credits_last_underflow_us =
-          bluetooth::common::time_get_os_boottime_us();
-
+    if (data_len > iso_buffer_size_) {
       LOG(WARNING) << __func__ << ", dropping ISO packet, len: "
                    << static_cast<int>(data_len)
-                   << ", iso credits: " << static_cast<int>(iso_credits_)
+                   << " exceeds controller buffer size: " << iso_buffer_size_
                    << ", iso handle: " << loghex(iso_handle);
       return;
     }
 
-    iso_credits_--;
-    iso->used_credits++;
-
     BT_HDR* packet =
         prepare_ts_hci_packet(iso_handle, ts, iso->sync_info.seq_nb, data_len);
     memcpy(packet->data + kIsoDataInTsBtHdrOffset, data, data_len);
-    send_iso_data_hci_packet(packet);
+
+    /* Keep the order of SDUs already waiting for credits */
+    if (iso_credits_ > 0 && iso->tx_queue.empty()) {
+      iso_credits_--;
+      iso->used_credits++;
+      send_iso_data_hci_packet(packet);
+      return;
+    }
+
+    uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+    /* Packets only queued behind others to keep their order did not lack
+     * credits */
+    if (iso_credits_ == 0) {
+      iso->cr_stats.credits_underflow_bytes += data_len;
+      iso->cr_stats.credits_underflow_count++;
+      iso->cr_stats.credits_last_underflow_us = now_us;
+    }
+
+    if (iso->tx_queue.size() >= kIsoTxQueueMaxDepth) {
+      /* The oldest SDU is the least likely to still be played in time */
+      osi_free(iso->tx_queue.front().packet);
+      iso->tx_queue.pop_front();
+      iso->txq_stats.overflow_drop_count++;
+      iso->txq_stats.last_drop_us = now_us;
+
+      LOG(WARNING) << __func__ << ", tx queue full, dropping oldest ISO packet"
+                   << ", iso handle: " << loghex(iso_handle);
+    }
+
+    uint64_t expiry_us =
+        now_us + static_cast<uint64_t>(kIsoTxQueueMaxSduItvs) * iso->sdu_itv;
+    iso->tx_queue.push_back({.packet = packet, .expiry_us = expiry_us});
+    iso->txq_stats.queued_count++;
+    iso->txq_stats.max_depth =
+        std::max(iso->txq_stats.max_depth, iso->tx_queue.size());
+
+    drain_iso_tx_queues();
+  }
+
+  /* Drop the queued packets of |iso| which expired by |now_us| */
+  static void expire_iso_tx_queue(iso_base* iso, uint64_t now_us) {
+    while (!iso->tx_queue.empty() &&
+           iso->tx_queue.front().expiry_us <= now_us) {
+      osi_free(iso->tx_queue.front().packet);
+      iso->tx_queue.pop_front();
+      iso->txq_stats.late_drop_count++;
+      iso->txq_stats.last_drop_us = now_us;
+    }
+  }
+
+  static void flush_iso_tx_queue(iso_base* iso) {
+    for (auto& entry : iso->tx_queue) osi_free(entry.packet);
+    iso->tx_queue.clear();
+  }
+
+  /* Send queued packets while there are credits, one packet per CIS/BIS at a
+   * time, starting after the handle served last so that no stream starves
+   * when credits come back one by one.
+   */
+  void drain_iso_tx_queues() {
+    uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+
+    std::vector<std::pair<uint16_t, iso_base*>> pending;
+    for (auto const& [handle, cis] : conn_hdl_to_cis_map_) {
+      expire_iso_tx_queue(cis.get(), now_us);
+      if (!cis->tx_queue.empty()) pending.emplace_back(handle, cis.get());
+    }
+    for (auto const& [handle, bis] : conn_hdl_to_bis_map_) {
+      expire_iso_tx_queue(bis.get(), now_us);
+      if (!bis->tx_queue.empty()) pending.emplace_back(handle, bis.get());
+    }
+    if (pending.empty()) return;
+
+    std::sort(pending.begin(), pending.end(),
+              [](auto const& a, auto const& b) { return a.first < b.first; });
+    auto first = std::upper_bound(
+        pending.begin(), pending.end(), last_drained_iso_handle_,
+        [](uint16_t handle, auto const& p) { return handle < p.first; });
+    std::rotate(pending.begin(), first, pending.end());
+
+    bool sent = true;
+    while (iso_credits_ > 0 && sent) {
+      sent = false;
+      for (auto& [handle, iso] : pending) {
+        if (iso_credits_ == 0) break;
+        if (iso->tx_queue.empty()) continue;
+
+        BT_HDR* packet = iso->tx_queue.front().packet;
+        iso->tx_queue.pop_front();
+        iso_credits_--;
+        iso->used_credits++;
+        last_drained_iso_handle_ = handle;
+        send_iso_data_hci_packet(packet);
+        sent = true;
+      }
+    }
   }
 
   void process_cis_est_pkt(uint8_t len, uint8_t* data) {
@@ -654,6 +767,8 @@ struct iso_impl {
       /* return used credits */
       iso_credits_ += cis->used_credits;
       cis->used_credits = 0;
+      flush_iso_tx_queue(cis);
+      drain_iso_tx_queues();
 
       /* Data path is considered still valid, but can be reconfigured only once
        * CIS is reestablished.
@@ -688,6 +803,8 @@ struct iso_impl {
         continue;
       }
     }
+
+    drain_iso_tx_queues();
   }
 
   void handle_gd_num_completed_pkts(uint16_t handle, uint16_t credits) {
@@ -695,6 +812,7 @@ struct iso_impl {
     if (iter != conn_hdl_to_cis_map_.end()) {
       iter->second->used_credits -= credits;
       iso_credits_ += credits;
+      drain_iso_tx_queues();
       return;
     }
 
@@ -703,6 +821,8 @@ struct iso_impl {
       iter->second->used_credits -= credits;
       iso_credits_ += credits;
     }
+
+    drain_iso_tx_queues();
   }
 
   void process_create_big_cmpl_pkt(uint8_t len, uint8_t* data) {
@@ -956,6 +1076,23 @@ struct iso_impl {
              : 0llu));
   }
 
+  static void dump_tx_queue_stats(int fd, const iso_base& iso) {
+    uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+    const iso_base::tx_queue_stats& stats = iso.txq_stats;
+
+    dprintf(fd, "        Tx Queue Stats:\n");
+    dprintf(fd, "          Queue depth (current/max): %zu/%zu\n",
+            iso.tx_queue.size(), stats.max_depth);
+    dprintf(fd, "          Queued packets (count): %zu\n", stats.queued_count);
+    dprintf(fd, "          Overflow drops (count): %zu\n",
+            stats.overflow_drop_count);
+    dprintf(fd, "          Late drops (count): %zu\n", stats.late_drop_count);
+    dprintf(fd, "          Last drop time ago (ms): %llu\n",
+            (stats.last_drop_us > 0
+                 ? (unsigned long long)(now_us - stats.last_drop_us) / 1000
+                 : 0llu));
+  }
+
   static void dump_event_stats(int fd, const iso_base::event_stats& stats) {
     uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
 
@@ -987,6 +1124,7 @@ struct iso_impl {
       dprintf(fd, "        State Flags: 0x%02hx\n",
               cis_pair.second->state_flags.load());
       dump_credits_stats(fd, cis_pair.second->cr_stats);
+      dump_tx_queue_stats(fd, *cis_pair.second);
       dump_event_stats(fd, cis_pair.second->evt_stats);
     }
     dprintf(fd, "    BISes:\n");
@@ -999,6 +1137,7 @@ struct iso_impl {
       dprintf(fd, "        State Flags: 0x%02hx\n",
               cis_pair.second->state_flags.load());
       dump_credits_stats(fd, cis_pair.second->cr_stats);
+      dump_tx_queue_stats(fd, *cis_pair.second);
       dump_event_stats(fd, cis_pair.second->evt_stats);
     }
     dprintf(fd, "  ----------------\n ");
@@ -1010,6 +1149,7 @@ struct iso_impl {
 
   std::atomic_uint16_t iso_credits_;
   uint16_t iso_buffer_size_;
+  uint16_t last_drained_iso_handle_ = 0;
   uint32_t last_big_create_req_sdu_itv_;
 
   CigCallbacks* cig_callbacks_ = nullptr;
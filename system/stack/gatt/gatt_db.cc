@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "bt_target.h"
 #include "bt_trace.h"
 #include "gatt_int.h"
@@ -291,8 +293,10 @@ tGATT_STATUS gatts_db_read_attr_value_by_type(
   uint8_t* p = (uint8_t*)(p_rsp + 1) + p_rsp->len + L2CAP_MIN_OFFSET;
 
   if (p_db) {
-    for (tGATT_ATTR& attr : p_db->attr_list) {
-      if (attr.handle >= s_handle && type == attr.uuid) {
+    for (auto it = gatts_find_first_attr_from_handle(*p_db, s_handle);
+         it != p_db->attr_list.end(); it++) {
+      tGATT_ATTR& attr = *it;
+      if (type == attr.uuid) {
         if (*p_len <= 2) {
           status = GATT_NO_RESOURCES;
           break;
@@ -453,15 +457,34 @@ uint16_t gatts_add_char_descr(tGATT_SVC_DB& db, tGATT_PERM perm,
 /******************************************************************************/
 /* Service Attribute Database Query Utility Functions */
 /******************************************************************************/
+/**
+ * Returns the first attribute of |db| whose handle is not less than |handle|.
+ * Attributes are allocated consecutive handles, so the position is normally
+ * computed directly; the binary search is only a fallback.
+ */
+std::vector<tGATT_ATTR>::iterator gatts_find_first_attr_from_handle(
+    tGATT_SVC_DB& db, uint16_t handle) {
+  auto& attr_list = db.attr_list;
+  if (attr_list.empty() || handle <= attr_list.front().handle)
+    return attr_list.begin();
+
+  size_t offset = handle - attr_list.front().handle;
+  if (offset < attr_list.size() && attr_list[offset].handle == handle)
+    return attr_list.begin() + offset;
+
+  return std::lower_bound(attr_list.begin(), attr_list.end(), handle,
+                          [](const tGATT_ATTR& attr, uint16_t handle) {
+                            return attr.handle < handle;
+                          });
+}
+
 tGATT_ATTR* find_attr_by_handle(tGATT_SVC_DB* p_db, uint16_t handle) {
   if (!p_db) return nullptr;
 
-  for (auto& attr : p_db->attr_list) {
-    if (attr.handle == handle) return &attr;
-    if (attr.handle > handle) return nullptr;
-  }
+  auto it = gatts_find_first_attr_from_handle(*p_db, handle);
+  if (it == p_db->attr_list.end() || it->handle != handle) return nullptr;
 
-  return nullptr;
+  return &*it;
 }
 
 /*******************************************************************************
@@ -532,9 +532,10 @@ static tGATT_STATUS gatt_build_primary_service_rsp(
 
   uint16_t payload_size = gatt_tcb_get_payload_size_tx(tcb, cid);
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl < s_hdl || el.s_hdl > e_hdl ||
-        el.type != GATT_UUID_PRI_SERVICE) {
+  for (auto it = gatt_sr_find_first_srv_from_handle(s_hdl);
+       it != gatt_cb.srv_list_info->end() && it->s_hdl <= e_hdl; it++) {
+    tGATT_SRV_LIST_ELEM& el = *it;
+    if (el.s_hdl < s_hdl || el.type != GATT_UUID_PRI_SERVICE) {
       continue;
     }
 
@@ -602,11 +603,11 @@ static tGATT_STATUS gatt_build_find_info_rsp(tGATT_SRV_LIST_ELEM& el,
 
   uint8_t* p = (uint8_t*)(p_msg + 1) + L2CAP_MIN_OFFSET + p_msg->len;
 
-  for (auto& attr : el.p_db->attr_list) {
+  for (auto it = gatts_find_first_attr_from_handle(*el.p_db, s_hdl);
+       it != el.p_db->attr_list.end(); it++) {
+    auto& attr = *it;
     if (attr.handle > e_hdl) break;
 
-    if (attr.handle < s_hdl) continue;
-
     uint8_t uuid_len = attr.uuid.GetShortestRepresentationSize();
     if (p_msg->offset == 0)
       p_msg->offset = (uuid_len == Uuid::kNumBytes16) ? GATT_INFO_TYPE_PAIR_16
@@ -774,13 +775,12 @@ static void gatts_process_find_info(tGATT_TCB& tcb, uint16_t cid,
 
   buf_len = payload_size - 2;
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl <= e_hdl && el.e_hdl >= s_hdl) {
-      reason = gatt_build_find_info_rsp(el, p_msg, buf_len, s_hdl, e_hdl);
-      if (reason == GATT_NO_RESOURCES) {
-        reason = GATT_SUCCESS;
-        break;
-      }
+  for (auto it = gatt_sr_find_first_srv_from_handle(s_hdl);
+       it != gatt_cb.srv_list_info->end() && it->s_hdl <= e_hdl; it++) {
+    reason = gatt_build_find_info_rsp(*it, p_msg, buf_len, s_hdl, e_hdl);
+    if (reason == GATT_NO_RESOURCES) {
+      reason = GATT_SUCCESS;
+      break;
     }
   }
 
@@ -912,24 +912,23 @@ static void gatts_process_read_by_type_req(tGATT_TCB& tcb, uint16_t cid,
   uint16_t buf_len = payload_size - 2;
 
   reason = GATT_NOT_FOUND;
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl <= e_hdl && el.e_hdl >= s_hdl) {
-      tGATT_SEC_FLAG sec_flag;
-      uint8_t key_size;
-      gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
-
-      tGATT_STATUS ret = gatts_db_read_attr_value_by_type(
-          tcb, cid, el.p_db, op_code, p_msg, s_hdl, e_hdl, uuid, &buf_len,
-          sec_flag, key_size, 0, &err_hdl);
-      if (ret != GATT_NOT_FOUND) {
-        reason = ret;
-        if (ret == GATT_NO_RESOURCES) reason = GATT_SUCCESS;
-      }
+  for (auto it = gatt_sr_find_first_srv_from_handle(s_hdl);
+       it != gatt_cb.srv_list_info->end() && it->s_hdl <= e_hdl; it++) {
+    tGATT_SEC_FLAG sec_flag;
+    uint8_t key_size;
+    gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
+
+    tGATT_STATUS ret = gatts_db_read_attr_value_by_type(
+        tcb, cid, it->p_db, op_code, p_msg, s_hdl, e_hdl, uuid, &buf_len,
+        sec_flag, key_size, 0, &err_hdl);
+    if (ret != GATT_NOT_FOUND) {
+      reason = ret;
+      if (ret == GATT_NO_RESOURCES) reason = GATT_SUCCESS;
+    }
 
-      if (ret != GATT_SUCCESS && ret != GATT_NOT_FOUND) {
-        s_hdl = err_hdl;
-        break;
-      }
+    if (ret != GATT_SUCCESS && ret != GATT_NOT_FOUND) {
+      s_hdl = err_hdl;
+      break;
     }
   }
   *p = (uint8_t)p_msg->offset;
@@ -1131,32 +1130,31 @@ void gatts_process_attribute_req(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
 #endif
 
   if (GATT_HANDLE_IS_VALID(handle)) {
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        for (const auto& attr : el.p_db->attr_list) {
-          if (attr.handle == handle) {
-            switch (op_code) {
-              case GATT_REQ_READ: /* read char/char descriptor value */
-              case GATT_REQ_READ_BLOB:
-                gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
-                break;
-
-              case GATT_REQ_WRITE: /* write char/char descriptor value */
-              case GATT_CMD_WRITE:
-              case GATT_SIGN_CMD_WRITE:
-              case GATT_REQ_PREPARE_WRITE:
-                gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
-                                        attr.gatt_type);
-                break;
-              default:
-                break;
-            }
-            status = GATT_SUCCESS;
-            break;
-          }
-        }
-        break;
+    auto it = gatt_sr_find_i_rcb_by_handle(handle);
+    const tGATT_ATTR* p_attr = nullptr;
+    if (it != gatt_cb.srv_list_info->end()) {
+      p_attr = find_attr_by_handle(it->p_db, handle);
+    }
+
+    if (p_attr != nullptr) {
+      tGATT_SRV_LIST_ELEM& el = *it;
+      switch (op_code) {
+        case GATT_REQ_READ: /* read char/char descriptor value */
+        case GATT_REQ_READ_BLOB:
+          gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
+          break;
+
+        case GATT_REQ_WRITE: /* write char/char descriptor value */
+        case GATT_CMD_WRITE:
+        case GATT_SIGN_CMD_WRITE:
+        case GATT_REQ_PREPARE_WRITE:
+          gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
+                                  p_attr->gatt_type);
+          break;
+        default:
+          break;
       }
+      status = GATT_SUCCESS;
     }
   }
 
@@ -1267,13 +1265,12 @@ void gatts_process_value_conf(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code) {
   if (continue_processing) {
     tGATTS_DATA gatts_data;
     gatts_data.handle = handle;
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
-        uint16_t conn_id = GATT_CREATE_CONN_ID(tcb.tcb_idx, el.gatt_if);
-        gatt_sr_send_req_callback(conn_id, trans_id, GATTS_REQ_TYPE_CONF,
-                                  &gatts_data);
-      }
+    auto it = gatt_sr_find_i_rcb_by_handle(handle);
+    if (it != gatt_cb.srv_list_info->end()) {
+      uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
+      uint16_t conn_id = GATT_CREATE_CONN_ID(tcb.tcb_idx, it->gatt_if);
+      gatt_sr_send_req_callback(conn_id, trans_id, GATTS_REQ_TYPE_CONF,
+                                &gatts_data);
     }
   }
 }
@@ -26,6 +26,7 @@
 #include <base/logging.h>
 #include <base/strings/stringprintf.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 
@@ -762,25 +763,70 @@ void  gatt_ind_ack_timeout(void* data) {
    */
   attp_send_cl_confirmation_msg(*p_tcb, L2CAP_ATT_CID);
 }
+/*******************************************************************************
+ *
+ * Description      Rebuild the handle index of the service list. Must be
+ *                  called whenever a service is added to or removed from
+ *                  gatt_cb.srv_list_info.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_sr_update_srv_list_index() {
+  gatt_cb.srv_list_index.clear();
+  if (gatt_cb.srv_list_info == nullptr) return;
+
+  gatt_cb.srv_list_index.reserve(gatt_cb.srv_list_info->size());
+  for (auto it = gatt_cb.srv_list_info->begin();
+       it != gatt_cb.srv_list_info->end(); it++) {
+    gatt_cb.srv_list_index.push_back(it);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Description      Search for the first service that ends at or after a
+ *                  specific handle. Services are kept in handle order and do
+ *                  not overlap, so iterating from there visits every service
+ *                  in a handle range.
+ *
+ * Returns          gatt_cb.srv_list_info->end() if not found. Otherwise an
+ *                  iterator to the service.
+ *
+ ******************************************************************************/
+std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_first_srv_from_handle(
+    uint16_t handle) {
+  if (gatt_cb.srv_list_index.size() != gatt_cb.srv_list_info->size()) {
+    gatt_sr_update_srv_list_index();
+  }
+
+  auto index = std::lower_bound(
+      gatt_cb.srv_list_index.begin(), gatt_cb.srv_list_index.end(), handle,
+      [](const std::list<tGATT_SRV_LIST_ELEM>::iterator& it, uint16_t handle) {
+        return it->e_hdl < handle;
+      });
+  if (index == gatt_cb.srv_list_index.end()) {
+    return gatt_cb.srv_list_info->end();
+  }
+  return *index;
+}
+
 /*******************************************************************************
  *
  * Description      Search for a service that owns a specific handle.
  *
- * Returns          GATT_MAX_SR_PROFILES if not found. Otherwise the index of
- *                  the service.
+ * Returns          gatt_cb.srv_list_info->end() if not found. Otherwise an
+ *                  iterator to the service.
  *
  ******************************************************************************/
 std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle) {
-  auto it = gatt_cb.srv_list_info->begin();
-
-  for (; it != gatt_cb.srv_list_info->end(); it++) {
-    if (it->s_hdl <= handle && it->e_hdl >= handle) {
-      return it;
-    }
+  auto it = gatt_sr_find_first_srv_from_handle(handle);
+  if (it != gatt_cb.srv_list_info->end() && it->s_hdl <= handle) {
+    return it;
   }
 
-  return it;
+  return gatt_cb.srv_list_info->end();
 }
 
 /*******************************************************************************
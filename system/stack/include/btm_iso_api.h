@@ -163,7 +163,9 @@ class IsoManager {
   virtual void ReadIsoLinkQuality(uint16_t conn_handle);
 
   /**
-   * Sends iso data to the controller
+   * Sends iso data to the controller. If the controller has no free ISO
+   * buffers, the data is queued and sent once buffers are returned, unless it
+   * expires or overflows the queue first.
    *
    * @param conn_handle handle of BIS or CIS connection
    * @param data data buffer. The ownership of data is not being transferred.
@@ -51,6 +51,13 @@ constexpr uint8_t kIsoDataPathHci = 0x00;
 constexpr uint8_t kIsoDataPathPlatformDefault = 0x01;
 constexpr uint8_t kIsoDataPathDisabled = 0xFF;
 
+/* ISO data sent while the controller is out of buffers is queued per CIS/BIS,
+ * up to kIsoTxQueueMaxDepth SDUs. Queued SDUs not sent within
+ * kIsoTxQueueMaxSduItvs SDU intervals are dropped as too late to be played.
+ */
+constexpr uint8_t kIsoTxQueueMaxDepth = 8;
+constexpr uint8_t kIsoTxQueueMaxSduItvs = 4;
+
 constexpr uint8_t kIsoSca251To500Ppm = 0x00;
 constexpr uint8_t kIsoSca151To250Ppm = 0x01;
 constexpr uint8_t kIsoSca101To150Ppm = 0x02;
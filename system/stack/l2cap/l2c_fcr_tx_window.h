@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/l2cdefs.h"
+
+/* I-frames sent in eRTM mode and waiting for the peer to acknowledge them,
+ * held in a ring indexed by TxSeq. Acknowledged frames are released from the
+ * front, and a retransmission only marks the TxSeq until the link can take the
+ * frame, so nothing is copied for frames that are acknowledged in between.
+ *
+ * Plain data so that it can live in tL2C_FCRB, which is reset with memset.
+ */
+struct tL2C_FCR_TX_WINDOW {
+  static constexpr uint8_t kSize = L2CAP_FCR_SEQ_MODULO + 1;
+
+  BT_HDR* frames[kSize];
+  uint8_t first_seq;        /* TxSeq of the oldest unacknowledged frame */
+  uint8_t count;            /* Number of unacknowledged frames */
+  uint64_t retransmissions; /* One bit per TxSeq waiting to be resent */
+
+  bool IsEmpty() const { return count == 0; }
+  uint8_t Size() const { return count; }
+
+  /* Adds the frame that was sent with the TxSeq following the last one */
+  void Push(BT_HDR* p_buf) {
+    frames[(first_seq + count) & L2CAP_FCR_SEQ_MODULO] = p_buf;
+    count++;
+  }
+
+  /* Returns the unacknowledged frame sent with |tx_seq|, or nullptr */
+  BT_HDR* Get(uint8_t tx_seq) const {
+    if (((tx_seq - first_seq) & L2CAP_FCR_SEQ_MODULO) >= count) return nullptr;
+    return frames[tx_seq & L2CAP_FCR_SEQ_MODULO];
+  }
+
+  /* Removes the oldest frame, once acknowledged, and returns it */
+  BT_HDR* PopFront() {
+    BT_HDR* p_buf = frames[first_seq];
+    frames[first_seq] = nullptr;
+    retransmissions &= ~(uint64_t{1} << first_seq);
+    first_seq = (first_seq + 1) & L2CAP_FCR_SEQ_MODULO;
+    count--;
+    return p_buf;
+  }
+
+  /* Marks the frame sent with |tx_seq| for retransmission. Returns false if
+   * there is no such unacknowledged frame */
+  bool QueueRetransmission(uint8_t tx_seq) {
+    if (Get(tx_seq) == nullptr) return false;
+    retransmissions |= uint64_t{1} << (tx_seq & L2CAP_FCR_SEQ_MODULO);
+    return true;
+  }
+
+  /* Marks all unacknowledged frames for retransmission */
+  void QueueAllRetransmissions() {
+    uint64_t mask = (count == kSize) ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+    retransmissions = RotateLeft(mask, first_seq);
+  }
+
+  void CancelRetransmissions() { retransmissions = 0; }
+  bool HasRetransmissions() const { return retransmissions != 0; }
+
+  /* Takes the next frame to resend, oldest first, or nullptr if none. The frame
+   * stays in the window until it is acknowledged. */
+  BT_HDR* NextRetransmission() {
+    if (retransmissions == 0) return nullptr;
+    uint64_t from_first = RotateLeft(retransmissions, kSize - first_seq);
+    uint8_t tx_seq =
+        (first_seq + __builtin_ctzll(from_first)) & L2CAP_FCR_SEQ_MODULO;
+    retransmissions &= ~(uint64_t{1} << tx_seq);
+    return frames[tx_seq];
+  }
+
+  /* Frees all frames and empties the window */
+  void Clear() {
+    while (!IsEmpty()) osi_free(PopFront());
+  }
+
+ private:
+  static uint64_t RotateLeft(uint64_t value, uint8_t shift) {
+    shift &= L2CAP_FCR_SEQ_MODULO;
+    if (shift == 0) return value;
+    return (value << shift) | (value >> (kSize - shift));
+  }
+};
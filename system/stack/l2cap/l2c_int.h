@@ -42,6 +42,7 @@
 #include "osi/include/list.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/hci_error_code.h"
+#include "stack/l2cap/l2c_fcr_tx_window.h"
 #include "types/hci_role.h"
 #include "types/raw_address.h"
 
@@ -244,10 +245,8 @@ typedef struct {
 
   uint16_t rx_sdu_len; /* Length of the SDU being received */
   BT_HDR* p_rx_sdu;    /* Buffer holding the SDU being received */
-  fixed_queue_t*
-      waiting_for_ack_q;          /* Buffers sent and waiting for peer to ack */
+  tL2C_FCR_TX_WINDOW tx_window;  /* Frames sent and waiting for peer to ack */
   fixed_queue_t* srej_rcv_hold_q; /* Buffers rcvd but held pending SREJ rsp */
-  fixed_queue_t* retrans_q;       /* Buffers being retransmitted */
 
   alarm_t* ack_timer;         /* Timer delaying RR */
   alarm_t* mon_retrans_timer; /* Timer Monitor or Retransmission */
@@ -1283,7 +1283,7 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
         if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_BASIC_MODE) {
           if (p_ccb->fcrb.wait_ack || p_ccb->fcrb.remote_busy) continue;
 
-          if (fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
+          if (!p_ccb->fcrb.tx_window.HasRetransmissions()) {
             if (fixed_queue_is_empty(p_ccb->xmit_hold_q)) continue;
 
             /* If in eRTM mode, check for window closure */
@@ -1349,7 +1349,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
       if (p_ccb->fcrb.wait_ack || p_ccb->fcrb.remote_busy) continue;
 
       /* No more checks needed if sending from the reatransmit queue */
-      if (fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
+      if (!p_ccb->fcrb.tx_window.HasRetransmissions()) {
         if (fixed_queue_is_empty(p_ccb->xmit_hold_q)) continue;
 
         /* If in eRTM mode, check for window closure */
@@ -1443,8 +1443,7 @@ tL2C_CCB* l2cu_allocate_ccb(tL2C_LCB* p_lcb, uint16_t cid) {
 
   p_ccb->xmit_hold_q = fixed_queue_new(SIZE_MAX);
   p_ccb->fcrb.srej_rcv_hold_q = fixed_queue_new(SIZE_MAX);
-  p_ccb->fcrb.retrans_q = fixed_queue_new(SIZE_MAX);
-  p_ccb->fcrb.waiting_for_ack_q = fixed_queue_new(SIZE_MAX);
+  p_ccb->fcrb.tx_window = {};
 
   p_ccb->cong_sent = false;
   p_ccb->buff_quota = 2; /* This gets set after config */
@@ -397,6 +397,72 @@ TEST_F(StackBtmWithInitFreeTest, btm_sec_allocate_dev_rec__all) {
   // Further, the memory for each record is reused when necessary.
 }
 
+TEST_F(StackBtmWithInitFreeTest, btm_find_dev__follows_record_changes) {
+  const RawAddress bd_addr = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const RawAddress new_bd_addr =
+      RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x77});
+
+  tBTM_SEC_DEV_REC* other_record = btm_sec_allocate_dev_rec();
+  other_record->bd_addr = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x88});
+  other_record->hci_handle = HCI_INVALID_HANDLE;
+  other_record->ble_hci_handle = HCI_INVALID_HANDLE;
+
+  tBTM_SEC_DEV_REC* device_record = btm_sec_allocate_dev_rec();
+  device_record->bd_addr = bd_addr;
+  device_record->hci_handle = 0x0010;
+  device_record->ble_hci_handle = HCI_INVALID_HANDLE;
+  btm_sec_dev_rec_update_index(device_record);
+
+  ASSERT_EQ(device_record, btm_find_dev(bd_addr));
+  ASSERT_EQ(device_record, btm_find_dev_by_handle(0x0010));
+
+  // Fields written without updating the index are still found
+  device_record->bd_addr = new_bd_addr;
+  device_record->hci_handle = 0x0020;
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0010));
+  ASSERT_EQ(device_record, btm_find_dev(new_bd_addr));
+  ASSERT_EQ(device_record, btm_find_dev_by_handle(0x0020));
+
+  // The handle moving to another record is picked up
+  device_record->hci_handle = HCI_INVALID_HANDLE;
+  other_record->hci_handle = 0x0020;
+  ASSERT_EQ(other_record, btm_find_dev_by_handle(0x0020));
+
+  wipe_secrets_and_remove(device_record);
+  ASSERT_EQ(nullptr, btm_find_dev(new_bd_addr));
+  ASSERT_EQ(other_record, btm_find_dev_by_handle(0x0020));
+}
+
+TEST_F(StackBtmWithInitFreeTest, btm_find_dev__duplicate_records) {
+  const RawAddress bd_addr = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+
+  tBTM_SEC_DEV_REC* first_record = btm_sec_allocate_dev_rec();
+  first_record->bd_addr = bd_addr;
+  first_record->hci_handle = 0x0010;
+  first_record->ble_hci_handle = HCI_INVALID_HANDLE;
+
+  tBTM_SEC_DEV_REC* second_record = btm_sec_allocate_dev_rec();
+  second_record->bd_addr = bd_addr;
+  second_record->hci_handle = 0x0010;
+  second_record->ble_hci_handle = HCI_INVALID_HANDLE;
+  second_record->ble.key_type = BTM_LE_KEY_LENC;
+
+  // Indexing the later record keeps returning the first one, as the scan does
+  btm_sec_dev_rec_update_index(second_record);
+  ASSERT_EQ(first_record, btm_find_dev(bd_addr));
+  ASSERT_EQ(first_record, btm_find_dev_by_handle(0x0010));
+  ASSERT_EQ(second_record, btm_find_dev_with_lenc(bd_addr));
+
+  btm_sec_dev_rec_update_index(first_record);
+  ASSERT_EQ(first_record, btm_find_dev(bd_addr));
+  ASSERT_EQ(second_record, btm_find_dev_with_lenc(bd_addr));
+
+  wipe_secrets_and_remove(first_record);
+  ASSERT_EQ(second_record, btm_find_dev(bd_addr));
+  ASSERT_EQ(second_record, btm_find_dev_by_handle(0x0010));
+}
+
 TEST_F(StackBtmTest, btm_oob_data_text) {
   std::vector<std::pair<tBTM_OOB_DATA, std::string>> datas = {
       std::make_pair(BTM_OOB_NONE, "BTM_OOB_NONE"),
@@ -18,6 +18,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 #include "btm_iso_api.h"
 #include "hci/include/hci_layer.h"
 #include "main/shim/shim.h"
@@ -1959,6 +1962,7 @@ TEST_F(IsoManagerTest, SendIsoDataBigValid) {
 
 TEST_F(IsoManagerTest, SendIsoDataNoCredits) {
   uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
+  uint8_t queue_depth = bluetooth::hci::iso_manager::kIsoTxQueueMaxDepth;
   std::vector<uint8_t> data_vec(108, 0);
 
   // Check on CIG
@@ -1975,23 +1979,48 @@ TEST_F(IsoManagerTest, SendIsoDataNoCredits) {
       volatile_test_cig_create_cmpl_evt_.conn_handles[0],
       kDefaultIsoDataPathParams);
 
-  /* Try sending twice as much data as we can ignoring the credit limits and
-   * expect the redundant packets to be ignored and not propagated down to the
-   * HCI.
+  /* Try sending more data than there are credits and queue space for. Expect
+   * only as many packets as there are credits to go down to the HCI, and the
+   * oldest of the redundant packets to be dropped from the queue.
    */
-  EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers).RetiresOnSaturation();
-  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+  EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers);
+  for (uint8_t i = 0; i < num_buffers + queue_depth + 2; i++) {
+    data_vec[0] = i;
     IsoManager::GetInstance()->SendIsoData(
         volatile_test_cig_create_cmpl_evt_.conn_handles[0], data_vec.data(),
         data_vec.size());
   }
-
-  // Return all credits for this one handle
+  testing::Mock::VerifyAndClearExpectations(&bte_interface_);
+
+  // Return all credits for this one handle, twice, to drain the queue
+  std::vector<uint8_t> sent_packets;
+  EXPECT_CALL(bte_interface_, HciSend)
+      .Times(queue_depth)
+      .WillRepeatedly([&sent_packets](BT_HDR* p_msg, uint16_t event) {
+        sent_packets.push_back(p_msg->data[12]);
+      });
   uint8_t mock_rsp[5];
+  for (int i = 0; i < 2; i++) {
+    uint8_t* p = mock_rsp;
+    UINT8_TO_STREAM(p, 1);
+    UINT16_TO_STREAM(p, volatile_test_cig_create_cmpl_evt_.conn_handles[0]);
+    UINT16_TO_STREAM(p, num_buffers);
+    IsoManager::GetInstance()->HandleNumComplDataPkts(mock_rsp,
+                                                      sizeof(mock_rsp));
+  }
+  testing::Mock::VerifyAndClearExpectations(&bte_interface_);
+
+  std::vector<uint8_t> expected_packets;
+  for (uint8_t i = 0; i < queue_depth; i++) {
+    expected_packets.push_back(num_buffers + 2 + i);
+  }
+  ASSERT_EQ(sent_packets, expected_packets);
+
+  // Return the credits used by the queued packets sent after the first return
   uint8_t* p = mock_rsp;
   UINT8_TO_STREAM(p, 1);
   UINT16_TO_STREAM(p, volatile_test_cig_create_cmpl_evt_.conn_handles[0]);
-  UINT16_TO_STREAM(p, num_buffers);
+  UINT16_TO_STREAM(p, queue_depth - num_buffers);
   IsoManager::GetInstance()->HandleNumComplDataPkts(mock_rsp, sizeof(mock_rsp));
 
   // Check on BIG
@@ -2000,12 +2029,11 @@ TEST_F(IsoManagerTest, SendIsoDataNoCredits) {
   IsoManager::GetInstance()->SetupIsoDataPath(
       volatile_test_big_params_evt_.conn_handles[0], kDefaultIsoDataPathParams);
 
-  /* Try sending twice as much data as we can ignoring the credit limits and
-   * expect the redundant packets to be ignored and not propagated down to the
-   * HCI.
+  /* Try sending more data than there are credits and queue space for, and
+   * expect the redundant packets not to be propagated down to the HCI.
    */
   EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers);
-  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+  for (uint8_t i = 0; i < num_buffers + queue_depth + 2; i++) {
     IsoManager::GetInstance()->SendIsoData(
         volatile_test_big_params_evt_.conn_handles[0], data_vec.data(),
         data_vec.size());
@@ -2030,12 +2058,9 @@ TEST_F(IsoManagerTest, SendIsoDataCreditsReturned) {
       volatile_test_cig_create_cmpl_evt_.conn_handles[0],
       kDefaultIsoDataPathParams);
 
-  /* Try sending twice as much data as we can, ignoring the credits limit and
-   * expect the redundant packets to be ignored and not propagated down to the
-   * HCI.
-   */
+  // Use up all the credits
   EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers).RetiresOnSaturation();
-  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+  for (uint8_t i = 0; i < num_buffers; i++) {
     IsoManager::GetInstance()->SendIsoData(
         volatile_test_cig_create_cmpl_evt_.conn_handles[0], data_vec.data(),
         data_vec.size());
@@ -2051,7 +2076,7 @@ TEST_F(IsoManagerTest, SendIsoDataCreditsReturned) {
 
   // Expect some more events go down the HCI
   EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers).RetiresOnSaturation();
-  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+  for (uint8_t i = 0; i < num_buffers; i++) {
     IsoManager::GetInstance()->SendIsoData(
         volatile_test_cig_create_cmpl_evt_.conn_handles[0], data_vec.data(),
         data_vec.size());
@@ -2070,12 +2095,9 @@ TEST_F(IsoManagerTest, SendIsoDataCreditsReturned) {
   IsoManager::GetInstance()->SetupIsoDataPath(
       volatile_test_big_params_evt_.conn_handles[0], kDefaultIsoDataPathParams);
 
-  /* Try sending twice as much data as we can, ignoring the credits limit and
-   * expect the redundant packets to be ignored and not propagated down to the
-   * HCI.
-   */
+  // Use up all the credits
   EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers).RetiresOnSaturation();
-  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+  for (uint8_t i = 0; i < num_buffers; i++) {
     IsoManager::GetInstance()->SendIsoData(
         volatile_test_big_params_evt_.conn_handles[0], data_vec.data(),
         data_vec.size());
@@ -2090,13 +2112,117 @@ TEST_F(IsoManagerTest, SendIsoDataCreditsReturned) {
 
   // Expect some more events go down the HCI
   EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers).RetiresOnSaturation();
-  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+  for (uint8_t i = 0; i < num_buffers; i++) {
     IsoManager::GetInstance()->SendIsoData(
         volatile_test_big_params_evt_.conn_handles[0], data_vec.data(),
         data_vec.size());
   }
 }
 
+TEST_F(IsoManagerTest, SendIsoDataQueuedDrainedInTurns) {
+  uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
+  std::vector<uint8_t> data_vec(108, 0);
+
+  IsoManager::GetInstance()->CreateCig(
+      volatile_test_cig_create_cmpl_evt_.cig_id, kDefaultCigParams);
+
+  bluetooth::hci::iso_manager::cis_establish_params params;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    params.conn_pairs.push_back({handle, 1});
+  }
+  IsoManager::GetInstance()->EstablishCis(params);
+
+  uint16_t handle_0 = volatile_test_cig_create_cmpl_evt_.conn_handles[0];
+  uint16_t handle_1 = volatile_test_cig_create_cmpl_evt_.conn_handles[1];
+  IsoManager::GetInstance()->SetupIsoDataPath(handle_0,
+                                              kDefaultIsoDataPathParams);
+  IsoManager::GetInstance()->SetupIsoDataPath(handle_1,
+                                              kDefaultIsoDataPathParams);
+
+  // Use up all the credits on the first CIS, then queue on both
+  EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers);
+  for (uint8_t i = 0; i < num_buffers + 2; i++) {
+    IsoManager::GetInstance()->SendIsoData(handle_0, data_vec.data(),
+                                           data_vec.size());
+  }
+  for (uint8_t i = 0; i < 2; i++) {
+    IsoManager::GetInstance()->SendIsoData(handle_1, data_vec.data(),
+                                           data_vec.size());
+  }
+  testing::Mock::VerifyAndClearExpectations(&bte_interface_);
+
+  // Credits returned one at a time are shared between the two CISes
+  std::vector<uint16_t> sent_handles;
+  EXPECT_CALL(bte_interface_, HciSend)
+      .Times(4)
+      .WillRepeatedly([&sent_handles](BT_HDR* p_msg, uint16_t event) {
+        uint8_t* p = p_msg->data;
+        uint16_t handle;
+        STREAM_TO_UINT16(handle, p);
+        sent_handles.push_back(handle);
+      });
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t mock_rsp[5];
+    uint8_t* p = mock_rsp;
+    UINT8_TO_STREAM(p, 1);
+    UINT16_TO_STREAM(p, handle_0);
+    UINT16_TO_STREAM(p, 1);
+    IsoManager::GetInstance()->HandleNumComplDataPkts(mock_rsp,
+                                                      sizeof(mock_rsp));
+  }
+
+  ASSERT_EQ(sent_handles.size(), 4u);
+  ASSERT_NE(sent_handles[0], sent_handles[1]);
+  ASSERT_EQ(sent_handles[0], sent_handles[2]);
+  ASSERT_EQ(sent_handles[1], sent_handles[3]);
+}
+
+TEST_F(IsoManagerTest, SendIsoDataQueuedExpired) {
+  uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
+  std::vector<uint8_t> data_vec(108, 0);
+
+  IsoManager::GetInstance()->CreateCig(
+      volatile_test_cig_create_cmpl_evt_.cig_id, kDefaultCigParams);
+
+  bluetooth::hci::iso_manager::cis_establish_params params;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    params.conn_pairs.push_back({handle, 1});
+  }
+  IsoManager::GetInstance()->EstablishCis(params);
+
+  uint16_t handle = volatile_test_cig_create_cmpl_evt_.conn_handles[0];
+  IsoManager::GetInstance()->SetupIsoDataPath(handle,
+                                              kDefaultIsoDataPathParams);
+
+  EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers);
+  for (uint8_t i = 0; i < num_buffers + 2; i++) {
+    IsoManager::GetInstance()->SendIsoData(handle, data_vec.data(),
+                                           data_vec.size());
+  }
+  testing::Mock::VerifyAndClearExpectations(&bte_interface_);
+
+  // Let the queued packets become too old to be played
+  std::this_thread::sleep_for(std::chrono::microseconds(
+      (bluetooth::hci::iso_manager::kIsoTxQueueMaxSduItvs + 1) *
+      kDefaultCigParams.sdu_itv_mtos));
+
+  EXPECT_CALL(bte_interface_, HciSend).Times(0);
+  uint8_t mock_rsp[5];
+  uint8_t* p = mock_rsp;
+  UINT8_TO_STREAM(p, 1);
+  UINT16_TO_STREAM(p, handle);
+  UINT16_TO_STREAM(p, num_buffers);
+  IsoManager::GetInstance()->HandleNumComplDataPkts(mock_rsp, sizeof(mock_rsp));
+  testing::Mock::VerifyAndClearExpectations(&bte_interface_);
+
+  // Fresh data goes straight down with the returned credits
+  EXPECT_CALL(bte_interface_, HciSend).Times(num_buffers);
+  for (uint8_t i = 0; i < num_buffers; i++) {
+    IsoManager::GetInstance()->SendIsoData(handle, data_vec.data(),
+                                           data_vec.size());
+  }
+}
+
 TEST_F(IsoManagerTest, SendIsoDataCreditsReturnedByDisconnection) {
   uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
   std::vector<uint8_t> data_vec(108, 0);
@@ -57,7 +57,10 @@ class GattApiTest : public ::testing::Test {
     logging::SetMinLogLevel(-2);
   }
 
-  void TearDown() override { list_free(btm_cb.sec_dev_rec); }
+  void TearDown() override {
+    btm_cb.sec_dev_rec_index.Clear();
+    list_free(btm_cb.sec_dev_rec);
+  }
 };
 
 static const RawAddress SAMPLE_PUBLIC_BDA = {
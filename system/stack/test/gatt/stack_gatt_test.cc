@@ -21,6 +21,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/message_loop_thread.h"
 #include "common/strings.h"
@@ -137,6 +139,63 @@ TEST_F(StackGattTest, GATT_Register_Deregister) {
   gatt_free();
 }
 
+TEST_F(StackGattTest, find_attr_by_handle) {
+  tGATT_SVC_DB db;
+  gatts_init_service_db(db, bluetooth::Uuid::From16Bit(0x180f), true, 0x0100,
+                        7);
+  for (int i = 0; i < 3; i++) {
+    gatts_add_characteristic(db, GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+                             bluetooth::Uuid::From16Bit(0x2a19));
+  }
+
+  ASSERT_EQ(nullptr, find_attr_by_handle(&db, 0x00ff));
+  for (uint16_t handle = 0x0100; handle <= 0x0106; handle++) {
+    tGATT_ATTR* p_attr = find_attr_by_handle(&db, handle);
+    ASSERT_NE(nullptr, p_attr);
+    ASSERT_EQ(handle, p_attr->handle);
+  }
+  ASSERT_EQ(nullptr, find_attr_by_handle(&db, 0x0107));
+
+  ASSERT_EQ(db.attr_list.begin(),
+            gatts_find_first_attr_from_handle(db, 0x0001));
+  ASSERT_EQ(0x0104, gatts_find_first_attr_from_handle(db, 0x0104)->handle);
+  ASSERT_EQ(db.attr_list.end(), gatts_find_first_attr_from_handle(db, 0x0107));
+}
+
+TEST_F(StackGattTest, gatt_sr_find_i_rcb_by_handle) {
+  gatt_init();
+
+  // Services registered at init occupy the lowest handles
+  const std::vector<std::pair<uint16_t, uint16_t>> ranges = {
+      {0x8000, 0x8005}, {0x8010, 0x8012}, {0x9000, 0x9000}};
+  for (const auto& range : ranges) {
+    gatt_cb.srv_list_info->emplace_back();
+    gatt_cb.srv_list_info->back().s_hdl = range.first;
+    gatt_cb.srv_list_info->back().e_hdl = range.second;
+  }
+  gatt_sr_update_srv_list_index();
+
+  for (const auto& range : ranges) {
+    for (uint16_t handle : {range.first, range.second}) {
+      auto it = gatt_sr_find_i_rcb_by_handle(handle);
+      ASSERT_NE(gatt_cb.srv_list_info->end(), it);
+      ASSERT_EQ(range.first, it->s_hdl);
+    }
+  }
+  ASSERT_EQ(gatt_cb.srv_list_info->end(), gatt_sr_find_i_rcb_by_handle(0x8006));
+  ASSERT_EQ(gatt_cb.srv_list_info->end(), gatt_sr_find_i_rcb_by_handle(0x9001));
+
+  // Iteration over a handle range starts at the service overlapping it
+  ASSERT_EQ(0x8010, gatt_sr_find_first_srv_from_handle(0x8006)->s_hdl);
+  ASSERT_EQ(0x8010, gatt_sr_find_first_srv_from_handle(0x8011)->s_hdl);
+
+  // The index follows services removed from the list
+  gatt_cb.srv_list_info->pop_back();
+  ASSERT_EQ(gatt_cb.srv_list_info->end(), gatt_sr_find_i_rcb_by_handle(0x9000));
+
+  gatt_free();
+}
+
 TEST_F(StackGattTest, gatt_status_text) {
   std::vector<std::pair<tGATT_STATUS, std::string>> statuses = {
       std::make_pair(GATT_SUCCESS, "GATT_SUCCESS"),  // Also GATT_ENCRYPED_MITM
@@ -157,9 +157,8 @@ class StackL2capChannelTest : public StackL2capTest {
               .rx_sdu_len = 0,
               .p_rx_sdu =
                   nullptr,  // BT_HDR* Buffer holding the SDU being received
-              .waiting_for_ack_q = nullptr,  // fixed_queue_t*
+              .tx_window = {},               // tL2C_FCR_TX_WINDOW
               .srej_rcv_hold_q = nullptr,    // fixed_queue_t*
-              .retrans_q = nullptr,          // fixed_queue_t*
               .ack_timer = nullptr,          // alarm_t*
               .mon_retrans_timer = nullptr,  // alarm_t*
           },
@@ -205,6 +204,93 @@ TEST_F(StackL2capChannelTest, l2c_link_init) {
             l2cb.controller_xmit_window);
 }
 
+class StackL2capFcrTxWindowTest : public ::testing::Test {
+ protected:
+  void TearDown() override { window_.Clear(); }
+
+  // Sends |count| frames, the first one with |first_seq|
+  void Send(uint8_t first_seq, size_t count) {
+    window_.first_seq = first_seq;
+    for (size_t i = 0; i < count; i++) {
+      BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR));
+      p_buf->event = (first_seq + i) & L2CAP_FCR_SEQ_MODULO;
+      window_.Push(p_buf);
+    }
+  }
+
+  tL2C_FCR_TX_WINDOW window_ = {};
+};
+
+TEST_F(StackL2capFcrTxWindowTest, push_and_ack_across_wrap) {
+  Send(60, 8);
+  ASSERT_EQ(8, window_.Size());
+
+  ASSERT_EQ(nullptr, window_.Get(59));
+  ASSERT_EQ(nullptr, window_.Get(4));
+  for (uint8_t tx_seq : {60, 63, 0, 3}) {
+    ASSERT_EQ(tx_seq, window_.Get(tx_seq)->event);
+  }
+
+  for (uint8_t tx_seq : {60, 61, 62, 63, 0}) {
+    BT_HDR* p_buf = window_.PopFront();
+    ASSERT_EQ(tx_seq, p_buf->event);
+    osi_free(p_buf);
+  }
+  ASSERT_EQ(3, window_.Size());
+  ASSERT_EQ(1, window_.first_seq);
+  ASSERT_EQ(nullptr, window_.Get(0));
+}
+
+TEST_F(StackL2capFcrTxWindowTest, retransmit_all_oldest_first) {
+  Send(62, 5);
+
+  window_.QueueAllRetransmissions();
+  for (uint8_t tx_seq : {62, 63, 0, 1, 2}) {
+    BT_HDR* p_buf = window_.NextRetransmission();
+    ASSERT_NE(nullptr, p_buf);
+    ASSERT_EQ(tx_seq, p_buf->event);
+  }
+  ASSERT_EQ(nullptr, window_.NextRetransmission());
+  ASSERT_FALSE(window_.HasRetransmissions());
+
+  // Resent frames stay in the window until acknowledged
+  ASSERT_EQ(5, window_.Size());
+}
+
+TEST_F(StackL2capFcrTxWindowTest, retransmit_all_full_window) {
+  Send(17, tL2C_FCR_TX_WINDOW::kSize);
+
+  window_.QueueAllRetransmissions();
+  for (size_t i = 0; i < tL2C_FCR_TX_WINDOW::kSize; i++) {
+    ASSERT_EQ((17 + i) & L2CAP_FCR_SEQ_MODULO,
+              window_.NextRetransmission()->event);
+  }
+  ASSERT_FALSE(window_.HasRetransmissions());
+}
+
+TEST_F(StackL2capFcrTxWindowTest, retransmit_single_frame) {
+  Send(10, 4);
+
+  ASSERT_FALSE(window_.QueueRetransmission(9));
+  ASSERT_FALSE(window_.QueueRetransmission(14));
+  ASSERT_FALSE(window_.HasRetransmissions());
+
+  ASSERT_TRUE(window_.QueueRetransmission(12));
+  ASSERT_EQ(12, window_.NextRetransmission()->event);
+  ASSERT_EQ(nullptr, window_.NextRetransmission());
+}
+
+TEST_F(StackL2capFcrTxWindowTest, ack_cancels_pending_retransmission) {
+  Send(0, 3);
+
+  window_.QueueAllRetransmissions();
+  osi_free(window_.PopFront());
+  osi_free(window_.PopFront());
+
+  ASSERT_EQ(2, window_.NextRetransmission()->event);
+  ASSERT_EQ(nullptr, window_.NextRetransmission());
+}
+
 TEST_F(StackL2capTest, l2cap_result_code_text) {
   std::vector<std::pair<tL2CAP_CONN, std::string>> results = {
       std::make_pair(L2CAP_CONN_OK, "L2CAP_CONN_OK"),
@@ -46,6 +46,7 @@ struct alarm_new alarm_new;
 struct alarm_new_periodic alarm_new_periodic;
 struct alarm_set alarm_set;
 struct alarm_set_on_mloop alarm_set_on_mloop;
+struct alarm_set_queue_backend alarm_set_queue_backend;
 
 }  // namespace osi_alarm
 }  // namespace mock
@@ -94,5 +95,9 @@ void alarm_set_on_mloop(alarm_t* alarm, uint64_t interval_ms,
   inc_func_call_count(__func__);
   test::mock::osi_alarm::alarm_set_on_mloop(alarm, interval_ms, cb, data);
 }
+void alarm_set_queue_backend(alarm_queue_backend_t backend) {
+  inc_func_call_count(__func__);
+  test::mock::osi_alarm::alarm_set_queue_backend(backend);
+}
 // Mocked functions complete
 // END mockcify generation
@@ -175,6 +175,16 @@ struct alarm_set_on_mloop {
 };
 extern struct alarm_set_on_mloop alarm_set_on_mloop;
 
+// Name: alarm_set_queue_backend
+// Params: alarm_queue_backend_t backend
+// Return: void
+struct alarm_set_queue_backend {
+  std::function<void(alarm_queue_backend_t backend)> body{
+      [](alarm_queue_backend_t backend) {}};
+  void operator()(alarm_queue_backend_t backend) { body(backend); };
+};
+extern struct alarm_set_queue_backend alarm_set_queue_backend;
+
 }  // namespace osi_alarm
 }  // namespace mock
 }  // namespace test
@@ -123,6 +123,9 @@ void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec) {
 void btm_dev_consolidate_existing_connections(const RawAddress& bd_addr) {
   inc_func_call_count(__func__);
 }
+void btm_sec_dev_rec_update_index(tBTM_SEC_DEV_REC* p_dev_rec) {
+  inc_func_call_count(__func__);
+}
 void BTM_SecDump(const std::string& label) { inc_func_call_count(__func__); }
 void BTM_SecDumpDev(const RawAddress& bd_addr) {
   inc_func_call_count(__func__);
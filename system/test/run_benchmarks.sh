@@ -8,6 +8,16 @@
 #   $ ./test/run_benchmarks.sh bluetooth_benchmark_example
 
 known_benchmarks=(
+  bluetooth_benchmark_bta_gattc_cache
+  bluetooth_benchmark_bta_le_audio_encode
+  bluetooth_benchmark_device_interop
+  bluetooth_benchmark_embdrv_lc3
+  bluetooth_benchmark_embdrv_sbc_encoder
+  bluetooth_benchmark_main_shim_acl
+  bluetooth_benchmark_osi_alarm
+  bluetooth_benchmark_stack_btm_dev
+  bluetooth_benchmark_stack_gatt_sr
+  bluetooth_benchmark_stack_l2cap_ertm
   bluetooth_benchmark_thread_performance
   bluetooth_benchmark_timer_performance
 )